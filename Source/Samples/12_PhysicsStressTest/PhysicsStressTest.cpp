@@ -190,7 +190,8 @@ void PhysicsStressTest::CreateInstructions()
         "Use WASD keys and mouse/touch to move\n"
         "LMB to spawn physics objects\n"
         "F5 to save scene, F7 to load\n"
-        "Space to toggle physics debug geometry"
+        "Space to toggle physics debug geometry\n"
+        "T to toggle multithreaded physics, F2 to see step time"
     );
     instructionText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
     // The text has multiple rows. Center them in relation to each other
@@ -272,6 +273,13 @@ void PhysicsStressTest::MoveCamera(float timeStep)
     // Toggle physics debug geometry with space
     if (input->GetKeyPress(KEY_SPACE))
         drawDebug_ = !drawDebug_;
+
+    // Toggle multithreaded physics simulation with T. Compare the StepSimulation time in the profiler (F2)
+    if (input->GetKeyPress(KEY_T))
+    {
+        PhysicsWorld* physicsWorld = scene_->GetComponent<PhysicsWorld>();
+        physicsWorld->SetThreadedSimulation(!physicsWorld->GetThreadedSimulation());
+    }
 }
 
 void PhysicsStressTest::SpawnObject()
@@ -37,6 +37,7 @@ class Scene;
 ///     - Physics and rendering performance with a high (1000) moving object count
 ///     - Using triangle meshes for collision
 ///     - Optimizing physics simulation by leaving out collision event signaling
+///     - Running the physics simulation on multiple threads
 class PhysicsStressTest : public Sample
 {
     URHO3D_OBJECT(PhysicsStressTest, Sample);
@@ -350,7 +350,9 @@ void btConvexConvexAlgorithm ::processCollision (const btCollisionObjectWrapper*
 	
 	btGjkPairDetector::ClosestPointInput input;
 
-	btGjkPairDetector	gjkPairDetector(min0,min1,m_simplexSolver,m_pdSolver);
+	// Urho3D: use a local simplex solver instead of the one shared by all algorithms, so that pairs can be processed in parallel
+	btVoronoiSimplexSolver simplexSolver;
+	btGjkPairDetector	gjkPairDetector(min0,min1,&simplexSolver,m_pdSolver);
 	//TODO: if (dispatchInfo.m_useContinuous)
 	gjkPairDetector.setMinkowskiA(min0);
 	gjkPairDetector.setMinkowskiB(min1);
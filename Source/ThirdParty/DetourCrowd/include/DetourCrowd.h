@@ -204,6 +204,17 @@ struct dtCrowdAgentDebugInfo
 /// Type for the update callback.
 typedef void (*dtUpdateCallback)(dtCrowdAgent* ag, float dt);
 
+// Urho3D: Add multithreaded update support
+/// Type for a job processing the active agents in the range [begin, end) on the thread with the given index.
+typedef void (*dtCrowdJob)(void* context, int begin, int end, int threadIndex);
+
+/// Type for the parallel-for callback. It must run the job over the range [0, count), split into any number of
+/// sub-ranges, and return only after all of them have been processed. Sub-ranges running at the same time must use
+/// different thread indices, each less than the maximum thread count given to dtCrowd::setParallelFor().
+typedef void (*dtParallelForCallback)(void* userData, int count, dtCrowdJob job, void* context);
+
+struct dtCrowdAgentSortItem;
+
 /// Provides local steering behaviors for a group of agents. 
 /// @ingroup crowd
 class dtCrowd
@@ -234,6 +245,20 @@ class dtCrowd
 
 	dtNavMeshQuery* m_navquery;
 
+	// Urho3D: Add multithreaded update support
+	dtParallelForCallback m_parallelFor;
+	void* m_parallelForData;
+	int m_maxThreads;
+	dtNavMeshQuery** m_threadNavQueries;
+	dtObstacleAvoidanceQuery** m_threadObstacleQueries;
+	int* m_threadSampleCounts;
+	dtCrowdAgentSortItem* m_sortItems;
+	int m_updatePhase;
+	dtCrowdAgent** m_updateAgents;
+	int m_updateAgentCount;
+	float m_updateDt;
+	dtCrowdAgentDebugInfo* m_updateDebug;
+
 	void updateTopologyOptimization(dtCrowdAgent** agents, const int nagents, const float dt);
 	void updateMoveRequest(const float dt);
 	void checkPathValidity(dtCrowdAgent** agents, const int nagents, const float dt);
@@ -244,6 +269,13 @@ class dtCrowd
 
 	void purge();
 
+	// Urho3D: Add multithreaded update support
+	void purgeThreads();
+	void sortAgentsSpatially(dtCrowdAgent** agents, const int nagents);
+	void runUpdatePhase(const int phase, const int nagents, const bool parallel);
+	void updateAgentRange(const int begin, const int end, const int threadIndex);
+	static void updateAgentRangeJob(void* context, int begin, int end, int threadIndex);
+
 public:
 	dtCrowd();
 	~dtCrowd();
@@ -256,6 +288,14 @@ public:
 	///  @param[in]		cb				The update callback.
 	/// @return True if the initialization succeeded.
 	bool init(const int maxAgents, const float maxAgentRadius, dtNavMesh* nav, dtUpdateCallback cb = 0);
+
+	// Urho3D: Add multithreaded update support
+	/// Sets the callback used to run the per-agent update stages on multiple threads. Must be called after init().
+	///  @param[in]		cb			The parallel-for callback, or null to update on the calling thread only.
+	///  @param[in]		userData	User pointer passed to the callback.
+	///  @param[in]		maxThreads	The maximum number of threads the callback uses, including the calling one. [Limit: >= 1]
+	/// @return True if the per-thread query objects were allocated.
+	bool setParallelFor(dtParallelForCallback cb, void* userData, const int maxThreads);
 	
 	/// Sets the shared avoidance configuration for the specified index.
 	///  @param[in]		idx		The index. [Limits: 0 <= value < #DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS]
@@ -53,6 +53,40 @@ static const int MAX_ITERS_PER_UPDATE = 100;
 static const int MAX_PATHQUEUE_NODES = 4096;
 static const int MAX_COMMON_NODES = 512;
 
+// Urho3D: Add multithreaded update support
+static const int MIN_PARALLEL_AGENTS = 64;
+
+enum UpdatePhase
+{
+	UPDATE_NEIGHBOURS,
+	UPDATE_CORNERS,
+	UPDATE_STEERING,
+	UPDATE_VELOCITY_PLANNING,
+	UPDATE_INTEGRATE,
+	UPDATE_COLLISION_DISPLACEMENT,
+	UPDATE_COLLISION_RESOLVE,
+	UPDATE_MOVE
+};
+
+struct dtCrowdAgentSortItem
+{
+	int x, z;
+	dtCrowdAgent* agent;
+};
+
+static int compareAgentSortItems(const void* va, const void* vb)
+{
+	const dtCrowdAgentSortItem* a = (const dtCrowdAgentSortItem*)va;
+	const dtCrowdAgentSortItem* b = (const dtCrowdAgentSortItem*)vb;
+	if (a->z != b->z)
+		return a->z < b->z ? -1 : 1;
+	if (a->x != b->x)
+		return a->x < b->x ? -1 : 1;
+	if (a->agent != b->agent)
+		return a->agent < b->agent ? -1 : 1;
+	return 0;
+}
+
 inline float tween(const float t, const float t0, const float t1)
 {
 	return dtClamp((t-t0) / (t1-t0), 0.0f, 1.0f);
@@ -344,7 +378,20 @@ dtCrowd::dtCrowd() :
 	m_maxPathResult(0),
 	m_maxAgentRadius(0),
 	m_velocitySampleCount(0),
-	m_navquery(0)
+	m_navquery(0),
+	// Urho3D: Add multithreaded update support
+	m_parallelFor(0),
+	m_parallelForData(0),
+	m_maxThreads(0),
+	m_threadNavQueries(0),
+	m_threadObstacleQueries(0),
+	m_threadSampleCounts(0),
+	m_sortItems(0),
+	m_updatePhase(0),
+	m_updateAgents(0),
+	m_updateAgentCount(0),
+	m_updateDt(0),
+	m_updateDebug(0)
 {
 	// Urho3D: initialize all class members
 	memset(&m_ext, 0, sizeof(m_ext));
@@ -358,6 +405,9 @@ dtCrowd::~dtCrowd()
 
 void dtCrowd::purge()
 {
+	// Urho3D: Add multithreaded update support
+	purgeThreads();
+
 	for (int i = 0; i < m_maxAgents; ++i)
 		m_agents[i].~dtCrowdAgent();
 	dtFree(m_agents);
@@ -470,6 +520,77 @@ bool dtCrowd::init(const int maxAgents, const float maxAgentRadius, dtNavMesh* n
 	return true;
 }
 
+// Urho3D: Add multithreaded update support
+void dtCrowd::purgeThreads()
+{
+	for (int i = 0; i < m_maxThreads; ++i)
+	{
+		if (m_threadNavQueries)
+			dtFreeNavMeshQuery(m_threadNavQueries[i]);
+		if (m_threadObstacleQueries)
+			dtFreeObstacleAvoidanceQuery(m_threadObstacleQueries[i]);
+	}
+	dtFree(m_threadNavQueries);
+	m_threadNavQueries = 0;
+	dtFree(m_threadObstacleQueries);
+	m_threadObstacleQueries = 0;
+	dtFree(m_threadSampleCounts);
+	m_threadSampleCounts = 0;
+	dtFree(m_sortItems);
+	m_sortItems = 0;
+
+	m_maxThreads = 0;
+	m_parallelFor = 0;
+	m_parallelForData = 0;
+}
+
+/// @par
+///
+/// Each thread other than the calling one gets its own navigation mesh query and obstacle avoidance query, so the
+/// per-agent stages of #update can run concurrently. The callback is used only when there are enough active agents
+/// and no debug information is requested. Calling #init again disables multithreading.
+bool dtCrowd::setParallelFor(dtParallelForCallback cb, void* userData, const int maxThreads)
+{
+	purgeThreads();
+
+	if (!cb || maxThreads < 2)
+		return true;
+	if (!m_navquery)
+		return false;
+
+	m_maxThreads = maxThreads;
+
+	m_threadNavQueries = (dtNavMeshQuery**)dtAlloc(sizeof(dtNavMeshQuery*)*m_maxThreads, DT_ALLOC_PERM);
+	m_threadObstacleQueries = (dtObstacleAvoidanceQuery**)dtAlloc(sizeof(dtObstacleAvoidanceQuery*)*m_maxThreads, DT_ALLOC_PERM);
+	m_threadSampleCounts = (int*)dtAlloc(sizeof(int)*m_maxThreads, DT_ALLOC_PERM);
+	m_sortItems = (dtCrowdAgentSortItem*)dtAlloc(sizeof(dtCrowdAgentSortItem)*m_maxAgents, DT_ALLOC_PERM);
+	if (!m_threadNavQueries || !m_threadObstacleQueries || !m_threadSampleCounts || !m_sortItems)
+	{
+		purgeThreads();
+		return false;
+	}
+	memset(m_threadNavQueries, 0, sizeof(dtNavMeshQuery*)*m_maxThreads);
+	memset(m_threadObstacleQueries, 0, sizeof(dtObstacleAvoidanceQuery*)*m_maxThreads);
+	memset(m_threadSampleCounts, 0, sizeof(int)*m_maxThreads);
+
+	// The calling thread uses the crowd's own query objects.
+	for (int i = 1; i < m_maxThreads; ++i)
+	{
+		m_threadNavQueries[i] = dtAllocNavMeshQuery();
+		m_threadObstacleQueries[i] = dtAllocObstacleAvoidanceQuery();
+		if (!m_threadNavQueries[i] || dtStatusFailed(m_threadNavQueries[i]->init(m_navquery->getAttachedNavMesh(), MAX_COMMON_NODES)) ||
+			!m_threadObstacleQueries[i] || !m_threadObstacleQueries[i]->init(6, 8))
+		{
+			purgeThreads();
+			return false;
+		}
+	}
+
+	m_parallelFor = cb;
+	m_parallelForData = userData;
+	return true;
+}
+
 void dtCrowd::setObstacleAvoidanceParams(const int idx, const dtObstacleAvoidanceParams* params)
 {
 	if (idx >= 0 && idx < DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS)
@@ -1058,8 +1179,6 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 {
 	m_velocitySampleCount = 0;
 	
-	const int debugIdx = debug ? debug->idx : -1;
-	
 	dtCrowdAgent** agents = m_activeAgents;
 	int nagents = getActiveAgents(agents, m_maxAgents);
 
@@ -1072,6 +1191,17 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 	// Optimize path topology.
 	updateTopologyOptimization(agents, nagents, dt);
 	
+	// Urho3D: Add multithreaded update support
+	// Debug information refers to an agent by its position in the active agent list, so the update stays on the
+	// calling thread when it is requested. Otherwise the agents are sorted into spatially coherent ranges.
+	const bool parallel = m_parallelFor && !debug && nagents >= MIN_PARALLEL_AGENTS;
+	if (parallel)
+		sortAgentsSpatially(agents, nagents);
+	m_updateAgents = agents;
+	m_updateAgentCount = nagents;
+	m_updateDt = dt;
+	m_updateDebug = debug;
+	
 	// Register agents to proximity grid.
 	m_grid->clear();
 	for (int i = 0; i < nagents; ++i)
@@ -1083,67 +1213,10 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 	}
 	
 	// Get nearby navmesh segments and agents to collide with.
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-
-		// Update the collision boundary after certain distance has been passed or
-		// if it has become invalid.
-		const float updateThr = ag->params.collisionQueryRange*0.25f;
-		if (dtVdist2DSqr(ag->npos, ag->boundary.getCenter()) > dtSqr(updateThr) ||
-			!ag->boundary.isValid(m_navquery, &m_filters[ag->params.queryFilterType]))
-		{
-			ag->boundary.update(ag->corridor.getFirstPoly(), ag->npos, ag->params.collisionQueryRange,
-								m_navquery, &m_filters[ag->params.queryFilterType]);
-		}
-		// Query neighbour agents
-		ag->nneis = getNeighbours(ag->npos, ag->params.height, ag->params.collisionQueryRange,
-								  ag, ag->neis, DT_CROWDAGENT_MAX_NEIGHBOURS,
-								  agents, nagents, m_grid);
-		for (int j = 0; j < ag->nneis; j++)
-			ag->neis[j].idx = getAgentIndex(agents[ag->neis[j].idx]);
-	}
+	runUpdatePhase(UPDATE_NEIGHBOURS, nagents, parallel);
 	
 	// Find next corner to steer to.
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
-			continue;
-		
-		// Find corners for steering
-		ag->ncorners = ag->corridor.findCorners(ag->cornerVerts, ag->cornerFlags, ag->cornerPolys,
-												DT_CROWDAGENT_MAX_CORNERS, m_navquery, &m_filters[ag->params.queryFilterType]);
-		
-		// Check to see if the corner after the next corner is directly visible,
-		// and short cut to there.
-		if ((ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS) && ag->ncorners > 0)
-		{
-			const float* target = &ag->cornerVerts[dtMin(1,ag->ncorners-1)*3];
-			ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, m_navquery, &m_filters[ag->params.queryFilterType]);
-			
-			// Copy data for debug purposes.
-			if (debugIdx == i)
-			{
-				dtVcopy(debug->optStart, ag->corridor.getPos());
-				dtVcopy(debug->optEnd, target);
-			}
-		}
-		else
-		{
-			// Copy data for debug purposes.
-			if (debugIdx == i)
-			{
-				dtVset(debug->optStart, 0,0,0);
-				dtVset(debug->optEnd, 0,0,0);
-			}
-		}
-	}
+	runUpdatePhase(UPDATE_CORNERS, nagents, parallel);
 	
 	// Trigger off-mesh connections (depends on corners).
 	for (int i = 0; i < nagents; ++i)
@@ -1187,172 +1260,340 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 	}
 		
 	// Calculate steering.
-	for (int i = 0; i < nagents; ++i)
+	runUpdatePhase(UPDATE_STEERING, nagents, parallel);
+	
+	// Velocity planning.
+	runUpdatePhase(UPDATE_VELOCITY_PLANNING, nagents, parallel);
+
+	// Integrate.
+	runUpdatePhase(UPDATE_INTEGRATE, nagents, parallel);
+	
+	// Handle collisions.
+	for (int iter = 0; iter < 4; ++iter)
 	{
-		dtCrowdAgent* ag = agents[i];
+		runUpdatePhase(UPDATE_COLLISION_DISPLACEMENT, nagents, parallel);
+		runUpdatePhase(UPDATE_COLLISION_RESOLVE, nagents, parallel);
+	}
+	
+	// Move along navmesh.
+	runUpdatePhase(UPDATE_MOVE, nagents, parallel);
 
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+	// Urho3D: Add update callback support
+	// The callback runs on the calling thread once all agents have moved.
+	if (m_updateCallback)
+	{
+		for (int i = 0; i < nagents; ++i)
+		{
+			dtCrowdAgent* ag = agents[i];
+			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+				continue;
+			(*m_updateCallback)(ag, dt);
+		}
+	}
+	
+	// Update agents using off-mesh connection.
+	for (int i = 0; i < m_maxAgents; ++i)
+	{
+		dtCrowdAgentAnimation* anim = &m_agentAnims[i];
+		if (!anim->active)
 			continue;
-		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE)
+		// Urho3D: animations are indexed by the agent pool, not by the active agent list
+		dtCrowdAgent* ag = &m_agents[i];
+
+		anim->t += dt;
+		if (anim->t > anim->tmax)
+		{
+			// Reset animation
+			anim->active = false;
+			// Prepare agent for walking.
+			ag->state = DT_CROWDAGENT_STATE_WALKING;
 			continue;
+		}
 		
-		float dvel[3] = {0,0,0};
-
-		if (ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
+		// Update position
+		const float ta = anim->tmax*0.15f;
+		const float tb = anim->tmax;
+		if (anim->t < ta)
 		{
-			dtVcopy(dvel, ag->targetPos);
-			ag->desiredSpeed = dtVlen(ag->targetPos);
+			const float u = tween(anim->t, 0.0, ta);
+			dtVlerp(ag->npos, anim->initPos, anim->startPos, u);
 		}
 		else
 		{
-			// Calculate steering direction.
-			if (ag->params.updateFlags & DT_CROWD_ANTICIPATE_TURNS)
-				calcSmoothSteerDirection(ag, dvel);
-			else
-				calcStraightSteerDirection(ag, dvel);
-			
-			// Calculate speed scale, which tells the agent to slowdown at the end of the path.
-			const float slowDownRadius = ag->params.radius*2;	// TODO: make less hacky.
-			const float speedScale = getDistanceToGoal(ag, slowDownRadius) / slowDownRadius;
-				
-			ag->desiredSpeed = ag->params.maxSpeed;
-			dtVscale(dvel, dvel, ag->desiredSpeed * speedScale);
+			const float u = tween(anim->t, ta, tb);
+			dtVlerp(ag->npos, anim->startPos, anim->endPos, u);
 		}
+			
+		// Update velocity.
+		dtVset(ag->vel, 0,0,0);
+		dtVset(ag->dvel, 0,0,0);
+	}
+	
+}
 
-		// Separation
-		if (ag->params.updateFlags & DT_CROWD_SEPARATION)
+// Urho3D: Add multithreaded update support
+void dtCrowd::sortAgentsSpatially(dtCrowdAgent** agents, const int nagents)
+{
+	const float ics = 1.0f / m_grid->getCellSize();
+	for (int i = 0; i < nagents; ++i)
+	{
+		dtCrowdAgentSortItem& item = m_sortItems[i];
+		item.x = (int)dtMathFloorf(agents[i]->npos[0] * ics);
+		item.z = (int)dtMathFloorf(agents[i]->npos[2] * ics);
+		item.agent = agents[i];
+	}
+	
+	qsort(m_sortItems, nagents, sizeof(dtCrowdAgentSortItem), compareAgentSortItems);
+	
+	for (int i = 0; i < nagents; ++i)
+		agents[i] = m_sortItems[i].agent;
+}
+
+void dtCrowd::runUpdatePhase(const int phase, const int nagents, const bool parallel)
+{
+	m_updatePhase = phase;
+	
+	if (m_threadSampleCounts)
+		memset(m_threadSampleCounts, 0, sizeof(int)*m_maxThreads);
+	
+	if (parallel)
+		(*m_parallelFor)(m_parallelForData, nagents, updateAgentRangeJob, this);
+	else
+		updateAgentRange(0, nagents, 0);
+	
+	if (m_threadSampleCounts)
+	{
+		for (int i = 0; i < m_maxThreads; ++i)
+			m_velocitySampleCount += m_threadSampleCounts[i];
+	}
+}
+
+void dtCrowd::updateAgentRangeJob(void* context, int begin, int end, int threadIndex)
+{
+	((dtCrowd*)context)->updateAgentRange(begin, end, threadIndex);
+}
+
+void dtCrowd::updateAgentRange(const int begin, const int end, const int threadIndex)
+{
+	dtAssert(threadIndex == 0 || threadIndex < m_maxThreads);
+	
+	dtCrowdAgent** agents = m_updateAgents;
+	dtNavMeshQuery* navquery = threadIndex ? m_threadNavQueries[threadIndex] : m_navquery;
+	dtObstacleAvoidanceQuery* obstacleQuery = threadIndex ? m_threadObstacleQueries[threadIndex] : m_obstacleQuery;
+	int* sampleCount = m_threadSampleCounts ? &m_threadSampleCounts[threadIndex] : &m_velocitySampleCount;
+	dtCrowdAgentDebugInfo* debug = m_updateDebug;
+	const int debugIdx = debug ? debug->idx : -1;
+	const int nagents = m_updateAgentCount;
+	
+	static const float COLLISION_RESOLVE_FACTOR = 0.7f;
+	
+	for (int i = begin; i < end; ++i)
+	{
+		dtCrowdAgent* ag = agents[i];
+		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
+			continue;
+		
+		switch (m_updatePhase)
 		{
-			const float separationDist = ag->params.collisionQueryRange; 
-			const float invSeparationDist = 1.0f / separationDist; 
-			const float separationWeight = ag->params.separationWeight;
+		case UPDATE_NEIGHBOURS:
+		{
+			// Update the collision boundary after certain distance has been passed or
+			// if it has become invalid.
+			const float updateThr = ag->params.collisionQueryRange*0.25f;
+			if (dtVdist2DSqr(ag->npos, ag->boundary.getCenter()) > dtSqr(updateThr) ||
+				!ag->boundary.isValid(navquery, &m_filters[ag->params.queryFilterType]))
+			{
+				ag->boundary.update(ag->corridor.getFirstPoly(), ag->npos, ag->params.collisionQueryRange,
+									navquery, &m_filters[ag->params.queryFilterType]);
+			}
+			// Query neighbour agents
+			ag->nneis = getNeighbours(ag->npos, ag->params.height, ag->params.collisionQueryRange,
+									  ag, ag->neis, DT_CROWDAGENT_MAX_NEIGHBOURS,
+									  agents, nagents, m_grid);
+			for (int j = 0; j < ag->nneis; j++)
+				ag->neis[j].idx = getAgentIndex(agents[ag->neis[j].idx]);
+			break;
+		}
+		
+		case UPDATE_CORNERS:
+		{
+			if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
+				continue;
 			
-			float w = 0;
-			float disp[3] = {0,0,0};
+			// Find corners for steering
+			ag->ncorners = ag->corridor.findCorners(ag->cornerVerts, ag->cornerFlags, ag->cornerPolys,
+													DT_CROWDAGENT_MAX_CORNERS, navquery, &m_filters[ag->params.queryFilterType]);
 			
-			for (int j = 0; j < ag->nneis; ++j)
+			// Check to see if the corner after the next corner is directly visible,
+			// and short cut to there.
+			if ((ag->params.updateFlags & DT_CROWD_OPTIMIZE_VIS) && ag->ncorners > 0)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				
-				float diff[3];
-				dtVsub(diff, ag->npos, nei->npos);
-				diff[1] = 0;
+				const float* target = &ag->cornerVerts[dtMin(1,ag->ncorners-1)*3];
+				ag->corridor.optimizePathVisibility(target, ag->params.pathOptimizationRange, navquery, &m_filters[ag->params.queryFilterType]);
 				
-				const float distSqr = dtVlenSqr(diff);
-				if (distSqr < 0.00001f)
-					continue;
-				if (distSqr > dtSqr(separationDist))
-					continue;
-				const float dist = dtMathSqrtf(distSqr);
-				const float weight = separationWeight * (1.0f - dtSqr(dist*invSeparationDist));
-				
-				dtVmad(disp, disp, diff, weight/dist);
-				w += 1.0f;
+				// Copy data for debug purposes.
+				if (debugIdx == i)
+				{
+					dtVcopy(debug->optStart, ag->corridor.getPos());
+					dtVcopy(debug->optEnd, target);
+				}
 			}
-			
-			if (w > 0.0001f)
+			else
 			{
-				// Adjust desired velocity.
-				dtVmad(dvel, dvel, disp, 1.0f/w);
-				// Clamp desired velocity to desired speed.
-				const float speedSqr = dtVlenSqr(dvel);
-				const float desiredSqr = dtSqr(ag->desiredSpeed);
-				if (speedSqr > desiredSqr)
-					dtVscale(dvel, dvel, desiredSqr/speedSqr);
+				// Copy data for debug purposes.
+				if (debugIdx == i)
+				{
+					dtVset(debug->optStart, 0,0,0);
+					dtVset(debug->optEnd, 0,0,0);
+				}
 			}
+			break;
 		}
 		
-		// Set the desired velocity.
-		dtVcopy(ag->dvel, dvel);
-	}
-	
-	// Velocity planning.	
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		
-		if (ag->params.updateFlags & DT_CROWD_OBSTACLE_AVOIDANCE)
+		case UPDATE_STEERING:
 		{
-			m_obstacleQuery->reset();
+			if (ag->targetState == DT_CROWDAGENT_TARGET_NONE)
+				continue;
 			
-			// Add neighbours as obstacles.
-			for (int j = 0; j < ag->nneis; ++j)
+			float dvel[3] = {0,0,0};
+			
+			if (ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
 			{
-				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
-				m_obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
+				dtVcopy(dvel, ag->targetPos);
+				ag->desiredSpeed = dtVlen(ag->targetPos);
 			}
-
-			// Append neighbour segments as obstacles.
-			for (int j = 0; j < ag->boundary.getSegmentCount(); ++j)
+			else
 			{
-				const float* s = ag->boundary.getSegment(j);
-				if (dtTriArea2D(ag->npos, s, s+3) < 0.0f)
-					continue;
-				m_obstacleQuery->addSegment(s, s+3);
+				// Calculate steering direction.
+				if (ag->params.updateFlags & DT_CROWD_ANTICIPATE_TURNS)
+					calcSmoothSteerDirection(ag, dvel);
+				else
+					calcStraightSteerDirection(ag, dvel);
+				
+				// Calculate speed scale, which tells the agent to slowdown at the end of the path.
+				const float slowDownRadius = ag->params.radius*2;	// TODO: make less hacky.
+				const float speedScale = getDistanceToGoal(ag, slowDownRadius) / slowDownRadius;
+				
+				ag->desiredSpeed = ag->params.maxSpeed;
+				dtVscale(dvel, dvel, ag->desiredSpeed * speedScale);
 			}
-
-			dtObstacleAvoidanceDebugData* vod = 0;
-			if (debugIdx == i) 
-				vod = debug->vod;
 			
-			// Sample new safe velocity.
-			bool adaptive = true;
-			int ns = 0;
-
-			const dtObstacleAvoidanceParams* params = &m_obstacleQueryParams[ag->params.obstacleAvoidanceType];
+			// Separation
+			if (ag->params.updateFlags & DT_CROWD_SEPARATION)
+			{
+				const float separationDist = ag->params.collisionQueryRange; 
+				const float invSeparationDist = 1.0f / separationDist; 
+				const float separationWeight = ag->params.separationWeight;
+				
+				float w = 0;
+				float disp[3] = {0,0,0};
 				
-			if (adaptive)
+				for (int j = 0; j < ag->nneis; ++j)
+				{
+					const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
+					
+					float diff[3];
+					dtVsub(diff, ag->npos, nei->npos);
+					diff[1] = 0;
+					
+					const float distSqr = dtVlenSqr(diff);
+					if (distSqr < 0.00001f)
+						continue;
+					if (distSqr > dtSqr(separationDist))
+						continue;
+					const float dist = dtMathSqrtf(distSqr);
+					const float weight = separationWeight * (1.0f - dtSqr(dist*invSeparationDist));
+					
+					dtVmad(disp, disp, diff, weight/dist);
+					w += 1.0f;
+				}
+				
+				if (w > 0.0001f)
+				{
+					// Adjust desired velocity.
+					dtVmad(dvel, dvel, disp, 1.0f/w);
+					// Clamp desired velocity to desired speed.
+					const float speedSqr = dtVlenSqr(dvel);
+					const float desiredSqr = dtSqr(ag->desiredSpeed);
+					if (speedSqr > desiredSqr)
+						dtVscale(dvel, dvel, desiredSqr/speedSqr);
+				}
+			}
+			
+			// Set the desired velocity.
+			dtVcopy(ag->dvel, dvel);
+			break;
+		}
+		
+		case UPDATE_VELOCITY_PLANNING:
+		{
+			if (ag->params.updateFlags & DT_CROWD_OBSTACLE_AVOIDANCE)
 			{
-				ns = m_obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
-															 ag->vel, ag->dvel, ag->nvel, params, vod);
+				obstacleQuery->reset();
+				
+				// Add neighbours as obstacles.
+				for (int j = 0; j < ag->nneis; ++j)
+				{
+					const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
+					obstacleQuery->addCircle(nei->npos, nei->params.radius, nei->vel, nei->dvel);
+				}
+				
+				// Append neighbour segments as obstacles.
+				for (int j = 0; j < ag->boundary.getSegmentCount(); ++j)
+				{
+					const float* s = ag->boundary.getSegment(j);
+					if (dtTriArea2D(ag->npos, s, s+3) < 0.0f)
+						continue;
+					obstacleQuery->addSegment(s, s+3);
+				}
+				
+				dtObstacleAvoidanceDebugData* vod = 0;
+				if (debugIdx == i) 
+					vod = debug->vod;
+				
+				// Sample new safe velocity.
+				bool adaptive = true;
+				int ns = 0;
+				
+				const dtObstacleAvoidanceParams* params = &m_obstacleQueryParams[ag->params.obstacleAvoidanceType];
+				
+				if (adaptive)
+				{
+					ns = obstacleQuery->sampleVelocityAdaptive(ag->npos, ag->params.radius, ag->desiredSpeed,
+															   ag->vel, ag->dvel, ag->nvel, params, vod);
+				}
+				else
+				{
+					ns = obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
+														   ag->vel, ag->dvel, ag->nvel, params, vod);
+				}
+				*sampleCount += ns;
 			}
 			else
 			{
-				ns = m_obstacleQuery->sampleVelocityGrid(ag->npos, ag->params.radius, ag->desiredSpeed,
-														 ag->vel, ag->dvel, ag->nvel, params, vod);
+				// If not using velocity planning, new velocity is directly the desired velocity.
+				dtVcopy(ag->nvel, ag->dvel);
 			}
-			m_velocitySampleCount += ns;
-		}
-		else
-		{
-			// If not using velocity planning, new velocity is directly the desired velocity.
-			dtVcopy(ag->nvel, ag->dvel);
+			break;
 		}
-	}
-
-	// Integrate.
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		integrate(ag, dt);
-	}
-	
-	// Handle collisions.
-	static const float COLLISION_RESOLVE_FACTOR = 0.7f;
-	
-	for (int iter = 0; iter < 4; ++iter)
-	{
-		for (int i = 0; i < nagents; ++i)
+		
+		case UPDATE_INTEGRATE:
+			integrate(ag, m_updateDt);
+			break;
+		
+		case UPDATE_COLLISION_DISPLACEMENT:
 		{
-			dtCrowdAgent* ag = agents[i];
 			const int idx0 = getAgentIndex(ag);
 			
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
-
 			dtVset(ag->disp, 0,0,0);
 			
 			float w = 0;
-
+			
 			for (int j = 0; j < ag->nneis; ++j)
 			{
 				const dtCrowdAgent* nei = &m_agents[ag->neis[j].idx];
 				const int idx1 = getAgentIndex(nei);
-
+				
 				float diff[3];
 				dtVsub(diff, ag->npos, nei->npos);
 				diff[1] = 0;
@@ -1386,76 +1627,26 @@ void dtCrowd::update(const float dt, dtCrowdAgentDebugInfo* debug)
 				const float iw = 1.0f / w;
 				dtVscale(ag->disp, ag->disp, iw);
 			}
+			break;
 		}
 		
-		for (int i = 0; i < nagents; ++i)
-		{
-			dtCrowdAgent* ag = agents[i];
-			if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-				continue;
-			
+		case UPDATE_COLLISION_RESOLVE:
 			dtVadd(ag->npos, ag->npos, ag->disp);
-		}
-	}
-	
-	for (int i = 0; i < nagents; ++i)
-	{
-		dtCrowdAgent* ag = agents[i];
-		if (ag->state != DT_CROWDAGENT_STATE_WALKING)
-			continue;
-		
-		// Move along navmesh.
-		ag->corridor.movePosition(ag->npos, m_navquery, &m_filters[ag->params.queryFilterType]);
-		// Get valid constrained position back.
-		dtVcopy(ag->npos, ag->corridor.getPos());
-
-		// If not using path, truncate the corridor to just one poly.
-		if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
-		{
-			ag->corridor.reset(ag->corridor.getFirstPoly(), ag->npos);
-			ag->partial = false;
-		}
-
-		// Urho3D: Add update callback support
-		if (m_updateCallback)
-			(*m_updateCallback)(ag, dt);
-	}
-	
-	// Update agents using off-mesh connection.
-	for (int i = 0; i < m_maxAgents; ++i)
-	{
-		dtCrowdAgentAnimation* anim = &m_agentAnims[i];
-		if (!anim->active)
-			continue;
-		dtCrowdAgent* ag = agents[i];
-
-		anim->t += dt;
-		if (anim->t > anim->tmax)
-		{
-			// Reset animation
-			anim->active = false;
-			// Prepare agent for walking.
-			ag->state = DT_CROWDAGENT_STATE_WALKING;
-			continue;
-		}
+			break;
 		
-		// Update position
-		const float ta = anim->tmax*0.15f;
-		const float tb = anim->tmax;
-		if (anim->t < ta)
-		{
-			const float u = tween(anim->t, 0.0, ta);
-			dtVlerp(ag->npos, anim->initPos, anim->startPos, u);
-		}
-		else
-		{
-			const float u = tween(anim->t, ta, tb);
-			dtVlerp(ag->npos, anim->startPos, anim->endPos, u);
-		}
+		case UPDATE_MOVE:
+			// Move along navmesh.
+			ag->corridor.movePosition(ag->npos, navquery, &m_filters[ag->params.queryFilterType]);
+			// Get valid constrained position back.
+			dtVcopy(ag->npos, ag->corridor.getPos());
 			
-		// Update velocity.
-		dtVset(ag->vel, 0,0,0);
-		dtVset(ag->dvel, 0,0,0);
+			// If not using path, truncate the corridor to just one poly.
+			if (ag->targetState == DT_CROWDAGENT_TARGET_NONE || ag->targetState == DT_CROWDAGENT_TARGET_VELOCITY)
+			{
+				ag->corridor.reset(ag->corridor.getFirstPoly(), ag->npos);
+				ag->partial = false;
+			}
+			break;
+		}
 	}
-	
 }
@@ -1153,6 +1153,9 @@ template <class T> void RegisterUIElement(asIScriptEngine* engine, const char* c
     }
     engine->RegisterObjectMethod(className, "void set_sortChildren(bool)", asMETHOD(T, SetSortChildren), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "bool get_sortChildren() const", asMETHOD(T, GetSortChildren), asCALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void set_cacheBatches(bool)", asMETHOD(T, SetCacheBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod(className, "bool get_cacheBatches() const", asMETHOD(T, GetCacheBatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod(className, "void MarkBatchesDirty()", asMETHOD(T, MarkBatchesDirty), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "void set_useDerivedOpacity(bool)", asMETHOD(T, SetUseDerivedOpacity), asCALL_THISCALL);
     engine->RegisterObjectMethod(className, "bool get_useDerivedOpacity() const", asMETHOD(T, GetUseDerivedOpacity), asCALL_THISCALL);
     if (!isSprite)
@@ -1579,6 +1579,7 @@ static void RegisterDecalSet(asIScriptEngine* engine)
 {
     RegisterDrawable<DecalSet>(engine, "DecalSet");
     engine->RegisterObjectMethod("DecalSet", "bool AddDecal(Drawable@+, const Vector3&in, const Quaternion&in, float, float, float, const Vector2&in, const Vector2&in, float timeToLive = 0.0, float normalCutoff = 0.1, uint subGeometry = 0xffffffff)", asMETHOD(DecalSet, AddDecal), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "bool AddDecalAsync(Drawable@+, const Vector3&in, const Quaternion&in, float, float, float, const Vector2&in, const Vector2&in, float timeToLive = 0.0, float normalCutoff = 0.1, uint subGeometry = 0xffffffff)", asMETHOD(DecalSet, AddDecalAsync), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void RemoveDecals(uint)", asMETHOD(DecalSet, RemoveDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void RemoveAllDecals()", asMETHOD(DecalSet, RemoveAllDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void set_material(Material@+)", asMETHOD(DecalSet, SetMaterial), asCALL_THISCALL);
@@ -1590,9 +1591,17 @@ static void RegisterDecalSet(asIScriptEngine* engine)
     engine->RegisterObjectMethod("DecalSet", "uint get_maxVertices() const", asMETHOD(DecalSet, GetMaxVertices), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "void set_maxIndices(uint)", asMETHOD(DecalSet, SetMaxIndices), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "uint get_maxIndices() const", asMETHOD(DecalSet, GetMaxIndices), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "void set_maxAsyncDecalsPerFrame(uint)", asMETHOD(DecalSet, SetMaxAsyncDecalsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "uint get_maxAsyncDecalsPerFrame() const", asMETHOD(DecalSet, GetMaxAsyncDecalsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod("DecalSet", "uint get_numAsyncDecals() const", asMETHOD(DecalSet, GetNumAsyncDecals), asCALL_THISCALL);
     engine->RegisterObjectMethod("DecalSet", "Zone@+ get_zone() const", asMETHOD(DecalSet, GetZone), asCALL_THISCALL);
 }
 
+static bool TerrainSetHeights(const IntRect& rect, CScriptArray* heights, Terrain* ptr)
+{
+    return ptr->SetHeights(rect, ArrayToPODVector<float>(heights));
+}
+
 static void RegisterTerrain(asIScriptEngine* engine)
 {
     RegisterDrawable<TerrainPatch>(engine, "TerrainPatch");
@@ -1602,6 +1611,8 @@ static void RegisterTerrain(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Terrain", "Vector3 GetNormal(const Vector3&in) const", asMETHOD(Terrain, GetNormal), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "TerrainPatch@+ GetPatch(int, int) const", asMETHODPR(Terrain, GetPatch, (int, int) const, TerrainPatch*), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "IntVector2 WorldToHeightMap(const Vector3&in) const", asMETHOD(Terrain, WorldToHeightMap), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "Vector3 HeightMapToWorld(const IntVector2&in) const", asMETHOD(Terrain, HeightMapToWorld), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "bool SetHeights(const IntRect&in, Array<float>@+)", asFUNCTION(TerrainSetHeights), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("Terrain", "void set_material(Material@+)", asMETHOD(Terrain, SetMaterial), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "Material@+ get_material() const", asMETHOD(Terrain, GetMaterial), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "void set_maxLodLevels(uint)", asMETHOD(Terrain, SetMaxLodLevels), asCALL_THISCALL);
@@ -1641,6 +1652,14 @@ static void RegisterTerrain(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Terrain", "uint get_zoneMask() const", asMETHOD(Terrain, GetZoneMask), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "void set_maxLights(uint)", asMETHOD(Terrain, SetMaxLights), asCALL_THISCALL);
     engine->RegisterObjectMethod("Terrain", "uint get_maxLights() const", asMETHOD(Terrain, GetMaxLights), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "void set_pagingDistance(float)", asMETHOD(Terrain, SetPagingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "float get_pagingDistance() const", asMETHOD(Terrain, GetPagingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "void set_patchMemoryBudget(uint)", asMETHOD(Terrain, SetPatchMemoryBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "uint get_patchMemoryBudget() const", asMETHOD(Terrain, GetPatchMemoryBudget), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "uint get_numResidentPatches() const", asMETHOD(Terrain, GetNumResidentPatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "uint get_numPendingPatches() const", asMETHOD(Terrain, GetNumPendingPatches), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "uint get_patchMemoryUse() const", asMETHOD(Terrain, GetPatchMemoryUse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Terrain", "bool IsPatchResident(uint) const", asMETHOD(Terrain, IsPatchResident), asCALL_THISCALL);
 }
 
 
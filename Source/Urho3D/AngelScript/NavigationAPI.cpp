@@ -92,6 +92,11 @@ static Vector3 NavigationMeshRaycast(const Vector3& start, const Vector3& end, c
     return ptr->Raycast(start, end, extents);
 }
 
+static unsigned NavigationMeshRequestPath(const Vector3& start, const Vector3& end, const Vector3& extents, NavigationMesh* ptr)
+{
+    return ptr->RequestPath(start, end, extents);
+}
+
 static Vector3 CrowdManagerGetRandomPoint(int queryFilterType, CrowdManager* crowdManager)
 {
     return crowdManager->GetRandomPoint(queryFilterType);
@@ -102,10 +107,39 @@ static Vector3 CrowdManagerRandomPointInCircle(const Vector3& center, float radi
     return manager->GetRandomPointInCircle(center, radius, queryFilterType);
 }
 
+static VectorBuffer NavigationMeshGetTileData(const IntVector2& tile, NavigationMesh* ptr)
+{
+    VectorBuffer buffer(ptr->GetTileData(tile));
+    return buffer;
+}
+
+static bool NavigationMeshAddTile(const VectorBuffer& tileData, NavigationMesh* ptr)
+{
+    return ptr->AddTile(tileData.GetBuffer());
+}
+
+static void NavigationMeshUpdateStreaming(CScriptArray* points, NavigationMesh* ptr)
+{
+    ptr->UpdateStreaming(ArrayToPODVector<Vector3>(points));
+}
+
 template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const char* name)
 {
     engine->RegisterObjectMethod(name, "bool Build()", asMETHODPR(T, Build, (void), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "bool Build(const BoundingBox&in)", asMETHODPR(T, Build, (const BoundingBox&), bool), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool BuildAsync(const BoundingBox&in)", asMETHOD(T, BuildAsync), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void CancelAsyncBuilds()", asMETHOD(T, CancelAsyncBuilds), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint RequestPath(const Vector3&in, const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshRequestPath), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "void CancelPathRequest(uint)", asMETHOD(T, CancelPathRequest), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool AddTile(const VectorBuffer&in)", asFUNCTION(NavigationMeshAddTile), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "void RemoveTile(const IntVector2&in)", asMETHOD(T, RemoveTile), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void RemoveAllTiles()", asMETHOD(T, RemoveAllTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool HasTile(const IntVector2&in) const", asMETHOD(T, HasTile), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "VectorBuffer GetTileData(const IntVector2&in) const", asFUNCTION(NavigationMeshGetTileData), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod(name, "IntVector2 GetTileIndex(const Vector3&in) const", asMETHOD(T, GetTileIndex), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "BoundingBox GetTileBoundingBox(const IntVector2&in) const", asMETHOD(T, GetTileBoundingBox), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool SaveTiles(const String&in) const", asMETHOD(T, SaveTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void UpdateStreaming(Array<Vector3>@+)", asFUNCTION(NavigationMeshUpdateStreaming), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod(name, "void SetAreaCost(uint, float)", asMETHOD(T, SetAreaCost), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "float GetAreaCost(uint) const", asMETHOD(T, GetAreaCost), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "Vector3 FindNearestPoint(const Vector3&in, const Vector3&in extents = Vector3(1.0, 1.0, 1.0))", asFUNCTION(NavigationMeshFindNearestPoint), asCALL_CDECL_OBJLAST);
@@ -147,6 +181,15 @@ template<class T> static void RegisterNavMeshBase(asIScriptEngine* engine, const
     engine->RegisterObjectMethod(name, "const BoundingBox& get_boundingBox() const", asMETHOD(T, GetBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "BoundingBox get_worldBoundingBox() const", asMETHOD(T, GetWorldBoundingBox), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "IntVector2 get_numTiles() const", asMETHOD(T, GetNumTiles), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "bool get_buildingAsync() const", asMETHOD(T, IsBuildingAsync), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_pathIterationsPerFrame(uint)", asMETHOD(T, SetPathIterationsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_pathIterationsPerFrame() const", asMETHOD(T, GetPathIterationsPerFrame), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numPathRequests() const", asMETHOD(T, GetNumPathRequests), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_streamingPath(const String&in)", asMETHOD(T, SetStreamingPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "const String& get_streamingPath() const", asMETHOD(T, GetStreamingPath), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "void set_streamingDistance(float)", asMETHOD(T, SetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "float get_streamingDistance() const", asMETHOD(T, GetStreamingDistance), asCALL_THISCALL);
+    engine->RegisterObjectMethod(name, "uint get_numStreamedTiles() const", asMETHOD(T, GetNumStreamedTiles), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_partitionType()", asMETHOD(T, SetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "NavmeshPartitionType get_partitionType()", asMETHOD(T, GetPartitionType), asCALL_THISCALL);
     engine->RegisterObjectMethod(name, "void set_drawOffMeshConnections(bool)", asMETHOD(T, SetDrawOffMeshConnections), asCALL_THISCALL);
@@ -259,6 +302,10 @@ void RegisterCrowdManager(asIScriptEngine* engine)
     engine->RegisterObjectMethod("CrowdManager", "uint get_numQueryFilterTypes() const", asMETHOD(CrowdManager, GetNumQueryFilterTypes), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "uint get_numAreas(uint) const", asMETHOD(CrowdManager, GetNumAreas), asCALL_THISCALL);
     engine->RegisterObjectMethod("CrowdManager", "uint get_numObstacleAvoidanceTypes() const", asMETHOD(CrowdManager, GetNumObstacleAvoidanceTypes), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_threadedUpdate(bool)", asMETHOD(CrowdManager, SetThreadedUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "bool get_threadedUpdate() const", asMETHOD(CrowdManager, GetThreadedUpdate), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "void set_batchRepositionEvents(bool)", asMETHOD(CrowdManager, SetBatchRepositionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("CrowdManager", "bool get_batchRepositionEvents() const", asMETHOD(CrowdManager, GetBatchRepositionEvents), asCALL_THISCALL);
 }
 
 void RegisterCrowdAgent(asIScriptEngine* engine)
@@ -63,6 +63,26 @@ static RigidBody* PhysicsRaycastResultGetRigidBody(PhysicsRaycastResult* ptr)
     return ptr->body_;
 }
 
+static RigidBody* PhysicsContactPairGetBodyA(PhysicsContactPair* ptr)
+{
+    return ptr->bodyA_;
+}
+
+static RigidBody* PhysicsContactPairGetBodyB(PhysicsContactPair* ptr)
+{
+    return ptr->bodyB_;
+}
+
+static void ConstructPhysicsRaycastQuery(PhysicsRaycastQuery* ptr)
+{
+    new(ptr) PhysicsRaycastQuery();
+}
+
+static void ConstructPhysicsRaycastQueryInit(const Ray& ray, float maxDistance, float radius, unsigned collisionMask, PhysicsRaycastQuery* ptr)
+{
+    new(ptr) PhysicsRaycastQuery(ray, maxDistance, radius, collisionMask);
+}
+
 static void RegisterCollisionShape(asIScriptEngine* engine)
 {
     engine->RegisterEnum("ShapeType");
@@ -187,6 +207,10 @@ static void RegisterRigidBody(asIScriptEngine* engine)
     engine->RegisterObjectMethod("RigidBody", "uint get_collisionMask() const", asMETHOD(RigidBody, GetCollisionMask), asCALL_THISCALL);
     engine->RegisterObjectMethod("RigidBody", "void set_collisionEventMode(CollisionEventMode)", asMETHOD(RigidBody, SetCollisionEventMode), asCALL_THISCALL);
     engine->RegisterObjectMethod("RigidBody", "CollisionEventMode get_collisionEventMode() const", asMETHOD(RigidBody, GetCollisionEventMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RigidBody", "void set_activationRadius(float)", asMETHOD(RigidBody, SetActivationRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RigidBody", "float get_activationRadius() const", asMETHOD(RigidBody, GetActivationRadius), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RigidBody", "void set_regionActive(bool)", asMETHOD(RigidBody, SetRegionActive), asCALL_THISCALL);
+    engine->RegisterObjectMethod("RigidBody", "bool get_regionActive() const", asMETHOD(RigidBody, IsRegionActive), asCALL_THISCALL);
     engine->RegisterObjectMethod("RigidBody", "Array<RigidBody@>@ get_collidingBodies() const", asFUNCTION(RigidBodyGetCollidingBodies), asCALL_CDECL_OBJLAST);
 }
 
@@ -235,6 +259,23 @@ static CScriptArray* PhysicsWorldRaycast(const Ray& ray, float maxDistance, unsi
     return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
 }
 
+static CScriptArray* PhysicsWorldRaycastSingleBatch(CScriptArray* queries, PhysicsWorld* ptr)
+{
+    PODVector<PhysicsRaycastResult> result;
+    ptr->RaycastSingleBatch(result, ArrayToPODVector<PhysicsRaycastQuery>(queries));
+    return VectorToArray<PhysicsRaycastResult>(result, "Array<PhysicsRaycastResult>");
+}
+
+static CScriptArray* PhysicsWorldGetContactPairs(PhysicsWorld* ptr)
+{
+    return VectorToArray<PhysicsContactPair>(ptr->GetContactPairs(), "Array<PhysicsContactPair>");
+}
+
+static CScriptArray* PhysicsWorldGetContactPoints(PhysicsWorld* ptr)
+{
+    return VectorToArray<PhysicsContactPoint>(ptr->GetContactPoints(), "Array<PhysicsContactPoint>");
+}
+
 static PhysicsRaycastResult PhysicsWorldRaycastSingle(const Ray& ray, float maxDistance, unsigned collisionMask, PhysicsWorld* ptr)
 {
     PhysicsRaycastResult result;
@@ -306,11 +347,44 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectProperty("PhysicsRaycastResult", "float hitFraction", offsetof(PhysicsRaycastResult, hitFraction_));
     engine->RegisterObjectMethod("PhysicsRaycastResult", "RigidBody@+ get_body() const", asFUNCTION(PhysicsRaycastResultGetRigidBody), asCALL_CDECL_OBJLAST);
 
+    engine->RegisterEnum("ActivationRegionMode");
+    engine->RegisterEnumValue("ActivationRegionMode", "ACTIVATION_REGION_NONE", ACTIVATION_REGION_NONE);
+    engine->RegisterEnumValue("ActivationRegionMode", "ACTIVATION_REGION_FREEZE", ACTIVATION_REGION_FREEZE);
+    engine->RegisterEnumValue("ActivationRegionMode", "ACTIVATION_REGION_REMOVE", ACTIVATION_REGION_REMOVE);
+
+    engine->RegisterEnum("ContactPairState");
+    engine->RegisterEnumValue("ContactPairState", "CONTACT_PAIR_START", CONTACT_PAIR_START);
+    engine->RegisterEnumValue("ContactPairState", "CONTACT_PAIR_ONGOING", CONTACT_PAIR_ONGOING);
+    engine->RegisterEnumValue("ContactPairState", "CONTACT_PAIR_END", CONTACT_PAIR_END);
+
+    engine->RegisterObjectType("PhysicsContactPoint", sizeof(PhysicsContactPoint), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS);
+    engine->RegisterObjectProperty("PhysicsContactPoint", "Vector3 position", offsetof(PhysicsContactPoint, position_));
+    engine->RegisterObjectProperty("PhysicsContactPoint", "Vector3 normal", offsetof(PhysicsContactPoint, normal_));
+    engine->RegisterObjectProperty("PhysicsContactPoint", "float distance", offsetof(PhysicsContactPoint, distance_));
+    engine->RegisterObjectProperty("PhysicsContactPoint", "float impulse", offsetof(PhysicsContactPoint, impulse_));
+
+    engine->RegisterObjectType("PhysicsContactPair", sizeof(PhysicsContactPair), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS);
+    engine->RegisterObjectMethod("PhysicsContactPair", "RigidBody@+ get_bodyA() const", asFUNCTION(PhysicsContactPairGetBodyA), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContactPair", "RigidBody@+ get_bodyB() const", asFUNCTION(PhysicsContactPairGetBodyB), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectProperty("PhysicsContactPair", "uint firstContact", offsetof(PhysicsContactPair, firstContact_));
+    engine->RegisterObjectProperty("PhysicsContactPair", "uint numContacts", offsetof(PhysicsContactPair, numContacts_));
+    engine->RegisterObjectProperty("PhysicsContactPair", "ContactPairState state", offsetof(PhysicsContactPair, state_));
+    engine->RegisterObjectProperty("PhysicsContactPair", "bool trigger", offsetof(PhysicsContactPair, trigger_));
+
+    engine->RegisterObjectType("PhysicsRaycastQuery", sizeof(PhysicsRaycastQuery), asOBJ_VALUE | asOBJ_POD | asOBJ_APP_CLASS_C);
+    engine->RegisterObjectBehaviour("PhysicsRaycastQuery", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructPhysicsRaycastQuery), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("PhysicsRaycastQuery", asBEHAVE_CONSTRUCT, "void f(const Ray&in, float, float radius = 0.0, uint collisionMask = 0xffff)", asFUNCTION(ConstructPhysicsRaycastQueryInit), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "Ray ray", offsetof(PhysicsRaycastQuery, ray_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "float maxDistance", offsetof(PhysicsRaycastQuery, maxDistance_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "float radius", offsetof(PhysicsRaycastQuery, radius_));
+    engine->RegisterObjectProperty("PhysicsRaycastQuery", "uint collisionMask", offsetof(PhysicsRaycastQuery, collisionMask_));
+
     RegisterComponent<PhysicsWorld>(engine, "PhysicsWorld");
     engine->RegisterObjectMethod("PhysicsWorld", "void Update(float)", asMETHOD(PhysicsWorld, Update), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void UpdateCollisions()", asMETHOD(PhysicsWorld, UpdateCollisions), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ Raycast(const Ray&in, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycast), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingle(const Ray&in, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingle), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsRaycastResult>@ RaycastSingleBatch(Array<PhysicsRaycastQuery>@+)", asFUNCTION(PhysicsWorldRaycastSingleBatch), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult RaycastSingleSegmented(const Ray&in, float, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldRaycastSingleSegmented), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld", "PhysicsRaycastResult SphereCast(const Ray&in, float, float, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorldSphereCast), asCALL_CDECL_OBJLAST);
     // There seems to be a bug in AngelScript resulting in a crash if we use an auto handle with this function.
@@ -338,6 +412,23 @@ static void RegisterPhysicsWorld(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_internalEdge() const", asMETHOD(PhysicsWorld, GetInternalEdge), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "void set_splitImpulse(bool)", asMETHOD(PhysicsWorld, SetSplitImpulse), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld", "bool get_splitImpulse() const", asMETHOD(PhysicsWorld, GetSplitImpulse), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_shapeCachePath(const String&in)", asMETHOD(PhysicsWorld, SetShapeCachePath), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "const String& get_shapeCachePath() const", asMETHOD(PhysicsWorld, GetShapeCachePath), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_threadedSimulation(bool)", asMETHOD(PhysicsWorld, SetThreadedSimulation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_threadedSimulation() const", asMETHOD(PhysicsWorld, GetThreadedSimulation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_collisionEvents(bool)", asMETHOD(PhysicsWorld, SetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_collisionEvents() const", asMETHOD(PhysicsWorld, GetCollisionEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_contactStream(bool)", asMETHOD(PhysicsWorld, SetContactStream), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "bool get_contactStream() const", asMETHOD(PhysicsWorld, GetContactStream), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsContactPair>@ get_contactPairs() const", asFUNCTION(PhysicsWorldGetContactPairs), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "Array<PhysicsContactPoint>@ get_contactPoints() const", asFUNCTION(PhysicsWorldGetContactPoints), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld", "void UpdateActivationRegions()", asMETHOD(PhysicsWorld, UpdateActivationRegions), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_activationRegionMode(ActivationRegionMode)", asMETHOD(PhysicsWorld, SetActivationRegionMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "ActivationRegionMode get_activationRegionMode() const", asMETHOD(PhysicsWorld, GetActivationRegionMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_activationMargin(float)", asMETHOD(PhysicsWorld, SetActivationMargin), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "float get_activationMargin() const", asMETHOD(PhysicsWorld, GetActivationMargin), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "void set_activationInterval(float)", asMETHOD(PhysicsWorld, SetActivationInterval), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld", "float get_activationInterval() const", asMETHOD(PhysicsWorld, GetActivationInterval), asCALL_THISCALL);
     engine->RegisterObjectMethod("Scene", "PhysicsWorld@+ get_physicsWorld() const", asFUNCTION(SceneGetPhysicsWorld), asCALL_CDECL_OBJLAST);
     engine->RegisterGlobalFunction("PhysicsWorld@+ get_physicsWorld()", asFUNCTION(GetPhysicsWorld), asCALL_CDECL);
 }
@@ -352,6 +352,15 @@ static void RegisterListView(asIScriptEngine* engine)
     engine->RegisterObjectMethod("ListView", "bool get_clearSelectionOnDefocus() const", asMETHOD(ListView, GetClearSelectionOnDefocus), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "void set_selectOnClickEnd(bool)", asMETHOD(ListView, SetSelectOnClickEnd), asCALL_THISCALL);
     engine->RegisterObjectMethod("ListView", "bool get_selectOnClickEnd() const", asMETHOD(ListView, GetSelectOnClickEnd), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void RefreshVirtualItems()", asMETHOD(ListView, RefreshVirtualItems), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualMode(bool)", asMETHOD(ListView, SetVirtualMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "bool get_virtualMode() const", asMETHOD(ListView, GetVirtualMode), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemCount(uint)", asMETHOD(ListView, SetVirtualItemCount), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "uint get_virtualItemCount() const", asMETHOD(ListView, GetVirtualItemCount), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemHeight(int)", asMETHOD(ListView, SetVirtualItemHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "int get_virtualItemHeight() const", asMETHOD(ListView, GetVirtualItemHeight), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "void set_virtualItemType(StringHash)", asMETHOD(ListView, SetVirtualItemType), asCALL_THISCALL);
+    engine->RegisterObjectMethod("ListView", "StringHash get_virtualItemType() const", asMETHOD(ListView, GetVirtualItemType), asCALL_THISCALL);
 }
 
 static void RegisterText(asIScriptEngine* engine)
@@ -365,6 +374,7 @@ static void RegisterText(asIScriptEngine* engine)
     engine->RegisterObjectMethod("Text", "bool SetFont(const String&in, int)", asMETHODPR(Text, SetFont, (const String&, int), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "bool SetFont(Font@+, int)", asMETHODPR(Text, SetFont, (Font*, int), bool), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "void SetSelection(uint, uint arg1 = M_MAX_UNSIGNED)", asMETHOD(Text, SetSelection), asCALL_THISCALL);
+    engine->RegisterObjectMethod("Text", "void AppendText(const String&in)", asMETHOD(Text, AppendText), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "void ClearSelection()", asMETHOD(Text, ClearSelection), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "Font@+ get_font() const", asMETHOD(Text, GetFont), asCALL_THISCALL);
     engine->RegisterObjectMethod("Text", "int get_fontSize() const", asMETHOD(Text, GetFontSize), asCALL_THISCALL);
@@ -727,6 +737,8 @@ static void RegisterUI(asIScriptEngine* engine)
     engine->RegisterObjectMethod("UI", "float get_defaultToolTipDelay() const", asMETHOD(UI, GetDefaultToolTipDelay), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_maxFontTextureSize(int)", asMETHOD(UI, SetMaxFontTextureSize), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "int get_maxFontTextureSize() const", asMETHOD(UI, GetMaxFontTextureSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "void set_maxFontTextures(uint)", asMETHOD(UI, SetMaxFontTextures), asCALL_THISCALL);
+    engine->RegisterObjectMethod("UI", "uint get_maxFontTextures() const", asMETHOD(UI, GetMaxFontTextures), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_nonFocusedMouseWheel(bool)", asMETHOD(UI, SetNonFocusedMouseWheel), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "bool get_nonFocusedMouseWheel() const", asMETHOD(UI, IsNonFocusedMouseWheel), asCALL_THISCALL);
     engine->RegisterObjectMethod("UI", "void set_useSystemClipboard(bool)", asMETHOD(UI, SetUseSystemClipboard), asCALL_THISCALL);
@@ -50,6 +50,7 @@
 #include "../Urho2D/PhysicsWorld2D.h"
 #include "../Urho2D/RigidBody2D.h"
 #include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
 #include "../Urho2D/SpriteSheet2D.h"
 #include "../Urho2D/TileMap2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
@@ -86,6 +87,20 @@ static void RegisterSpriteSheet2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("SpriteSheet2D", "void DefineSprite(const String&, const IntRect&, const Vector2& hotSpot=Vector2(0.5f, 0.5f), const IntVector2& offset = IntVector2::ZERO)", asMETHOD(SpriteSheet2D, DefineSprite), asCALL_THISCALL);
 }
 
+static void RegisterSpriteAtlas2D(asIScriptEngine* engine)
+{
+    RegisterObject<SpriteAtlas2D>(engine, "SpriteAtlas2D");
+    RegisterObjectConstructor<SpriteAtlas2D>(engine, "SpriteAtlas2D");
+    engine->RegisterObjectMethod("SpriteAtlas2D", "bool AddSprite(Sprite2D@+)", asMETHOD(SpriteAtlas2D, AddSprite), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void Commit()", asMETHOD(SpriteAtlas2D, Commit), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "SpriteSheet2D@+ GetPage(uint) const", asMETHOD(SpriteAtlas2D, GetPage), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_pageSize(int)", asMETHOD(SpriteAtlas2D, SetPageSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "int get_pageSize() const", asMETHOD(SpriteAtlas2D, GetPageSize), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "void set_padding(int)", asMETHOD(SpriteAtlas2D, SetPadding), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "int get_padding() const", asMETHOD(SpriteAtlas2D, GetPadding), asCALL_THISCALL);
+    engine->RegisterObjectMethod("SpriteAtlas2D", "uint get_numPages() const", asMETHOD(SpriteAtlas2D, GetNumPages), asCALL_THISCALL);
+}
+
 // Template function for registering a class derived from Drawable2D.
 template <class T> void RegisterDrawable2D(asIScriptEngine* engine, const char* className)
 {
@@ -369,6 +384,66 @@ static CScriptArray* PhysicsWorld2DGetRigidBodies(const Rect& aabb, unsigned col
     return VectorToHandleArray<RigidBody2D>(results, "Array<RigidBody2D@>");
 }
 
+static void ConstructPhysicsContact2D(PhysicsContact2D* ptr)
+{
+    new(ptr) PhysicsContact2D();
+}
+
+static void DestructPhysicsContact2D(PhysicsContact2D* ptr)
+{
+    ptr->~PhysicsContact2D();
+}
+
+static RigidBody2D* PhysicsContact2DGetBodyA(PhysicsContact2D* ptr)
+{
+    return ptr->bodyA_;
+}
+
+static RigidBody2D* PhysicsContact2DGetBodyB(PhysicsContact2D* ptr)
+{
+    return ptr->bodyB_;
+}
+
+static Node* PhysicsContact2DGetNodeA(PhysicsContact2D* ptr)
+{
+    return ptr->nodeA_;
+}
+
+static Node* PhysicsContact2DGetNodeB(PhysicsContact2D* ptr)
+{
+    return ptr->nodeB_;
+}
+
+static CollisionShape2D* PhysicsContact2DGetShapeA(PhysicsContact2D* ptr)
+{
+    return ptr->shapeA_;
+}
+
+static CollisionShape2D* PhysicsContact2DGetShapeB(PhysicsContact2D* ptr)
+{
+    return ptr->shapeB_;
+}
+
+static CScriptArray* PhysicsWorld2DGetBeginContacts(Node* node, PhysicsWorld2D* ptr)
+{
+    if (!node)
+        return VectorToArray<PhysicsContact2D>(ptr->GetBeginContacts(), "Array<PhysicsContact2D>");
+
+    PODVector<PhysicsContact2D> result;
+    ptr->GetBeginContacts(result, node);
+    return VectorToArray<PhysicsContact2D>(result, "Array<PhysicsContact2D>");
+}
+
+static CScriptArray* PhysicsWorld2DGetEndContacts(Node* node, PhysicsWorld2D* ptr)
+{
+    if (!node)
+        return VectorToArray<PhysicsContact2D>(ptr->GetEndContacts(), "Array<PhysicsContact2D>");
+
+    PODVector<PhysicsContact2D> result;
+    ptr->GetEndContacts(result, node);
+    return VectorToArray<PhysicsContact2D>(result, "Array<PhysicsContact2D>");
+}
+
 static PhysicsWorld2D* SceneGetPhysicsWorld2D(Scene* ptr)
 {
     return ptr->GetComponent<PhysicsWorld2D>();
@@ -391,6 +466,20 @@ static void RegisterPhysicsWorld2D(asIScriptEngine* engine)
     engine->RegisterObjectProperty("PhysicsRaycastResult2D", "float distance", offsetof(PhysicsRaycastResult2D, distance_));
     engine->RegisterObjectMethod("PhysicsRaycastResult2D", "RigidBody2D@+ get_body() const", asFUNCTION(PhysicsRaycastResultGetRigidBody2D), asCALL_CDECL_OBJLAST);
 
+    engine->RegisterObjectType("PhysicsContact2D", sizeof(PhysicsContact2D), asOBJ_VALUE | asOBJ_APP_CLASS_C);
+    engine->RegisterObjectBehaviour("PhysicsContact2D", asBEHAVE_CONSTRUCT, "void f()", asFUNCTION(ConstructPhysicsContact2D), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectBehaviour("PhysicsContact2D", asBEHAVE_DESTRUCT, "void f()", asFUNCTION(DestructPhysicsContact2D), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "PhysicsContact2D& opAssign(const PhysicsContact2D&in)", asMETHODPR(PhysicsContact2D, operator =, (const PhysicsContact2D&), PhysicsContact2D&), asCALL_THISCALL);
+    engine->RegisterObjectProperty("PhysicsContact2D", "Vector2 position", offsetof(PhysicsContact2D, position_));
+    engine->RegisterObjectProperty("PhysicsContact2D", "Vector2 normal", offsetof(PhysicsContact2D, normal_));
+    engine->RegisterObjectProperty("PhysicsContact2D", "float impulse", offsetof(PhysicsContact2D, impulse_));
+    engine->RegisterObjectMethod("PhysicsContact2D", "RigidBody2D@+ get_bodyA() const", asFUNCTION(PhysicsContact2DGetBodyA), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "RigidBody2D@+ get_bodyB() const", asFUNCTION(PhysicsContact2DGetBodyB), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "Node@+ get_nodeA() const", asFUNCTION(PhysicsContact2DGetNodeA), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "Node@+ get_nodeB() const", asFUNCTION(PhysicsContact2DGetNodeB), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "CollisionShape2D@+ get_shapeA() const", asFUNCTION(PhysicsContact2DGetShapeA), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsContact2D", "CollisionShape2D@+ get_shapeB() const", asFUNCTION(PhysicsContact2DGetShapeB), asCALL_CDECL_OBJLAST);
+
     RegisterComponent<PhysicsWorld2D>(engine, "PhysicsWorld2D");
     engine->RegisterObjectMethod("PhysicsWorld2D", "Array<PhysicsRaycastResult2D>@ Raycast(const Vector2&, const Vector2&, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorld2DRaycast), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld2D", "PhysicsRaycastResult2D RaycastSingle(const Vector2&, const Vector2&, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorld2DRaycastSingle), asCALL_CDECL_OBJLAST);
@@ -399,6 +488,12 @@ static void RegisterPhysicsWorld2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld2D", "Array<RigidBody2D@>@ GetRigidBodies(const Rect&in, uint collisionMask = 0xffff)", asFUNCTION(PhysicsWorld2DGetRigidBodies), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_updateEnabled(bool)", asMETHOD(PhysicsWorld2D, SetUpdateEnabled), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_updateEnabled() const", asMETHOD(PhysicsWorld2D, IsUpdateEnabled), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "void set_fps(int)", asMETHOD(PhysicsWorld2D, SetFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "int get_fps() const", asMETHOD(PhysicsWorld2D, GetFps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "void set_maxSubSteps(int)", asMETHOD(PhysicsWorld2D, SetMaxSubSteps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "int get_maxSubSteps() const", asMETHOD(PhysicsWorld2D, GetMaxSubSteps), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "void set_interpolation(bool)", asMETHOD(PhysicsWorld2D, SetInterpolation), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_interpolation() const", asMETHOD(PhysicsWorld2D, GetInterpolation), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_drawShape(bool)", asMETHOD(PhysicsWorld2D, SetDrawShape), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_drawShape() const", asMETHOD(PhysicsWorld2D, GetDrawShape), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_drawJoint(bool)", asMETHOD(PhysicsWorld2D, SetDrawJoint), asCALL_THISCALL);
@@ -423,6 +518,10 @@ static void RegisterPhysicsWorld2D(asIScriptEngine* engine)
     engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_autoClearForces() const", asMETHOD(PhysicsWorld2D, GetAutoClearForces), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_velocityIterations(uint)", asMETHOD(PhysicsWorld2D, SetVelocityIterations), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "uint get_velocityIterations() const", asMETHOD(PhysicsWorld2D, GetVelocityIterations), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "void set_batchContactEvents(bool)", asMETHOD(PhysicsWorld2D, SetBatchContactEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "bool get_batchContactEvents() const", asMETHOD(PhysicsWorld2D, GetBatchContactEvents), asCALL_THISCALL);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "Array<PhysicsContact2D>@ GetBeginContacts(Node@+ node = null)", asFUNCTION(PhysicsWorld2DGetBeginContacts), asCALL_CDECL_OBJLAST);
+    engine->RegisterObjectMethod("PhysicsWorld2D", "Array<PhysicsContact2D>@ GetEndContacts(Node@+ node = null)", asFUNCTION(PhysicsWorld2DGetEndContacts), asCALL_CDECL_OBJLAST);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void set_positionIterations(uint)", asMETHOD(PhysicsWorld2D, SetPositionIterations), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "uint get_positionIterations() const", asMETHOD(PhysicsWorld2D, GetPositionIterations), asCALL_THISCALL);
     engine->RegisterObjectMethod("PhysicsWorld2D", "void DrawDebugGeometry() const", asMETHOD(PhysicsWorld2D, DrawDebugGeometry), asCALL_THISCALL);
@@ -718,6 +817,7 @@ void RegisterUrho2DAPI(asIScriptEngine* engine)
 {
     RegisterSprite2D(engine);
     RegisterSpriteSheet2D(engine);
+    RegisterSpriteAtlas2D(engine);
     RegisterDrawable2D(engine);
     RegisterStaticSprite2D(engine);
 
@@ -733,7 +833,6 @@ void RegisterUrho2DAPI(asIScriptEngine* engine)
     RegisterTileMap2D(engine);
 
     RegisterRigidBody2D(engine);
-    RegisterPhysicsWorld2D(engine);
 
     RegisterCollisionShape2D(engine);
     RegisterCollisionBox2D(engine);
@@ -742,6 +841,8 @@ void RegisterUrho2DAPI(asIScriptEngine* engine)
     RegisterCollisionEdge2D(engine);
     RegisterCollisionPolygon2D(engine);
 
+    RegisterPhysicsWorld2D(engine);
+
     RegisterConstraint2D(engine);
     RegisterConstraintDistance2D(engine);
     RegisterConstraintFriction2D(engine);
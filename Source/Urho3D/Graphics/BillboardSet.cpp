@@ -45,6 +45,7 @@ namespace Urho3D
 extern const char* GEOMETRY_CATEGORY;
 
 static const float INV_SQRT_TWO = 1.0f / sqrtf(2.0f);
+static const unsigned MAX_SORT_MOVES_PER_BILLBOARD = 4;
 
 const char* faceCameraModeNames[] =
 {
@@ -62,6 +63,37 @@ inline bool CompareBillboards(Billboard* lhs, Billboard* rhs)
     return lhs->sortDistance_ > rhs->sortDistance_;
 }
 
+/// Insertion sort billboards which are expected to be nearly in order since the previous frame. Give up and return false if
+/// more than the allowed amount of element moves would be needed; the order remains valid but unfinished in that case.
+static bool SortBillboardsIncremental(Vector<Billboard*>& billboards, unsigned maxMoves)
+{
+    if (billboards.Empty())
+        return true;
+
+    Billboard** begin = &billboards[0];
+    Billboard** end = begin + billboards.Size();
+    unsigned moves = 0;
+
+    for (Billboard** i = begin + 1; i < end; ++i)
+    {
+        Billboard* temp = *i;
+        Billboard** j = i;
+        while (j > begin && CompareBillboards(temp, *(j - 1)))
+        {
+            *j = *(j - 1);
+            --j;
+            if (++moves > maxMoves)
+            {
+                *j = temp;
+                return false;
+            }
+        }
+        *j = temp;
+    }
+
+    return true;
+}
+
 BillboardSet::BillboardSet(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY),
     animationLodBias_(1.0f),
@@ -244,6 +276,8 @@ void BillboardSet::SetNumBillboards(unsigned num)
     unsigned oldNum = billboards_.Size();
 
     billboards_.Resize(num);
+    // The billboards may have been reallocated, so the previous sort order can not be reused
+    sortedBillboards_.Clear();
 
     // Set default values to new billboards
     for (unsigned i = oldNum; i < num; ++i)
@@ -538,18 +572,45 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             ++enabledBillboards;
     }
 
-    sortedBillboards_.Resize(enabledBillboards);
-    unsigned index = 0;
+    // When sorting, start from the previous frame's order if the same billboards are still enabled, as it is likely to be
+    // nearly correct already
+    bool keepOrder = sorted_ && enabledBillboards && sortedBillboards_.Size() == enabledBillboards;
+    if (keepOrder)
+    {
+        Billboard* first = &billboards_[0];
+        Billboard* last = first + numBillboards;
+        for (unsigned i = 0; i < enabledBillboards; ++i)
+        {
+            Billboard* billboard = sortedBillboards_[i];
+            if (billboard < first || billboard >= last || !billboard->enabled_)
+            {
+                keepOrder = false;
+                break;
+            }
+        }
+    }
 
-    // Then set initial sort order and distances
-    for (unsigned i = 0; i < numBillboards; ++i)
+    if (!keepOrder)
+    {
+        sortedBillboards_.Resize(enabledBillboards);
+        unsigned index = 0;
+
+        // Then set initial sort order
+        for (unsigned i = 0; i < numBillboards; ++i)
+        {
+            Billboard& billboard = billboards_[i];
+            if (billboard.enabled_)
+                sortedBillboards_[index++] = &billboard;
+        }
+    }
+
+    // Set sort distances
+    if (sorted_)
     {
-        Billboard& billboard = billboards_[i];
-        if (billboard.enabled_)
+        for (unsigned i = 0; i < enabledBillboards; ++i)
         {
-            sortedBillboards_[index++] = &billboard;
-            if (sorted_)
-                billboard.sortDistance_ = frame.camera_->GetDistanceSquared(billboardTransform * billboards_[i].position_);
+            Billboard& billboard = *sortedBillboards_[i];
+            billboard.sortDistance_ = frame.camera_->GetDistanceSquared(billboardTransform * billboard.position_);
         }
     }
 
@@ -562,7 +623,10 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
 
     if (sorted_)
     {
-        Sort(sortedBillboards_.Begin(), sortedBillboards_.End(), CompareBillboards);
+        URHO3D_PROFILE(SortBillboards);
+
+        if (!keepOrder || !SortBillboardsIncremental(sortedBillboards_, enabledBillboards * MAX_SORT_MOVES_PER_BILLBOARD))
+            Sort(sortedBillboards_.Begin(), sortedBillboards_.End(), CompareBillboards);
         Vector3 worldPos = node_->GetWorldPosition();
         // Store the "last sorted position" now
         previousOffset_ = (worldPos - frame.camera_->GetNode()->GetWorldPosition());
@@ -627,6 +691,8 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
     } 
     else
     {
+        Vector3 cameraPos = frame.camera_->GetNode()->GetWorldPosition();
+
         for (unsigned i = 0; i < enabledBillboards; ++i)
         {
             Billboard& billboard = *sortedBillboards_[i];
@@ -650,9 +716,9 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             dest[8] = billboard.uv_.min_.y_;
             dest[9] = -size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
             dest[10] = -size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
-            dest[11] = frame.camera_->GetNode()->GetWorldPosition().x_;
-            dest[12] = frame.camera_->GetNode()->GetWorldPosition().y_;
-            dest[13] = frame.camera_->GetNode()->GetWorldPosition().z_;
+            dest[11] = cameraPos.x_;
+            dest[12] = cameraPos.y_;
+            dest[13] = cameraPos.z_;
             dest[14] = 1.0f;
 
             dest[15] = billboard.position_.x_;
@@ -666,9 +732,9 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             dest[23] = billboard.uv_.min_.y_;
             dest[24] = size.x_ * rot2D[0][0] + size.y_ * rot2D[0][1];
             dest[25] = size.x_ * rot2D[1][0] + size.y_ * rot2D[1][1];
-            dest[26] = frame.camera_->GetNode()->GetWorldPosition().x_;
-            dest[27] = frame.camera_->GetNode()->GetWorldPosition().y_;
-            dest[28] = frame.camera_->GetNode()->GetWorldPosition().z_;
+            dest[26] = cameraPos.x_;
+            dest[27] = cameraPos.y_;
+            dest[28] = cameraPos.z_;
             dest[29] = 1.0f;
 
             dest[30] = billboard.position_.x_;
@@ -682,9 +748,9 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             dest[38] = billboard.uv_.max_.y_;
             dest[39] = size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
             dest[40] = size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
-            dest[41] = frame.camera_->GetNode()->GetWorldPosition().x_;
-            dest[42] = frame.camera_->GetNode()->GetWorldPosition().y_;
-            dest[43] = frame.camera_->GetNode()->GetWorldPosition().z_;
+            dest[41] = cameraPos.x_;
+            dest[42] = cameraPos.y_;
+            dest[43] = cameraPos.z_;
             dest[44] = 1.0f;
 
             dest[45] = billboard.position_.x_;
@@ -698,9 +764,9 @@ void BillboardSet::UpdateVertexBuffer(const FrameInfo& frame)
             dest[53] = billboard.uv_.max_.y_;
             dest[54] = -size.x_ * rot2D[0][0] - size.y_ * rot2D[0][1];
             dest[55] = -size.x_ * rot2D[1][0] - size.y_ * rot2D[1][1];
-            dest[56] = frame.camera_->GetNode()->GetWorldPosition().x_;
-            dest[57] = frame.camera_->GetNode()->GetWorldPosition().y_;
-            dest[58] = frame.camera_->GetNode()->GetWorldPosition().z_;
+            dest[56] = cameraPos.x_;
+            dest[57] = cameraPos.y_;
+            dest[58] = cameraPos.z_;
             dest[59] = 1.0f;
 
             dest += 60;
@@ -24,6 +24,8 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/AnimatedModel.h"
 #include "../Graphics/Batch.h"
 #include "../Graphics/Camera.h"
@@ -56,6 +58,7 @@ static const unsigned MIN_INDICES = 6;
 static const unsigned MAX_VERTICES = 65536;
 static const unsigned DEFAULT_MAX_VERTICES = 512;
 static const unsigned DEFAULT_MAX_INDICES = 1024;
+static const unsigned DEFAULT_MAX_ASYNC_DECALS_PER_FRAME = 4;
 static const unsigned STATIC_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT;
 static const unsigned SKINNED_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT | MASK_BLENDWEIGHTS |
                                              MASK_BLENDINDICES;
@@ -128,6 +131,154 @@ static void ClipPolygon(PODVector<DecalVertex>& dest, const PODVector<DecalVerte
         dest.Push(ClipEdge(src[last], src[0], lastDistance, distance, skinned));
 }
 
+static void ClipAndTriangulate(Decal& decal, Vector<PODVector<DecalVertex> >& faces, const Frustum& frustum, bool skinned)
+{
+    PODVector<DecalVertex> tempFace;
+
+    // Clip the acquired faces against all frustum planes
+    for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
+    {
+        for (unsigned j = 0; j < faces.Size(); ++j)
+        {
+            PODVector<DecalVertex>& face = faces[j];
+            if (face.Empty())
+                continue;
+
+            ClipPolygon(tempFace, face, frustum.planes_[i], skinned);
+            face = tempFace;
+        }
+    }
+
+    // Now triangulate the resulting faces into decal vertices
+    for (unsigned i = 0; i < faces.Size(); ++i)
+    {
+        PODVector<DecalVertex>& face = faces[i];
+        if (face.Size() < 3)
+            continue;
+
+        for (unsigned j = 2; j < face.Size(); ++j)
+        {
+            decal.AddVertex(face[0]);
+            decal.AddVertex(face[j - 1]);
+            decal.AddVertex(face[j]);
+        }
+    }
+}
+
+static bool CheckDecalSize(const Decal& decal, unsigned maxVertices, unsigned maxIndices)
+{
+    if (decal.vertices_.Size() > maxVertices)
+    {
+        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(decal.vertices_.Size()) + " exceeds maximum " +
+                   String(maxVertices));
+        return false;
+    }
+    if (decal.indices_.Size() > maxIndices)
+    {
+        URHO3D_LOGWARNING("Can not add decal, index count " + String(decal.indices_.Size()) + " exceeds maximum " +
+                   String(maxIndices));
+        return false;
+    }
+
+    return true;
+}
+
+static bool GetGeometryData(Geometry* geometry, const unsigned char*& positionData, const unsigned char*& normalData,
+    const unsigned char*& skinningData, const unsigned char*& indexData, unsigned& positionStride, unsigned& normalStride,
+    unsigned& skinningStride, unsigned& indexStride)
+{
+    positionData = 0;
+    normalData = 0;
+    skinningData = 0;
+    indexData = 0;
+    positionStride = 0;
+    normalStride = 0;
+    skinningStride = 0;
+    indexStride = 0;
+
+    IndexBuffer* ib = geometry->GetIndexBuffer();
+    if (ib)
+    {
+        indexData = ib->GetShadowData();
+        indexStride = ib->GetIndexSize();
+    }
+
+    // For morphed models positions, normals and skinning may be in different buffers
+    for (unsigned i = 0; i < geometry->GetNumVertexBuffers(); ++i)
+    {
+        VertexBuffer* vb = geometry->GetVertexBuffer(i);
+        if (!vb)
+            continue;
+
+        unsigned elementMask = geometry->GetVertexElementMask(i);
+        unsigned char* data = vb->GetShadowData();
+        if (!data)
+            continue;
+
+        if (elementMask & MASK_POSITION)
+        {
+            positionData = data;
+            positionStride = vb->GetVertexSize();
+        }
+        if (elementMask & MASK_NORMAL)
+        {
+            normalData = data + vb->GetElementOffset(ELEMENT_NORMAL);
+            normalStride = vb->GetVertexSize();
+        }
+        if (elementMask & MASK_BLENDWEIGHTS)
+        {
+            skinningData = data + vb->GetElementOffset(ELEMENT_BLENDWEIGHTS);
+            skinningStride = vb->GetVertexSize();
+        }
+    }
+
+    // Positions and indices are needed
+    if (!positionData)
+    {
+        // As a fallback, try to get the geometry's raw vertex/index data
+        unsigned elementMask;
+        geometry->GetRawData(positionData, positionStride, indexData, indexStride, elementMask);
+        if (!positionData)
+        {
+            URHO3D_LOGWARNING("Can not add decal, target drawable has no CPU-side geometry data");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ProjectDecalWork(const WorkItem* item, unsigned threadIndex)
+{
+    DecalSet* decalSet = reinterpret_cast<DecalSet*>(item->start_);
+    AsyncDecal* asyncDecal = reinterpret_cast<AsyncDecal*>(item->aux_);
+    Decal& decal = asyncDecal->decal_;
+
+    // Static geometry only, so the decal set's bone data is never touched. The triangles were copied from the target in the
+    // main thread, so the target's vertex and index buffers may change or be freed meanwhile
+    Vector<PODVector<DecalVertex> > faces;
+    const PODVector<Vector3>& positions = asyncDecal->positions_;
+    if (!positions.Empty())
+    {
+        const unsigned char* positionData = reinterpret_cast<const unsigned char*>(&positions[0]);
+        const unsigned char* normalData = reinterpret_cast<const unsigned char*>(&asyncDecal->normals_[0]);
+        for (unsigned i = 0; i + 2 < positions.Size(); i += 3)
+        {
+            decalSet->GetFace(faces, 0, 0, i, i + 1, i + 2, positionData, normalData, 0, sizeof(Vector3), sizeof(Vector3), 0,
+                asyncDecal->frustum_, asyncDecal->decalNormal_, asyncDecal->normalCutoff_);
+        }
+    }
+
+    ClipAndTriangulate(decal, faces, asyncDecal->frustum_, false);
+    if (!decal.vertices_.Empty())
+    {
+        decalSet->CalculateVertices(decal, asyncDecal->frustumTransform_, asyncDecal->projection_, asyncDecal->topLeftUV_,
+            asyncDecal->bottomRightUV_, asyncDecal->decalTransform_);
+    }
+
+    asyncDecal->completed_ = true;
+}
+
 void Decal::AddVertex(const DecalVertex& vertex)
 {
     for (unsigned i = 0; i < vertices_.Size(); ++i)
@@ -151,6 +302,17 @@ void Decal::CalculateBoundingBox()
         boundingBox_.Merge(vertices_[i].position_);
 }
 
+AsyncDecal::AsyncDecal() :
+    normalCutoff_(0.0f),
+    started_(false),
+    completed_(false)
+{
+}
+
+AsyncDecal::~AsyncDecal()
+{
+}
+
 DecalSet::DecalSet(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY),
     geometry_(new Geometry(context)),
@@ -160,6 +322,8 @@ DecalSet::DecalSet(Context* context) :
     numIndices_(0),
     maxVertices_(DEFAULT_MAX_VERTICES),
     maxIndices_(DEFAULT_MAX_INDICES),
+    maxAsyncDecalsPerFrame_(DEFAULT_MAX_ASYNC_DECALS_PER_FRAME),
+    asyncDecalsStarted_(0),
     skinned_(false),
     bufferSizeDirty_(true),
     bufferDirty_(true),
@@ -177,6 +341,7 @@ DecalSet::DecalSet(Context* context) :
 
 DecalSet::~DecalSet()
 {
+    CancelAsyncDecals();
 }
 
 void DecalSet::RegisterObject(Context* context)
@@ -314,108 +479,32 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
         bufferSizeDirty_ = true;
     }
 
-    // Center the decal frustum on the world position
-    Vector3 adjustedWorldPosition = worldPosition - 0.5f * depth * (worldRotation * Vector3::FORWARD);
-    /// \todo target transform is not right if adding a decal to StaticModelGroup
-    Matrix3x4 targetTransform = target->GetNode()->GetWorldTransform().Inverse();
-
-    // For an animated model, adjust the decal position back to the bind pose
-    // To do this, need to find the bone the decal is colliding with
-    if (animatedModel)
-    {
-        Skeleton& skeleton = animatedModel->GetSkeleton();
-        unsigned numBones = skeleton.GetNumBones();
-        Bone* bestBone = 0;
-        float bestSize = 0.0f;
-
-        for (unsigned i = 0; i < numBones; ++i)
-        {
-            Bone* bone = skeleton.GetBone(i);
-            if (!bone->node_ || !bone->collisionMask_)
-                continue;
-
-            // Represent the decal as a sphere, try to find the biggest colliding bone
-            Sphere decalSphere
-                (bone->node_->GetWorldTransform().Inverse() * worldPosition, 0.5f * size / bone->node_->GetWorldScale().Length());
-
-            if (bone->collisionMask_ & BONECOLLISION_BOX)
-            {
-                float size = bone->boundingBox_.HalfSize().Length();
-                if (bone->boundingBox_.IsInside(decalSphere) && size > bestSize)
-                {
-                    bestBone = bone;
-                    bestSize = size;
-                }
-            }
-            else if (bone->collisionMask_ & BONECOLLISION_SPHERE)
-            {
-                Sphere boneSphere(Vector3::ZERO, bone->radius_);
-                float size = bone->radius_;
-                if (boneSphere.IsInside(decalSphere) && size > bestSize)
-                {
-                    bestBone = bone;
-                    bestSize = size;
-                }
-            }
-        }
-
-        if (bestBone)
-            targetTransform = (bestBone->node_->GetWorldTransform() * bestBone->offsetMatrix_).Inverse();
-    }
-
-    // Build the decal frustum
     Frustum decalFrustum;
-    Matrix3x4 frustumTransform = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
-    decalFrustum.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, frustumTransform);
-
-    Vector3 decalNormal = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+    Matrix3x4 frustumTransform;
+    Matrix4 projection;
+    Vector3 decalNormal;
+    PrepareDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, decalFrustum, frustumTransform, projection,
+        decalNormal);
 
     decals_.Resize(decals_.Size() + 1);
     Decal& newDecal = decals_.Back();
     newDecal.timeToLive_ = timeToLive;
 
     Vector<PODVector<DecalVertex> > faces;
-    PODVector<DecalVertex> tempFace;
+    Drawable* skinnedTarget = skinned_ ? target : 0;
 
     unsigned numBatches = target->GetBatches().Size();
 
     // Use either a specified subgeometry in the target, or all
     if (subGeometry < numBatches)
-        GetFaces(faces, target, subGeometry, decalFrustum, decalNormal, normalCutoff);
+        GetFaces(faces, target->GetLodGeometry(subGeometry, 0), skinnedTarget, subGeometry, decalFrustum, decalNormal, normalCutoff);
     else
     {
         for (unsigned i = 0; i < numBatches; ++i)
-            GetFaces(faces, target, i, decalFrustum, decalNormal, normalCutoff);
+            GetFaces(faces, target->GetLodGeometry(i, 0), skinnedTarget, i, decalFrustum, decalNormal, normalCutoff);
     }
 
-    // Clip the acquired faces against all frustum planes
-    for (unsigned i = 0; i < NUM_FRUSTUM_PLANES; ++i)
-    {
-        for (unsigned j = 0; j < faces.Size(); ++j)
-        {
-            PODVector<DecalVertex>& face = faces[j];
-            if (face.Empty())
-                continue;
-
-            ClipPolygon(tempFace, face, decalFrustum.planes_[i], skinned_);
-            face = tempFace;
-        }
-    }
-
-    // Now triangulate the resulting faces into decal vertices
-    for (unsigned i = 0; i < faces.Size(); ++i)
-    {
-        PODVector<DecalVertex>& face = faces[i];
-        if (face.Size() < 3)
-            continue;
-
-        for (unsigned j = 2; j < face.Size(); ++j)
-        {
-            newDecal.AddVertex(face[0]);
-            newDecal.AddVertex(face[j - 1]);
-            newDecal.AddVertex(face[j]);
-        }
-    }
+    ClipAndTriangulate(newDecal, faces, decalFrustum, skinned_);
 
     // Check if resulted in no triangles
     if (newDecal.vertices_.Empty())
@@ -424,38 +513,17 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
         return true;
     }
 
-    if (newDecal.vertices_.Size() > maxVertices_)
-    {
-        URHO3D_LOGWARNING("Can not add decal, vertex count " + String(newDecal.vertices_.Size()) + " exceeds maximum " +
-                   String(maxVertices_));
-        decals_.Pop();
-        return false;
-    }
-    if (newDecal.indices_.Size() > maxIndices_)
+    if (!CheckDecalSize(newDecal, maxVertices_, maxIndices_))
     {
-        URHO3D_LOGWARNING("Can not add decal, index count " + String(newDecal.indices_.Size()) + " exceeds maximum " +
-                   String(maxIndices_));
         decals_.Pop();
         return false;
     }
 
-    // Calculate UVs
-    Matrix4 projection(Matrix4::ZERO);
-    projection.m11_ = (1.0f / (size * 0.5f));
-    projection.m00_ = projection.m11_ / aspectRatio;
-    projection.m22_ = 1.0f / depth;
-    projection.m33_ = 1.0f;
-
-    CalculateUVs(newDecal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
-
-    // Transform vertices to this node's local space and generate tangents
+    // Calculate UVs, transform vertices to this node's local space and generate tangents
     Matrix3x4 decalTransform = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
-    TransformVertices(newDecal, skinned_ ? Matrix3x4::IDENTITY : decalTransform);
-    GenerateTangents(&newDecal.vertices_[0], sizeof(DecalVertex), &newDecal.indices_[0], sizeof(unsigned short), 0,
-        newDecal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
-        tangent_));
+    CalculateVertices(newDecal, frustumTransform, projection, topLeftUV, bottomRightUV,
+        skinned_ ? Matrix3x4::IDENTITY : decalTransform);
 
-    newDecal.CalculateBoundingBox();
     numVertices_ += newDecal.vertices_.Size();
     numIndices_ += newDecal.indices_.Size();
 
@@ -473,6 +541,68 @@ bool DecalSet::AddDecal(Drawable* target, const Vector3& worldPosition, const Qu
     return true;
 }
 
+bool DecalSet::AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+    float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive, float normalCutoff,
+    unsigned subGeometry)
+{
+    // Do not add decals in headless mode
+    if (!node_ || !GetSubsystem<Graphics>())
+        return false;
+
+    if (!target || !target->GetNode())
+    {
+        URHO3D_LOGERROR("Null target drawable for decal");
+        return false;
+    }
+
+    // Skinned decals need to update the bone list while the faces are acquired, so add them immediately
+    if (dynamic_cast<AnimatedModel*>(target))
+    {
+        return AddDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, topLeftUV, bottomRightUV, timeToLive,
+            normalCutoff, subGeometry);
+    }
+
+    if (skinned_)
+    {
+        RemoveAllDecals();
+        skinned_ = false;
+        bufferSizeDirty_ = true;
+    }
+
+    SharedPtr<AsyncDecal> asyncDecal(new AsyncDecal());
+    PrepareDecal(target, worldPosition, worldRotation, size, aspectRatio, depth, asyncDecal->frustum_,
+        asyncDecal->frustumTransform_, asyncDecal->projection_, asyncDecal->decalNormal_);
+    asyncDecal->decalTransform_ = node_->GetWorldTransform().Inverse() * target->GetNode()->GetWorldTransform();
+    asyncDecal->topLeftUV_ = topLeftUV;
+    asyncDecal->bottomRightUV_ = bottomRightUV;
+    asyncDecal->normalCutoff_ = normalCutoff;
+    asyncDecal->decal_.timeToLive_ = timeToLive;
+
+    // Use either a specified subgeometry in the target, or all
+    unsigned numBatches = target->GetBatches().Size();
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        if (subGeometry < numBatches && i != subGeometry)
+            continue;
+
+        CopyFaces(asyncDecal->positions_, asyncDecal->normals_, target->GetLodGeometry(i, 0));
+    }
+
+    asyncDecals_.Push(asyncDecal);
+    StartAsyncDecals();
+
+    // Finished decals are collected in scene post-update
+    if (!subscribed_)
+        UpdateEventSubscription(false);
+
+    return true;
+}
+
+void DecalSet::SetMaxAsyncDecalsPerFrame(unsigned num)
+{
+    maxAsyncDecalsPerFrame_ = Max(num, 1U);
+}
+
 void DecalSet::RemoveDecals(unsigned num)
 {
     while (num-- && decals_.Size())
@@ -481,6 +611,8 @@ void DecalSet::RemoveDecals(unsigned num)
 
 void DecalSet::RemoveAllDecals()
 {
+    CancelAsyncDecals();
+
     if (!decals_.Empty())
     {
         decals_.Clear();
@@ -686,72 +818,92 @@ void DecalSet::OnWorldBoundingBoxUpdate()
     }
 }
 
-void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-    const Vector3& decalNormal, float normalCutoff)
+void DecalSet::PrepareDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+    float aspectRatio, float depth, Frustum& frustum, Matrix3x4& frustumTransform, Matrix4& projection, Vector3& decalNormal)
 {
-    // Try to use the most accurate LOD level if possible
-    Geometry* geometry = target->GetLodGeometry(batchIndex, 0);
-    if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
-        return;
-
-    const unsigned char* positionData = 0;
-    const unsigned char* normalData = 0;
-    const unsigned char* skinningData = 0;
-    const unsigned char* indexData = 0;
-    unsigned positionStride = 0;
-    unsigned normalStride = 0;
-    unsigned skinningStride = 0;
-    unsigned indexStride = 0;
+    // Center the decal frustum on the world position
+    Vector3 adjustedWorldPosition = worldPosition - 0.5f * depth * (worldRotation * Vector3::FORWARD);
+    /// \todo target transform is not right if adding a decal to StaticModelGroup
+    Matrix3x4 targetTransform = target->GetNode()->GetWorldTransform().Inverse();
 
-    IndexBuffer* ib = geometry->GetIndexBuffer();
-    if (ib)
+    // For an animated model, adjust the decal position back to the bind pose
+    // To do this, need to find the bone the decal is colliding with
+    AnimatedModel* animatedModel = dynamic_cast<AnimatedModel*>(target);
+    if (animatedModel)
     {
-        indexData = ib->GetShadowData();
-        indexStride = ib->GetIndexSize();
-    }
+        Skeleton& skeleton = animatedModel->GetSkeleton();
+        unsigned numBones = skeleton.GetNumBones();
+        Bone* bestBone = 0;
+        float bestSize = 0.0f;
 
-    // For morphed models positions, normals and skinning may be in different buffers
-    for (unsigned i = 0; i < geometry->GetNumVertexBuffers(); ++i)
-    {
-        VertexBuffer* vb = geometry->GetVertexBuffer(i);
-        if (!vb)
-            continue;
+        for (unsigned i = 0; i < numBones; ++i)
+        {
+            Bone* bone = skeleton.GetBone(i);
+            if (!bone->node_ || !bone->collisionMask_)
+                continue;
 
-        unsigned elementMask = geometry->GetVertexElementMask(i);
-        unsigned char* data = vb->GetShadowData();
-        if (!data)
-            continue;
+            // Represent the decal as a sphere, try to find the biggest colliding bone
+            Sphere decalSphere
+                (bone->node_->GetWorldTransform().Inverse() * worldPosition, 0.5f * size / bone->node_->GetWorldScale().Length());
 
-        if (elementMask & MASK_POSITION)
-        {
-            positionData = data;
-            positionStride = vb->GetVertexSize();
-        }
-        if (elementMask & MASK_NORMAL)
-        {
-            normalData = data + vb->GetElementOffset(ELEMENT_NORMAL);
-            normalStride = vb->GetVertexSize();
-        }
-        if (elementMask & MASK_BLENDWEIGHTS)
-        {
-            skinningData = data + vb->GetElementOffset(ELEMENT_BLENDWEIGHTS);
-            skinningStride = vb->GetVertexSize();
+            if (bone->collisionMask_ & BONECOLLISION_BOX)
+            {
+                float size = bone->boundingBox_.HalfSize().Length();
+                if (bone->boundingBox_.IsInside(decalSphere) && size > bestSize)
+                {
+                    bestBone = bone;
+                    bestSize = size;
+                }
+            }
+            else if (bone->collisionMask_ & BONECOLLISION_SPHERE)
+            {
+                Sphere boneSphere(Vector3::ZERO, bone->radius_);
+                float size = bone->radius_;
+                if (boneSphere.IsInside(decalSphere) && size > bestSize)
+                {
+                    bestBone = bone;
+                    bestSize = size;
+                }
+            }
         }
-    }
 
-    // Positions and indices are needed
-    if (!positionData)
-    {
-        // As a fallback, try to get the geometry's raw vertex/index data
-        unsigned elementMask;
-        geometry->GetRawData(positionData, positionStride, indexData, indexStride, elementMask);
-        if (!positionData)
-        {
-            URHO3D_LOGWARNING("Can not add decal, target drawable has no CPU-side geometry data");
-            return;
-        }
+        if (bestBone)
+            targetTransform = (bestBone->node_->GetWorldTransform() * bestBone->offsetMatrix_).Inverse();
     }
 
+    // Build the decal frustum
+    frustumTransform = targetTransform * Matrix3x4(adjustedWorldPosition, worldRotation, 1.0f);
+    frustum.DefineOrtho(size, aspectRatio, 1.0, 0.0f, depth, frustumTransform);
+
+    decalNormal = (targetTransform * Vector4(worldRotation * Vector3::BACK, 0.0f)).Normalized();
+
+    // Projection for calculating UVs
+    projection = Matrix4::ZERO;
+    projection.m11_ = (1.0f / (size * 0.5f));
+    projection.m00_ = projection.m11_ / aspectRatio;
+    projection.m22_ = 1.0f / depth;
+    projection.m33_ = 1.0f;
+}
+
+void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Geometry* geometry, Drawable* skinnedTarget, unsigned batchIndex,
+    const Frustum& frustum, const Vector3& decalNormal, float normalCutoff)
+{
+    // The caller should use the most accurate LOD level if possible
+    if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
+        return;
+
+    const unsigned char* positionData;
+    const unsigned char* normalData;
+    const unsigned char* skinningData;
+    const unsigned char* indexData;
+    unsigned positionStride;
+    unsigned normalStride;
+    unsigned skinningStride;
+    unsigned indexStride;
+    if (!GetGeometryData(geometry, positionData, normalData, skinningData, indexData, positionStride, normalStride, skinningStride,
+        indexStride))
+        return;
+
     if (indexData)
     {
         unsigned indexStart = geometry->GetIndexStart();
@@ -765,7 +917,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
 
             while (indices < indicesEnd)
             {
-                GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
+                GetFace(faces, skinnedTarget, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
                     positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
                 indices += 3;
             }
@@ -778,7 +930,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
 
             while (indices < indicesEnd)
             {
-                GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
+                GetFace(faces, skinnedTarget, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
                     positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
                 indices += 3;
             }
@@ -792,20 +944,69 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
 
         while (indices + 2 < indicesEnd)
         {
-            GetFace(faces, target, batchIndex, indices, indices + 1, indices + 2, positionData, normalData, skinningData,
+            GetFace(faces, skinnedTarget, batchIndex, indices, indices + 1, indices + 2, positionData, normalData, skinningData,
                 positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
             indices += 3;
         }
     }
 }
 
-void DecalSet::GetFace(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1,
+void DecalSet::CopyFaces(PODVector<Vector3>& positions, PODVector<Vector3>& normals, Geometry* geometry) const
+{
+    if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST)
+        return;
+
+    const unsigned char* positionData;
+    const unsigned char* normalData;
+    const unsigned char* skinningData;
+    const unsigned char* indexData;
+    unsigned positionStride;
+    unsigned normalStride;
+    unsigned skinningStride;
+    unsigned indexStride;
+    if (!GetGeometryData(geometry, positionData, normalData, skinningData, indexData, positionStride, normalStride, skinningStride,
+        indexStride))
+        return;
+
+    unsigned start = indexData ? geometry->GetIndexStart() : geometry->GetVertexStart();
+    unsigned end = start + (indexData ? geometry->GetIndexCount() : geometry->GetVertexCount());
+
+    for (unsigned i = start; i + 2 < end; i += 3)
+    {
+        unsigned first = positions.Size();
+        for (unsigned j = i; j < i + 3; ++j)
+        {
+            unsigned index = j;
+            if (indexData)
+            {
+                index = indexStride == sizeof(unsigned short) ? ((const unsigned short*)indexData)[j] :
+                    ((const unsigned*)indexData)[j];
+            }
+
+            positions.Push(*((const Vector3*)(&positionData[index * positionStride])));
+            if (normalData)
+                normals.Push(*((const Vector3*)(&normalData[index * normalStride])));
+        }
+
+        // Use unsmoothed face normals if no normal data
+        if (!normalData)
+        {
+            Vector3 faceNormal = (positions[first + 1] - positions[first]).CrossProduct(positions[first + 2] -
+                positions[first]).Normalized();
+            normals.Push(faceNormal);
+            normals.Push(faceNormal);
+            normals.Push(faceNormal);
+        }
+    }
+}
+
+void DecalSet::GetFace(Vector<PODVector<DecalVertex> >& faces, Drawable* skinnedTarget, unsigned batchIndex, unsigned i0, unsigned i1,
     unsigned i2, const unsigned char* positionData, const unsigned char* normalData, const unsigned char* skinningData,
     unsigned positionStride, unsigned normalStride, unsigned skinningStride, const Frustum& frustum, const Vector3& decalNormal,
     float normalCutoff)
 {
     bool hasNormals = normalData != 0;
-    bool hasSkinning = skinned_ && skinningData != 0;
+    bool hasSkinning = skinnedTarget != 0 && skinningData != 0;
 
     const Vector3& v0 = *((const Vector3*)(&positionData[i0 * positionStride]));
     const Vector3& v1 = *((const Vector3*)(&positionData[i1 * positionStride]));
@@ -862,8 +1063,8 @@ void DecalSet::GetFace(Vector<PODVector<DecalVertex> >& faces, Drawable* target,
         unsigned char nbi2[4];
 
         // Make sure all bones are found and that there is room in the skinning matrices
-        if (!GetBones(target, batchIndex, bw0, bi0, nbi0) || !GetBones(target, batchIndex, bw1, bi1, nbi1) ||
-            !GetBones(target, batchIndex, bw2, bi2, nbi2))
+        if (!GetBones(skinnedTarget, batchIndex, bw0, bi0, nbi0) || !GetBones(skinnedTarget, batchIndex, bw1, bi1, nbi1) ||
+            !GetBones(skinnedTarget, batchIndex, bw2, bi2, nbi2))
             return;
 
         face.Reserve(3);
@@ -973,6 +1174,86 @@ void DecalSet::TransformVertices(Decal& decal, const Matrix3x4& transform)
     }
 }
 
+void DecalSet::CalculateVertices(Decal& decal, const Matrix3x4& frustumTransform, const Matrix4& projection,
+    const Vector2& topLeftUV, const Vector2& bottomRightUV, const Matrix3x4& transform)
+{
+    CalculateUVs(decal, frustumTransform.Inverse(), projection, topLeftUV, bottomRightUV);
+    TransformVertices(decal, transform);
+    GenerateTangents(&decal.vertices_[0], sizeof(DecalVertex), &decal.indices_[0], sizeof(unsigned short), 0,
+        decal.indices_.Size(), offsetof(DecalVertex, normal_), offsetof(DecalVertex, texCoord_), offsetof(DecalVertex,
+        tangent_));
+    decal.CalculateBoundingBox();
+}
+
+void DecalSet::FinishAsyncDecal(AsyncDecal& asyncDecal)
+{
+    const Decal& newDecal = asyncDecal.decal_;
+
+    // Check if resulted in no triangles, or if skinned decals have been added meanwhile
+    if (newDecal.vertices_.Empty() || skinned_)
+        return;
+
+    if (!CheckDecalSize(newDecal, maxVertices_, maxIndices_))
+        return;
+
+    decals_.Push(newDecal);
+    numVertices_ += newDecal.vertices_.Size();
+    numIndices_ += newDecal.indices_.Size();
+
+    // Remove oldest decals if total vertices exceeded
+    while (decals_.Size() && (numVertices_ > maxVertices_ || numIndices_ > maxIndices_))
+        RemoveDecals(1);
+
+    URHO3D_LOGDEBUG("Added decal with " + String(newDecal.vertices_.Size()) + " vertices");
+
+    MarkDecalsDirty();
+}
+
+void DecalSet::StartAsyncDecals()
+{
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    for (Vector<SharedPtr<AsyncDecal> >::Iterator i = asyncDecals_.Begin(); i != asyncDecals_.End() &&
+        asyncDecalsStarted_ < maxAsyncDecalsPerFrame_; ++i)
+    {
+        AsyncDecal* asyncDecal = *i;
+        if (asyncDecal->started_)
+            continue;
+
+        // Use a non-pooled work item, so that it can safely be removed from the queue later
+        SharedPtr<WorkItem> item(new WorkItem());
+        item->workFunction_ = ProjectDecalWork;
+        item->start_ = this;
+        item->aux_ = asyncDecal;
+        item->priority_ = 0;
+        asyncDecal->workItem_ = item;
+        asyncDecal->started_ = true;
+        queue->AddWorkItem(item);
+        ++asyncDecalsStarted_;
+    }
+}
+
+void DecalSet::CancelAsyncDecals()
+{
+    if (asyncDecals_.Empty())
+        return;
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    for (Vector<SharedPtr<AsyncDecal> >::Iterator i = asyncDecals_.Begin(); i != asyncDecals_.End(); ++i)
+    {
+        AsyncDecal* asyncDecal = *i;
+        if (!asyncDecal->started_ || !queue || queue->RemoveWorkItem(asyncDecal->workItem_))
+            continue;
+
+        // The projection is already running in a worker thread, wait for it to finish
+        while (!asyncDecal->completed_)
+            Time::Sleep(0);
+    }
+
+    asyncDecals_.Clear();
+}
+
 List<Decal>::Iterator DecalSet::RemoveDecal(List<Decal>::Iterator i)
 {
     numVertices_ -= i->vertices_.Size();
@@ -1133,8 +1414,8 @@ void DecalSet::UpdateEventSubscription(bool checkAllDecals)
             }
         }
 
-        // If no time limited decals, no need to subscribe to scene update
-        enabled = hasTimeLimitedDecals;
+        // If no time limited or asynchronous decals, no need to subscribe to scene update
+        enabled = hasTimeLimitedDecals || !asyncDecals_.Empty();
     }
 
     if (enabled && !subscribed_)
@@ -1155,6 +1436,24 @@ void DecalSet::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData
 
     float timeStep = eventData[P_TIMESTEP].GetFloat();
 
+    // Add asynchronous decals that have finished, then start new projections within the per-frame limit
+    if (!asyncDecals_.Empty())
+    {
+        for (Vector<SharedPtr<AsyncDecal> >::Iterator i = asyncDecals_.Begin(); i != asyncDecals_.End();)
+        {
+            if ((*i)->completed_)
+            {
+                FinishAsyncDecal(**i);
+                i = asyncDecals_.Erase(i);
+            }
+            else
+                ++i;
+        }
+
+        asyncDecalsStarted_ = 0;
+        StartAsyncDecals();
+    }
+
     for (List<Decal>::Iterator i = decals_.Begin(); i != decals_.End();)
     {
         i->timer_ += timeStep;
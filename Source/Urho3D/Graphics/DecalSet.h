@@ -32,6 +32,7 @@ namespace Urho3D
 
 class IndexBuffer;
 class VertexBuffer;
+struct WorkItem;
 
 /// %Decal vertex.
 struct DecalVertex
@@ -101,11 +102,51 @@ struct Decal
     PODVector<unsigned short> indices_;
 };
 
+/// Decal that is being projected asynchronously in a worker thread.
+struct AsyncDecal : public RefCounted
+{
+    /// Construct with defaults.
+    AsyncDecal();
+    /// Destruct.
+    ~AsyncDecal();
+
+    /// Target triangle vertex positions in target geometry space, three per triangle. Copied in the main thread.
+    PODVector<Vector3> positions_;
+    /// Target triangle vertex normals, three per triangle. Copied in the main thread.
+    PODVector<Vector3> normals_;
+    /// Decal frustum in target geometry space.
+    Frustum frustum_;
+    /// Decal frustum transform in target geometry space.
+    Matrix3x4 frustumTransform_;
+    /// Decal projection for calculating UV coordinates.
+    Matrix4 projection_;
+    /// Transform from target geometry space to the decal set's local space.
+    Matrix3x4 decalTransform_;
+    /// Decal normal in target geometry space.
+    Vector3 decalNormal_;
+    /// Top-left UV coordinate.
+    Vector2 topLeftUV_;
+    /// Bottom-right UV coordinate.
+    Vector2 bottomRightUV_;
+    /// Normal cutoff.
+    float normalCutoff_;
+    /// Resulting decal.
+    Decal decal_;
+    /// Work item.
+    SharedPtr<WorkItem> workItem_;
+    /// Work item queued flag.
+    bool started_;
+    /// Projection finished flag. Written by the worker thread.
+    volatile bool completed_;
+};
+
 /// %Decal renderer component.
 class URHO3D_API DecalSet : public Drawable
 {
     URHO3D_OBJECT(DecalSet, Drawable);
 
+    friend void ProjectDecalWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     DecalSet(Context* context);
@@ -137,6 +178,12 @@ public:
     bool AddDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size, float aspectRatio,
         float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f, float normalCutoff = 0.1f,
         unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Add a decal at world coordinates like AddDecal(), but clip the target geometry in a worker thread. The decal is added on a later frame, and the target's vertex data must not be modified until then. Skinned targets are not supported and are added immediately instead. Return true if successful.
+    bool AddDecalAsync(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+        float aspectRatio, float depth, const Vector2& topLeftUV, const Vector2& bottomRightUV, float timeToLive = 0.0f,
+        float normalCutoff = 0.1f, unsigned subGeometry = M_MAX_UNSIGNED);
+    /// Set maximum number of asynchronous decal projections to start per frame. Further requests wait for the next frames.
+    void SetMaxAsyncDecalsPerFrame(unsigned num);
     /// Remove n oldest decals.
     void RemoveDecals(unsigned num);
     /// Remove all decals.
@@ -160,6 +207,12 @@ public:
     /// Return maximum number of decal vertex indices.
     unsigned GetMaxIndices() const { return maxIndices_; }
 
+    /// Return number of asynchronous decals still being projected.
+    unsigned GetNumAsyncDecals() const { return asyncDecals_.Size(); }
+
+    /// Return maximum number of asynchronous decal projections to start per frame.
+    unsigned GetMaxAsyncDecalsPerFrame() const { return maxAsyncDecalsPerFrame_; }
+
     /// Set material attribute.
     void SetMaterialAttr(const ResourceRef& value);
     /// Set decals attribute.
@@ -176,12 +229,17 @@ protected:
     virtual void OnMarkedDirty(Node* node);
 
 private:
-    /// Get triangle faces from the target geometry.
-    void GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, const Frustum& frustum,
-        const Vector3& decalNormal, float normalCutoff);
+    /// Calculate the decal frustum, transform and projection in the target drawable's geometry space.
+    void PrepareDecal(Drawable* target, const Vector3& worldPosition, const Quaternion& worldRotation, float size,
+        float aspectRatio, float depth, Frustum& frustum, Matrix3x4& frustumTransform, Matrix4& projection, Vector3& decalNormal);
+    /// Get triangle faces from the target geometry. Skinning data is used only if a skinned target is given.
+    void GetFaces(Vector<PODVector<DecalVertex> >& faces, Geometry* geometry, Drawable* skinnedTarget, unsigned batchIndex,
+        const Frustum& frustum, const Vector3& decalNormal, float normalCutoff);
+    /// Copy triangle vertex positions and normals from the target geometry for an asynchronous projection.
+    void CopyFaces(PODVector<Vector3>& positions, PODVector<Vector3>& normals, Geometry* geometry) const;
     /// Get triangle face from the target geometry.
     void GetFace
-        (Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1, unsigned i2,
+        (Vector<PODVector<DecalVertex> >& faces, Drawable* skinnedTarget, unsigned batchIndex, unsigned i0, unsigned i1, unsigned i2,
             const unsigned char* positionData, const unsigned char* normalData, const unsigned char* skinningData,
             unsigned positionStride, unsigned normalStride, unsigned skinningStride, const Frustum& frustum,
             const Vector3& decalNormal, float normalCutoff);
@@ -193,6 +251,15 @@ private:
         (Decal& decal, const Matrix3x4& view, const Matrix4& projection, const Vector2& topLeftUV, const Vector2& bottomRightUV);
     /// Transform decal's vertices from the target geometry to the decal set local space.
     void TransformVertices(Decal& decal, const Matrix3x4& transform);
+    /// Calculate UVs, local space vertices, tangents and bounding box for a clipped decal.
+    void CalculateVertices(Decal& decal, const Matrix3x4& frustumTransform, const Matrix4& projection, const Vector2& topLeftUV,
+        const Vector2& bottomRightUV, const Matrix3x4& transform);
+    /// Add a finished asynchronous decal to the set.
+    void FinishAsyncDecal(AsyncDecal& asyncDecal);
+    /// Queue asynchronous decal projections to the work queue within the per-frame limit.
+    void StartAsyncDecals();
+    /// Cancel all asynchronous decal projections, waiting for the ones already running.
+    void CancelAsyncDecals();
     /// Remove a decal by iterator and return iterator to the next decal.
     List<Decal>::Iterator RemoveDecal(List<Decal>::Iterator i);
     /// Mark decals and the bounding box dirty.
@@ -226,6 +293,8 @@ private:
     Vector<Bone> bones_;
     /// Skinning matrices.
     PODVector<Matrix3x4> skinMatrices_;
+    /// Asynchronous decals being projected, in the order they were requested.
+    Vector<SharedPtr<AsyncDecal> > asyncDecals_;
     /// Vertices in the current decals.
     unsigned numVertices_;
     /// Indices in the current decals.
@@ -234,6 +303,10 @@ private:
     unsigned maxVertices_;
     /// Maximum indices.
     unsigned maxIndices_;
+    /// Maximum asynchronous decal projections to start per frame.
+    unsigned maxAsyncDecalsPerFrame_;
+    /// Asynchronous decal projections started on the current frame.
+    unsigned asyncDecalsStarted_;
     /// Skinned mode flag.
     bool skinned_;
     /// Vertex buffer needs resize flag.
@@ -65,4 +65,11 @@ URHO3D_EVENT(E_TERRAINCREATED, TerrainCreated)
     URHO3D_PARAM(P_NODE, Node);                    // Node pointer
 }
 
+/// Terrain heights changed in a region without recreating the terrain.
+URHO3D_EVENT(E_TERRAINHEIGHTSCHANGED, TerrainHeightsChanged)
+{
+    URHO3D_PARAM(P_NODE, Node);                    // Node pointer
+    URHO3D_PARAM(P_RECT, Rect);                    // IntRect in heightmap pixels
+}
+
 }
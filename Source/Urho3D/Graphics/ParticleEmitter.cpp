@@ -47,6 +47,7 @@ ParticleEmitter::ParticleEmitter(Context* context) :
     emissionTimer_(0.0f),
     lastTimeStep_(0.0f),
     lastUpdateFrameNumber_(M_MAX_UNSIGNED),
+    freeParticleHint_(0),
     emitting_(true),
     needUpdate_(false),
     serializeParticles_(true),
@@ -163,91 +164,93 @@ void ParticleEmitter::Update(const FrameInfo& frame)
         }
     }
 
-    // Update existing particles
-    Vector3 relativeConstantForce = node_->GetWorldRotation().Inverse() * effect_->GetConstantForce();
+    // Update existing particles. Fetch the effect parameters once, as they stay constant for the whole batch
+    const Vector3& constantForce = effect_->GetConstantForce();
+    Vector3 forceStep = lastTimeStep_ * (relative_ ? node_->GetWorldRotation().Inverse() * constantForce : constantForce);
+    bool applyForce = constantForce != Vector3::ZERO;
+    float dampingStep = 1.0f - lastTimeStep_ * effect_->GetDampingForce();
+    bool applyDamping = effect_->GetDampingForce() != 0.0f;
+    float sizeAdd = effect_->GetSizeAdd();
+    float sizeMul = effect_->GetSizeMul();
+    bool applySize = sizeAdd != 0.0f || sizeMul != 1.0f;
+    float sizeAddStep = lastTimeStep_ * sizeAdd;
+    float sizeMulStep = (lastTimeStep_ * (sizeMul - 1.0f)) + 1.0f;
+    const Vector<ColorFrame>& colorFrames = effect_->GetColorFrames();
+    const Vector<TextureFrame>& textureFrames = effect_->GetTextureFrames();
+    unsigned numColorFrames = colorFrames.Size();
+    unsigned numTextureFrames = textureFrames.Size();
+
     // If billboards are not relative, apply scaling to the position update
-    Vector3 scaleVector = Vector3::ONE;
+    Vector3 positionStep = Vector3(lastTimeStep_, lastTimeStep_, lastTimeStep_);
     if (scaled_ && !relative_)
-        scaleVector = node_->GetWorldScale();
+        positionStep *= node_->GetWorldScale();
+
+    Particle* particles = particles_.Size() ? &particles_[0] : (Particle*)0;
+    Billboard* billboards = billboards_.Size() ? &billboards_[0] : (Billboard*)0;
+    unsigned numParticles = particles_.Size();
 
-    for (unsigned i = 0; i < particles_.Size(); ++i)
+    for (unsigned i = 0; i < numParticles; ++i)
     {
-        Particle& particle = particles_[i];
-        Billboard& billboard = billboards_[i];
+        Billboard& billboard = billboards[i];
+        if (!billboard.enabled_)
+            continue;
 
-        if (billboard.enabled_)
-        {
-            needCommit = true;
+        Particle& particle = particles[i];
+        needCommit = true;
 
-            // Time to live
-            if (particle.timer_ >= particle.timeToLive_)
-            {
-                billboard.enabled_ = false;
-                continue;
-            }
-            particle.timer_ += lastTimeStep_;
-
-            // Velocity & position
-            const Vector3& constantForce = effect_->GetConstantForce();
-            if (constantForce != Vector3::ZERO)
-            {
-                if (relative_)
-                    particle.velocity_ += lastTimeStep_ * relativeConstantForce;
-                else
-                    particle.velocity_ += lastTimeStep_ * constantForce;
-            }
+        // Time to live
+        if (particle.timer_ >= particle.timeToLive_)
+        {
+            billboard.enabled_ = false;
+            continue;
+        }
+        particle.timer_ += lastTimeStep_;
 
-            float dampingForce = effect_->GetDampingForce();
-            if (dampingForce != 0.0f)
-            {
-                Vector3 force = -dampingForce * particle.velocity_;
-                particle.velocity_ += lastTimeStep_ * force;
-            }
-            billboard.position_ += lastTimeStep_ * particle.velocity_ * scaleVector;
-            billboard.direction_ = particle.velocity_.Normalized();
+        // Velocity & position
+        if (applyForce)
+            particle.velocity_ += forceStep;
+        if (applyDamping)
+            particle.velocity_ *= dampingStep;
+        billboard.position_ += particle.velocity_ * positionStep;
+        billboard.direction_ = particle.velocity_.Normalized();
 
-            // Rotation
-            billboard.rotation_ += lastTimeStep_ * particle.rotationSpeed_;
+        // Rotation
+        billboard.rotation_ += lastTimeStep_ * particle.rotationSpeed_;
 
-            // Scaling
-            float sizeAdd = effect_->GetSizeAdd();
-            float sizeMul = effect_->GetSizeMul();
-            if (sizeAdd != 0.0f || sizeMul != 1.0f)
-            {
-                particle.scale_ += lastTimeStep_ * sizeAdd;
-                if (particle.scale_ < 0.0f)
-                    particle.scale_ = 0.0f;
-                if (sizeMul != 1.0f)
-                    particle.scale_ *= (lastTimeStep_ * (sizeMul - 1.0f)) + 1.0f;
-                billboard.size_ = particle.size_ * particle.scale_;
-            }
+        // Scaling
+        if (applySize)
+        {
+            particle.scale_ += sizeAddStep;
+            if (particle.scale_ < 0.0f)
+                particle.scale_ = 0.0f;
+            if (sizeMul != 1.0f)
+                particle.scale_ *= sizeMulStep;
+            billboard.size_ = particle.size_ * particle.scale_;
+        }
 
-            // Color interpolation
-            unsigned& index = particle.colorIndex_;
-            const Vector<ColorFrame>& colorFrames_ = effect_->GetColorFrames();
-            if (index < colorFrames_.Size())
+        // Color interpolation
+        unsigned& index = particle.colorIndex_;
+        if (index < numColorFrames)
+        {
+            if (index < numColorFrames - 1)
             {
-                if (index < colorFrames_.Size() - 1)
-                {
-                    if (particle.timer_ >= colorFrames_[index + 1].time_)
-                        ++index;
-                }
-                if (index < colorFrames_.Size() - 1)
-                    billboard.color_ = colorFrames_[index].Interpolate(colorFrames_[index + 1], particle.timer_);
-                else
-                    billboard.color_ = colorFrames_[index].color_;
+                if (particle.timer_ >= colorFrames[index + 1].time_)
+                    ++index;
             }
+            if (index < numColorFrames - 1)
+                billboard.color_ = colorFrames[index].Interpolate(colorFrames[index + 1], particle.timer_);
+            else
+                billboard.color_ = colorFrames[index].color_;
+        }
 
-            // Texture animation
-            unsigned& texIndex = particle.texIndex_;
-            const Vector<TextureFrame>& textureFrames_ = effect_->GetTextureFrames();
-            if (textureFrames_.Size() && texIndex < textureFrames_.Size() - 1)
+        // Texture animation
+        unsigned& texIndex = particle.texIndex_;
+        if (numTextureFrames && texIndex < numTextureFrames - 1)
+        {
+            if (particle.timer_ >= textureFrames[texIndex + 1].time_)
             {
-                if (particle.timer_ >= textureFrames_[texIndex + 1].time_)
-                {
-                    billboard.uv_ = textureFrames_[texIndex + 1].uv_;
-                    ++texIndex;
-                }
+                billboard.uv_ = textureFrames[texIndex + 1].uv_;
+                ++texIndex;
             }
         }
     }
@@ -508,12 +511,23 @@ bool ParticleEmitter::EmitNewParticle()
     billboard.enabled_ = true;
     billboard.direction_ = startDir;
 
+    freeParticleHint_ = index + 1;
     return true;
 }
 
 unsigned ParticleEmitter::GetFreeParticle() const
 {
-    for (unsigned i = 0; i < billboards_.Size(); ++i)
+    // Continue the search from where the previous particle was emitted, so that emitting several particles in one frame
+    // does not rescan the already occupied slots from the beginning
+    unsigned numBillboards = billboards_.Size();
+    unsigned start = freeParticleHint_ < numBillboards ? freeParticleHint_ : 0;
+
+    for (unsigned i = start; i < numBillboards; ++i)
+    {
+        if (!billboards_[i].enabled_)
+            return i;
+    }
+    for (unsigned i = 0; i < start; ++i)
     {
         if (!billboards_[i].enabled_)
             return i;
@@ -135,6 +135,8 @@ private:
     float lastTimeStep_;
     /// Rendering framenumber on which was last updated.
     unsigned lastUpdateFrameNumber_;
+    /// Index from which to start searching for a free particle.
+    unsigned freeParticleHint_;
     /// Currently emitting flag.
     bool emitting_;
     /// Need update flag.
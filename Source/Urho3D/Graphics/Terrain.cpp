@@ -24,20 +24,26 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Camera.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/Octree.h"
+#include "../Graphics/Renderer.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/TerrainPatch.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../Graphics/Viewport.h"
 #include "../IO/Log.h"
 #include "../Resource/Image.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Scene/Node.h"
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
 #include "../DebugNew.h"
 
@@ -56,6 +62,8 @@ static const unsigned STITCH_NORTH = 1;
 static const unsigned STITCH_SOUTH = 2;
 static const unsigned STITCH_WEST = 4;
 static const unsigned STITCH_EAST = 8;
+static const unsigned PATCH_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT;
+static const unsigned MAX_PENDING_PATCH_BUILDS = 8;
 
 inline void GrowUpdateRegion(IntRect& updateRegion, int x, int y)
 {
@@ -77,6 +85,26 @@ inline void GrowUpdateRegion(IntRect& updateRegion, int x, int y)
     }
 }
 
+void BuildTerrainPatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    const Terrain* terrain = reinterpret_cast<Terrain*>(item->start_);
+    TerrainPatchBuild* build = reinterpret_cast<TerrainPatchBuild*>(item->aux_);
+
+    terrain->BuildPatchData(*build);
+    build->completed_ = true;
+}
+
+TerrainPatchBuild::TerrainPatchBuild() :
+    coordinates_(IntVector2::ZERO),
+    calculateLodErrors_(false),
+    completed_(false)
+{
+}
+
+TerrainPatchBuild::~TerrainPatchBuild()
+{
+}
+
 Terrain::Terrain(Context* context) :
     Component(context),
     indexBuffer_(new IndexBuffer(context)),
@@ -105,6 +133,10 @@ Terrain::Terrain(Context* context) :
     shadowDistance_(0.0f),
     lodBias_(1.0f),
     maxLights_(0),
+    pagingDistance_(0.0f),
+    patchMemoryBudget_(0),
+    numResidentPatches_(0),
+    subscribed_(false),
     recreateTerrain_(false)
 {
     indexBuffer_->SetShadowed(true);
@@ -112,6 +144,7 @@ Terrain::Terrain(Context* context) :
 
 Terrain::~Terrain()
 {
+    CancelPatchBuilds();
 }
 
 void Terrain::RegisterObject(Context* context)
@@ -139,15 +172,21 @@ void Terrain::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Shadow Mask", GetShadowMask, SetShadowMask, unsigned, DEFAULT_SHADOWMASK, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Zone Mask", GetZoneMask, SetZoneMask, unsigned, DEFAULT_ZONEMASK, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Occlusion LOD level", GetOcclusionLodLevel, SetOcclusionLodLevelAttr, unsigned, M_MAX_UNSIGNED, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Paging Distance", float, pagingDistance_, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Patch Memory Budget", GetPatchMemoryBudget, SetPatchMemoryBudget, unsigned, 0, AM_DEFAULT);
 }
 
 void Terrain::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
 {
-    Serializable::OnSetAttribute(attr, src);
-
-    // Change of any non-accessor attribute requires recreation of the terrain
+    // Change of any non-accessor attribute requires recreation of the terrain. Background patch builds read the terrain
+    // parameters, so stop them before the value changes
     if (!attr.accessor_)
+    {
+        CancelPatchBuilds();
         recreateTerrain_ = true;
+    }
+
+    Serializable::OnSetAttribute(attr, src);
 }
 
 void Terrain::ApplyAttributes()
@@ -163,7 +202,7 @@ void Terrain::OnSetEnabled()
     for (unsigned i = 0; i < patches_.Size(); ++i)
     {
         if (patches_[i])
-            patches_[i]->SetEnabled(enabled);
+            patches_[i]->SetEnabled(enabled && IsPatchResident(i));
     }
 }
 
@@ -380,12 +419,117 @@ void Terrain::SetOccludee(bool enable)
     MarkNetworkUpdate();
 }
 
+void Terrain::SetPagingDistance(float distance)
+{
+    distance = Max(distance, 0.0f);
+    if (distance != pagingDistance_)
+    {
+        bool modeChanged = (distance > 0.0f) != (pagingDistance_ > 0.0f);
+        pagingDistance_ = distance;
+
+        // Switching between paged and immediate building needs the patches to be rebuilt or released
+        if (modeChanged)
+            CreateGeometry();
+        MarkNetworkUpdate();
+    }
+}
+
+void Terrain::SetPatchMemoryBudget(unsigned bytes)
+{
+    patchMemoryBudget_ = bytes;
+    MarkNetworkUpdate();
+}
+
 void Terrain::ApplyHeightMap()
 {
     if (heightMap_)
         CreateGeometry();
 }
 
+bool Terrain::SetHeights(const IntRect& rect, const float* heights)
+{
+    if (!heightData_)
+    {
+        URHO3D_LOGERROR("Terrain has no height data, can not set heights");
+        return false;
+    }
+    if (!heights)
+    {
+        URHO3D_LOGERROR("Null pointer for terrain heights");
+        return false;
+    }
+    if (rect.left_ < 0 || rect.top_ < 0 || rect.right_ > numVertices_.x_ || rect.bottom_ > numVertices_.y_ ||
+        rect.left_ >= rect.right_ || rect.top_ >= rect.bottom_)
+    {
+        URHO3D_LOGERROR("Illegal rectangle for setting terrain heights");
+        return false;
+    }
+
+    URHO3D_PROFILE(SetTerrainHeights);
+
+    // Background builds read the height data, so stop them before writing. Patches whose build was cancelled are rebuilt
+    // along with the modified ones
+    PODVector<bool> dirtyPatches((unsigned)(numPatches_.x_ * numPatches_.y_));
+    for (unsigned i = 0; i < dirtyPatches.Size(); ++i)
+        dirtyPatches[i] = false;
+    CancelPatchBuilds(&dirtyPatches);
+
+    // The height data is stored bottom-up, while the heightmap image is top-down
+    float* dest = smoothing_ ? sourceHeightData_.Get() : heightData_.Get();
+    int width = rect.Width();
+    for (int y = rect.top_; y < rect.bottom_; ++y)
+    {
+        int z = numVertices_.y_ - 1 - y;
+        memcpy(dest + z * numVertices_.x_ + rect.left_, heights + (y - rect.top_) * width, width * sizeof(float));
+    }
+
+    IntRect updateRegion(rect.left_, numVertices_.y_ - rect.bottom_, rect.right_ - 1, numVertices_.y_ - 1 - rect.top_);
+
+    // Smoothing also changes the heights 1 vertex outside the modified area
+    if (smoothing_)
+    {
+        updateRegion.left_ = Max(updateRegion.left_ - 1, 0);
+        updateRegion.top_ = Max(updateRegion.top_ - 1, 0);
+        updateRegion.right_ = Min(updateRegion.right_ + 1, numVertices_.x_ - 1);
+        updateRegion.bottom_ = Min(updateRegion.bottom_ + 1, numVertices_.y_ - 1);
+        SmoothHeightData(updateRegion);
+    }
+
+    MarkDirtyPatches(updateRegion, dirtyPatches);
+    RebuildPatches(dirtyPatches);
+
+    if (node_)
+    {
+        using namespace TerrainHeightsChanged;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_RECT] = IntRect(updateRegion.left_, numVertices_.y_ - 1 - updateRegion.bottom_, updateRegion.right_ + 1,
+            numVertices_.y_ - updateRegion.top_);
+        node_->SendEvent(E_TERRAINHEIGHTSCHANGED, eventData);
+    }
+
+    return true;
+}
+
+bool Terrain::SetHeights(const IntRect& rect, const PODVector<float>& heights)
+{
+    if (heights.Size() < (unsigned)(rect.Width() * rect.Height()))
+    {
+        URHO3D_LOGERROR("Not enough heights for the terrain rectangle");
+        return false;
+    }
+
+    return SetHeights(rect, heights.Empty() ? (const float*)0 : &heights[0]);
+}
+
+unsigned Terrain::GetPatchMemoryUse() const
+{
+    // GPU vertex data, plus the position-only copies used for raycasts, decals and occlusion
+    unsigned row = (unsigned)(patchSize_ + 1);
+    return row * row * (VertexBuffer::GetVertexSize(PATCH_ELEMENT_MASK) + 2 * sizeof(Vector3));
+}
+
 Image* Terrain::GetHeightMap() const
 {
     return heightMap_;
@@ -490,116 +634,28 @@ IntVector2 Terrain::WorldToHeightMap(const Vector3& worldPosition) const
     return IntVector2(xPos, numVertices_.y_ - 1 - zPos);
 }
 
-void Terrain::CreatePatchGeometry(TerrainPatch* patch)
+Vector3 Terrain::HeightMapToWorld(const IntVector2& pixelPosition) const
 {
-    URHO3D_PROFILE(CreatePatchGeometry);
-
-    unsigned row = (unsigned)(patchSize_ + 1);
-    VertexBuffer* vertexBuffer = patch->GetVertexBuffer();
-    Geometry* geometry = patch->GetGeometry();
-    Geometry* maxLodGeometry = patch->GetMaxLodGeometry();
-    Geometry* occlusionGeometry = patch->GetOcclusionGeometry();
-
-    if (vertexBuffer->GetVertexCount() != row * row)
-        vertexBuffer->SetSize(row * row, MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT);
-
-    SharedArrayPtr<unsigned char> cpuVertexData(new unsigned char[row * row * sizeof(Vector3)]);
-    SharedArrayPtr<unsigned char> occlusionCpuVertexData(new unsigned char[row * row * sizeof(Vector3)]);
-
-    float* vertexData = (float*)vertexBuffer->Lock(0, vertexBuffer->GetVertexCount());
-    float* positionData = (float*)cpuVertexData.Get();
-    float* occlusionData = (float*)occlusionCpuVertexData.Get();
-    BoundingBox box;
-
-    unsigned occlusionLevel = occlusionLodLevel_;
-    if (occlusionLevel > numLodLevels_ - 1)
-        occlusionLevel = numLodLevels_ - 1;
-
-    if (vertexData)
-    {
-        const IntVector2& coords = patch->GetCoordinates();
-        int lodExpand = (1 << (occlusionLevel)) - 1;
-        int halfLodExpand = (1 << (occlusionLevel)) / 2;
-        
-        for (int z = 0; z <= patchSize_; ++z)
-        {
-            for (int x = 0; x <= patchSize_; ++x)
-            {
-                int xPos = coords.x_ * patchSize_ + x;
-                int zPos = coords.y_ * patchSize_ + z;
-
-                // Position
-                Vector3 position((float)x * spacing_.x_, GetRawHeight(xPos, zPos), (float)z * spacing_.z_);
-                *vertexData++ = position.x_;
-                *vertexData++ = position.y_;
-                *vertexData++ = position.z_;
-                *positionData++ = position.x_;
-                *positionData++ = position.y_;
-                *positionData++ = position.z_;
-
-                box.Merge(position);
-                
-                // For vertices that are part of the occlusion LOD, calculate the minimum height in the neighborhood
-                // to prevent false positive occlusion due to inaccuracy between occlusion LOD & visible LOD
-                float minHeight = position.y_;
-                if (halfLodExpand > 0 && (x & lodExpand) == 0 && (z & lodExpand) == 0)
-                {
-                    int minX = Max(xPos - halfLodExpand, 0);
-                    int maxX = Min(xPos + halfLodExpand, numVertices_.x_ - 1);
-                    int minZ = Max(zPos - halfLodExpand, 0);
-                    int maxZ = Min(zPos + halfLodExpand, numVertices_.y_ - 1);
-                    for (int nZ = minZ; nZ <= maxZ; ++nZ)
-                    {
-                        for (int nX = minX; nX <= maxX; ++nX)
-                            minHeight = Min(minHeight, GetRawHeight(nX, nZ));
-                    }
-                }
-                *occlusionData++ = position.x_;
-                *occlusionData++ = minHeight;
-                *occlusionData++ = position.z_;
-
-                // Normal
-                Vector3 normal = GetRawNormal(xPos, zPos);
-                *vertexData++ = normal.x_;
-                *vertexData++ = normal.y_;
-                *vertexData++ = normal.z_;
-
-                // Texture coordinate
-                Vector2 texCoord((float)xPos / (float)numVertices_.x_, 1.0f - (float)zPos / (float)numVertices_.y_);
-                *vertexData++ = texCoord.x_;
-                *vertexData++ = texCoord.y_;
-
-                // Tangent
-                Vector3 xyz = (Vector3::RIGHT - normal * normal.DotProduct(Vector3::RIGHT)).Normalized();
-                *vertexData++ = xyz.x_;
-                *vertexData++ = xyz.y_;
-                *vertexData++ = xyz.z_;
-                *vertexData++ = 1.0f;
-            }
-        }
-
-        vertexBuffer->Unlock();
-        vertexBuffer->ClearDataLost();
-    }
+    if (!node_)
+        return Vector3::ZERO;
 
-    patch->SetBoundingBox(box);
+    int xPos = Clamp(pixelPosition.x_, 0, numVertices_.x_ - 1);
+    int zPos = Clamp(numVertices_.y_ - 1 - pixelPosition.y_, 0, numVertices_.y_ - 1);
+    Vector3 position((float)xPos * spacing_.x_ + patchWorldOrigin_.x_, GetRawHeight(xPos, zPos),
+        (float)zPos * spacing_.z_ + patchWorldOrigin_.y_);
 
-    if (drawRanges_.Size())
-    {
-        unsigned occlusionDrawRange = occlusionLevel << 4;
+    return node_->GetWorldTransform() * position;
+}
 
-        geometry->SetIndexBuffer(indexBuffer_);
-        geometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[0].first_, drawRanges_[0].second_, false);
-        geometry->SetRawVertexData(cpuVertexData, sizeof(Vector3), MASK_POSITION);
-        maxLodGeometry->SetIndexBuffer(indexBuffer_);
-        maxLodGeometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[0].first_, drawRanges_[0].second_, false);
-        maxLodGeometry->SetRawVertexData(cpuVertexData, sizeof(Vector3), MASK_POSITION);
-        occlusionGeometry->SetIndexBuffer(indexBuffer_);
-        occlusionGeometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[occlusionDrawRange].first_, drawRanges_[occlusionDrawRange].second_, false);
-        occlusionGeometry->SetRawVertexData(occlusionCpuVertexData, sizeof(Vector3), MASK_POSITION);
-    }
+void Terrain::CreatePatchGeometry(TerrainPatch* patch)
+{
+    URHO3D_PROFILE(CreatePatchGeometry);
 
-    patch->ResetLod();
+    TerrainPatchBuild build;
+    build.patch_ = patch;
+    build.coordinates_ = patch->GetCoordinates();
+    BuildPatchData(build);
+    ApplyPatchData(build);
 }
 
 void Terrain::UpdatePatchLod(TerrainPatch* patch)
@@ -650,6 +706,7 @@ void Terrain::SetPatchSizeAttr(int value)
 
     if (value != patchSize_)
     {
+        CancelPatchBuilds();
         patchSize_ = value;
         recreateTerrain_ = true;
     }
@@ -661,6 +718,7 @@ void Terrain::SetMaxLodLevelsAttr(unsigned value)
     
     if (value != maxLodLevels_)
     {
+        CancelPatchBuilds();
         maxLodLevels_ = value;
         lastPatchSize_ = 0; // Force full recreate
         recreateTerrain_ = true;
@@ -671,6 +729,7 @@ void Terrain::SetOcclusionLodLevelAttr(unsigned value)
 {
     if (value != occlusionLodLevel_)
     {
+        CancelPatchBuilds();
         occlusionLodLevel_ = value;
         lastPatchSize_ = 0; // Force full recreate
         recreateTerrain_ = true;
@@ -696,6 +755,8 @@ void Terrain::CreateGeometry()
 
     URHO3D_PROFILE(CreateTerrainGeometry);
 
+    CancelPatchBuilds();
+
     unsigned prevNumPatches = patches_.Size();
 
     // Determine number of LOD levels
@@ -778,6 +839,13 @@ void Terrain::CreateGeometry()
 
     patches_.Clear();
 
+    // Patches keep their geometry only if the terrain is updated partially
+    if (updateAll || !heightMap_)
+    {
+        residentPatches_.Clear();
+        numResidentPatches_ = 0;
+    }
+
     if (heightMap_)
     {
         // Copy heightmap data
@@ -842,24 +910,7 @@ void Terrain::CreateGeometry()
 
         // If updating a region of the heightmap, check which patches change
         if (!updateAll)
-        {
-            int lodExpand = 1 << (numLodLevels_ - 1);
-            // Expand the right & bottom 1 pixel more, as patches share vertices at the edge
-            updateRegion.left_ -= lodExpand;
-            updateRegion.right_ += lodExpand + 1;
-            updateRegion.top_ -= lodExpand;
-            updateRegion.bottom_ += lodExpand + 1;
-
-            int sX = Max(updateRegion.left_ / patchSize_, 0);
-            int eX = Min(updateRegion.right_ / patchSize_, numPatches_.x_ - 1);
-            int sY = Max(updateRegion.top_ / patchSize_, 0);
-            int eY = Min(updateRegion.bottom_ / patchSize_, numPatches_.y_ - 1);
-            for (int y = sY; y <= eY; ++y)
-            {
-                for (int x = sX; x <= eX; ++x)
-                    dirtyPatches[y * numPatches_.x_ + x] = true;
-            }
-        }
+            MarkDirtyPatches(updateRegion, dirtyPatches);
 
         patches_.Reserve((unsigned)(numPatches_.x_ * numPatches_.y_));
 
@@ -915,6 +966,25 @@ void Terrain::CreateGeometry()
             }
         }
 
+        if (residentPatches_.Size() != patches_.Size())
+        {
+            unsigned oldSize = residentPatches_.Size();
+            residentPatches_.Resize(patches_.Size());
+            for (unsigned i = oldSize; i < residentPatches_.Size(); ++i)
+                residentPatches_[i] = false;
+        }
+
+        // When not paging, also build the patches that were released by paging earlier
+        bool paging = pagingDistance_ > 0.0f;
+        if (!paging)
+        {
+            for (unsigned i = 0; i < patches_.Size(); ++i)
+            {
+                if (!residentPatches_[i])
+                    dirtyPatches[i] = true;
+            }
+        }
+
         // Create the shared index data
         if (updateAll)
             CreateIndexData();
@@ -928,41 +998,20 @@ void Terrain::CreateGeometry()
             {
                 if (dirtyPatches[i])
                 {
-                    TerrainPatch* patch = patches_[i];
-                    const IntVector2& coords = patch->GetCoordinates();
+                    const IntVector2& coords = patches_[i]->GetCoordinates();
                     int startX = coords.x_ * patchSize_;
-                    int endX = startX + patchSize_;
                     int startZ = coords.y_ * patchSize_;
-                    int endZ = startZ + patchSize_;
-
-                    for (int z = startZ; z <= endZ; ++z)
-                    {
-                        for (int x = startX; x <= endX; ++x)
-                        {
-                            float smoothedHeight = (
-                                GetSourceHeight(x - 1, z - 1) + GetSourceHeight(x, z - 1) * 2.0f + GetSourceHeight(x + 1, z - 1) +
-                                GetSourceHeight(x - 1, z) * 2.0f + GetSourceHeight(x, z) * 4.0f + GetSourceHeight(x + 1, z) * 2.0f +
-                                GetSourceHeight(x - 1, z + 1) + GetSourceHeight(x, z + 1) * 2.0f + GetSourceHeight(x + 1, z + 1)
-                            ) / 16.0f;
-
-                            heightData_[z * numVertices_.x_ + x] = smoothedHeight;
-                        }
-                    }
+                    SmoothHeightData(IntRect(startX, startZ, startX + patchSize_, startZ + patchSize_));
                 }
             }
         }
 
+        RebuildPatches(dirtyPatches);
+
         for (unsigned i = 0; i < patches_.Size(); ++i)
         {
-            TerrainPatch* patch = patches_[i];
-
-            if (dirtyPatches[i])
-            {
-                CreatePatchGeometry(patch);
-                CalculateLodErrors(patch);
-            }
-
-            SetNeighbors(patch);
+            SetNeighbors(patches_[i]);
+            patches_[i]->SetEnabled(enabled && residentPatches_[i]);
         }
     }
 
@@ -975,6 +1024,8 @@ void Terrain::CreateGeometry()
         eventData[P_NODE] = node_;
         node_->SendEvent(E_TERRAINCREATED, eventData);
     }
+
+    UpdateEventSubscription();
 }
 
 void Terrain::CreateIndexData()
@@ -1137,6 +1188,112 @@ void Terrain::CreateIndexData()
     indexBuffer_->SetData(&indices[0]);
 }
 
+void Terrain::RebuildPatches(const PODVector<bool>& dirtyPatches)
+{
+    if (pagingDistance_ > 0.0f)
+    {
+        // Rebuild the changed patches that are in use in the background and release the rest. Further patches around
+        // the cameras are built during scene update
+        for (unsigned i = 0; i < patches_.Size(); ++i)
+        {
+            if (dirtyPatches[i])
+            {
+                if (residentPatches_[i])
+                    StartPatchBuild(i);
+                else
+                    EvictPatch(i);
+            }
+        }
+    }
+    else
+    {
+        URHO3D_PROFILE(BuildPatches);
+
+        // Generate vertex data and LOD errors of the changed patches in all threads, then upload in the main thread
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        Vector<SharedPtr<TerrainPatchBuild> > builds;
+
+        for (unsigned i = 0; i < patches_.Size(); ++i)
+        {
+            if (!dirtyPatches[i])
+                continue;
+
+            SharedPtr<TerrainPatchBuild> build(new TerrainPatchBuild());
+            build->patch_ = patches_[i];
+            build->coordinates_ = patches_[i]->GetCoordinates();
+            build->calculateLodErrors_ = true;
+            builds.Push(build);
+
+            if (queue)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildTerrainPatchWork;
+                item->start_ = this;
+                item->aux_ = build;
+                queue->AddWorkItem(item);
+            }
+            else
+                BuildPatchData(*build);
+        }
+
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < builds.Size(); ++i)
+            ApplyPatchData(*builds[i]);
+
+        for (unsigned i = 0; i < patches_.Size(); ++i)
+        {
+            if (!residentPatches_[i])
+            {
+                residentPatches_[i] = true;
+                ++numResidentPatches_;
+            }
+        }
+    }
+}
+
+void Terrain::MarkDirtyPatches(IntRect updateRegion, PODVector<bool>& dirtyPatches) const
+{
+    if (updateRegion.left_ < 0)
+        return;
+
+    int lodExpand = 1 << (numLodLevels_ - 1);
+    // Expand the right & bottom 1 pixel more, as patches share vertices at the edge
+    updateRegion.left_ -= lodExpand;
+    updateRegion.right_ += lodExpand + 1;
+    updateRegion.top_ -= lodExpand;
+    updateRegion.bottom_ += lodExpand + 1;
+
+    int sX = Max(updateRegion.left_ / patchSize_, 0);
+    int eX = Min(updateRegion.right_ / patchSize_, numPatches_.x_ - 1);
+    int sY = Max(updateRegion.top_ / patchSize_, 0);
+    int eY = Min(updateRegion.bottom_ / patchSize_, numPatches_.y_ - 1);
+    for (int y = sY; y <= eY; ++y)
+    {
+        for (int x = sX; x <= eX; ++x)
+            dirtyPatches[y * numPatches_.x_ + x] = true;
+    }
+}
+
+void Terrain::SmoothHeightData(const IntRect& region)
+{
+    for (int z = region.top_; z <= region.bottom_; ++z)
+    {
+        for (int x = region.left_; x <= region.right_; ++x)
+        {
+            float smoothedHeight = (
+                GetSourceHeight(x - 1, z - 1) + GetSourceHeight(x, z - 1) * 2.0f + GetSourceHeight(x + 1, z - 1) +
+                GetSourceHeight(x - 1, z) * 2.0f + GetSourceHeight(x, z) * 4.0f + GetSourceHeight(x + 1, z) * 2.0f +
+                GetSourceHeight(x - 1, z + 1) + GetSourceHeight(x, z + 1) * 2.0f + GetSourceHeight(x + 1, z + 1)
+            ) / 16.0f;
+
+            heightData_[z * numVertices_.x_ + x] = smoothedHeight;
+        }
+    }
+}
+
 float Terrain::GetRawHeight(int x, int z) const
 {
     if (!heightData_)
@@ -1210,8 +1367,11 @@ void Terrain::CalculateLodErrors(TerrainPatch* patch)
 {
     URHO3D_PROFILE(CalculateLodErrors);
 
-    const IntVector2& coords = patch->GetCoordinates();
-    PODVector<float>& lodErrors = patch->GetLodErrors();
+    CalculateLodErrors(patch->GetCoordinates(), patch->GetLodErrors());
+}
+
+void Terrain::CalculateLodErrors(const IntVector2& coords, PODVector<float>& lodErrors) const
+{
     lodErrors.Clear();
     lodErrors.Reserve(numLodLevels_);
 
@@ -1249,9 +1409,361 @@ void Terrain::CalculateLodErrors(TerrainPatch* patch)
 
 void Terrain::SetNeighbors(TerrainPatch* patch)
 {
+    // Patches without geometry are not rendered, so they must not take part in LOD stitching
     const IntVector2& coords = patch->GetCoordinates();
-    patch->SetNeighbors(GetPatch(coords.x_, coords.y_ + 1), GetPatch(coords.x_, coords.y_ - 1),
-        GetPatch(coords.x_ - 1, coords.y_), GetPatch(coords.x_ + 1, coords.y_));
+    patch->SetNeighbors(GetResidentPatch(coords.x_, coords.y_ + 1), GetResidentPatch(coords.x_, coords.y_ - 1),
+        GetResidentPatch(coords.x_ - 1, coords.y_), GetResidentPatch(coords.x_ + 1, coords.y_));
+}
+
+TerrainPatch* Terrain::GetResidentPatch(int x, int z) const
+{
+    if (x < 0 || x >= numPatches_.x_ || z < 0 || z >= numPatches_.y_)
+        return 0;
+
+    unsigned index = (unsigned)(z * numPatches_.x_ + x);
+    return IsPatchResident(index) ? GetPatch(index) : (TerrainPatch*)0;
+}
+
+void Terrain::BuildPatchData(TerrainPatchBuild& build) const
+{
+    unsigned row = (unsigned)(patchSize_ + 1);
+    unsigned vertexSize = VertexBuffer::GetVertexSize(PATCH_ELEMENT_MASK) / sizeof(float);
+
+    build.vertexData_ = new float[row * row * vertexSize];
+    build.cpuVertexData_ = new unsigned char[row * row * sizeof(Vector3)];
+    build.occlusionCpuVertexData_ = new unsigned char[row * row * sizeof(Vector3)];
+    build.boundingBox_.Clear();
+
+    float* vertexData = build.vertexData_.Get();
+    float* positionData = (float*)build.cpuVertexData_.Get();
+    float* occlusionData = (float*)build.occlusionCpuVertexData_.Get();
+
+    unsigned occlusionLevel = occlusionLodLevel_;
+    if (occlusionLevel > numLodLevels_ - 1)
+        occlusionLevel = numLodLevels_ - 1;
+
+    const IntVector2& coords = build.coordinates_;
+    int lodExpand = (1 << (occlusionLevel)) - 1;
+    int halfLodExpand = (1 << (occlusionLevel)) / 2;
+
+    for (int z = 0; z <= patchSize_; ++z)
+    {
+        for (int x = 0; x <= patchSize_; ++x)
+        {
+            int xPos = coords.x_ * patchSize_ + x;
+            int zPos = coords.y_ * patchSize_ + z;
+
+            // Position
+            Vector3 position((float)x * spacing_.x_, GetRawHeight(xPos, zPos), (float)z * spacing_.z_);
+            *vertexData++ = position.x_;
+            *vertexData++ = position.y_;
+            *vertexData++ = position.z_;
+            *positionData++ = position.x_;
+            *positionData++ = position.y_;
+            *positionData++ = position.z_;
+
+            build.boundingBox_.Merge(position);
+
+            // For vertices that are part of the occlusion LOD, calculate the minimum height in the neighborhood
+            // to prevent false positive occlusion due to inaccuracy between occlusion LOD & visible LOD
+            float minHeight = position.y_;
+            if (halfLodExpand > 0 && (x & lodExpand) == 0 && (z & lodExpand) == 0)
+            {
+                int minX = Max(xPos - halfLodExpand, 0);
+                int maxX = Min(xPos + halfLodExpand, numVertices_.x_ - 1);
+                int minZ = Max(zPos - halfLodExpand, 0);
+                int maxZ = Min(zPos + halfLodExpand, numVertices_.y_ - 1);
+                for (int nZ = minZ; nZ <= maxZ; ++nZ)
+                {
+                    for (int nX = minX; nX <= maxX; ++nX)
+                        minHeight = Min(minHeight, GetRawHeight(nX, nZ));
+                }
+            }
+            *occlusionData++ = position.x_;
+            *occlusionData++ = minHeight;
+            *occlusionData++ = position.z_;
+
+            // Normal
+            Vector3 normal = GetRawNormal(xPos, zPos);
+            *vertexData++ = normal.x_;
+            *vertexData++ = normal.y_;
+            *vertexData++ = normal.z_;
+
+            // Texture coordinate
+            Vector2 texCoord((float)xPos / (float)numVertices_.x_, 1.0f - (float)zPos / (float)numVertices_.y_);
+            *vertexData++ = texCoord.x_;
+            *vertexData++ = texCoord.y_;
+
+            // Tangent
+            Vector3 xyz = (Vector3::RIGHT - normal * normal.DotProduct(Vector3::RIGHT)).Normalized();
+            *vertexData++ = xyz.x_;
+            *vertexData++ = xyz.y_;
+            *vertexData++ = xyz.z_;
+            *vertexData++ = 1.0f;
+        }
+    }
+
+    if (build.calculateLodErrors_)
+        CalculateLodErrors(coords, build.lodErrors_);
+}
+
+void Terrain::ApplyPatchData(const TerrainPatchBuild& build)
+{
+    TerrainPatch* patch = build.patch_;
+    if (!patch)
+        return;
+
+    unsigned row = (unsigned)(patchSize_ + 1);
+    VertexBuffer* vertexBuffer = patch->GetVertexBuffer();
+    Geometry* geometry = patch->GetGeometry();
+    Geometry* maxLodGeometry = patch->GetMaxLodGeometry();
+    Geometry* occlusionGeometry = patch->GetOcclusionGeometry();
+
+    if (vertexBuffer->GetVertexCount() != row * row)
+        vertexBuffer->SetSize(row * row, PATCH_ELEMENT_MASK);
+    vertexBuffer->SetData(build.vertexData_.Get());
+
+    patch->SetBoundingBox(build.boundingBox_);
+
+    if (drawRanges_.Size())
+    {
+        unsigned occlusionLevel = occlusionLodLevel_;
+        if (occlusionLevel > numLodLevels_ - 1)
+            occlusionLevel = numLodLevels_ - 1;
+        unsigned occlusionDrawRange = occlusionLevel << 4;
+
+        geometry->SetIndexBuffer(indexBuffer_);
+        geometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[0].first_, drawRanges_[0].second_, false);
+        geometry->SetRawVertexData(build.cpuVertexData_, sizeof(Vector3), MASK_POSITION);
+        maxLodGeometry->SetIndexBuffer(indexBuffer_);
+        maxLodGeometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[0].first_, drawRanges_[0].second_, false);
+        maxLodGeometry->SetRawVertexData(build.cpuVertexData_, sizeof(Vector3), MASK_POSITION);
+        occlusionGeometry->SetIndexBuffer(indexBuffer_);
+        occlusionGeometry->SetDrawRange(TRIANGLE_LIST, drawRanges_[occlusionDrawRange].first_, drawRanges_[occlusionDrawRange].second_, false);
+        occlusionGeometry->SetRawVertexData(build.occlusionCpuVertexData_, sizeof(Vector3), MASK_POSITION);
+    }
+
+    if (build.calculateLodErrors_)
+        patch->GetLodErrors() = build.lodErrors_;
+
+    patch->ResetLod();
+}
+
+void Terrain::StartPatchBuild(unsigned index)
+{
+    TerrainPatch* patch = patches_[index];
+    if (!patch)
+        return;
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    SharedPtr<TerrainPatchBuild> build(new TerrainPatchBuild());
+    build->patch_ = patch;
+    build->coordinates_ = patch->GetCoordinates();
+    build->calculateLodErrors_ = true;
+
+    // Use a non-pooled work item, so that it can safely be removed from the queue later
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->workFunction_ = BuildTerrainPatchWork;
+    item->start_ = this;
+    item->aux_ = build;
+    item->priority_ = 0;
+    build->workItem_ = item;
+    patchBuilds_.Push(build);
+    queue->AddWorkItem(item);
+}
+
+void Terrain::CancelPatchBuilds(PODVector<bool>* dirtyPatches)
+{
+    if (patchBuilds_.Empty())
+        return;
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    for (Vector<SharedPtr<TerrainPatchBuild> >::Iterator i = patchBuilds_.Begin(); i != patchBuilds_.End(); ++i)
+    {
+        TerrainPatchBuild* build = *i;
+        if (!queue || queue->RemoveWorkItem(build->workItem_))
+            continue;
+
+        // The build is already running in a worker thread, wait for it to finish
+        while (!build->completed_)
+            Time::Sleep(0);
+    }
+
+    // Patches that were waiting to be rebuilt have stale geometry. Either let the caller rebuild them, or release the
+    // geometry so that paging builds them again
+    for (Vector<SharedPtr<TerrainPatchBuild> >::Iterator i = patchBuilds_.Begin(); i != patchBuilds_.End(); ++i)
+    {
+        const IntVector2& coords = (*i)->coordinates_;
+        unsigned index = (unsigned)(coords.y_ * numPatches_.x_ + coords.x_);
+        if (!IsPatchResident(index))
+            continue;
+
+        if (dirtyPatches && index < dirtyPatches->Size())
+            (*dirtyPatches)[index] = true;
+        else
+            EvictPatch(index);
+    }
+
+    patchBuilds_.Clear();
+}
+
+void Terrain::EvictPatch(unsigned index)
+{
+    if (residentPatches_[index])
+    {
+        residentPatches_[index] = false;
+        --numResidentPatches_;
+    }
+
+    TerrainPatch* patch = patches_[index];
+    if (!patch)
+        return;
+
+    patch->SetEnabled(false);
+    patch->GetVertexBuffer()->SetSize(0, PATCH_ELEMENT_MASK);
+    patch->GetGeometry()->SetRawVertexData(SharedArrayPtr<unsigned char>(), 0, 0);
+    patch->GetMaxLodGeometry()->SetRawVertexData(SharedArrayPtr<unsigned char>(), 0, 0);
+    patch->GetOcclusionGeometry()->SetRawVertexData(SharedArrayPtr<unsigned char>(), 0, 0);
+
+    UpdateNeighbors(index);
+}
+
+void Terrain::UpdatePaging()
+{
+    Renderer* renderer = GetSubsystem<Renderer>();
+    Scene* scene = GetScene();
+    if (!renderer || !scene || patches_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateTerrainPaging);
+
+    // Gather the viewport camera positions in terrain space. Without cameras keep the current patches
+    Matrix3x4 inverseWorldTransform = node_->GetWorldTransform().Inverse();
+    PODVector<Vector3> cameraPositions;
+    for (unsigned i = 0; i < renderer->GetNumViewports(); ++i)
+    {
+        Viewport* viewport = renderer->GetViewport(i);
+        Camera* camera = viewport ? viewport->GetCamera() : 0;
+        if (camera && camera->GetNode() && viewport->GetScene() == scene)
+            cameraPositions.Push(inverseWorldTransform * camera->GetNode()->GetWorldPosition());
+    }
+    if (cameraPositions.Empty())
+        return;
+
+    Vector3 worldScale = node_->GetWorldScale();
+    float localDistance = pagingDistance_ / Max(0.5f * (worldScale.x_ + worldScale.z_), M_EPSILON);
+    float localDistanceSquared = localDistance * localDistance;
+
+    // Find the patches within paging distance of any camera on the XZ-plane, nearest first
+    PODVector<Pair<float, unsigned> > wantedPatches;
+    for (unsigned i = 0; i < patches_.Size(); ++i)
+    {
+        float minX = patchWorldOrigin_.x_ + (float)(i % numPatches_.x_) * patchWorldSize_.x_;
+        float minZ = patchWorldOrigin_.y_ + (float)(i / numPatches_.x_) * patchWorldSize_.y_;
+        float maxX = minX + patchWorldSize_.x_;
+        float maxZ = minZ + patchWorldSize_.y_;
+        float distanceSquared = M_INFINITY;
+
+        for (unsigned j = 0; j < cameraPositions.Size(); ++j)
+        {
+            const Vector3& position = cameraPositions[j];
+            float dx = Max(Max(minX - position.x_, position.x_ - maxX), 0.0f);
+            float dz = Max(Max(minZ - position.z_, position.z_ - maxZ), 0.0f);
+            distanceSquared = Min(distanceSquared, dx * dx + dz * dz);
+        }
+
+        if (distanceSquared <= localDistanceSquared)
+            wantedPatches.Push(MakePair(distanceSquared, i));
+    }
+
+    Sort(wantedPatches.Begin(), wantedPatches.End());
+
+    unsigned numWanted = wantedPatches.Size();
+    if (patchMemoryBudget_)
+        numWanted = Min(numWanted, Max(patchMemoryBudget_ / GetPatchMemoryUse(), 1U));
+
+    PODVector<bool> keepPatches(patches_.Size());
+    PODVector<bool> buildingPatches(patches_.Size());
+    for (unsigned i = 0; i < patches_.Size(); ++i)
+    {
+        keepPatches[i] = false;
+        buildingPatches[i] = false;
+    }
+    for (unsigned i = 0; i < numWanted; ++i)
+        keepPatches[wantedPatches[i].second_] = true;
+    for (unsigned i = 0; i < patchBuilds_.Size(); ++i)
+    {
+        const IntVector2& coords = patchBuilds_[i]->coordinates_;
+        buildingPatches[coords.y_ * numPatches_.x_ + coords.x_] = true;
+    }
+
+    // Evict first, so that the budget is not exceeded when the new patches arrive
+    for (unsigned i = 0; i < patches_.Size(); ++i)
+    {
+        if (residentPatches_[i] && !keepPatches[i] && !buildingPatches[i])
+            EvictPatch(i);
+    }
+
+    for (unsigned i = 0; i < numWanted && patchBuilds_.Size() < MAX_PENDING_PATCH_BUILDS; ++i)
+    {
+        unsigned index = wantedPatches[i].second_;
+        if (!residentPatches_[index] && !buildingPatches[index])
+            StartPatchBuild(index);
+    }
+}
+
+void Terrain::UpdateNeighbors(unsigned index)
+{
+    int x = (int)(index % numPatches_.x_);
+    int z = (int)(index / numPatches_.x_);
+
+    TerrainPatch* patch = GetPatch(index);
+    if (patch)
+        SetNeighbors(patch);
+
+    TerrainPatch* neighbors[] = { GetPatch(x, z + 1), GetPatch(x, z - 1), GetPatch(x - 1, z), GetPatch(x + 1, z) };
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (neighbors[i])
+            SetNeighbors(neighbors[i]);
+    }
+}
+
+void Terrain::OnSceneSet(Scene* scene)
+{
+    if (scene)
+        UpdateEventSubscription();
+    else
+    {
+        CancelPatchBuilds();
+        if (subscribed_)
+        {
+            UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+            subscribed_ = false;
+        }
+    }
+}
+
+void Terrain::UpdateEventSubscription()
+{
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    bool needUpdate = pagingDistance_ > 0.0f || !patchBuilds_.Empty();
+
+    if (needUpdate && !subscribed_)
+    {
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(Terrain, HandleScenePostUpdate));
+        subscribed_ = true;
+    }
+    else if (!needUpdate && subscribed_)
+    {
+        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+        subscribed_ = false;
+    }
 }
 
 bool Terrain::SetHeightMapInternal(Image* image, bool recreateNow)
@@ -1273,7 +1785,10 @@ bool Terrain::SetHeightMapInternal(Image* image, bool recreateNow)
     if (recreateNow)
         CreateGeometry();
     else
+    {
+        CancelPatchBuilds();
         recreateTerrain_ = true;
+    }
 
     return true;
 }
@@ -1283,4 +1798,43 @@ void Terrain::HandleHeightMapReloadFinished(StringHash eventType, VariantMap& ev
     CreateGeometry();
 }
 
+void Terrain::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // Apply the patches built in the background since last frame
+    for (Vector<SharedPtr<TerrainPatchBuild> >::Iterator i = patchBuilds_.Begin(); i != patchBuilds_.End();)
+    {
+        TerrainPatchBuild* build = *i;
+        if (!build->completed_)
+        {
+            ++i;
+            continue;
+        }
+
+        const IntVector2& coords = build->coordinates_;
+        unsigned index = (unsigned)(coords.y_ * numPatches_.x_ + coords.x_);
+        TerrainPatch* patch = build->patch_;
+        if (patch)
+        {
+            ApplyPatchData(*build);
+            if (!residentPatches_[index])
+            {
+                residentPatches_[index] = true;
+                ++numResidentPatches_;
+                patch->SetEnabled(IsEnabledEffective());
+                UpdateNeighbors(index);
+            }
+        }
+
+        i = patchBuilds_.Erase(i);
+    }
+
+    if (pagingDistance_ > 0.0f)
+    {
+        if (IsEnabledEffective())
+            UpdatePaging();
+    }
+    else
+        UpdateEventSubscription();
+}
+
 }
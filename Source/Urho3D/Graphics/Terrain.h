@@ -22,6 +22,8 @@
 
 #pragma once
 
+#include "../Container/ArrayPtr.h"
+#include "../Math/BoundingBox.h"
 #include "../Scene/Component.h"
 
 namespace Urho3D
@@ -32,12 +34,45 @@ class IndexBuffer;
 class Material;
 class Node;
 class TerrainPatch;
+struct WorkItem;
+
+/// Terrain patch vertex data and LOD errors generated in a background job, waiting to be applied to the patch.
+struct TerrainPatchBuild : public RefCounted
+{
+    /// Construct with defaults.
+    TerrainPatchBuild();
+    /// Destruct.
+    ~TerrainPatchBuild();
+
+    /// Patch to apply the data to.
+    WeakPtr<TerrainPatch> patch_;
+    /// Patch coordinates.
+    IntVector2 coordinates_;
+    /// Vertex buffer data.
+    SharedArrayPtr<float> vertexData_;
+    /// Position-only vertex data for raycasts and decals.
+    SharedArrayPtr<unsigned char> cpuVertexData_;
+    /// Position-only vertex data for occlusion.
+    SharedArrayPtr<unsigned char> occlusionCpuVertexData_;
+    /// Local-space bounding box.
+    BoundingBox boundingBox_;
+    /// Geometrical error per LOD level.
+    PODVector<float> lodErrors_;
+    /// Calculate LOD errors flag.
+    bool calculateLodErrors_;
+    /// Work item.
+    SharedPtr<WorkItem> workItem_;
+    /// Completed flag.
+    volatile bool completed_;
+};
 
 /// Heightmap terrain component.
 class URHO3D_API Terrain : public Component
 {
     URHO3D_OBJECT(Terrain, Component);
 
+    friend void BuildTerrainPatchWork(const WorkItem* item, unsigned threadIndex);
+
 public:
     /// Construct.
     Terrain(Context* context);
@@ -89,8 +124,16 @@ public:
     void SetOccluder(bool enable);
     /// Set occludee flag for patches.
     void SetOccludee(bool enable);
+    /// Set paging distance. When nonzero, only patches within this distance of a viewport camera keep their geometry, which is built in background jobs. The heightmap and height data stay loaded in full. Default 0 builds all patches immediately.
+    void SetPagingDistance(float distance);
+    /// Set memory budget in bytes for paged patch geometry. When exceeded, the patches nearest to the cameras are kept. Default 0 is unlimited.
+    void SetPatchMemoryBudget(unsigned bytes);
     /// Apply changes from the heightmap image.
     void ApplyHeightMap();
+    /// Set heights in a rectangle of heightmap pixels, given row by row from the top. Heights are in the same units as the height data. Only the affected patches are rebuilt. The changes are lost if the terrain is recreated from the heightmap image. Return true if successful.
+    bool SetHeights(const IntRect& rect, const float* heights);
+    /// Set heights in a rectangle of heightmap pixels, given row by row from the top. Return true if successful.
+    bool SetHeights(const IntRect& rect, const PODVector<float>& heights);
 
     /// Return patch quads per side.
     int GetPatchSize() const { return patchSize_; }
@@ -113,6 +156,23 @@ public:
     /// Return whether smoothing is in use.
     bool GetSmoothing() const { return smoothing_; }
 
+    /// Return paging distance.
+    float GetPagingDistance() const { return pagingDistance_; }
+
+    /// Return memory budget for paged patch geometry.
+    unsigned GetPatchMemoryBudget() const { return patchMemoryBudget_; }
+
+    /// Return number of patches that currently have geometry.
+    unsigned GetNumResidentPatches() const { return numResidentPatches_; }
+
+    /// Return number of patches waiting for their geometry to be built in the background.
+    unsigned GetNumPendingPatches() const { return patchBuilds_.Size(); }
+
+    /// Return whether a patch currently has geometry.
+    bool IsPatchResident(unsigned index) const { return index < residentPatches_.Size() && residentPatches_[index]; }
+
+    /// Return geometry memory use of one patch in bytes.
+    unsigned GetPatchMemoryUse() const;
     /// Return heightmap image.
     Image* GetHeightMap() const;
     /// Return material.
@@ -127,6 +187,8 @@ public:
     Vector3 GetNormal(const Vector3& worldPosition) const;
     /// Convert world position to heightmap pixel position. Note that the internal height data representation is reversed vertically, but in the heightmap image north is at the top.
     IntVector2 WorldToHeightMap(const Vector3& worldPosition) const;
+    /// Convert heightmap pixel position to world position, including the terrain height at that point.
+    Vector3 HeightMapToWorld(const IntVector2& pixelPosition) const;
 
     /// Return raw height data.
     SharedArrayPtr<float> GetHeightData() const { return heightData_; }
@@ -186,6 +248,10 @@ public:
     /// Return material attribute.
     ResourceRef GetMaterialAttr() const;
 
+protected:
+    /// Handle scene being assigned.
+    virtual void OnSceneSet(Scene* scene);
+
 private:
     /// Regenerate terrain geometry.
     void CreateGeometry();
@@ -201,8 +267,36 @@ private:
     Vector3 GetRawNormal(int x, int z) const;
     /// Calculate LOD errors for a patch.
     void CalculateLodErrors(TerrainPatch* patch);
+    /// Calculate LOD errors for patch coordinates. Only reads the height data, so may be called from a worker thread.
+    void CalculateLodErrors(const IntVector2& coords, PODVector<float>& lodErrors) const;
+    /// Generate vertex data and optionally LOD errors for a patch. Only reads the height data, so may be called from a worker thread.
+    void BuildPatchData(TerrainPatchBuild& build) const;
+    /// Apply generated vertex data to a patch.
+    void ApplyPatchData(const TerrainPatchBuild& build);
+    /// Start a background build of a paged patch.
+    void StartPatchBuild(unsigned index);
+    /// Cancel background patch builds. Waits for builds already running in a worker thread. Resident patches that were being rebuilt are either marked dirty, or evicted if no dirty flags are given.
+    void CancelPatchBuilds(PODVector<bool>* dirtyPatches = 0);
+    /// Rebuild or release changed patches, depending on whether paging is in use.
+    void RebuildPatches(const PODVector<bool>& dirtyPatches);
+    /// Mark the patches affected by a height data region as dirty.
+    void MarkDirtyPatches(IntRect updateRegion, PODVector<bool>& dirtyPatches) const;
+    /// Smooth the height data in a region from the source height data.
+    void SmoothHeightData(const IntRect& region);
+    /// Release the geometry of a paged patch.
+    void EvictPatch(unsigned index);
+    /// Choose the paged patches to keep around the viewport cameras, then evict and build patches accordingly.
+    void UpdatePaging();
+    /// Update the neighbors of a patch and the patches around it.
+    void UpdateNeighbors(unsigned index);
+    /// Subscribe to or unsubscribe from scene post-update according to whether paging is in use.
+    void UpdateEventSubscription();
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
     /// Set neighbors for a patch.
     void SetNeighbors(TerrainPatch* patch);
+    /// Return patch by patch coordinates if it currently has geometry.
+    TerrainPatch* GetResidentPatch(int x, int z) const;
     /// Set heightmap image and optionally recreate the geometry immediately. Return true if successful.
     bool SetHeightMapInternal(Image* image, bool recreateNow);
     /// Handle heightmap image reload finished.
@@ -220,6 +314,10 @@ private:
     SharedPtr<Material> material_;
     /// Terrain patches.
     Vector<WeakPtr<TerrainPatch> > patches_;
+    /// Patch residency flags.
+    PODVector<bool> residentPatches_;
+    /// Background patch builds in progress.
+    Vector<SharedPtr<TerrainPatchBuild> > patchBuilds_;
     /// Draw ranges for different LODs and stitching combinations.
     PODVector<Pair<unsigned, unsigned> > drawRanges_;
     /// Vertex and height spacing.
@@ -272,6 +370,14 @@ private:
     float lodBias_;
     /// Maximum lights.
     unsigned maxLights_;
+    /// Paging distance.
+    float pagingDistance_;
+    /// Memory budget for paged patch geometry.
+    unsigned patchMemoryBudget_;
+    /// Number of patches that have geometry.
+    unsigned numResidentPatches_;
+    /// Subscribed to scene post-update flag.
+    bool subscribed_;
     /// Terrain needs regeneration flag.
     bool recreateTerrain_;
 };
@@ -137,7 +137,7 @@ end
 
 function is_arithmetic(t)
     for _, type in pairs({ "char", "short", "int", "unsigned", "long", "float", "double", "bool" }) do
-        _, pos = t:find(type)
+        _, pos = t:find("%f[%w]" .. type .. "%f[%W]")
         if pos ~= nil and t:sub(pos + 1, pos + 1) ~= "*" then return true end
     end
     return false
@@ -519,17 +519,22 @@ void CrowdAgent::OnCrowdUpdate(dtCrowdAgent* ag, float dt)
         {
             previousPosition_ = newPos;
 
-            using namespace CrowdAgentReposition;
+            if (crowdManager_->batchRepositionEvents_)
+                crowdManager_->repositionedAgents_.Push(Variant(this));
+            else
+            {
+                using namespace CrowdAgentReposition;
 
-            VariantMap& map = GetEventDataMap();
-            map[P_NODE] = node_;
-            map[P_CROWD_AGENT] = this;
-            map[P_POSITION] = newPos;
-            map[P_VELOCITY] = newVel;
-            map[P_ARRIVED] = HasArrived();
-            map[P_TIMESTEP] = dt;
-            crowdManager_->SendEvent(E_CROWD_AGENT_REPOSITION, map);
-            node_->SendEvent(E_CROWD_AGENT_NODE_REPOSITION, map);
+                VariantMap& map = GetEventDataMap();
+                map[P_NODE] = node_;
+                map[P_CROWD_AGENT] = this;
+                map[P_POSITION] = newPos;
+                map[P_VELOCITY] = newVel;
+                map[P_ARRIVED] = HasArrived();
+                map[P_TIMESTEP] = dt;
+                crowdManager_->SendEvent(E_CROWD_AGENT_REPOSITION, map);
+                node_->SendEvent(E_CROWD_AGENT_NODE_REPOSITION, map);
+            }
 
             if (updateNodePosition_)
             {
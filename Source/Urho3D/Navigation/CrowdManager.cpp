@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../IO/Log.h"
 #include "../Navigation/CrowdAgent.h"
@@ -45,12 +46,65 @@ extern const char* NAVIGATION_CATEGORY;
 
 static const unsigned DEFAULT_MAX_AGENTS = 512;
 static const float DEFAULT_MAX_AGENT_RADIUS = 0.f;
+static const int MAX_CROWD_JOBS = 64;
+static const int MIN_AGENTS_PER_CROWD_JOB = 32;
+
+/// Range of active crowd agents processed by one work item.
+struct CrowdJobRange
+{
+    /// Detour crowd job function.
+    dtCrowdJob job_;
+    /// Detour crowd job context.
+    void* context_;
+    /// First agent index.
+    int begin_;
+    /// Agent index past the last one.
+    int end_;
+};
 
 void CrowdAgentUpdateCallback(dtCrowdAgent* ag, float dt)
 {
     static_cast<CrowdAgent*>(ag->params.userData)->OnCrowdUpdate(ag, dt);
 }
 
+static void CrowdJobWork(const WorkItem* item, unsigned threadIndex)
+{
+    const CrowdJobRange* range = reinterpret_cast<const CrowdJobRange*>(item->start_);
+    range->job_(range->context_, range->begin_, range->end_, (int)threadIndex);
+}
+
+static void CrowdParallelFor(void* userData, int count, dtCrowdJob job, void* context)
+{
+    WorkQueue* queue = static_cast<WorkQueue*>(userData);
+
+    // Use a couple of ranges per thread so that uneven agent costs even out
+    int numJobs = Min((int)(queue->GetNumThreads() + 1) * 2, MAX_CROWD_JOBS);
+    numJobs = Max(Min(numJobs, count / MIN_AGENTS_PER_CROWD_JOB), 1);
+    int agentsPerJob = (count + numJobs - 1) / numJobs;
+
+    CrowdJobRange ranges[MAX_CROWD_JOBS];
+    int begin = 0;
+    for (int i = 0; i < numJobs && begin < count; ++i)
+    {
+        CrowdJobRange& range = ranges[i];
+        range.job_ = job;
+        range.context_ = context;
+        range.begin_ = begin;
+        range.end_ = Min(begin + agentsPerJob, count);
+        begin = range.end_;
+
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = CrowdJobWork;
+        item->aux_ = 0;
+        item->start_ = &range;
+        item->end_ = 0;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 CrowdManager::CrowdManager(Context* context) :
     Component(context),
     crowd_(0),
@@ -59,7 +113,9 @@ CrowdManager::CrowdManager(Context* context) :
     maxAgents_(DEFAULT_MAX_AGENTS),
     maxAgentRadius_(DEFAULT_MAX_AGENT_RADIUS),
     numQueryFilterTypes_(0),
-    numObstacleAvoidanceTypes_(0)
+    numObstacleAvoidanceTypes_(0),
+    threadedUpdate_(false),
+    batchRepositionEvents_(false)
 {
     // The actual buffer is allocated inside dtCrowd, we only track the number of "slots" being configured explicitly
     numAreas_.Reserve(DT_CROWD_MAX_QUERY_FILTER_TYPE);
@@ -84,6 +140,8 @@ void CrowdManager::RegisterObject(Context* context)
         Variant::emptyVariantVector, AM_DEFAULT);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Obstacle Avoidance Types", GetObstacleAvoidanceTypesAttr, SetObstacleAvoidanceTypesAttr,
         VariantVector, Variant::emptyVariantVector, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Threaded Update", GetThreadedUpdate, SetThreadedUpdate, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Batch Reposition Events", GetBatchRepositionEvents, SetBatchRepositionEvents, bool, false, AM_DEFAULT);
 }
 
 void CrowdManager::ApplyAttributes()
@@ -223,6 +281,26 @@ void CrowdManager::SetMaxAgents(unsigned maxAgents)
     }
 }
 
+void CrowdManager::SetThreadedUpdate(bool enable)
+{
+    if (enable != threadedUpdate_)
+    {
+        threadedUpdate_ = enable;
+        if (crowd_)
+            SetupCrowdThreading();
+        MarkNetworkUpdate();
+    }
+}
+
+void CrowdManager::SetBatchRepositionEvents(bool enable)
+{
+    if (enable != batchRepositionEvents_)
+    {
+        batchRepositionEvents_ = enable;
+        MarkNetworkUpdate();
+    }
+}
+
 void CrowdManager::SetMaxAgentRadius(float maxAgentRadius)
 {
     if (maxAgentRadius != maxAgentRadius_ && maxAgentRadius > 0.f)
@@ -556,6 +634,7 @@ bool CrowdManager::CreateCrowd()
         URHO3D_LOGERROR("Could not initialize DetourCrowd");
         return false;
     }
+    SetupCrowdThreading();
 
     if (recreate)
     {
@@ -638,11 +717,38 @@ void CrowdManager::OnSceneSet(Scene* scene)
     }
 }
 
+void CrowdManager::SetupCrowdThreading()
+{
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (threadedUpdate_ && queue && queue->GetNumThreads())
+    {
+        if (!crowd_->setParallelFor(CrowdParallelFor, queue, queue->GetNumThreads() + 1))
+            URHO3D_LOGERROR("Could not initialize DetourCrowd for multithreaded update");
+    }
+    else
+        crowd_->setParallelFor(0, 0, 0);
+}
+
 void CrowdManager::Update(float delta)
 {
     assert(crowd_ && navigationMesh_);
     URHO3D_PROFILE(UpdateCrowd);
+
+    // Agents write back their node positions in one pass after the simulation step, collecting the repositioned
+    // agents for a single event if requested
+    repositionedAgents_.Clear();
     crowd_->update(delta, 0);
+
+    if (batchRepositionEvents_ && !repositionedAgents_.Empty())
+    {
+        using namespace CrowdAgentsReposition;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_CROWD_MANAGER] = this;
+        eventData[P_CROWD_AGENTS] = repositionedAgents_;
+        eventData[P_TIMESTEP] = delta;
+        SendEvent(E_CROWD_AGENTS_REPOSITION, eventData);
+    }
 }
 
 const dtCrowdAgent* CrowdManager::GetDetourCrowdAgent(int agent) const
@@ -101,6 +101,10 @@ public:
     void SetObstacleAvoidanceTypesAttr(const VariantVector& value);
     /// Set the params for the specified obstacle avoidance type.
     void SetObstacleAvoidanceParams(unsigned obstacleAvoidanceType, const CrowdObstacleAvoidanceParams& params);
+    /// Set whether to run neighbour gathering, steering, obstacle avoidance and movement of large crowds in parallel on the work queue. Default false.
+    void SetThreadedUpdate(bool enable);
+    /// Set whether to send a single crowd agents reposition event per update instead of the per-agent reposition events. Default false.
+    void SetBatchRepositionEvents(bool enable);
 
     /// Get all the crowd agent components in the specified node hierarchy. If the node is not specified then use scene node. When inCrowdFilter is set to true then only get agents that are in the crowd.
     PODVector<CrowdAgent*> GetAgents(Node* node = 0, bool inCrowdFilter = true) const;
@@ -150,6 +154,12 @@ public:
     /// Get the params for the specified obstacle avoidance type.
     const CrowdObstacleAvoidanceParams& GetObstacleAvoidanceParams(unsigned obstacleAvoidanceType) const;
 
+    /// Return whether the crowd update is run in parallel on the work queue.
+    bool GetThreadedUpdate() const { return threadedUpdate_; }
+
+    /// Return whether a single batched reposition event is sent per update.
+    bool GetBatchRepositionEvents() const { return batchRepositionEvents_; }
+
 protected:
     /// Create and initialized internal Detour crowd object. When it is a recreate, it preserves the configuration and attempts to re-add existing agents in the previous crowd back to the newly created crowd.
     bool CreateCrowd();
@@ -157,6 +167,8 @@ protected:
     int AddAgent(CrowdAgent* agent, const Vector3& pos);
     /// Removes the detour crowd agent.
     void RemoveAgent(CrowdAgent* agent);
+    /// Enable or disable the multithreaded update of the internal Detour crowd object.
+    void SetupCrowdThreading();
 
 protected:
     /// Handle scene being assigned.
@@ -193,6 +205,12 @@ private:
     PODVector<unsigned> numAreas_;
     /// Number of obstacle avoidance types configured in the crowd. Limit to DT_CROWD_MAX_OBSTAVOIDANCE_PARAMS.
     unsigned numObstacleAvoidanceTypes_;
+    /// Multithreaded update flag.
+    bool threadedUpdate_;
+    /// Batched reposition events flag.
+    bool batchRepositionEvents_;
+    /// Crowd agents repositioned during the current update, when reposition events are batched.
+    VariantVector repositionedAgents_;
 };
 
 }
@@ -59,12 +59,6 @@ extern const char* NAVIGATION_CATEGORY;
 static const int DEFAULT_MAX_OBSTACLES = 1024;
 static const int DEFAULT_MAX_LAYERS = 16;
 
-struct DynamicNavigationMesh::TileCacheData
-{
-    unsigned char* data;
-    int dataSize;
-};
-
 struct TileCompressor : public dtTileCacheCompressor
 {
     virtual int maxCompressedSize(const int bufferSize)
@@ -344,29 +338,7 @@ bool DynamicNavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                TileCacheData tiles[TILECACHE_MAXLAYERS];
-                int layerCt = BuildTile(geometryList, x, z, tiles);
-                for (int i = 0; i < layerCt; ++i)
-                {
-                    dtCompressedTileRef tileRef;
-                    int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                    if (dtStatusFailed((dtStatus)status))
-                    {
-                        dtFree(tiles[i].data);
-                        tiles[i].data = 0x0;
-                    }
-                }
-                ++numTiles;
-            }
-            for (int x = 0; x < numTilesX_; ++x)
-                tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-        }
+        unsigned numTiles = BuildTiles(geometryList, IntVector2::ZERO, IntVector2(numTilesX_ - 1, numTilesZ_ - 1));
 
         // For a full build it's necessary to update the nav mesh
         // not doing so will cause dependent components to crash, like CrowdManager
@@ -413,52 +385,12 @@ bool DynamicNavigationMesh::Build(const BoundingBox& boundingBox)
     if (!node_->GetWorldScale().Equals(Vector3::ONE))
         URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
 
-    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
-
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
-
     Vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
-    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-
-    unsigned numTiles = 0;
-
-    for (int z = sz; z <= ez; ++z)
-    {
-        for (int x = sx; x <= ex; ++x)
-        {
-            dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
-            const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
-            for (int i = 0; i < existingCt; ++i)
-            {
-                unsigned char* data = 0x0;
-                if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, 0)) && data != 0x0)
-                    dtFree(data);
-            }
-
-            TileCacheData tiles[TILECACHE_MAXLAYERS];
-            int layerCt = BuildTile(geometryList, x, z, tiles);
-            for (int i = 0; i < layerCt; ++i)
-            {
-                dtCompressedTileRef tileRef;
-                int status = tileCache_->addTile(tiles[i].data, tiles[i].dataSize, DT_COMPRESSEDTILE_FREE_DATA, &tileRef);
-                if (dtStatusFailed((dtStatus)status))
-                {
-                    dtFree(tiles[i].data);
-                    tiles[i].data = 0x0;
-                }
-                else
-                {
-                    tileCache_->buildNavMeshTile(tileRef, navMesh_);
-                    ++numTiles;
-                }
-            }
-        }
-    }
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
+    unsigned numTiles = BuildTiles(geometryList, from, to);
 
     URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
     return true;
@@ -602,27 +534,8 @@ void DynamicNavigationMesh::SetNavigationDataAttr(const PODVector<unsigned char>
         return;
     }
 
-    while (!buffer.IsEof())
-    {
-        dtTileCacheLayerHeader header;
-        buffer.Read(&header, sizeof(dtTileCacheLayerHeader));
-        const int dataSize = buffer.ReadInt();
-        unsigned char* data = (unsigned char*)dtAlloc(dataSize, DT_ALLOC_PERM);
-        buffer.Read(data, (unsigned)dataSize);
-
-        if (dtStatusFailed(tileCache_->addTile(data, dataSize, DT_TILE_FREE_DATA, 0)))
-        {
-            URHO3D_LOGERROR("Failed to add tile");
-            dtFree(data);
-            return;
-        }
-    }
-
-    for (int x = 0; x < numTilesX_; ++x)
-    {
-        for (int z = 0; z < numTilesZ_; ++z)
-            tileCache_->buildNavMeshTilesAt(x, z, navMesh_);
-    }
+    // When streaming, the tiles are loaded separately by UpdateStreaming()
+    ReadTiles(buffer, true);
 
     tileCache_->update(0, navMesh_);
 }
@@ -642,28 +555,125 @@ PODVector<unsigned char> DynamicNavigationMesh::GetNavigationDataAttr() const
         const dtTileCacheParams* tcParams = tileCache_->getParams();
         ret.Write(tcParams, sizeof(dtTileCacheParams));
 
-        for (int z = 0; z < numTilesZ_; ++z)
+        // When streaming, the tiles are stored in separate files written by SaveTiles()
+        if (streamingPath_.Empty())
         {
-            for (int x = 0; x < numTilesX_; ++x)
+            for (int z = 0; z < numTilesZ_; ++z)
             {
-                dtCompressedTileRef tiles[TILECACHE_MAXLAYERS];
-                const int ct = tileCache_->getTilesAt(x, z, tiles, maxLayers_);
-                for (int i = 0; i < ct; ++i)
-                {
-                    const dtCompressedTile* tile = tileCache_->getTileByRef(tiles[i]);
-                    if (!tile || !tile->header || !tile->dataSize)
-                        continue; // Don't write "void-space" tiles
-                    // The header conveniently has the majority of the information required
-                    ret.Write(tile->header, sizeof(dtTileCacheLayerHeader));
-                    ret.WriteInt(tile->dataSize);
-                    ret.Write(tile->data, (unsigned)tile->dataSize);
-                }
+                for (int x = 0; x < numTilesX_; ++x)
+                    WriteTile(ret, x, z);
             }
         }
     }
     return ret.GetBuffer();
 }
 
+bool DynamicNavigationMesh::HasTile(const IntVector2& tile) const
+{
+    if (!tileCache_)
+        return false;
+    dtCompressedTileRef tiles[TILECACHE_MAXLAYERS];
+    return tileCache_->getTilesAt(tile.x_, tile.y_, tiles, maxLayers_) > 0;
+}
+
+void DynamicNavigationMesh::WriteTile(Serializer& dest, int x, int z) const
+{
+    if (!tileCache_)
+        return;
+
+    dtCompressedTileRef tiles[TILECACHE_MAXLAYERS];
+    const int ct = tileCache_->getTilesAt(x, z, tiles, maxLayers_);
+    for (int i = 0; i < ct; ++i)
+    {
+        const dtCompressedTile* tile = tileCache_->getTileByRef(tiles[i]);
+        if (!tile || !tile->header || !tile->dataSize)
+            continue; // Don't write "void-space" tiles
+        // The header conveniently has the majority of the information required
+        dest.Write(tile->header, sizeof(dtTileCacheLayerHeader));
+        dest.WriteInt(tile->dataSize);
+        dest.Write(tile->data, (unsigned)tile->dataSize);
+    }
+}
+
+bool DynamicNavigationMesh::ReadTiles(Deserializer& source, bool silent)
+{
+    if (!tileCache_)
+    {
+        URHO3D_LOGERROR("Tile cache must first be built or allocated before adding tiles");
+        return false;
+    }
+
+    PODVector<IntVector2> tiles;
+    bool success = true;
+
+    while (!source.IsEof())
+    {
+        dtTileCacheLayerHeader header;
+        source.Read(&header, sizeof(dtTileCacheLayerHeader));
+        const int dataSize = source.ReadInt();
+        unsigned char* data = (unsigned char*)dtAlloc(dataSize, DT_ALLOC_PERM);
+        if (!data)
+        {
+            URHO3D_LOGERROR("Could not allocate data for navigation mesh tile");
+            success = false;
+            break;
+        }
+        source.Read(data, (unsigned)dataSize);
+
+        // Replace the previous layers of a tile when its first layer is read
+        IntVector2 tile(header.tx, header.ty);
+        if (!tiles.Contains(tile))
+        {
+            RemoveTileData(tile.x_, tile.y_);
+            tiles.Push(tile);
+        }
+
+        if (dtStatusFailed(tileCache_->addTile(data, dataSize, DT_TILE_FREE_DATA, 0)))
+        {
+            URHO3D_LOGERROR("Failed to add tile");
+            dtFree(data);
+            success = false;
+            break;
+        }
+    }
+
+    // Build the navigation mesh tiles of the layers added so far
+    for (unsigned i = 0; i < tiles.Size(); ++i)
+        tileCache_->buildNavMeshTilesAt(tiles[i].x_, tiles[i].y_, navMesh_);
+
+    if (!silent)
+    {
+        // Event handlers may remove the navigation mesh
+        WeakPtr<DynamicNavigationMesh> self(this);
+        for (unsigned i = 0; i < tiles.Size() && !self.Expired(); ++i)
+            SendTileEvent(E_NAVIGATION_TILE_ADDED, tiles[i]);
+    }
+
+    return success;
+}
+
+bool DynamicNavigationMesh::RemoveTileData(int x, int z)
+{
+    if (!tileCache_)
+        return false;
+
+    // Remove the layers from both the tile cache and the navigation mesh
+    dtCompressedTileRef existing[TILECACHE_MAXLAYERS];
+    const int existingCt = tileCache_->getTilesAt(x, z, existing, maxLayers_);
+    for (int i = 0; i < existingCt; ++i)
+    {
+        const dtCompressedTile* tile = tileCache_->getTileByRef(existing[i]);
+        if (tile && tile->header)
+            navMesh_->removeTile(navMesh_->getTileRefAt(x, z, tile->header->tlayer), 0, 0);
+
+        unsigned char* data = 0x0;
+        if (!dtStatusFailed(tileCache_->removeTile(existing[i], &data, 0)) && data != 0x0)
+            dtFree(data);
+    }
+
+    return existingCt > 0;
+}
+
 void DynamicNavigationMesh::SetMaxLayers(unsigned maxLayers)
 {
     // Set 3 as a minimum due to the tendency of layers to be constructed inside the hollow space of stacked objects
@@ -671,156 +681,117 @@ void DynamicNavigationMesh::SetMaxLayers(unsigned maxLayers)
     maxLayers_ = Max(3U, Min(maxLayers, TILECACHE_MAXLAYERS));
 }
 
-int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles)
+SharedPtr<NavBuildData> DynamicNavigationMesh::CreateTileBuildData()
+{
+    return SharedPtr<NavBuildData>(new DynamicNavBuildData(allocator_));
+}
+
+bool DynamicNavigationMesh::BuildTileData(NavBuildData* buildData) const
 {
-    URHO3D_PROFILE(BuildNavigationMeshTile);
-
-    tileCache_->removeTile(navMesh_->getTileRefAt(x, z, 0), 0, 0);
-
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
-
-    BoundingBox tileBoundingBox(Vector3(
-            boundingBox_.min_.x_ + tileEdgeLength * (float)x,
-            boundingBox_.min_.y_,
-            boundingBox_.min_.z_ + tileEdgeLength * (float)z),
-        Vector3(
-            boundingBox_.min_.x_ + tileEdgeLength * (float)(x + 1),
-            boundingBox_.max_.y_,
-            boundingBox_.min_.z_ + tileEdgeLength * (float)(z + 1)));
-
-    DynamicNavBuildData build(allocator_);
-
-    rcConfig cfg;
-    memset(&cfg, 0, sizeof cfg);
-    cfg.cs = cellSize_;
-    cfg.ch = cellHeight_;
-    cfg.walkableSlopeAngle = agentMaxSlope_;
-    cfg.walkableHeight = (int)ceilf(agentHeight_ / cfg.ch);
-    cfg.walkableClimb = (int)floorf(agentMaxClimb_ / cfg.ch);
-    cfg.walkableRadius = (int)ceilf(agentRadius_ / cfg.cs);
-    cfg.maxEdgeLen = (int)(edgeMaxLength_ / cellSize_);
-    cfg.maxSimplificationError = edgeMaxError_;
-    cfg.minRegionArea = (int)sqrtf(regionMinSize_);
-    cfg.mergeRegionArea = (int)sqrtf(regionMergeSize_);
-    cfg.maxVertsPerPoly = 6;
-    cfg.tileSize = tileSize_;
-    cfg.borderSize = cfg.walkableRadius + 3; // Add padding
-    cfg.width = cfg.tileSize + cfg.borderSize * 2;
-    cfg.height = cfg.tileSize + cfg.borderSize * 2;
-    cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
-    cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
-
-    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
-    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
-    cfg.bmin[0] -= cfg.borderSize * cfg.cs;
-    cfg.bmin[2] -= cfg.borderSize * cfg.cs;
-    cfg.bmax[0] += cfg.borderSize * cfg.cs;
-    cfg.bmax[2] += cfg.borderSize * cfg.cs;
-
-    BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
-
-    if (build.vertices_.Empty() || build.indices_.Empty())
-        return 0; // Nothing to do
-
-    build.heightField_ = rcAllocHeightfield();
-    if (!build.heightField_)
+    DynamicNavBuildData* build = static_cast<DynamicNavBuildData*>(buildData);
+
+    if (build->vertices_.Empty() || build->indices_.Empty())
+        return true; // Nothing to do
+
+    const rcConfig& cfg = *build->config_;
+
+    build->heightField_ = rcAllocHeightfield();
+    if (!build->heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
-        return 0;
+        return false;
     }
 
-    if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
+    if (!rcCreateHeightfield(build->ctx_, *build->heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
-        return 0;
+        return false;
     }
 
-    unsigned numTriangles = build.indices_.Size() / 3;
+    unsigned numTriangles = build->indices_.Size() / 3;
     SharedArrayPtr<unsigned char> triAreas(new unsigned char[numTriangles]);
     memset(triAreas.Get(), 0, numTriangles);
 
-    rcMarkWalkableTriangles(build.ctx_, cfg.walkableSlopeAngle, &build.vertices_[0].x_, build.vertices_.Size(),
-        &build.indices_[0], numTriangles, triAreas.Get());
-    rcRasterizeTriangles(build.ctx_, &build.vertices_[0].x_, build.vertices_.Size(), &build.indices_[0],
-        triAreas.Get(), numTriangles, *build.heightField_, cfg.walkableClimb);
-    rcFilterLowHangingWalkableObstacles(build.ctx_, cfg.walkableClimb, *build.heightField_);
+    rcMarkWalkableTriangles(build->ctx_, cfg.walkableSlopeAngle, &build->vertices_[0].x_, build->vertices_.Size(),
+        &build->indices_[0], numTriangles, triAreas.Get());
+    rcRasterizeTriangles(build->ctx_, &build->vertices_[0].x_, build->vertices_.Size(), &build->indices_[0],
+        triAreas.Get(), numTriangles, *build->heightField_, cfg.walkableClimb);
+    rcFilterLowHangingWalkableObstacles(build->ctx_, cfg.walkableClimb, *build->heightField_);
 
-    rcFilterLedgeSpans(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_);
-    rcFilterWalkableLowHeightSpans(build.ctx_, cfg.walkableHeight, *build.heightField_);
+    rcFilterLedgeSpans(build->ctx_, cfg.walkableHeight, cfg.walkableClimb, *build->heightField_);
+    rcFilterWalkableLowHeightSpans(build->ctx_, cfg.walkableHeight, *build->heightField_);
 
-    build.compactHeightField_ = rcAllocCompactHeightfield();
-    if (!build.compactHeightField_)
+    build->compactHeightField_ = rcAllocCompactHeightfield();
+    if (!build->compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
-        return 0;
+        return false;
     }
-    if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
-        *build.compactHeightField_))
+    if (!rcBuildCompactHeightfield(build->ctx_, cfg.walkableHeight, cfg.walkableClimb, *build->heightField_,
+        *build->compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
-        return 0;
+        return false;
     }
-    if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
+    if (!rcErodeWalkableArea(build->ctx_, cfg.walkableRadius, *build->compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
-        return 0;
+        return false;
     }
 
     // area volumes
-    for (unsigned i = 0; i < build.navAreas_.Size(); ++i)
-        rcMarkBoxArea(build.ctx_, &build.navAreas_[i].bounds_.min_.x_, &build.navAreas_[i].bounds_.max_.x_,
-            build.navAreas_[i].areaID_, *build.compactHeightField_);
+    for (unsigned i = 0; i < build->navAreas_.Size(); ++i)
+        rcMarkBoxArea(build->ctx_, &build->navAreas_[i].bounds_.min_.x_, &build->navAreas_[i].bounds_.max_.x_,
+            build->navAreas_[i].areaID_, *build->compactHeightField_);
 
-    if (this->partitionType_ == NAVMESH_PARTITION_WATERSHED)
+    if (build->watershedPartition_)
     {
-        if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
+        if (!rcBuildDistanceField(build->ctx_, *build->compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
-            return 0;
+            return false;
         }
-        if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
+        if (!rcBuildRegions(build->ctx_, *build->compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
-            return 0;
+            return false;
         }
     }
     else
     {
-        if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
+        if (!rcBuildRegionsMonotone(build->ctx_, *build->compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
-            return 0;
+            return false;
         }
     }
 
-    build.heightFieldLayers_ = rcAllocHeightfieldLayerSet();
-    if (!build.heightFieldLayers_)
+    build->heightFieldLayers_ = rcAllocHeightfieldLayerSet();
+    if (!build->heightFieldLayers_)
     {
         URHO3D_LOGERROR("Could not allocate height field layer set");
-        return 0;
+        return false;
     }
 
-    if (!rcBuildHeightfieldLayers(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.walkableHeight,
-        *build.heightFieldLayers_))
+    if (!rcBuildHeightfieldLayers(build->ctx_, *build->compactHeightField_, cfg.borderSize, cfg.walkableHeight,
+        *build->heightFieldLayers_))
     {
         URHO3D_LOGERROR("Could not build height field layers");
-        return 0;
+        return false;
     }
 
-    int retCt = 0;
-    for (int i = 0; i < build.heightFieldLayers_->nlayers; ++i)
+    for (int i = 0; i < build->heightFieldLayers_->nlayers; ++i)
     {
         dtTileCacheLayerHeader header;
         header.magic = DT_TILECACHE_MAGIC;
         header.version = DT_TILECACHE_VERSION;
-        header.tx = x;
-        header.ty = z;
+        header.tx = build->tileX_;
+        header.ty = build->tileZ_;
         header.tlayer = i;
 
-        rcHeightfieldLayer* layer = &build.heightFieldLayers_->layers[i];
+        rcHeightfieldLayer* layer = &build->heightFieldLayers_->layers[i];
 
         // Tile info.
         rcVcopy(header.bmin, layer->bmin);
@@ -834,29 +805,57 @@ int DynamicNavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryLis
         header.hmin = (unsigned short)layer->hmin;
         header.hmax = (unsigned short)layer->hmax;
 
+        unsigned char* data = 0x0;
+        int dataSize = 0;
         if (dtStatusFailed(
             dtBuildTileCacheLayer(compressor_/*compressor*/, &header, layer->heights, layer->areas/*areas*/, layer->cons,
-                &(tiles[retCt].data), &tiles[retCt].dataSize)))
+                &data, &dataSize)))
         {
             URHO3D_LOGERROR("Failed to build tile cache layers");
-            return 0;
+            // Free the layers built so far so that none of the tile is added
+            for (unsigned j = 0; j < build->layerData_.Size(); ++j)
+                dtFree(build->layerData_[j]);
+            build->layerData_.Clear();
+            build->layerDataSizes_.Clear();
+            return false;
         }
-        else
-            ++retCt;
+
+        build->layerData_.Push(data);
+        build->layerDataSizes_.Push(dataSize);
     }
 
-    // Send a notification of the rebuild of this tile to anyone interested
+    return true;
+}
+
+bool DynamicNavigationMesh::AddTileData(NavBuildData* buildData)
+{
+    DynamicNavBuildData* build = static_cast<DynamicNavBuildData*>(buildData);
+    int x = build->tileX_;
+    int z = build->tileZ_;
+
+    // Remove the previous layers (if any)
+    RemoveTileData(x, z);
+
+    int numLayers = 0;
+    for (unsigned i = 0; i < build->layerData_.Size(); ++i)
     {
-        using namespace NavigationAreaRebuilt;
-        VariantMap& eventData = GetContext()->GetEventDataMap();
-        eventData[P_NODE] = GetNode();
-        eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
-        SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
+        dtCompressedTileRef tileRef;
+        int status = tileCache_->addTile(build->layerData_[i], build->layerDataSizes_[i], DT_COMPRESSEDTILE_FREE_DATA,
+            &tileRef);
+        if (!dtStatusFailed((dtStatus)status))
+        {
+            // The tile cache owns the data now
+            build->layerData_[i] = 0x0;
+            tileCache_->buildNavMeshTile(tileRef, navMesh_);
+            ++numLayers;
+        }
     }
 
-    return retCt;
+    if (!numLayers)
+        return false;
+
+    SendTileRebuiltEvents(build);
+    return true;
 }
 
 PODVector<OffMeshConnection*> DynamicNavigationMesh::CollectOffMeshConnections(const BoundingBox& bounds)
@@ -67,6 +67,8 @@ public:
     virtual void SetNavigationDataAttr(const PODVector<unsigned char>& value);
     /// Return navigation data attribute.
     virtual PODVector<unsigned char> GetNavigationDataAttr() const;
+    /// Return whether the tile cache contains layers for a tile.
+    virtual bool HasTile(const IntVector2& tile) const;
 
     /// Set the maximum number of obstacles allowed.
     void SetMaxObstacles(unsigned maxObstacles) { maxObstacles_ = maxObstacles; }
@@ -85,8 +87,6 @@ public:
     bool GetDrawObstacles() const { return drawObstacles_; }
 
 protected:
-    struct TileCacheData;
-
     /// Subscribe to events when assigned to a scene.
     virtual void OnSceneSet(Scene* scene);
     /// Trigger the tile cache to make updates to the nav mesh if necessary.
@@ -99,8 +99,18 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle*, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData*);
+    /// Allocate the build data for one tile.
+    virtual SharedPtr<NavBuildData> CreateTileBuildData();
+    /// Run Recast on the collected geometry to create compressed tile cache layers. Safe to call from worker threads. Return true if successful.
+    virtual bool BuildTileData(NavBuildData* build) const;
+    /// Replace the tile cache layers at the tile position with the built layers and rebuild the navigation mesh tiles. Return true if any layers were added.
+    virtual bool AddTileData(NavBuildData* build);
+    /// Write the tile cache layers of a tile to a serializer. Writes nothing if the tile has no layers.
+    virtual void WriteTile(Serializer& dest, int x, int z) const;
+    /// Read tile cache layers from a deserializer until its end, replacing the existing layers of the same tiles, and build their navigation mesh tiles. Send tile added events unless silent. Return true if successful.
+    virtual bool ReadTiles(Deserializer& source, bool silent);
+    /// Remove the tile cache layers and navigation mesh tiles of a tile without sending events. Return true if there were layers.
+    virtual bool RemoveTileData(int x, int z);
     /// Off-mesh connections to be rebuilt in the mesh processor.
     PODVector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
@@ -24,6 +24,7 @@
 
 #include "../Navigation/NavBuildData.h"
 
+#include <Detour/DetourAlloc.h>
 #include <DetourTileCache/DetourTileCacheBuilder.h>
 #include <Recast/Recast.h>
 
@@ -31,6 +32,13 @@ namespace Urho3D
 {
 
 NavBuildData::NavBuildData() :
+    tileX_(0),
+    tileZ_(0),
+    config_(new rcConfig()),
+    agentHeight_(0.0f),
+    agentRadius_(0.0f),
+    agentMaxClimb_(0.0f),
+    watershedPartition_(true),
     ctx_(new rcContext(true)),
     heightField_(0),
     compactHeightField_(0)
@@ -41,6 +49,8 @@ NavBuildData::~NavBuildData()
 {
     delete(ctx_);
     ctx_ = 0;
+    delete(config_);
+    config_ = 0;
     rcFreeHeightField(heightField_);
     heightField_ = 0;
     rcFreeCompactHeightfield(compactHeightField_);
@@ -51,7 +61,9 @@ SimpleNavBuildData::SimpleNavBuildData() :
     NavBuildData(),
     contourSet_(0),
     polyMesh_(0),
-    polyMeshDetail_(0)
+    polyMeshDetail_(0),
+    navData_(0),
+    navDataSize_(0)
 {
 }
 
@@ -63,6 +75,8 @@ SimpleNavBuildData::~SimpleNavBuildData()
     polyMesh_ = 0;
     rcFreePolyMeshDetail(polyMeshDetail_);
     polyMeshDetail_ = 0;
+    dtFree(navData_);
+    navData_ = 0;
 }
 
 DynamicNavBuildData::DynamicNavBuildData(dtTileCacheAlloc* allocator) :
@@ -83,6 +97,9 @@ DynamicNavBuildData::~DynamicNavBuildData()
     polyMesh_ = 0;
     rcFreeHeightfieldLayerSet(heightFieldLayers_);
     heightFieldLayers_ = 0;
+    for (unsigned i = 0; i < layerData_.Size(); ++i)
+        dtFree(layerData_[i]);
+    layerData_.Clear();
 }
 
 }
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/RefCounted.h"
 #include "../Container/Vector.h"
 #include "../Math/BoundingBox.h"
 #include "../Math/Vector3.h"
@@ -32,6 +33,7 @@ struct dtTileCacheContourSet;
 struct dtTileCachePolyMesh;
 struct dtTileCacheAlloc;
 struct rcCompactHeightfield;
+struct rcConfig;
 struct rcContourSet;
 struct rcHeightfield;
 struct rcHeightfieldLayerSet;
@@ -50,8 +52,8 @@ struct URHO3D_API NavAreaStub
     unsigned char areaID_;
 };
 
-/// Navigation build data.
-struct URHO3D_API NavBuildData
+/// Navigation build data of one tile. Geometry is collected in the main thread, after which the Recast processing may run in a worker thread.
+struct URHO3D_API NavBuildData : public RefCounted
 {
     /// Constructor.
     NavBuildData();
@@ -60,6 +62,22 @@ struct URHO3D_API NavBuildData
 
     /// World-space bounding box of the navigation mesh tile.
     BoundingBox worldBoundingBox_;
+    /// Local-space bounding box of the navigation mesh tile without border padding.
+    BoundingBox tileBoundingBox_;
+    /// Tile X index.
+    int tileX_;
+    /// Tile Z index.
+    int tileZ_;
+    /// Recast build configuration.
+    rcConfig* config_;
+    /// Navigation agent height. Copied from the navigation mesh so that the build is unaffected by later changes to it.
+    float agentHeight_;
+    /// Navigation agent radius.
+    float agentRadius_;
+    /// Navigation agent max vertical climb.
+    float agentMaxClimb_;
+    /// Whether to partition the heightfield with the watershed algorithm instead of the monotone one.
+    bool watershedPartition_;
     /// Vertices from geometries.
     PODVector<Vector3> vertices_;
     /// Triangle indices from geometries.
@@ -97,6 +115,10 @@ struct SimpleNavBuildData : public NavBuildData
     rcPolyMesh* polyMesh_;
     /// Recast detail poly mesh.
     rcPolyMeshDetail* polyMeshDetail_;
+    /// Finished Detour tile data. Freed on destruction unless ownership has been passed to the navigation mesh.
+    unsigned char* navData_;
+    /// Size of the Detour tile data.
+    int navDataSize_;
 };
 
 struct DynamicNavBuildData : public NavBuildData
@@ -112,6 +134,10 @@ struct DynamicNavBuildData : public NavBuildData
     dtTileCachePolyMesh* polyMesh_;
     /// Recast heightfield layer set.
     rcHeightfieldLayerSet* heightFieldLayers_;
+    /// Finished compressed tile cache layers. Freed on destruction unless ownership has been passed to the tile cache.
+    PODVector<unsigned char*> layerData_;
+    /// Sizes of the compressed tile cache layers.
+    PODVector<int> layerDataSizes_;
     /// Allocator from DynamicNavigationMesh instance.
     dtTileCacheAlloc* alloc_;
 };
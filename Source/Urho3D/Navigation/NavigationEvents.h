@@ -43,6 +43,32 @@ URHO3D_EVENT(E_NAVIGATION_AREA_REBUILT, NavigationAreaRebuilt)
     URHO3D_PARAM(P_BOUNDSMAX, BoundsMax); // Vector3
 }
 
+/// Tile added to the navigation mesh.
+URHO3D_EVENT(E_NAVIGATION_TILE_ADDED, NavigationTileAdded)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_TILE, Tile); // IntVector2
+}
+
+/// Tile removed from the navigation mesh.
+URHO3D_EVENT(E_NAVIGATION_TILE_REMOVED, NavigationTileRemoved)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_TILE, Tile); // IntVector2
+}
+
+/// Queued path request finished.
+URHO3D_EVENT(E_NAVIGATION_PATH_RESULT, NavigationPathResult)
+{
+    URHO3D_PARAM(P_NODE, Node); // Node pointer
+    URHO3D_PARAM(P_MESH, Mesh); // NavigationMesh pointer
+    URHO3D_PARAM(P_REQUEST, Request); // unsigned
+    URHO3D_PARAM(P_SUCCESS, Success); // bool
+    URHO3D_PARAM(P_PATH, Path); // VariantVector of world space Vector3 points
+}
+
 /// Crowd agent formation.
 URHO3D_EVENT(E_CROWD_AGENT_FORMATION, CrowdAgentFormation)
 {
@@ -74,6 +100,14 @@ URHO3D_EVENT(E_CROWD_AGENT_REPOSITION, CrowdAgentReposition)
     URHO3D_PARAM(P_TIMESTEP, TimeStep); // float
 }
 
+/// Crowd agents have been repositioned. Sent once per crowd update instead of the per-agent reposition events when the crowd manager batches them.
+URHO3D_EVENT(E_CROWD_AGENTS_REPOSITION, CrowdAgentsReposition)
+{
+    URHO3D_PARAM(P_CROWD_MANAGER, CrowdManager); // CrowdManager pointer
+    URHO3D_PARAM(P_CROWD_AGENTS, CrowdAgents); // VariantVector of CrowdAgent pointers
+    URHO3D_PARAM(P_TIMESTEP, TimeStep); // float
+}
+
 /// Crowd agent has been repositioned, specific to a node
 URHO3D_EVENT(E_CROWD_AGENT_NODE_REPOSITION, CrowdAgentNodeReposition)
 {
@@ -23,13 +23,19 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Model.h"
 #include "../Graphics/StaticModel.h"
 #include "../Graphics/TerrainPatch.h"
+#include "../IO/Compression.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../Navigation/CrowdAgent.h"
@@ -44,7 +50,9 @@
 #ifdef URHO3D_PHYSICS
 #include "../Physics/CollisionShape.h"
 #endif
+#include "../Resource/ResourceCache.h"
 #include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
 
 #include <cfloat>
 #include <Detour/DetourNavMesh.h>
@@ -81,6 +89,21 @@ static const float DEFAULT_DETAIL_SAMPLE_DISTANCE = 6.0f;
 static const float DEFAULT_DETAIL_SAMPLE_MAX_ERROR = 1.0f;
 
 static const int MAX_POLYS = 2048;
+static const unsigned TILE_BATCH_SIZE_PER_THREAD = 4;
+static const unsigned DEFAULT_PATH_ITERATIONS_PER_FRAME = 4096;
+static const float DEFAULT_STREAMING_DISTANCE = 100.0f;
+static const char* TILE_FILE_ID = "UNVT";
+
+/// Return distance from a point to the nearest point of a bounding box, or zero if inside.
+static float GetDistanceToBox(const BoundingBox& box, const Vector3& point)
+{
+    Vector3 offset(
+        Max(Max(box.min_.x_ - point.x_, point.x_ - box.max_.x_), 0.0f),
+        Max(Max(box.min_.y_ - point.y_, point.y_ - box.max_.y_), 0.0f),
+        Max(Max(box.min_.z_ - point.z_, point.z_ - box.max_.z_), 0.0f)
+    );
+    return offset.Length();
+}
 
 
 /// Temporary data for finding a path.
@@ -96,6 +119,171 @@ struct FindPathData
     unsigned char pathFlags_[MAX_POLYS];
 };
 
+/// Queued asynchronous path request.
+struct PathRequest : public RefCounted
+{
+    /// Request ID.
+    unsigned id_;
+    /// Start point in navigation mesh local space.
+    Vector3 start_;
+    /// End point in navigation mesh local space.
+    Vector3 end_;
+    /// Search extents.
+    Vector3 extents_;
+    /// Query filter.
+    const dtQueryFilter* filter_;
+    /// Polygon nearest to the end point.
+    dtPolyRef endRef_;
+    /// Resulting path points in navigation mesh local space.
+    PODVector<Vector3> path_;
+};
+
+/// Path query lane. Owns a Detour query object, used by one work item at a time, and the sliced search in progress on it.
+struct PathQueryLane
+{
+    /// Construct.
+    PathQueryLane() :
+        query_(0),
+        iterations_(0)
+    {
+    }
+
+    /// Destruct.
+    ~PathQueryLane()
+    {
+        dtFreeNavMeshQuery(query_);
+        query_ = 0;
+    }
+
+    /// Detour navigation mesh query.
+    dtNavMeshQuery* query_;
+    /// Request being searched.
+    SharedPtr<PathRequest> current_;
+    /// Requests finished during this frame.
+    Vector<SharedPtr<PathRequest> > finished_;
+    /// Search iterations allowed for this frame.
+    int iterations_;
+    /// Temporary data for finalizing the path.
+    FindPathData pathData_;
+};
+
+/// Asynchronous path request queue and the query lanes processing it, one lane per thread.
+struct PathQueryData
+{
+    /// Construct.
+    PathQueryData() :
+        nextPending_(0),
+        nextId_(1)
+    {
+    }
+
+    /// Destruct.
+    ~PathQueryData()
+    {
+        ReleaseLanes();
+    }
+
+    /// Free the query lanes. Requests being searched are returned to the front of the queue.
+    void ReleaseLanes()
+    {
+        for (unsigned i = 0; i < lanes_.Size(); ++i)
+        {
+            if (lanes_[i]->current_)
+                pending_.Insert(0, lanes_[i]->current_);
+            delete lanes_[i];
+        }
+        lanes_.Clear();
+    }
+
+    /// Requests waiting to be searched.
+    Vector<SharedPtr<PathRequest> > pending_;
+    /// Index of the next pending request to take. Accessed by the lanes during processing.
+    unsigned nextPending_;
+    /// Mutex for taking pending requests.
+    Mutex pendingMutex_;
+    /// Query lanes.
+    PODVector<PathQueryLane*> lanes_;
+    /// Next request ID.
+    unsigned nextId_;
+};
+
+static void ProcessPathRequests(PathQueryData* data, PathQueryLane* lane)
+{
+    dtNavMeshQuery* query = lane->query_;
+    FindPathData& pathData = lane->pathData_;
+
+    while (lane->iterations_ > 0)
+    {
+        if (!lane->current_)
+        {
+            {
+                MutexLock lock(data->pendingMutex_);
+                if (data->nextPending_ >= data->pending_.Size())
+                    return;
+                lane->current_ = data->pending_[data->nextPending_++];
+            }
+
+            PathRequest* request = lane->current_;
+            dtPolyRef startRef;
+            dtPolyRef endRef;
+            query->findNearestPoly(&request->start_.x_, &request->extents_.x_, request->filter_, &startRef, 0);
+            query->findNearestPoly(&request->end_.x_, &request->extents_.x_, request->filter_, &endRef, 0);
+
+            request->endRef_ = endRef;
+            if (!startRef || !endRef || dtStatusFailed(query->initSlicedFindPath(startRef, endRef, &request->start_.x_,
+                &request->end_.x_, request->filter_)))
+            {
+                lane->finished_.Push(lane->current_);
+                lane->current_.Reset();
+                continue;
+            }
+        }
+
+        int numIterations = 0;
+        dtStatus status = query->updateSlicedFindPath(lane->iterations_, &numIterations);
+        lane->iterations_ -= Max(numIterations, 1);
+        if (dtStatusInProgress(status))
+            continue;
+
+        PathRequest* request = lane->current_;
+        int numPolys = 0;
+        if (dtStatusSucceed(status))
+            query->finalizeSlicedFindPath(pathData.polys_, &numPolys, MAX_POLYS);
+
+        if (numPolys)
+        {
+            Vector3 actualEnd = request->end_;
+
+            // If full path was not found, clamp end point to the end polygon
+            if (pathData.polys_[numPolys - 1] != request->endRef_)
+                query->closestPointOnPoly(pathData.polys_[numPolys - 1], &request->end_.x_, &actualEnd.x_, 0);
+
+            int numPathPoints = 0;
+            query->findStraightPath(&request->start_.x_, &actualEnd.x_, pathData.polys_, numPolys,
+                &pathData.pathPoints_[0].x_, pathData.pathFlags_, pathData.pathPolys_, &numPathPoints, MAX_POLYS);
+            request->path_.Resize((unsigned)numPathPoints);
+            for (int i = 0; i < numPathPoints; ++i)
+                request->path_[i] = pathData.pathPoints_[i];
+        }
+
+        lane->finished_.Push(lane->current_);
+        lane->current_.Reset();
+    }
+}
+
+static void ProcessPathRequestsWork(const WorkItem* item, unsigned threadIndex)
+{
+    ProcessPathRequests(reinterpret_cast<PathQueryData*>(item->start_), reinterpret_cast<PathQueryLane*>(item->aux_));
+}
+
+void BuildNavigationTileWork(const WorkItem* item, unsigned threadIndex)
+{
+    const NavigationMesh* navMesh = reinterpret_cast<NavigationMesh*>(item->start_);
+    NavBuildData* build = reinterpret_cast<NavBuildData*>(item->aux_);
+
+    navMesh->BuildTileData(build);
+}
+
 NavigationMesh::NavigationMesh(Context* context) :
     Component(context),
     navMesh_(0),
@@ -121,7 +309,10 @@ NavigationMesh::NavigationMesh(Context* context) :
     partitionType_(NAVMESH_PARTITION_WATERSHED),
     keepInterResults_(false),
     drawOffMeshConnections_(false),
-    drawNavAreas_(false)
+    drawNavAreas_(false),
+    pathQueryData_(0),
+    pathIterationsPerFrame_(DEFAULT_PATH_ITERATIONS_PER_FRAME),
+    streamingDistance_(DEFAULT_STREAMING_DISTANCE)
 {
 }
 
@@ -134,6 +325,9 @@ NavigationMesh::~NavigationMesh()
 
     delete pathData_;
     pathData_ = 0;
+
+    delete pathQueryData_;
+    pathQueryData_ = 0;
 }
 
 void NavigationMesh::RegisterObject(Context* context)
@@ -162,6 +356,9 @@ void NavigationMesh::RegisterObject(Context* context)
         NAVMESH_PARTITION_WATERSHED, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw OffMeshConnections", GetDrawOffMeshConnections, SetDrawOffMeshConnections, bool, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Draw NavAreas", GetDrawNavAreas, SetDrawNavAreas, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Path", GetStreamingPath, SetStreamingPath, String, String::EMPTY, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Streaming Distance", GetStreamingDistance, SetStreamingDistance, float, DEFAULT_STREAMING_DISTANCE,
+        AM_DEFAULT);
 }
 
 void NavigationMesh::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -403,16 +600,7 @@ bool NavigationMesh::Build()
         }
 
         // Build each tile
-        unsigned numTiles = 0;
-
-        for (int z = 0; z < numTilesZ_; ++z)
-        {
-            for (int x = 0; x < numTilesX_; ++x)
-            {
-                if (BuildTile(geometryList, x, z))
-                    ++numTiles;
-            }
-        }
+        unsigned numTiles = BuildTiles(geometryList, IntVector2::ZERO, IntVector2(numTilesX_ - 1, numTilesZ_ - 1));
 
         URHO3D_LOGDEBUG("Built navigation mesh with " + String(numTiles) + " tiles");
 
@@ -445,33 +633,100 @@ bool NavigationMesh::Build(const BoundingBox& boundingBox)
     if (!node_->GetWorldScale().Equals(Vector3::ONE))
         URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
 
-    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
+    Vector<NavigationGeometryInfo> geometryList;
+    CollectGeometries(geometryList);
 
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
+    unsigned numTiles = BuildTiles(geometryList, from, to);
+
+    URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
+    return true;
+}
+
+bool NavigationMesh::BuildAsync(const BoundingBox& boundingBox)
+{
+    URHO3D_PROFILE(StartAsyncNavigationMeshBuild);
+
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    Scene* scene = GetScene();
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (!scene || !queue)
+    {
+        URHO3D_LOGERROR("Navigation mesh must be in a scene and the work queue must exist for an asynchronous rebuild");
+        return false;
+    }
 
+    if (!node_->GetWorldScale().Equals(Vector3::ONE))
+        URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
+
+    // The geometry is collected now and copied to the build data of each tile, so the scene is free to change while
+    // the tiles are being built
     Vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
-    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    IntVector2 from, to;
+    GetTileRange(boundingBox, from, to);
 
     unsigned numTiles = 0;
-
-    for (int z = sz; z <= ez; ++z)
+    for (int z = from.y_; z <= to.y_; ++z)
     {
-        for (int x = sx; x <= ex; ++x)
+        for (int x = from.x_; x <= to.x_; ++x)
         {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
+            SharedPtr<NavBuildData> build = CreateTileBuildData();
+            PrepareTileBuild(build, geometryList, x, z);
+
+            // Use non-pooled low-priority items, as they are held across frames. Without worker threads the work queue
+            // completes them in the main thread a few milliseconds each frame
+            SharedPtr<WorkItem> item(new WorkItem());
+            item->workFunction_ = BuildNavigationTileWork;
+            item->start_ = this;
+            item->aux_ = build;
+            queue->AddWorkItem(item);
+
+            asyncBuildItems_.Push(item);
+            asyncBuildData_.Push(build);
+            ++numTiles;
         }
     }
 
-    URHO3D_LOGDEBUG("Rebuilt " + String(numTiles) + " tiles of the navigation mesh");
+    asyncBuildSizes_.Push(numTiles);
+    SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(NavigationMesh, HandleSceneUpdate));
     return true;
 }
 
+void NavigationMesh::CancelAsyncBuilds()
+{
+    if (asyncBuildItems_.Empty())
+        return;
+
+    // Items already taken by a worker thread can not be removed from the queue, so wait for them to finish
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (queue)
+    {
+        for (unsigned i = 0; i < asyncBuildItems_.Size(); ++i)
+        {
+            if (!queue->RemoveWorkItem(asyncBuildItems_[i]))
+            {
+                while (!asyncBuildItems_[i]->completed_)
+                    Time::Sleep(0);
+            }
+        }
+    }
+
+    asyncBuildItems_.Clear();
+    asyncBuildData_.Clear();
+    asyncBuildSizes_.Clear();
+}
+
 Vector3 NavigationMesh::FindNearestPoint(const Vector3& point, const Vector3& extents, const dtQueryFilter* filter,
     dtPolyRef* nearestRef)
 {
@@ -529,6 +784,260 @@ void NavigationMesh::FindPath(PODVector<Vector3>& dest, const Vector3& start, co
         dest.Push(navPathPoints[i].position_);
 }
 
+unsigned NavigationMesh::RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents,
+    const dtQueryFilter* filter)
+{
+    Scene* scene = GetScene();
+    if (!scene)
+    {
+        URHO3D_LOGERROR("Navigation mesh must be in a scene to queue path requests");
+        return 0;
+    }
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must be built to queue path requests");
+        return 0;
+    }
+
+    if (!pathQueryData_)
+        pathQueryData_ = new PathQueryData();
+
+    // Navigation data is in local space. Transform path points from world to local
+    Matrix3x4 inverse = node_->GetWorldTransform().Inverse();
+
+    SharedPtr<PathRequest> request(new PathRequest());
+    request->id_ = pathQueryData_->nextId_++;
+    // Zero is reserved for failure
+    if (!pathQueryData_->nextId_)
+        pathQueryData_->nextId_ = 1;
+    request->start_ = inverse * start;
+    request->end_ = inverse * end;
+    request->extents_ = extents;
+    request->filter_ = filter ? filter : queryFilter_;
+    request->endRef_ = 0;
+    pathQueryData_->pending_.Push(request);
+
+    SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(NavigationMesh, HandleSceneUpdate));
+    return request->id_;
+}
+
+void NavigationMesh::CancelPathRequest(unsigned id)
+{
+    if (!pathQueryData_)
+        return;
+
+    Vector<SharedPtr<PathRequest> >& pending = pathQueryData_->pending_;
+    for (unsigned i = 0; i < pending.Size(); ++i)
+    {
+        if (pending[i]->id_ == id)
+        {
+            pending.Erase(i);
+            return;
+        }
+    }
+
+    // The lane starts a new search the next time it is processed, so the search in progress can simply be dropped
+    PODVector<PathQueryLane*>& lanes = pathQueryData_->lanes_;
+    for (unsigned i = 0; i < lanes.Size(); ++i)
+    {
+        if (lanes[i]->current_ && lanes[i]->current_->id_ == id)
+        {
+            lanes[i]->current_.Reset();
+            return;
+        }
+    }
+}
+
+void NavigationMesh::SetPathIterationsPerFrame(unsigned iterations)
+{
+    pathIterationsPerFrame_ = Max(iterations, 1U);
+}
+
+bool NavigationMesh::AddTile(const PODVector<unsigned char>& tileData)
+{
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built or allocated before adding tiles");
+        return false;
+    }
+
+    MemoryBuffer buffer(tileData);
+    return ReadTiles(buffer, false);
+}
+
+void NavigationMesh::RemoveTile(const IntVector2& tile)
+{
+    if (!navMesh_ || tile.x_ < 0 || tile.y_ < 0 || tile.x_ >= numTilesX_ || tile.y_ >= numTilesZ_)
+        return;
+
+    streamedTiles_.Erase((unsigned)(tile.y_ * numTilesX_ + tile.x_));
+    if (RemoveTileData(tile.x_, tile.y_))
+        SendTileEvent(E_NAVIGATION_TILE_REMOVED, tile);
+}
+
+void NavigationMesh::RemoveAllTiles()
+{
+    if (!navMesh_)
+        return;
+
+    // Event handlers may remove the navigation mesh
+    WeakPtr<NavigationMesh> self(this);
+
+    for (int z = 0; z < numTilesZ_; ++z)
+    {
+        for (int x = 0; x < numTilesX_; ++x)
+        {
+            RemoveTile(IntVector2(x, z));
+            if (self.Expired() || !navMesh_)
+                return;
+        }
+    }
+}
+
+bool NavigationMesh::SaveTiles(const String& pathName) const
+{
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("No navigation mesh to save tiles from");
+        return false;
+    }
+
+    String path = AddTrailingSlash(pathName);
+    FileSystem* fileSystem = GetSubsystem<FileSystem>();
+    if (!fileSystem->DirExists(path) && !fileSystem->CreateDir(path))
+    {
+        URHO3D_LOGERROR("Could not create directory " + path);
+        return false;
+    }
+
+    unsigned numTiles = 0;
+    for (int z = 0; z < numTilesZ_; ++z)
+    {
+        for (int x = 0; x < numTilesX_; ++x)
+        {
+            VectorBuffer tileData;
+            WriteTile(tileData, x, z);
+            if (!tileData.GetSize())
+                continue;
+
+            String fileName = path + String(x) + "_" + String(z) + ".tile";
+            File file(context_, fileName, FILE_WRITE);
+            tileData.Seek(0);
+            if (!file.IsOpen() || !file.WriteFileID(TILE_FILE_ID) || !CompressStream(file, tileData))
+            {
+                URHO3D_LOGERROR("Could not write navigation mesh tile " + fileName);
+                return false;
+            }
+            ++numTiles;
+        }
+    }
+
+    URHO3D_LOGDEBUG("Saved " + String(numTiles) + " navigation mesh tiles to " + path);
+    return true;
+}
+
+void NavigationMesh::SetStreamingPath(const String& path)
+{
+    streamingPath_ = path.Empty() ? path : AddTrailingSlash(path);
+    MarkNetworkUpdate();
+}
+
+void NavigationMesh::SetStreamingDistance(float distance)
+{
+    streamingDistance_ = Max(distance, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void NavigationMesh::UpdateStreaming(const PODVector<Vector3>& points)
+{
+    if (!navMesh_ || !node_ || streamingPath_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateNavigationStreaming);
+
+    // Event handlers may remove the navigation mesh
+    WeakPtr<NavigationMesh> self(this);
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    // Stream out first, using one extra tile of hysteresis so that tiles at the edge do not get reloaded repeatedly
+    PODVector<unsigned> farTiles;
+    float unloadDistance = streamingDistance_ + tileEdgeLength;
+    for (HashSet<unsigned>::ConstIterator i = streamedTiles_.Begin(); i != streamedTiles_.End(); ++i)
+    {
+        IntVector2 tile((int)(*i % numTilesX_), (int)(*i / numTilesX_));
+        BoundingBox tileBox = GetTileBoundingBox(tile).Transformed(worldTransform);
+        bool isNear = false;
+        for (unsigned j = 0; j < points.Size() && !isNear; ++j)
+            isNear = GetDistanceToBox(tileBox, points[j]) <= unloadDistance;
+        if (!isNear)
+            farTiles.Push(*i);
+    }
+
+    for (unsigned i = 0; i < farTiles.Size(); ++i)
+    {
+        RemoveTile(IntVector2((int)(farTiles[i] % numTilesX_), (int)(farTiles[i] / numTilesX_)));
+        if (self.Expired() || !navMesh_)
+            return;
+    }
+
+    // Then stream in the missing tiles near each point. Only the tile files are read, so loading cost scales with the
+    // area around the points instead of the whole navigation mesh
+    ResourceCache* cache = GetSubsystem<ResourceCache>();
+    Vector3 extent(streamingDistance_, streamingDistance_, streamingDistance_);
+    for (unsigned i = 0; i < points.Size(); ++i)
+    {
+        IntVector2 from, to;
+        GetTileRange(BoundingBox(points[i] - extent, points[i] + extent), from, to);
+
+        for (int z = from.y_; z <= to.y_; ++z)
+        {
+            for (int x = from.x_; x <= to.x_; ++x)
+            {
+                IntVector2 tile(x, z);
+                unsigned key = (unsigned)(z * numTilesX_ + x);
+                if (streamedTiles_.Contains(key) || HasTile(tile))
+                    continue;
+                if (GetDistanceToBox(GetTileBoundingBox(tile).Transformed(worldTransform), points[i]) > streamingDistance_)
+                    continue;
+
+                // Remember also the tiles without a file so that they are not looked up again
+                streamedTiles_.Insert(key);
+                SharedPtr<File> file = cache->GetFile(streamingPath_ + String(x) + "_" + String(z) + ".tile", false);
+                if (!file)
+                    continue;
+
+                VectorBuffer tileData;
+                if (file->ReadFileID() != TILE_FILE_ID || !DecompressStream(tileData, *file))
+                {
+                    URHO3D_LOGERROR("Could not read navigation mesh tile " + file->GetName());
+                    continue;
+                }
+
+                tileData.Seek(0);
+                ReadTiles(tileData, false);
+                if (self.Expired() || !navMesh_)
+                    return;
+            }
+        }
+    }
+}
+
+unsigned NavigationMesh::GetNumPathRequests() const
+{
+    if (!pathQueryData_)
+        return 0;
+
+    unsigned numRequests = pathQueryData_->pending_.Size();
+    for (unsigned i = 0; i < pathQueryData_->lanes_.Size(); ++i)
+    {
+        if (pathQueryData_->lanes_[i]->current_)
+            ++numRequests;
+    }
+
+    return numRequests;
+}
+
 void NavigationMesh::FindPath(PODVector<NavigationPathPoint>& dest, const Vector3& start, const Vector3& end,
     const Vector3& extents, const dtQueryFilter* filter)
 {
@@ -744,6 +1253,45 @@ float NavigationMesh::GetAreaCost(unsigned areaID) const
     return 1.0f;
 }
 
+IntVector2 NavigationMesh::GetTileIndex(const Vector3& position) const
+{
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+    Vector3 localPosition = node_ ? node_->GetWorldTransform().Inverse() * position : position;
+    Vector3 offset = localPosition - boundingBox_.min_;
+    return IntVector2(Clamp((int)floorf(offset.x_ / tileEdgeLength), 0, Max(numTilesX_ - 1, 0)),
+        Clamp((int)floorf(offset.z_ / tileEdgeLength), 0, Max(numTilesZ_ - 1, 0)));
+}
+
+BoundingBox NavigationMesh::GetTileBoundingBox(const IntVector2& tile) const
+{
+    float tileEdgeLength = (float)tileSize_ * cellSize_;
+    return BoundingBox(Vector3(
+            boundingBox_.min_.x_ + tileEdgeLength * (float)tile.x_,
+            boundingBox_.min_.y_,
+            boundingBox_.min_.z_ + tileEdgeLength * (float)tile.y_
+        ),
+        Vector3(
+            boundingBox_.min_.x_ + tileEdgeLength * (float)(tile.x_ + 1),
+            boundingBox_.max_.y_,
+            boundingBox_.min_.z_ + tileEdgeLength * (float)(tile.y_ + 1)
+        ));
+}
+
+bool NavigationMesh::HasTile(const IntVector2& tile) const
+{
+    if (!navMesh_)
+        return false;
+    return navMesh_->getTileAt(tile.x_, tile.y_, 0) != 0;
+}
+
+PODVector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
+{
+    VectorBuffer ret;
+    if (navMesh_)
+        WriteTile(ret, tile.x_, tile.y_);
+    return ret.GetBuffer();
+}
+
 void NavigationMesh::SetNavigationDataAttr(const PODVector<unsigned char>& value)
 {
     ReleaseNavigationMesh();
@@ -778,34 +1326,9 @@ void NavigationMesh::SetNavigationDataAttr(const PODVector<unsigned char>& value
         return;
     }
 
-    unsigned numTiles = 0;
-
-    while (!buffer.IsEof())
-    {
-        /*int x =*/ buffer.ReadInt();
-        /*int z =*/ buffer.ReadInt();
-        /*dtTileRef tileRef =*/ buffer.ReadUInt();
-        unsigned navDataSize = buffer.ReadUInt();
-
-        unsigned char* navData = (unsigned char*)dtAlloc(navDataSize, DT_ALLOC_PERM);
-        if (!navData)
-        {
-            URHO3D_LOGERROR("Could not allocate data for navigation mesh tile");
-            return;
-        }
-
-        buffer.Read(navData, navDataSize);
-        if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, 0)))
-        {
-            URHO3D_LOGERROR("Failed to add navigation mesh tile");
-            dtFree(navData);
-            return;
-        }
-        else
-            ++numTiles;
-    }
-
-    URHO3D_LOGDEBUG("Created navigation mesh with " + String(numTiles) + " tiles from serialized data");
+    // When streaming, the tiles are loaded separately by UpdateStreaming()
+    if (ReadTiles(buffer, true))
+        URHO3D_LOGDEBUG("Created navigation mesh from serialized data");
 }
 
 PODVector<unsigned char> NavigationMesh::GetNavigationDataAttr() const
@@ -824,21 +1347,13 @@ PODVector<unsigned char> NavigationMesh::GetNavigationDataAttr() const
         ret.WriteInt(params->maxTiles);
         ret.WriteInt(params->maxPolys);
 
-        const dtNavMesh* navMesh = navMesh_;
-
-        for (int z = 0; z < numTilesZ_; ++z)
+        // When streaming, the tiles are stored in separate files written by SaveTiles()
+        if (streamingPath_.Empty())
         {
-            for (int x = 0; x < numTilesX_; ++x)
+            for (int z = 0; z < numTilesZ_; ++z)
             {
-                const dtMeshTile* tile = navMesh->getTileAt(x, z, 0);
-                if (!tile)
-                    continue;
-
-                ret.WriteInt(x);
-                ret.WriteInt(z);
-                ret.WriteUInt(navMesh->getTileRef(tile));
-                ret.WriteUInt((unsigned)tile->dataSize);
-                ret.Write(tile->data, (unsigned)tile->dataSize);
+                for (int x = 0; x < numTilesX_; ++x)
+                    WriteTile(ret, x, z);
             }
         }
     }
@@ -846,6 +1361,64 @@ PODVector<unsigned char> NavigationMesh::GetNavigationDataAttr() const
     return ret.GetBuffer();
 }
 
+void NavigationMesh::WriteTile(Serializer& dest, int x, int z) const
+{
+    const dtNavMesh* navMesh = navMesh_;
+    const dtMeshTile* tile = navMesh->getTileAt(x, z, 0);
+    if (!tile)
+        return;
+
+    dest.WriteInt(x);
+    dest.WriteInt(z);
+    dest.WriteUInt(navMesh->getTileRef(tile));
+    dest.WriteUInt((unsigned)tile->dataSize);
+    dest.Write(tile->data, (unsigned)tile->dataSize);
+}
+
+bool NavigationMesh::ReadTiles(Deserializer& source, bool silent)
+{
+    while (!source.IsEof())
+    {
+        int x = source.ReadInt();
+        int z = source.ReadInt();
+        /*dtTileRef tileRef =*/ source.ReadUInt();
+        unsigned navDataSize = source.ReadUInt();
+
+        unsigned char* navData = (unsigned char*)dtAlloc(navDataSize, DT_ALLOC_PERM);
+        if (!navData)
+        {
+            URHO3D_LOGERROR("Could not allocate data for navigation mesh tile");
+            return false;
+        }
+
+        source.Read(navData, navDataSize);
+
+        // Remove previous tile (if any)
+        RemoveTileData(x, z);
+        if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, 0)))
+        {
+            URHO3D_LOGERROR("Failed to add navigation mesh tile");
+            dtFree(navData);
+            return false;
+        }
+
+        if (!silent)
+            SendTileEvent(E_NAVIGATION_TILE_ADDED, IntVector2(x, z));
+    }
+
+    return true;
+}
+
+bool NavigationMesh::RemoveTileData(int x, int z)
+{
+    dtTileRef tileRef = navMesh_->getTileRefAt(x, z, 0);
+    if (!tileRef)
+        return false;
+
+    navMesh_->removeTile(tileRef, 0, 0);
+    return true;
+}
+
 void NavigationMesh::CollectGeometries(Vector<NavigationGeometryInfo>& geometryList)
 {
     URHO3D_PROFILE(CollectNavigationGeometry);
@@ -1150,25 +1723,91 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 {
     URHO3D_PROFILE(BuildNavigationMeshTile);
 
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), 0, 0);
+    SharedPtr<NavBuildData> build = CreateTileBuildData();
+    PrepareTileBuild(build, geometryList, x, z);
+    bool success = BuildTileData(build);
+    // The previous tile is removed even if building failed
+    return AddTileData(build) || success;
+}
+
+unsigned NavigationMesh::BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
+{
+    URHO3D_PROFILE(BuildNavigationMeshTiles);
+
+    // Collect geometry in the main thread, run Recast for a batch of tiles in all threads, then add the finished tiles to
+    // the navigation mesh in the main thread. The batch size bounds the amount of geometry held in memory at once
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned batchSize = queue ? (queue->GetNumThreads() + 1) * TILE_BATCH_SIZE_PER_THREAD : 1;
+    int width = to.x_ - from.x_ + 1;
+    int numTotal = width * (to.y_ - from.y_ + 1);
+    unsigned numTiles = 0;
+
+    Vector<SharedPtr<NavBuildData> > builds;
+    for (int start = 0; start < numTotal; start += batchSize)
+    {
+        int end = Min(start + (int)batchSize, numTotal);
+        builds.Clear();
+
+        for (int i = start; i < end; ++i)
+        {
+            SharedPtr<NavBuildData> build = CreateTileBuildData();
+            PrepareTileBuild(build, geometryList, from.x_ + i % width, from.y_ + i / width);
+            builds.Push(build);
+
+            if (queue)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildNavigationTileWork;
+                item->start_ = this;
+                item->aux_ = build;
+                queue->AddWorkItem(item);
+            }
+            else
+                BuildTileData(build);
+        }
+
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < builds.Size(); ++i)
+        {
+            if (AddTileData(builds[i]))
+                ++numTiles;
+        }
+    }
+
+    return numTiles;
+}
+
+void NavigationMesh::GetTileRange(const BoundingBox& boundingBox, IntVector2& from, IntVector2& to) const
+{
+    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
 
     float tileEdgeLength = (float)tileSize_ * cellSize_;
 
-    BoundingBox tileBoundingBox(Vector3(
-            boundingBox_.min_.x_ + tileEdgeLength * (float)x,
-            boundingBox_.min_.y_,
-            boundingBox_.min_.z_ + tileEdgeLength * (float)z
-        ),
-        Vector3(
-            boundingBox_.min_.x_ + tileEdgeLength * (float)(x + 1),
-            boundingBox_.max_.y_,
-            boundingBox_.min_.z_ + tileEdgeLength * (float)(z + 1)
-        ));
+    from.x_ = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    from.y_ = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    to.x_ = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    to.y_ = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+}
 
-    SimpleNavBuildData build;
+SharedPtr<NavBuildData> NavigationMesh::CreateTileBuildData()
+{
+    return SharedPtr<NavBuildData>(new SimpleNavBuildData());
+}
 
-    rcConfig cfg;
+void NavigationMesh::PrepareTileBuild(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, int x, int z)
+{
+    build->tileX_ = x;
+    build->tileZ_ = z;
+    build->agentHeight_ = agentHeight_;
+    build->agentRadius_ = agentRadius_;
+    build->agentMaxClimb_ = agentMaxClimb_;
+    build->watershedPartition_ = partitionType_ == NAVMESH_PARTITION_WATERSHED;
+    build->tileBoundingBox_ = GetTileBoundingBox(IntVector2(x, z));
+
+    rcConfig& cfg = *build->config_;
     memset(&cfg, 0, sizeof cfg);
     cfg.cs = cellSize_;
     cfg.ch = cellHeight_;
@@ -1188,77 +1827,84 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     cfg.detailSampleDist = detailSampleDistance_ < 0.9f ? 0.0f : cellSize_ * detailSampleDistance_;
     cfg.detailSampleMaxError = cellHeight_ * detailSampleMaxError_;
 
-    rcVcopy(cfg.bmin, &tileBoundingBox.min_.x_);
-    rcVcopy(cfg.bmax, &tileBoundingBox.max_.x_);
+    rcVcopy(cfg.bmin, &build->tileBoundingBox_.min_.x_);
+    rcVcopy(cfg.bmax, &build->tileBoundingBox_.max_.x_);
     cfg.bmin[0] -= cfg.borderSize * cfg.cs;
     cfg.bmin[2] -= cfg.borderSize * cfg.cs;
     cfg.bmax[0] += cfg.borderSize * cfg.cs;
     cfg.bmax[2] += cfg.borderSize * cfg.cs;
 
     BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
+    GetTileGeometry(build, geometryList, expandedBox);
+}
 
-    if (build.vertices_.Empty() || build.indices_.Empty())
+bool NavigationMesh::BuildTileData(NavBuildData* buildData) const
+{
+    SimpleNavBuildData* build = static_cast<SimpleNavBuildData*>(buildData);
+
+    if (build->vertices_.Empty() || build->indices_.Empty())
         return true; // Nothing to do
 
-    build.heightField_ = rcAllocHeightfield();
-    if (!build.heightField_)
+    const rcConfig& cfg = *build->config_;
+
+    build->heightField_ = rcAllocHeightfield();
+    if (!build->heightField_)
     {
         URHO3D_LOGERROR("Could not allocate heightfield");
         return false;
     }
 
-    if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
+    if (!rcCreateHeightfield(build->ctx_, *build->heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
         cfg.ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
         return false;
     }
 
-    unsigned numTriangles = build.indices_.Size() / 3;
+    unsigned numTriangles = build->indices_.Size() / 3;
     SharedArrayPtr<unsigned char> triAreas(new unsigned char[numTriangles]);
     memset(triAreas.Get(), 0, numTriangles);
 
-    rcMarkWalkableTriangles(build.ctx_, cfg.walkableSlopeAngle, &build.vertices_[0].x_, build.vertices_.Size(),
-        &build.indices_[0], numTriangles, triAreas.Get());
-    rcRasterizeTriangles(build.ctx_, &build.vertices_[0].x_, build.vertices_.Size(), &build.indices_[0],
-        triAreas.Get(), numTriangles, *build.heightField_, cfg.walkableClimb);
-    rcFilterLowHangingWalkableObstacles(build.ctx_, cfg.walkableClimb, *build.heightField_);
+    rcMarkWalkableTriangles(build->ctx_, cfg.walkableSlopeAngle, &build->vertices_[0].x_, build->vertices_.Size(),
+        &build->indices_[0], numTriangles, triAreas.Get());
+    rcRasterizeTriangles(build->ctx_, &build->vertices_[0].x_, build->vertices_.Size(), &build->indices_[0],
+        triAreas.Get(), numTriangles, *build->heightField_, cfg.walkableClimb);
+    rcFilterLowHangingWalkableObstacles(build->ctx_, cfg.walkableClimb, *build->heightField_);
 
-    rcFilterWalkableLowHeightSpans(build.ctx_, cfg.walkableHeight, *build.heightField_);
-    rcFilterLedgeSpans(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_);
+    rcFilterWalkableLowHeightSpans(build->ctx_, cfg.walkableHeight, *build->heightField_);
+    rcFilterLedgeSpans(build->ctx_, cfg.walkableHeight, cfg.walkableClimb, *build->heightField_);
 
-    build.compactHeightField_ = rcAllocCompactHeightfield();
-    if (!build.compactHeightField_)
+    build->compactHeightField_ = rcAllocCompactHeightfield();
+    if (!build->compactHeightField_)
     {
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
         return false;
     }
-    if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
-        *build.compactHeightField_))
+    if (!rcBuildCompactHeightfield(build->ctx_, cfg.walkableHeight, cfg.walkableClimb, *build->heightField_,
+        *build->compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
         return false;
     }
-    if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
+    if (!rcErodeWalkableArea(build->ctx_, cfg.walkableRadius, *build->compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
         return false;
     }
 
     // Mark area volumes
-    for (unsigned i = 0; i < build.navAreas_.Size(); ++i)
-        rcMarkBoxArea(build.ctx_, &build.navAreas_[i].bounds_.min_.x_, &build.navAreas_[i].bounds_.max_.x_,
-            build.navAreas_[i].areaID_, *build.compactHeightField_);
+    for (unsigned i = 0; i < build->navAreas_.Size(); ++i)
+        rcMarkBoxArea(build->ctx_, &build->navAreas_[i].bounds_.min_.x_, &build->navAreas_[i].bounds_.max_.x_,
+            build->navAreas_[i].areaID_, *build->compactHeightField_);
 
-    if (this->partitionType_ == NAVMESH_PARTITION_WATERSHED)
+    if (build->watershedPartition_)
     {
-        if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
+        if (!rcBuildDistanceField(build->ctx_, *build->compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
             return false;
         }
-        if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
+        if (!rcBuildRegions(build->ctx_, *build->compactHeightField_, cfg.borderSize, cfg.minRegionArea,
             cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
@@ -1267,46 +1913,46 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
     }
     else
     {
-        if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
+        if (!rcBuildRegionsMonotone(build->ctx_, *build->compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
             return false;
         }
     }
 
-    build.contourSet_ = rcAllocContourSet();
-    if (!build.contourSet_)
+    build->contourSet_ = rcAllocContourSet();
+    if (!build->contourSet_)
     {
         URHO3D_LOGERROR("Could not allocate contour set");
         return false;
     }
-    if (!rcBuildContours(build.ctx_, *build.compactHeightField_, cfg.maxSimplificationError, cfg.maxEdgeLen,
-        *build.contourSet_))
+    if (!rcBuildContours(build->ctx_, *build->compactHeightField_, cfg.maxSimplificationError, cfg.maxEdgeLen,
+        *build->contourSet_))
     {
         URHO3D_LOGERROR("Could not create contours");
         return false;
     }
 
-    build.polyMesh_ = rcAllocPolyMesh();
-    if (!build.polyMesh_)
+    build->polyMesh_ = rcAllocPolyMesh();
+    if (!build->polyMesh_)
     {
         URHO3D_LOGERROR("Could not allocate poly mesh");
         return false;
     }
-    if (!rcBuildPolyMesh(build.ctx_, *build.contourSet_, cfg.maxVertsPerPoly, *build.polyMesh_))
+    if (!rcBuildPolyMesh(build->ctx_, *build->contourSet_, cfg.maxVertsPerPoly, *build->polyMesh_))
     {
         URHO3D_LOGERROR("Could not triangulate contours");
         return false;
     }
 
-    build.polyMeshDetail_ = rcAllocPolyMeshDetail();
-    if (!build.polyMeshDetail_)
+    build->polyMeshDetail_ = rcAllocPolyMeshDetail();
+    if (!build->polyMeshDetail_)
     {
         URHO3D_LOGERROR("Could not allocate detail mesh");
         return false;
     }
-    if (!rcBuildPolyMeshDetail(build.ctx_, *build.polyMesh_, *build.compactHeightField_, cfg.detailSampleDist,
-        cfg.detailSampleMaxError, *build.polyMeshDetail_))
+    if (!rcBuildPolyMeshDetail(build->ctx_, *build->polyMesh_, *build->compactHeightField_, cfg.detailSampleDist,
+        cfg.detailSampleMaxError, *build->polyMeshDetail_))
     {
         URHO3D_LOGERROR("Could not build detail mesh");
         return false;
@@ -1314,75 +1960,269 @@ bool NavigationMesh::BuildTile(Vector<NavigationGeometryInfo>& geometryList, int
 
     // Set polygon flags
     /// \todo Assignment of flags from navigation areas?
-    for (int i = 0; i < build.polyMesh_->npolys; ++i)
+    for (int i = 0; i < build->polyMesh_->npolys; ++i)
     {
-        if (build.polyMesh_->areas[i] != RC_NULL_AREA)
-            build.polyMesh_->flags[i] = 0x1;
+        if (build->polyMesh_->areas[i] != RC_NULL_AREA)
+            build->polyMesh_->flags[i] = 0x1;
     }
 
-    unsigned char* navData = 0;
-    int navDataSize = 0;
-
     dtNavMeshCreateParams params;
     memset(&params, 0, sizeof params);
-    params.verts = build.polyMesh_->verts;
-    params.vertCount = build.polyMesh_->nverts;
-    params.polys = build.polyMesh_->polys;
-    params.polyAreas = build.polyMesh_->areas;
-    params.polyFlags = build.polyMesh_->flags;
-    params.polyCount = build.polyMesh_->npolys;
-    params.nvp = build.polyMesh_->nvp;
-    params.detailMeshes = build.polyMeshDetail_->meshes;
-    params.detailVerts = build.polyMeshDetail_->verts;
-    params.detailVertsCount = build.polyMeshDetail_->nverts;
-    params.detailTris = build.polyMeshDetail_->tris;
-    params.detailTriCount = build.polyMeshDetail_->ntris;
-    params.walkableHeight = agentHeight_;
-    params.walkableRadius = agentRadius_;
-    params.walkableClimb = agentMaxClimb_;
-    params.tileX = x;
-    params.tileY = z;
-    rcVcopy(params.bmin, build.polyMesh_->bmin);
-    rcVcopy(params.bmax, build.polyMesh_->bmax);
+    params.verts = build->polyMesh_->verts;
+    params.vertCount = build->polyMesh_->nverts;
+    params.polys = build->polyMesh_->polys;
+    params.polyAreas = build->polyMesh_->areas;
+    params.polyFlags = build->polyMesh_->flags;
+    params.polyCount = build->polyMesh_->npolys;
+    params.nvp = build->polyMesh_->nvp;
+    params.detailMeshes = build->polyMeshDetail_->meshes;
+    params.detailVerts = build->polyMeshDetail_->verts;
+    params.detailVertsCount = build->polyMeshDetail_->nverts;
+    params.detailTris = build->polyMeshDetail_->tris;
+    params.detailTriCount = build->polyMeshDetail_->ntris;
+    params.walkableHeight = build->agentHeight_;
+    params.walkableRadius = build->agentRadius_;
+    params.walkableClimb = build->agentMaxClimb_;
+    params.tileX = build->tileX_;
+    params.tileY = build->tileZ_;
+    rcVcopy(params.bmin, build->polyMesh_->bmin);
+    rcVcopy(params.bmax, build->polyMesh_->bmax);
     params.cs = cfg.cs;
     params.ch = cfg.ch;
     params.buildBvTree = true;
 
     // Add off-mesh connections if have them
-    if (build.offMeshRadii_.Size())
+    if (build->offMeshRadii_.Size())
     {
-        params.offMeshConCount = build.offMeshRadii_.Size();
-        params.offMeshConVerts = &build.offMeshVertices_[0].x_;
-        params.offMeshConRad = &build.offMeshRadii_[0];
-        params.offMeshConFlags = &build.offMeshFlags_[0];
-        params.offMeshConAreas = &build.offMeshAreas_[0];
-        params.offMeshConDir = &build.offMeshDir_[0];
+        params.offMeshConCount = build->offMeshRadii_.Size();
+        params.offMeshConVerts = &build->offMeshVertices_[0].x_;
+        params.offMeshConRad = &build->offMeshRadii_[0];
+        params.offMeshConFlags = &build->offMeshFlags_[0];
+        params.offMeshConAreas = &build->offMeshAreas_[0];
+        params.offMeshConDir = &build->offMeshDir_[0];
     }
 
-    if (!dtCreateNavMeshData(&params, &navData, &navDataSize))
+    if (!dtCreateNavMeshData(&params, &build->navData_, &build->navDataSize_))
     {
         URHO3D_LOGERROR("Could not build navigation mesh tile data");
         return false;
     }
 
-    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, 0)))
+    return true;
+}
+
+bool NavigationMesh::AddTileData(NavBuildData* buildData)
+{
+    SimpleNavBuildData* build = static_cast<SimpleNavBuildData*>(buildData);
+
+    // Remove previous tile (if any)
+    RemoveTileData(build->tileX_, build->tileZ_);
+
+    if (!build->navData_)
+        return false;
+
+    if (dtStatusFailed(navMesh_->addTile(build->navData_, build->navDataSize_, DT_TILE_FREE_DATA, 0, 0)))
     {
         URHO3D_LOGERROR("Failed to add navigation mesh tile");
-        dtFree(navData);
         return false;
     }
 
+    // The navigation mesh owns the data now
+    build->navData_ = 0;
+    build->navDataSize_ = 0;
+
+    SendTileRebuiltEvents(build);
+    return true;
+}
+
+void NavigationMesh::SendTileRebuiltEvents(NavBuildData* build)
+{
     // Send a notification of the rebuild of this tile to anyone interested
     {
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
         eventData[P_MESH] = this;
-        eventData[P_BOUNDSMIN] = Variant(tileBoundingBox.min_);
-        eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
+        eventData[P_BOUNDSMIN] = Variant(build->tileBoundingBox_.min_);
+        eventData[P_BOUNDSMAX] = Variant(build->tileBoundingBox_.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
-    return true;
+    SendTileEvent(E_NAVIGATION_TILE_ADDED, IntVector2(build->tileX_, build->tileZ_));
+}
+
+void NavigationMesh::SendTileEvent(StringHash eventType, const IntVector2& tile)
+{
+    // The tile added and removed events share the same parameters
+    using namespace NavigationTileAdded;
+
+    VariantMap& eventData = GetContext()->GetEventDataMap();
+    eventData[P_NODE] = GetNode();
+    eventData[P_MESH] = this;
+    eventData[P_TILE] = tile;
+    SendEvent(eventType, eventData);
+}
+
+void NavigationMesh::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+{
+    // Event handlers may remove the navigation mesh
+    WeakPtr<NavigationMesh> self(this);
+
+    UpdateAsyncBuilds();
+    if (self.Expired())
+        return;
+
+    UpdatePathRequests();
+    if (self.Expired())
+        return;
+
+    if (asyncBuildItems_.Empty() && !GetNumPathRequests())
+        UnsubscribeFromEvent(E_SCENEUPDATE);
+}
+
+void NavigationMesh::UpdateAsyncBuilds()
+{
+    WeakPtr<NavigationMesh> self(this);
+
+    // Swap in each finished rebuild as a whole, so that the navigation mesh never contains a partial update. The rebuilds
+    // are applied in the order they were requested, so that a newer rebuild of the same tiles is never overwritten
+    while (asyncBuildSizes_.Size())
+    {
+        unsigned numTiles = asyncBuildSizes_[0];
+        for (unsigned i = 0; i < numTiles; ++i)
+        {
+            if (!asyncBuildItems_[i]->completed_)
+                return;
+        }
+
+        // Remove the rebuild from the pending lists first, as event handlers may start or cancel rebuilds
+        Vector<SharedPtr<NavBuildData> > finished(&asyncBuildData_[0], numTiles);
+        asyncBuildItems_.Erase(0, numTiles);
+        asyncBuildData_.Erase(0, numTiles);
+        asyncBuildSizes_.Erase(0);
+
+        URHO3D_PROFILE(SwapNavigationMeshTiles);
+
+        dtNavMesh* navMesh = navMesh_;
+        for (unsigned i = 0; i < finished.Size(); ++i)
+        {
+            AddTileData(finished[i]);
+            if (self.Expired() || navMesh_ != navMesh)
+                return;
+        }
+    }
+}
+
+void NavigationMesh::UpdatePathRequests()
+{
+    if (!pathQueryData_ || !node_ || !GetNumPathRequests())
+        return;
+
+    URHO3D_PROFILE(UpdatePathRequests);
+
+    PathQueryData& data = *pathQueryData_;
+
+    // If the navigation mesh was released after the requests were queued, fail them, so that every request gets a result.
+    // The lanes were released along with the navigation mesh, so all requests are pending
+    if (!navMesh_)
+    {
+        Vector<SharedPtr<PathRequest> > failed = data.pending_;
+        data.pending_.Clear();
+        for (unsigned i = 0; i < failed.Size(); ++i)
+            failed[i]->path_.Clear();
+        SendPathResults(failed);
+        return;
+    }
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+
+    // Create a query lane for each thread, including the main thread
+    if (data.lanes_.Empty())
+    {
+        unsigned numLanes = queue ? queue->GetNumThreads() + 1 : 1;
+        for (unsigned i = 0; i < numLanes; ++i)
+        {
+            PathQueryLane* lane = new PathQueryLane();
+            lane->query_ = dtAllocNavMeshQuery();
+            if (!lane->query_ || dtStatusFailed(lane->query_->init(navMesh_, MAX_POLYS)))
+            {
+                URHO3D_LOGERROR("Could not create navigation mesh query");
+                delete lane;
+                break;
+            }
+            data.lanes_.Push(lane);
+        }
+
+        if (data.lanes_.Empty())
+            return;
+    }
+
+    // Divide the iteration budget between the lanes, which take pending requests until they run out of iterations.
+    // A search left unfinished continues on the same lane next frame
+    int iterations = Max((int)(pathIterationsPerFrame_ / data.lanes_.Size()), 1);
+    data.nextPending_ = 0;
+
+    for (unsigned i = 0; i < data.lanes_.Size(); ++i)
+    {
+        PathQueryLane* lane = data.lanes_[i];
+        lane->iterations_ = iterations;
+
+        if (queue)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = ProcessPathRequestsWork;
+            item->start_ = &data;
+            item->aux_ = lane;
+            queue->AddWorkItem(item);
+        }
+        else
+            ProcessPathRequests(&data, lane);
+    }
+
+    if (queue)
+        queue->Complete(M_MAX_UNSIGNED);
+
+    data.pending_.Erase(0, data.nextPending_);
+    data.nextPending_ = 0;
+
+    // Collect the results before sending, as event handlers may queue or cancel requests
+    Vector<SharedPtr<PathRequest> > finished;
+    for (unsigned i = 0; i < data.lanes_.Size(); ++i)
+    {
+        finished.Push(data.lanes_[i]->finished_);
+        data.lanes_[i]->finished_.Clear();
+    }
+
+    SendPathResults(finished);
+}
+
+void NavigationMesh::SendPathResults(const Vector<SharedPtr<PathRequest> >& finished)
+{
+    WeakPtr<NavigationMesh> self(this);
+
+    for (unsigned i = 0; i < finished.Size(); ++i)
+    {
+        PathRequest* request = finished[i];
+
+        // Transform path result back to world space
+        const Matrix3x4& transform = node_->GetWorldTransform();
+        VariantVector path(request->path_.Size());
+        for (unsigned j = 0; j < request->path_.Size(); ++j)
+            path[j] = transform * request->path_[j];
+
+        using namespace NavigationPathResult;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_NODE] = node_;
+        eventData[P_MESH] = this;
+        eventData[P_REQUEST] = request->id_;
+        eventData[P_SUCCESS] = !path.Empty();
+        eventData[P_PATH] = path;
+        SendEvent(E_NAVIGATION_PATH_RESULT, eventData);
+
+        if (self.Expired() || !node_)
+            return;
+    }
 }
 
 bool NavigationMesh::InitializeQuery()
@@ -1411,6 +2251,12 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    // Tiles being built for the old navigation mesh would not fit the new one
+    CancelAsyncBuilds();
+    // Path searches in progress restart on new query objects once there is a navigation mesh again
+    if (pathQueryData_)
+        pathQueryData_->ReleaseLanes();
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = 0;
 
@@ -1420,6 +2266,7 @@ void NavigationMesh::ReleaseNavigationMesh()
     numTilesX_ = 0;
     numTilesZ_ = 0;
     boundingBox_.Clear();
+    streamedTiles_.Clear();
 }
 
 void NavigationMesh::SetPartitionType(NavmeshPartitionType ptype)
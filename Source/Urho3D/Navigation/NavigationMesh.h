@@ -47,11 +47,16 @@ enum NavmeshPartitionType
     NAVMESH_PARTITION_MONOTONE
 };
 
+class Deserializer;
 class Geometry;
 class NavArea;
+class Serializer;
 
 struct FindPathData;
 struct NavBuildData;
+struct PathQueryData;
+struct PathRequest;
+struct WorkItem;
 
 /// Description of a navigation mesh geometry component, with transform and bounds information.
 struct NavigationGeometryInfo
@@ -92,6 +97,7 @@ class URHO3D_API NavigationMesh : public Component
     URHO3D_OBJECT(NavigationMesh, Component);
 
     friend class CrowdManager;
+    friend void BuildNavigationTileWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -138,6 +144,30 @@ public:
     virtual bool Build();
     /// Rebuild part of the navigation mesh contained by the world-space bounding box. Return true if successful.
     virtual bool Build(const BoundingBox& boundingBox);
+    /// Rebuild part of the navigation mesh contained by the world-space bounding box in worker threads. The current tiles stay in use until all the replacement tiles are finished, after which they are swapped in together at the start of a scene update. Return true if the rebuild was started.
+    bool BuildAsync(const BoundingBox& boundingBox);
+    /// Cancel unfinished asynchronous rebuilds. Tiles already being processed by worker threads are waited for.
+    void CancelAsyncBuilds();
+    /// Queue a path request between world space points. The path is searched in worker threads over one or more frames and the result sent with the E_NAVIGATION_PATH_RESULT event. The filter, if given, must stay valid until then. Requests still queued when the navigation mesh is released fail. Return request ID, or 0 if failed.
+    unsigned RequestPath(const Vector3& start, const Vector3& end, const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = 0);
+    /// Cancel a queued path request. No result is sent for it.
+    void CancelPathRequest(unsigned id);
+    /// Set the total number of path search iterations per frame for queued path requests.
+    void SetPathIterationsPerFrame(unsigned iterations);
+    /// Add tiles from serialized data, replacing the existing tiles at the same indices. Return true if successful.
+    bool AddTile(const PODVector<unsigned char>& tileData);
+    /// Remove a tile from the navigation mesh.
+    void RemoveTile(const IntVector2& tile);
+    /// Remove all tiles from the navigation mesh, keeping its dimensions.
+    void RemoveAllTiles();
+    /// Save each tile into a separate compressed file in a directory, to be streamed in as resources. Return true if successful.
+    bool SaveTiles(const String& pathName) const;
+    /// Set the resource directory from which UpdateStreaming() loads the tiles saved with SaveTiles(). When set, the navigation data attribute stores only the dimensions of the navigation mesh and no tiles.
+    void SetStreamingPath(const String& path);
+    /// Set the distance from the points of interest within which tiles are streamed in. Tiles are streamed out once they are further than this plus one tile.
+    void SetStreamingDistance(float distance);
+    /// Stream in the tiles near any of the world space points of interest and stream out the previously streamed tiles far from all of them.
+    void UpdateStreaming(const PODVector<Vector3>& points);
     /// Find the nearest point on the navigation mesh to a given point. Extents specifies how far out from the specified point to check along each axis.
     Vector3 FindNearestPoint
         (const Vector3& point, const Vector3& extents = Vector3::ONE, const dtQueryFilter* filter = 0, dtPolyRef* nearestRef = 0);
@@ -231,6 +261,33 @@ public:
     /// Return number of tiles.
     IntVector2 GetNumTiles() const { return IntVector2(numTilesX_, numTilesZ_); }
 
+    /// Return index of the tile containing a world space position, clamped to the tile grid.
+    IntVector2 GetTileIndex(const Vector3& position) const;
+    /// Return local space bounding box of a tile.
+    BoundingBox GetTileBoundingBox(const IntVector2& tile) const;
+    /// Return whether the navigation mesh contains a tile.
+    virtual bool HasTile(const IntVector2& tile) const;
+    /// Return serialized data of a tile, or empty if the tile does not exist.
+    PODVector<unsigned char> GetTileData(const IntVector2& tile) const;
+
+    /// Return the resource directory tiles are streamed from.
+    const String& GetStreamingPath() const { return streamingPath_; }
+
+    /// Return the distance from the points of interest within which tiles are streamed in.
+    float GetStreamingDistance() const { return streamingDistance_; }
+
+    /// Return number of tiles currently streamed in.
+    unsigned GetNumStreamedTiles() const { return streamedTiles_.Size(); }
+
+    /// Return whether asynchronous rebuilds are in progress.
+    bool IsBuildingAsync() const { return !asyncBuildItems_.Empty(); }
+
+    /// Return the total number of path search iterations per frame for queued path requests.
+    unsigned GetPathIterationsPerFrame() const { return pathIterationsPerFrame_; }
+
+    /// Return number of queued path requests that have not finished yet.
+    unsigned GetNumPathRequests() const;
+
     /// Set the partition type used for polygon generation.
     void SetPartitionType(NavmeshPartitionType aType);
 
@@ -266,6 +323,36 @@ protected:
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
     /// Build one tile of the navigation mesh. Return true if successful.
     virtual bool BuildTile(Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Build the tiles within an inclusive tile index range, processing them in worker threads. Return number of tiles built.
+    unsigned BuildTiles(Vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Return the inclusive tile index range covered by a world-space bounding box.
+    void GetTileRange(const BoundingBox& boundingBox, IntVector2& from, IntVector2& to) const;
+    /// Allocate the build data for one tile.
+    virtual SharedPtr<NavBuildData> CreateTileBuildData();
+    /// Fill the build configuration and collect the input geometry of one tile. Must be called from the main thread.
+    void PrepareTileBuild(NavBuildData* build, Vector<NavigationGeometryInfo>& geometryList, int x, int z);
+    /// Run Recast on the collected geometry to create the Detour tile data. Safe to call from worker threads. Return true if successful.
+    virtual bool BuildTileData(NavBuildData* build) const;
+    /// Replace the tile in the navigation mesh with the built tile data and send the rebuild events. Return true if a tile was added.
+    virtual bool AddTileData(NavBuildData* build);
+    /// Send the rebuild notification events of a tile.
+    void SendTileRebuiltEvents(NavBuildData* build);
+    /// Send a tile added or removed notification event.
+    void SendTileEvent(StringHash eventType, const IntVector2& tile);
+    /// Write the data of a tile to a serializer. Writes nothing if the tile does not exist.
+    virtual void WriteTile(Serializer& dest, int x, int z) const;
+    /// Read tiles from a deserializer until its end, replacing the existing tiles at the same indices. Send tile added events unless silent. Return true if successful.
+    virtual bool ReadTiles(Deserializer& source, bool silent);
+    /// Remove the data of a tile from the navigation mesh without sending events. Return true if there was a tile.
+    virtual bool RemoveTileData(int x, int z);
+    /// Handle scene update event. Swap in the finished asynchronous rebuilds and advance the queued path requests.
+    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    /// Swap in the finished asynchronous rebuilds.
+    void UpdateAsyncBuilds();
+    /// Advance the queued path requests in all threads and send the results of the finished ones.
+    void UpdatePathRequests();
+    /// Send the results of finished path requests.
+    void SendPathResults(const Vector<SharedPtr<PathRequest> >& finished);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
@@ -325,6 +412,22 @@ protected:
     bool drawNavAreas_;
     /// NavAreas for this NavMesh
     Vector<WeakPtr<NavArea> > areas_;
+    /// Work items of the asynchronous rebuilds in progress, in the order requested.
+    Vector<SharedPtr<WorkItem> > asyncBuildItems_;
+    /// Build data of the asynchronous rebuilds in progress.
+    Vector<SharedPtr<NavBuildData> > asyncBuildData_;
+    /// Number of tiles in each asynchronous rebuild in progress.
+    PODVector<unsigned> asyncBuildSizes_;
+    /// Queued path requests and the per-thread query objects searching them.
+    PathQueryData* pathQueryData_;
+    /// Path search iterations per frame for queued path requests.
+    unsigned pathIterationsPerFrame_;
+    /// Resource directory to stream tiles from.
+    String streamingPath_;
+    /// Distance from the points of interest within which tiles are streamed in.
+    float streamingDistance_;
+    /// Indices of the tiles streamed in, including those without a tile file.
+    HashSet<unsigned> streamedTiles_;
 };
 
 /// Register Navigation library objects.
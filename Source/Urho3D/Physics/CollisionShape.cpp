@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../Graphics/CustomGeometry.h"
 #include "../Graphics/DebugRenderer.h"
@@ -32,7 +33,10 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/VectorBuffer.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
@@ -61,6 +65,13 @@ namespace Urho3D
 
 static const float DEFAULT_COLLISION_MARGIN = 0.04f;
 static const unsigned QUANTIZE_MAX_TRIANGLES = 1000000;
+static const unsigned TRIANGLE_INFO_SIZE = 5 * sizeof(int);
+static const char* SHAPE_CACHE_ID = "USHC";
+/// Cooked shape file version. Bump when the format or Bullet's in-place BVH layout changes.
+static const unsigned SHAPE_CACHE_VERSION = 2;
+
+/// StanHull uses global working data, so convex hulls can only be built one at a time.
+static Mutex hullMutex;
 
 static const btVector3 WHITE(1.0f, 1.0f, 1.0f);
 static const btVector3 GREEN(0.0f, 1.0f, 0.0f);
@@ -194,12 +205,16 @@ private:
     Vector<SharedArrayPtr<unsigned char> > dataArrays_;
 };
 
-TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel) :
+TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* source) :
     meshInterface_(0),
     shape_(0),
-    infoMap_(0)
+    infoMap_(0),
+    loadedBvh_(0)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
+    if (source && Load(*source))
+        return;
+
     shape_ = new btBvhTriangleMeshShape(meshInterface_, meshInterface_->useQuantize_, true);
 
     infoMap_ = new btTriangleInfoMap();
@@ -209,7 +224,8 @@ TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel) :
 TriangleMeshData::TriangleMeshData(CustomGeometry* custom) :
     meshInterface_(0),
     shape_(0),
-    infoMap_(0)
+    infoMap_(0),
+    loadedBvh_(0)
 {
     meshInterface_ = new TriangleMeshInterface(custom);
     shape_ = new btBvhTriangleMeshShape(meshInterface_, meshInterface_->useQuantize_, true);
@@ -228,10 +244,133 @@ TriangleMeshData::~TriangleMeshData()
 
     delete infoMap_;
     infoMap_ = 0;
+
+    // The shape does not own a BVH that was deserialized in place
+    if (loadedBvh_)
+    {
+        loadedBvh_->~btOptimizedBvh();
+        btAlignedFree(loadedBvh_);
+        loadedBvh_ = 0;
+    }
+}
+
+bool TriangleMeshData::Save(Serializer& dest) const
+{
+    btOptimizedBvh* bvh = shape_ ? shape_->getOptimizedBvh() : 0;
+    if (!bvh || !infoMap_)
+        return false;
+
+    dest.WriteBool(meshInterface_->useQuantize_);
+
+    // The BVH refers to triangles by submesh and index, so record the submesh sizes to check them on load
+    int numSubParts = meshInterface_->getNumSubParts();
+    dest.WriteInt(numSubParts);
+    for (int i = 0; i < numSubParts; ++i)
+    {
+        const btIndexedMesh& mesh = meshInterface_->getIndexedMeshArray()[i];
+        dest.WriteInt(mesh.m_numTriangles);
+        dest.WriteInt(mesh.m_numVertices);
+    }
+
+    // The info map does not expose its keys, so look up every triangle with the key used by btGenerateInternalEdgeInfo
+    dest.WriteUInt((unsigned)infoMap_->size());
+    int numInfos = 0;
+    for (int i = 0; i < meshInterface_->getNumSubParts(); ++i)
+    {
+        int numTriangles = meshInterface_->getIndexedMeshArray()[i].m_numTriangles;
+        for (int j = 0; j < numTriangles; ++j)
+        {
+            int key = (i << (31 - MAX_NUM_PARTS_IN_BITS)) | j;
+            const btTriangleInfo* info = infoMap_->find(key);
+            if (!info)
+                continue;
+
+            dest.WriteInt(key);
+            dest.WriteInt(info->m_flags);
+            dest.WriteFloat(info->m_edgeV0V1Angle);
+            dest.WriteFloat(info->m_edgeV1V2Angle);
+            dest.WriteFloat(info->m_edgeV2V0Angle);
+            ++numInfos;
+        }
+    }
+    if (numInfos != infoMap_->size())
+        return false;
+
+    unsigned bvhSize = bvh->calculateSerializeBufferSize();
+    void* bvhData = btAlignedAlloc(bvhSize, 16);
+    bool success = bvh->serializeInPlace(bvhData, bvhSize, false);
+    dest.WriteUInt(bvhSize);
+    success &= dest.Write(bvhData, bvhSize) == bvhSize;
+    btAlignedFree(bvhData);
+
+    return success;
+}
+
+bool TriangleMeshData::Load(Deserializer& source)
+{
+    // The BVH layout depends on whether quantization is used
+    if (source.ReadBool() != meshInterface_->useQuantize_)
+        return false;
+
+    // Reject data cooked from a different mesh, as its BVH could refer to triangles that do not exist in this one
+    int numSubParts = meshInterface_->getNumSubParts();
+    if (source.ReadInt() != numSubParts)
+        return false;
+    for (int i = 0; i < numSubParts; ++i)
+    {
+        const btIndexedMesh& mesh = meshInterface_->getIndexedMeshArray()[i];
+        if (source.ReadInt() != mesh.m_numTriangles || source.ReadInt() != mesh.m_numVertices)
+            return false;
+    }
+
+    unsigned numInfos = source.ReadUInt();
+    if (numInfos > (source.GetSize() - source.GetPosition()) / TRIANGLE_INFO_SIZE)
+        return false;
+
+    infoMap_ = new btTriangleInfoMap();
+    for (unsigned i = 0; i < numInfos; ++i)
+    {
+        int key = source.ReadInt();
+        btTriangleInfo info;
+        info.m_flags = source.ReadInt();
+        info.m_edgeV0V1Angle = source.ReadFloat();
+        info.m_edgeV1V2Angle = source.ReadFloat();
+        info.m_edgeV2V0Angle = source.ReadFloat();
+        infoMap_->insert(key, info);
+    }
+
+    unsigned bvhSize = source.ReadUInt();
+    void* bvhData = 0;
+    if (bvhSize && bvhSize <= source.GetSize() - source.GetPosition())
+    {
+        bvhData = btAlignedAlloc(bvhSize, 16);
+        if (source.Read(bvhData, bvhSize) == bvhSize)
+            loadedBvh_ = btOptimizedBvh::deSerializeInPlace(bvhData, bvhSize, false);
+    }
+
+    if (!loadedBvh_)
+    {
+        if (bvhData)
+            btAlignedFree(bvhData);
+        delete infoMap_;
+        infoMap_ = 0;
+        return false;
+    }
+
+    shape_ = new btBvhTriangleMeshShape(meshInterface_, meshInterface_->useQuantize_, false);
+    shape_->setOptimizedBvh(loadedBvh_);
+    shape_->setTriangleInfoMap(infoMap_);
+    return true;
 }
 
-ConvexData::ConvexData(Model* model, unsigned lodLevel)
+ConvexData::ConvexData(Model* model, unsigned lodLevel, Deserializer* source) :
+    vertexCount_(0),
+    indexCount_(0),
+    loaded_(false)
 {
+    if (source && Load(*source))
+        return;
+
     PODVector<Vector3> vertices;
     unsigned numGeometries = model->GetNumGeometries();
 
@@ -271,7 +410,10 @@ ConvexData::ConvexData(Model* model, unsigned lodLevel)
     BuildHull(vertices);
 }
 
-ConvexData::ConvexData(CustomGeometry* custom)
+ConvexData::ConvexData(CustomGeometry* custom) :
+    vertexCount_(0),
+    indexCount_(0),
+    loaded_(false)
 {
     const Vector<PODVector<CustomGeometryVertex> >& srcVertices = custom->GetVertices();
     PODVector<Vector3> vertices;
@@ -297,6 +439,7 @@ void ConvexData::BuildHull(const PODVector<Vector3>& vertices)
         desc.mVertexStride = 3 * sizeof(float);
         desc.mSkinWidth = 0.0f;
 
+        MutexLock lock(hullMutex);
         StanHull::HullLibrary lib;
         StanHull::HullResult result;
         lib.CreateConvexHull(desc, result);
@@ -324,6 +467,40 @@ ConvexData::~ConvexData()
 {
 }
 
+bool ConvexData::Save(Serializer& dest) const
+{
+    bool success = dest.WriteUInt(vertexCount_);
+    if (vertexCount_)
+        success &= dest.Write(vertexData_.Get(), vertexCount_ * sizeof(Vector3)) == vertexCount_ * sizeof(Vector3);
+    success &= dest.WriteUInt(indexCount_);
+    if (indexCount_)
+        success &= dest.Write(indexData_.Get(), indexCount_ * sizeof(unsigned)) == indexCount_ * sizeof(unsigned);
+    return success;
+}
+
+bool ConvexData::Load(Deserializer& source)
+{
+    unsigned vertexCount = source.ReadUInt();
+    if (!vertexCount || vertexCount > (source.GetSize() - source.GetPosition()) / sizeof(Vector3))
+        return false;
+    SharedArrayPtr<Vector3> vertexData(new Vector3[vertexCount]);
+    source.Read(vertexData.Get(), vertexCount * sizeof(Vector3));
+
+    unsigned indexCount = source.ReadUInt();
+    if (indexCount > (source.GetSize() - source.GetPosition()) / sizeof(unsigned))
+        return false;
+    SharedArrayPtr<unsigned> indexData(new unsigned[indexCount]);
+    if (indexCount)
+        source.Read(indexData.Get(), indexCount * sizeof(unsigned));
+
+    vertexData_ = vertexData;
+    vertexCount_ = vertexCount;
+    indexData_ = indexData;
+    indexCount_ = indexCount;
+    loaded_ = true;
+    return true;
+}
+
 HeightfieldData::HeightfieldData(Terrain* terrain, unsigned lodLevel) :
     heightData_(terrain->GetHeightData()),
     spacing_(terrain->GetSpacing()),
@@ -408,6 +585,121 @@ bool HasDynamicBuffers(Model* model, unsigned lodLevel)
     return false;
 }
 
+/// Return a hash of the vertex positions and indices of a model LOD level for naming cooked shape files, and the numbers of vertices and indices hashed.
+static unsigned GetGeometryHash(Model* model, unsigned lodLevel, unsigned& numVertices, unsigned& numIndices)
+{
+    unsigned hash = 0;
+    numVertices = 0;
+    numIndices = 0;
+    unsigned numGeometries = model->GetNumGeometries();
+
+    for (unsigned i = 0; i < numGeometries; ++i)
+    {
+        Geometry* geometry = model->GetGeometry(i, lodLevel);
+        if (!geometry)
+            continue;
+
+        const unsigned char* vertexData;
+        const unsigned char* indexData;
+        unsigned vertexSize;
+        unsigned indexSize;
+        unsigned elementMask;
+
+        geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elementMask);
+        if (!vertexData)
+            continue;
+
+        unsigned vertexStart = geometry->GetVertexStart();
+        unsigned vertexEnd = vertexStart + geometry->GetVertexCount();
+        numVertices += geometry->GetVertexCount();
+        for (unsigned j = vertexStart; j < vertexEnd; ++j)
+        {
+            const unsigned char* position = &vertexData[j * vertexSize];
+            for (unsigned k = 0; k < sizeof(Vector3); ++k)
+                hash = SDBMHash(hash, position[k]);
+        }
+
+        if (indexData)
+        {
+            numIndices += geometry->GetIndexCount();
+            const unsigned char* indexStart = &indexData[geometry->GetIndexStart() * indexSize];
+            const unsigned char* indexEnd = indexStart + geometry->GetIndexCount() * indexSize;
+            for (const unsigned char* j = indexStart; j < indexEnd; ++j)
+                hash = SDBMHash(hash, *j);
+        }
+    }
+
+    return hash;
+}
+
+SharedPtr<CollisionGeometryData> CreateCollisionGeometryData
+    (ShapeType shapeType, Model* model, unsigned lodLevel, const String& cachePath)
+{
+    if (shapeType != SHAPE_TRIANGLEMESH && shapeType != SHAPE_CONVEXHULL)
+        return SharedPtr<CollisionGeometryData>();
+
+    // Open the cooked shape file if it exists and was written by a compatible build. The file name hash may collide
+    // between models, so the file also records the vertex and index counts of the geometry it was cooked from
+    Context* context = model->GetContext();
+    SharedPtr<File> file;
+    String fileName;
+    unsigned numVertices = 0;
+    unsigned numIndices = 0;
+    if (!cachePath.Empty())
+    {
+        unsigned hash = GetGeometryHash(model, lodLevel, numVertices, numIndices);
+        fileName = AddTrailingSlash(cachePath) + ToStringHex(hash) + "_" + String(lodLevel) +
+            (shapeType == SHAPE_TRIANGLEMESH ? ".tri" : ".hull");
+        if (context->GetSubsystem<FileSystem>()->FileExists(fileName))
+        {
+            file = new File(context, fileName);
+            if (file->ReadFileID() != SHAPE_CACHE_ID || file->ReadUInt() != SHAPE_CACHE_VERSION ||
+                file->ReadUByte() != sizeof(void*) || file->ReadUInt() != numVertices || file->ReadUInt() != numIndices)
+                file.Reset();
+        }
+    }
+
+    SharedPtr<CollisionGeometryData> geometry;
+    bool loaded;
+    if (shapeType == SHAPE_TRIANGLEMESH)
+    {
+        TriangleMeshData* triMesh = new TriangleMeshData(model, lodLevel, file);
+        geometry = triMesh;
+        loaded = triMesh->loadedBvh_ != 0;
+    }
+    else
+    {
+        ConvexData* convex = new ConvexData(model, lodLevel, file);
+        geometry = convex;
+        loaded = convex->loaded_;
+    }
+
+    // Write the cooked data so that the next load can skip building
+    if (!fileName.Empty() && !loaded)
+    {
+        file.Reset();
+
+        VectorBuffer buffer;
+        buffer.WriteFileID(SHAPE_CACHE_ID);
+        buffer.WriteUInt(SHAPE_CACHE_VERSION);
+        buffer.WriteUByte((unsigned char)sizeof(void*));
+        buffer.WriteUInt(numVertices);
+        buffer.WriteUInt(numIndices);
+        bool saved = shapeType == SHAPE_TRIANGLEMESH ? static_cast<TriangleMeshData*>(geometry.Get())->Save(buffer) :
+            static_cast<ConvexData*>(geometry.Get())->Save(buffer);
+
+        if (saved)
+        {
+            context->GetSubsystem<FileSystem>()->CreateDir(cachePath);
+            File dest(context, fileName, FILE_WRITE);
+            if (!dest.IsOpen() || dest.Write(buffer.GetData(), buffer.GetSize()) != buffer.GetSize())
+                URHO3D_LOGWARNING("Could not write cooked collision shape " + fileName);
+        }
+    }
+
+    return geometry;
+}
+
 CollisionShape::CollisionShape(Context* context) :
     Component(context),
     shape_(0),
@@ -928,6 +1220,7 @@ void CollisionShape::OnNodeSet(Node* node)
 
         // Terrain collision shape depends on the terrain component's geometry updates. Subscribe to them
         SubscribeToEvent(node, E_TERRAINCREATED, URHO3D_HANDLER(CollisionShape, HandleTerrainCreated));
+        SubscribeToEvent(node, E_TERRAINHEIGHTSCHANGED, URHO3D_HANDLER(CollisionShape, HandleTerrainHeightsChanged));
     }
 }
 
@@ -1086,12 +1379,13 @@ void CollisionShape::UpdateShape()
                 HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >::Iterator j = cache.Find(id);
                 if (j != cache.End())
                     geometry_ = j->second_;
+                // Check if model has dynamic buffers, do not cache in that case
+                else if (HasDynamicBuffers(model_, lodLevel_))
+                    geometry_ = new TriangleMeshData(model_, lodLevel_);
                 else
                 {
-                    geometry_ = new TriangleMeshData(model_, lodLevel_);
-                    // Check if model has dynamic buffers, do not cache in that case
-                    if (!HasDynamicBuffers(model_, lodLevel_))
-                        cache[id] = geometry_;
+                    geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_, physicsWorld_->GetShapeCachePath());
+                    cache[id] = geometry_;
                 }
 
                 TriangleMeshData* triMesh = static_cast<TriangleMeshData*>(geometry_.Get());
@@ -1125,12 +1419,13 @@ void CollisionShape::UpdateShape()
                 HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >::Iterator j = cache.Find(id);
                 if (j != cache.End())
                     geometry_ = j->second_;
+                // Check if model has dynamic buffers, do not cache in that case
+                else if (HasDynamicBuffers(model_, lodLevel_))
+                    geometry_ = new ConvexData(model_, lodLevel_);
                 else
                 {
-                    geometry_ = new ConvexData(model_, lodLevel_);
-                    // Check if model has dynamic buffers, do not cache in that case
-                    if (!HasDynamicBuffers(model_, lodLevel_))
-                        cache[id] = geometry_;
+                    geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_, physicsWorld_->GetShapeCachePath());
+                    cache[id] = geometry_;
                 }
 
                 ConvexData* convex = static_cast<ConvexData*>(geometry_.Get());
@@ -1187,6 +1482,66 @@ void CollisionShape::HandleTerrainCreated(StringHash eventType, VariantMap& even
     }
 }
 
+void CollisionShape::HandleTerrainHeightsChanged(StringHash eventType, VariantMap& eventData)
+{
+    using namespace TerrainHeightsChanged;
+
+    if (shapeType_ != SHAPE_TERRAIN || !geometry_ || !node_)
+        return;
+
+    HeightfieldData* heightfield = static_cast<HeightfieldData*>(geometry_.Get());
+    Terrain* terrain = node_->GetComponent<Terrain>();
+    IntRect rect = eventData[P_RECT].GetIntRect();
+
+    // On LOD level 0 the heightfield uses the terrain's height data directly, so the shape only needs to be recreated if
+    // the height range grew
+    bool recreate = lodLevel_ > 0 || !terrain || terrain->GetHeightData() != heightfield->heightData_;
+    if (!recreate)
+    {
+        const float* data = heightfield->heightData_.Get();
+        const IntVector2& size = heightfield->size_;
+        rect.right_ = Min(rect.right_, size.x_);
+        rect.bottom_ = Min(rect.bottom_, size.y_);
+
+        for (int y = Max(rect.top_, 0); y < rect.bottom_ && !recreate; ++y)
+        {
+            const float* row = data + (size.y_ - 1 - y) * size.x_;
+            for (int x = Max(rect.left_, 0); x < rect.right_; ++x)
+            {
+                if (row[x] < heightfield->minHeight_ || row[x] > heightfield->maxHeight_)
+                {
+                    recreate = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (recreate)
+    {
+        UpdateShape();
+        NotifyRigidBody();
+        return;
+    }
+
+    // Wake up rigid bodies that may be resting on the changed area
+    if (physicsWorld_ && rect.left_ < rect.right_ && rect.top_ < rect.bottom_)
+    {
+        BoundingBox box;
+        box.Merge(terrain->HeightMapToWorld(IntVector2(rect.left_, rect.bottom_ - 1)));
+        box.Merge(terrain->HeightMapToWorld(IntVector2(rect.right_ - 1, rect.top_)));
+        /// \todo This assumes that the terrain scene node is upright
+        const Matrix3x4& transform = node_->GetWorldTransform();
+        box.min_.y_ = (transform * Vector3(0.0f, heightfield->minHeight_, 0.0f)).y_;
+        box.max_.y_ = (transform * Vector3(0.0f, heightfield->maxHeight_, 0.0f)).y_;
+
+        PODVector<RigidBody*> bodies;
+        physicsWorld_->GetRigidBodies(bodies, box);
+        for (unsigned i = 0; i < bodies.Size(); ++i)
+            bodies[i]->Activate();
+    }
+}
+
 void CollisionShape::HandleModelReloadFinished(StringHash eventType, VariantMap& eventData)
 {
     if (physicsWorld_)
@@ -30,6 +30,7 @@
 class btBvhTriangleMeshShape;
 class btCollisionShape;
 class btCompoundShape;
+class btOptimizedBvh;
 class btTriangleMesh;
 
 struct btTriangleInfoMap;
@@ -38,10 +39,12 @@ namespace Urho3D
 {
 
 class CustomGeometry;
+class Deserializer;
 class Geometry;
 class Model;
 class PhysicsWorld;
 class RigidBody;
+class Serializer;
 class Terrain;
 class TriangleMeshInterface;
 
@@ -67,26 +70,35 @@ struct CollisionGeometryData : public RefCounted
 /// Triangle mesh geometry data.
 struct TriangleMeshData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    TriangleMeshData(Model* model, unsigned lodLevel);
+    /// Construct from a model. If a source is given, read the cooked BVH and triangle info from it instead of building them. Building is used as a fallback if reading fails.
+    TriangleMeshData(Model* model, unsigned lodLevel, Deserializer* source = 0);
     /// Construct from a custom geometry.
     TriangleMeshData(CustomGeometry* custom);
     /// Destruct. Free geometry data.
     ~TriangleMeshData();
 
+    /// Write the cooked BVH and triangle info. Return true if successful.
+    bool Save(Serializer& dest) const;
+
     /// Bullet triangle mesh interface.
     TriangleMeshInterface* meshInterface_;
     /// Bullet triangle mesh collision shape.
     btBvhTriangleMeshShape* shape_;
     /// Bullet triangle info map.
     btTriangleInfoMap* infoMap_;
+    /// BVH deserialized in place into its own buffer. Null if the BVH was built and is owned by the shape.
+    btOptimizedBvh* loadedBvh_;
+
+private:
+    /// Read the cooked BVH and triangle info and create the shape. Return true if successful.
+    bool Load(Deserializer& source);
 };
 
 /// Convex hull geometry data.
 struct ConvexData : public CollisionGeometryData
 {
-    /// Construct from a model.
-    ConvexData(Model* model, unsigned lodLevel);
+    /// Construct from a model. If a source is given, read the cooked hull from it instead of building it. Building is used as a fallback if reading fails.
+    ConvexData(Model* model, unsigned lodLevel, Deserializer* source = 0);
     /// Construct from a custom geometry.
     ConvexData(CustomGeometry* custom);
     /// Destruct. Free geometry data.
@@ -94,6 +106,8 @@ struct ConvexData : public CollisionGeometryData
 
     /// Build the convex hull from vertices.
     void BuildHull(const PODVector<Vector3>& vertices);
+    /// Write the cooked hull. Return true if successful.
+    bool Save(Serializer& dest) const;
 
     /// Vertex data.
     SharedArrayPtr<Vector3> vertexData_;
@@ -103,6 +117,12 @@ struct ConvexData : public CollisionGeometryData
     SharedArrayPtr<unsigned> indexData_;
     /// Number of indices.
     unsigned indexCount_;
+    /// Whether the hull was read from cooked data.
+    bool loaded_;
+
+private:
+    /// Read the cooked hull. Return true if successful.
+    bool Load(Deserializer& source);
 };
 
 /// Heightfield geometry data.
@@ -125,6 +145,12 @@ struct HeightfieldData : public CollisionGeometryData
     float maxHeight_;
 };
 
+/// Create triangle mesh or convex hull geometry data from a model. If a cache path is given, cooked data is read from and written to files named by a hash of the model geometry and the LOD level. Safe to call from worker threads as long as the model is not accessed elsewhere at the same time.
+URHO3D_API SharedPtr<CollisionGeometryData> CreateCollisionGeometryData
+    (ShapeType shapeType, Model* model, unsigned lodLevel, const String& cachePath = String::EMPTY);
+/// Return whether a model LOD level has dynamic vertex or index buffers, in which case its collision geometry is not cached.
+URHO3D_API bool HasDynamicBuffers(Model* model, unsigned lodLevel);
+
 /// Physics collision shape component.
 class URHO3D_API CollisionShape : public Component
 {
@@ -252,6 +278,8 @@ private:
     void UpdateShape();
     /// Update terrain collision shape from the terrain component.
     void HandleTerrainCreated(StringHash eventType, VariantMap& eventData);
+    /// Update terrain collision shape after the terrain heights changed in a region.
+    void HandleTerrainHeightsChanged(StringHash eventType, VariantMap& eventData);
     /// Update trimesh or convex shape after a model has reloaded itself.
     void HandleModelReloadFinished(StringHash eventType, VariantMap& eventData);
 
@@ -76,6 +76,12 @@ URHO3D_EVENT(E_PHYSICSCOLLISIONEND, PhysicsCollisionEnd)
     URHO3D_PARAM(P_TRIGGER, Trigger);              // bool
 }
 
+/// Contact stream of the physics world has been updated after a simulation step. Read the colliding pairs and contact points from the physics world.
+URHO3D_EVENT(E_PHYSICSCONTACTS, PhysicsContacts)
+{
+    URHO3D_PARAM(P_WORLD, World);                  // PhysicsWorld pointer
+}
+
 /// Physics collision started (sent to the participating scene nodes.)
 URHO3D_EVENT(E_NODECOLLISIONSTART, NodeCollisionStart)
 {
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -35,9 +36,11 @@
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
 #include "../Physics/RigidBody.h"
+#include "../Physics/ThreadedDynamicsWorld.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 
+#include <Bullet/BulletCollision/BroadphaseCollision/btCollisionAlgorithm.h>
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
@@ -57,12 +60,53 @@ extern const char* SUBSYSTEM_CATEGORY;
 static const int MAX_SOLVER_ITERATIONS = 256;
 static const int DEFAULT_FPS = 60;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
+static const unsigned QUERIES_PER_BATCH_JOB = 32;
+
+static const char* activationRegionModeNames[] =
+{
+    "None",
+    "Freeze",
+    "Remove",
+    0
+};
 
 static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const PhysicsRaycastResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
 }
 
+static bool CompareContactPairs(const PhysicsContactPair& lhs, const PhysicsContactPair& rhs)
+{
+    return lhs.bodyA_ != rhs.bodyA_ ? lhs.bodyA_ < rhs.bodyA_ : lhs.bodyB_ < rhs.bodyB_;
+}
+
+static bool IsCollisionReported(RigidBody* bodyA, RigidBody* bodyB)
+{
+    // Skip collision event signaling if both objects are static, or if collision event mode does not match
+    if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
+        return false;
+    if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
+        !bodyA->IsActive() && !bodyB->IsActive())
+        return false;
+
+    return true;
+}
+
+static void AddEndedContactPair(PODVector<PhysicsContactPair>& pairs, const PhysicsContactPair& previous)
+{
+    if (!IsCollisionReported(previous.bodyA_, previous.bodyB_))
+        return;
+
+    PhysicsContactPair ended = previous;
+    ended.firstContact_ = 0;
+    ended.numContacts_ = 0;
+    ended.state_ = CONTACT_PAIR_END;
+    ended.trigger_ = previous.bodyA_->IsTrigger() || previous.bodyB_->IsTrigger();
+    pairs.Push(ended);
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -114,6 +158,314 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+/// Collision geometry to build for a model.
+struct CollisionGeometryBuild
+{
+    /// Shape type.
+    ShapeType shapeType_;
+    /// Model LOD level.
+    unsigned lodLevel_;
+    /// Resulting geometry data.
+    SharedPtr<CollisionGeometryData> geometry_;
+};
+
+/// Collision geometries to build for one model. A model is handled by one work item only, as the reference counts of its shared vertex and index data are not thread-safe.
+struct CollisionGeometryBuildWork
+{
+    /// Model.
+    Model* model_;
+    /// Geometries to build.
+    Vector<CollisionGeometryBuild> builds_;
+};
+
+void BuildCollisionGeometryWork(const WorkItem* item, unsigned threadIndex)
+{
+    CollisionGeometryBuildWork* work = reinterpret_cast<CollisionGeometryBuildWork*>(item->start_);
+    const String& cachePath = *reinterpret_cast<const String*>(item->aux_);
+
+    for (unsigned i = 0; i < work->builds_.Size(); ++i)
+    {
+        CollisionGeometryBuild& build = work->builds_[i];
+        build.geometry_ = CreateCollisionGeometryData(build.shapeType_, work->model_, build.lodLevel_, cachePath);
+    }
+}
+
+/// Broadphase tree traversal for one batched raycast or swept sphere query. Keeps its own traversal stack, so that queries can run concurrently.
+struct RaycastBatchCollider : public btDbvt::ICollide
+{
+    /// Construct.
+    RaycastBatchCollider(const PhysicsRaycastQuery& query) :
+        query_(query),
+        from_(btQuaternion::getIdentity(), ToBtVector3(query.ray_.origin_)),
+        to_(btQuaternion::getIdentity(), ToBtVector3(query.ray_.origin_ + query.maxDistance_ * query.ray_.direction_)),
+        rayCallback_(from_.getOrigin(), to_.getOrigin()),
+        convexCallback_(from_.getOrigin(), to_.getOrigin()),
+        sphereShape_(query.radius_),
+        inflate_(query.radius_, query.radius_, query.radius_)
+    {
+        rayCallback_.m_collisionFilterGroup = (short)0xffff;
+        rayCallback_.m_collisionFilterMask = (short)query.collisionMask_;
+        convexCallback_.m_collisionFilterGroup = (short)0xffff;
+        convexCallback_.m_collisionFilterMask = (short)query.collisionMask_;
+    }
+
+    /// Return whether to descend into a tree node. Nodes beyond the closest hit so far are skipped.
+    virtual bool Descent(const btDbvtNode* node)
+    {
+        float closestHitFraction = IsSweep() ? convexCallback_.m_closestHitFraction : rayCallback_.m_closestHitFraction;
+        BoundingBox bounds(ToVector3(node->volume.Mins()) - inflate_, ToVector3(node->volume.Maxs()) + inflate_);
+        return query_.ray_.HitDistance(bounds) <= query_.maxDistance_ * closestHitFraction;
+    }
+
+    /// Test against the collision object of a tree leaf.
+    virtual void Process(const btDbvtNode* leaf)
+    {
+        btBroadphaseProxy* proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+        btCollisionObject* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+
+        if (IsSweep())
+        {
+            if (convexCallback_.needsCollision(proxy))
+            {
+                btCollisionWorld::objectQuerySingle(&sphereShape_, from_, to_, object, object->getCollisionShape(),
+                    object->getWorldTransform(), convexCallback_, 0.0f);
+            }
+        }
+        else if (rayCallback_.needsCollision(proxy))
+        {
+            btCollisionWorld::rayTestSingle(from_, to_, object, object->getCollisionShape(), object->getWorldTransform(),
+                rayCallback_);
+        }
+    }
+
+    /// Fill the result with the closest hit.
+    void GetResult(PhysicsRaycastResult& result) const
+    {
+        if (IsSweep() && convexCallback_.hasHit())
+        {
+            result.body_ = static_cast<RigidBody*>(convexCallback_.m_hitCollisionObject->getUserPointer());
+            result.position_ = ToVector3(convexCallback_.m_hitPointWorld);
+            result.normal_ = ToVector3(convexCallback_.m_hitNormalWorld);
+            result.distance_ = convexCallback_.m_closestHitFraction * query_.maxDistance_;
+            result.hitFraction_ = convexCallback_.m_closestHitFraction;
+        }
+        else if (!IsSweep() && rayCallback_.hasHit())
+        {
+            result.body_ = static_cast<RigidBody*>(rayCallback_.m_collisionObject->getUserPointer());
+            result.position_ = ToVector3(rayCallback_.m_hitPointWorld);
+            result.normal_ = ToVector3(rayCallback_.m_hitNormalWorld);
+            result.distance_ = (result.position_ - query_.ray_.origin_).Length();
+            result.hitFraction_ = rayCallback_.m_closestHitFraction;
+        }
+        else
+        {
+            result.body_ = 0;
+            result.position_ = Vector3::ZERO;
+            result.normal_ = Vector3::ZERO;
+            result.distance_ = M_INFINITY;
+            result.hitFraction_ = 0.0f;
+        }
+    }
+
+    /// Return whether the query is a swept sphere.
+    bool IsSweep() const { return query_.radius_ > 0.0f; }
+
+    /// Query.
+    const PhysicsRaycastQuery& query_;
+    /// Start transform.
+    btTransform from_;
+    /// End transform.
+    btTransform to_;
+    /// Raycast result callback.
+    btCollisionWorld::ClosestRayResultCallback rayCallback_;
+    /// Swept sphere result callback.
+    btCollisionWorld::ClosestConvexResultCallback convexCallback_;
+    /// Swept sphere shape.
+    btSphereShape sphereShape_;
+    /// Amount to inflate the tree node bounds by for the swept sphere.
+    Vector3 inflate_;
+};
+
+/// Manifold result that only records whether a contact was found.
+struct OverlapManifoldResult : public btManifoldResult
+{
+    /// Construct.
+    OverlapManifoldResult(const btCollisionObjectWrapper* obj0Wrap, const btCollisionObjectWrapper* obj1Wrap) :
+        btManifoldResult(obj0Wrap, obj1Wrap),
+        overlap_(false)
+    {
+    }
+
+    /// Record a contact point.
+    virtual void addContactPoint(const btVector3&, const btVector3&, btScalar) { overlap_ = true; }
+
+    /// Contact found flag.
+    bool overlap_;
+};
+
+/// Broadphase tree traversal for one batched overlap query. Keeps its own traversal stack, so that queries can run concurrently.
+struct OverlapBatchCollider : public btDbvt::ICollide
+{
+    /// Construct.
+    OverlapBatchCollider(const btCollisionObject& queryObject, btCollisionWorld* world, PODVector<RigidBody*>& result,
+        unsigned collisionMask) :
+        queryObject_(queryObject),
+        world_(world),
+        result_(result),
+        collisionMask_(collisionMask)
+    {
+        btVector3 aabbMin, aabbMax;
+        queryObject.getCollisionShape()->getAabb(queryObject.getWorldTransform(), aabbMin, aabbMax);
+        bounds_ = btDbvtVolume::FromMM(aabbMin, aabbMax);
+    }
+
+    /// Return whether to descend into a tree node.
+    virtual bool Descent(const btDbvtNode* node) { return Intersect(node->volume, bounds_); }
+
+    /// Test against the collision object of a tree leaf.
+    virtual void Process(const btDbvtNode* leaf)
+    {
+        // Filter the same way as a contact test with the default filter group
+        btBroadphaseProxy* proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+        if (!(proxy->m_collisionFilterGroup & btBroadphaseProxy::AllFilter) ||
+            !(proxy->m_collisionFilterMask & btBroadphaseProxy::DefaultFilter))
+            return;
+
+        const btCollisionObject* object = static_cast<btCollisionObject*>(proxy->m_clientObject);
+        RigidBody* body = static_cast<RigidBody*>(object->getUserPointer());
+        if (!body || !(body->GetCollisionLayer() & collisionMask_))
+            return;
+
+        btCollisionObjectWrapper obj0Wrap(0, queryObject_.getCollisionShape(), &queryObject_, queryObject_.getWorldTransform(), -1, -1);
+        btCollisionObjectWrapper obj1Wrap(0, object->getCollisionShape(), object, object->getWorldTransform(), -1, -1);
+
+        btDispatcher* dispatcher = world_->getDispatcher();
+        btCollisionAlgorithm* algorithm = dispatcher->findAlgorithm(&obj0Wrap, &obj1Wrap);
+        if (algorithm)
+        {
+            OverlapManifoldResult manifoldResult(&obj0Wrap, &obj1Wrap);
+            algorithm->processCollision(&obj0Wrap, &obj1Wrap, world_->getDispatchInfo(), &manifoldResult);
+            algorithm->~btCollisionAlgorithm();
+            dispatcher->freeCollisionAlgorithm(algorithm);
+
+            if (manifoldResult.overlap_)
+                result_.Push(body);
+        }
+    }
+
+    /// Query collision object.
+    const btCollisionObject& queryObject_;
+    /// Physics world.
+    btCollisionWorld* world_;
+    /// Found rigid bodies.
+    PODVector<RigidBody*>& result_;
+    /// Collision mask for the query.
+    unsigned collisionMask_;
+    /// Query bounds.
+    btDbvtVolume bounds_;
+};
+
+/// Shared state of a batch of raycast and swept sphere queries.
+struct RaycastBatch
+{
+    /// Broadphase.
+    btDbvtBroadphase* broadphase_;
+    /// Queries.
+    const PhysicsRaycastQuery* queries_;
+    /// Results.
+    PhysicsRaycastResult* results_;
+};
+
+/// Shared state of a batch of overlap queries.
+struct OverlapBatch
+{
+    /// Broadphase.
+    btDbvtBroadphase* broadphase_;
+    /// Physics world.
+    btCollisionWorld* world_;
+    /// Queries.
+    const PhysicsOverlapQuery* queries_;
+    /// Results.
+    PODVector<RigidBody*>* results_;
+};
+
+static void ProcessRaycastQueries(const RaycastBatch& batch, unsigned begin, unsigned end)
+{
+    for (unsigned i = begin; i < end; ++i)
+    {
+        // Traverse the broadphase trees directly, as the broadphase's own raycast shares one stack between all callers
+        RaycastBatchCollider collider(batch.queries_[i]);
+        btDbvt::collideTU(batch.broadphase_->m_sets[0].m_root, collider);
+        btDbvt::collideTU(batch.broadphase_->m_sets[1].m_root, collider);
+        collider.GetResult(batch.results_[i]);
+    }
+}
+
+static void ProcessOverlapQueries(const OverlapBatch& batch, unsigned begin, unsigned end)
+{
+    for (unsigned i = begin; i < end; ++i)
+    {
+        const PhysicsOverlapQuery& query = batch.queries_[i];
+        PODVector<RigidBody*>& result = batch.results_[i];
+        result.Clear();
+
+        btSphereShape sphereShape(query.sphere_.radius_);
+        btBoxShape boxShape(ToBtVector3(query.box_.HalfSize()));
+        btCollisionObject queryObject;
+        if (query.sphere_.Defined())
+        {
+            queryObject.setCollisionShape(&sphereShape);
+            queryObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), ToBtVector3(query.sphere_.center_)));
+        }
+        else if (query.box_.Defined())
+        {
+            queryObject.setCollisionShape(&boxShape);
+            queryObject.setWorldTransform(btTransform(btQuaternion::getIdentity(), ToBtVector3(query.box_.Center())));
+        }
+        else
+            continue;
+
+        OverlapBatchCollider collider(queryObject, batch.world_, result, query.collisionMask_);
+        btDbvt::collideTU(batch.broadphase_->m_sets[0].m_root, collider);
+        btDbvt::collideTU(batch.broadphase_->m_sets[1].m_root, collider);
+    }
+}
+
+void RaycastBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    const RaycastBatch& batch = *reinterpret_cast<RaycastBatch*>(item->aux_);
+    const PhysicsRaycastQuery* start = reinterpret_cast<PhysicsRaycastQuery*>(item->start_);
+    const PhysicsRaycastQuery* end = reinterpret_cast<PhysicsRaycastQuery*>(item->end_);
+    ProcessRaycastQueries(batch, (unsigned)(start - batch.queries_), (unsigned)(end - batch.queries_));
+}
+
+void OverlapBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    const OverlapBatch& batch = *reinterpret_cast<OverlapBatch*>(item->aux_);
+    const PhysicsOverlapQuery* start = reinterpret_cast<PhysicsOverlapQuery*>(item->start_);
+    const PhysicsOverlapQuery* end = reinterpret_cast<PhysicsOverlapQuery*>(item->end_);
+    ProcessOverlapQueries(batch, (unsigned)(start - batch.queries_), (unsigned)(end - batch.queries_));
+}
+
+/// Queue a batch of scene queries as fixed-size ranges on the work queue and wait for them to finish.
+template <class T> static void RunQueryBatch(WorkQueue* queue, void (*workFunction)(const WorkItem*, unsigned),
+    const PODVector<T>& queries, void* batch)
+{
+    T* first = const_cast<T*>(&queries[0]);
+    for (unsigned i = 0; i < queries.Size(); i += QUERIES_PER_BATCH_JOB)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = workFunction;
+        item->aux_ = batch;
+        item->start_ = first + i;
+        item->end_ = first + Min(i + QUERIES_PER_BATCH_JOB, queries.Size());
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     collisionConfiguration_(0),
@@ -125,21 +477,29 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     maxSubSteps_(0),
     timeAcc_(0.0f),
     maxNetworkAngularVelocity_(DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY),
+    activationRegionMode_(ACTIVATION_REGION_NONE),
+    activationMargin_(DEFAULT_ACTIVATION_MARGIN),
+    activationInterval_(DEFAULT_ACTIVATION_INTERVAL),
+    activationBudget_(0.0f),
+    activationCursor_(0),
     updateEnabled_(true),
     interpolation_(true),
     internalEdge_(true),
     applyingTransforms_(false),
     simulating_(false),
+    threadedSimulation_(false),
+    collisionEvents_(true),
+    contactStream_(false),
     debugRenderer_(0),
     debugMode_(btIDebugDraw::DBG_DrawWireframe | btIDebugDraw::DBG_DrawConstraints | btIDebugDraw::DBG_DrawConstraintLimits)
 {
     gContactAddedCallback = CustomMaterialCombinerCallback;
 
     collisionConfiguration_ = new btDefaultCollisionConfiguration();
-    collisionDispatcher_ = new btCollisionDispatcher(collisionConfiguration_);
+    collisionDispatcher_ = new ThreadedCollisionDispatcher(collisionConfiguration_);
     broadphase_ = new btDbvtBroadphase();
     solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_, broadphase_, solver_, collisionConfiguration_);
+    world_ = new ThreadedDynamicsWorld(collisionDispatcher_, broadphase_, solver_, collisionConfiguration_);
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -192,6 +552,26 @@ void PhysicsWorld::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Interpolation", bool, interpolation_, true, AM_FILE);
     URHO3D_ATTRIBUTE("Internal Edge Utility", bool, internalEdge_, true, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Split Impulse", GetSplitImpulse, SetSplitImpulse, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Shape Cache Path", GetShapeCachePath, SetShapeCachePath, String, String::EMPTY, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Threaded Simulation", GetThreadedSimulation, SetThreadedSimulation, bool, false, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Collision Events", GetCollisionEvents, SetCollisionEvents, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Contact Stream", GetContactStream, SetContactStream, bool, false, AM_DEFAULT);
+    URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Activation Region Mode", GetActivationRegionMode, SetActivationRegionMode, ActivationRegionMode,
+        activationRegionModeNames, ACTIVATION_REGION_NONE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Activation Margin", GetActivationMargin, SetActivationMargin, float, DEFAULT_ACTIVATION_MARGIN, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Activation Interval", GetActivationInterval, SetActivationInterval, float, DEFAULT_ACTIVATION_INTERVAL,
+        AM_DEFAULT);
+}
+
+void PhysicsWorld::ApplyAttributes()
+{
+    // On scene load all attributes have been read before any component applies them. The world is in the root node, so it
+    // applies before the collision shapes and can build their geometry at once
+    if (collisionShapes_.Size())
+    {
+        PODVector<CollisionShape*> shapes(collisionShapes_);
+        BuildCollisionGeometry(shapes);
+    }
 }
 
 bool PhysicsWorld::isVisible(const btVector3& aabbMin, const btVector3& aabbMax)
@@ -249,6 +629,20 @@ void PhysicsWorld::Update(float timeStep)
     else if (maxSubSteps_ > 0)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
+    // Check a share of the rigid bodies against the activation regions, so that all of them are checked once per interval
+    if (activationRegionMode_ != ACTIVATION_REGION_NONE && activationObservers_.Size())
+    {
+        if (activationInterval_ > 0.0f)
+        {
+            activationBudget_ += rigidBodies_.Size() * timeStep / activationInterval_;
+            unsigned count = (unsigned)activationBudget_;
+            activationBudget_ -= (float)count;
+            CheckActivationRegions(count);
+        }
+        else
+            CheckActivationRegions(rigidBodies_.Size());
+    }
+
     delayedWorldTransforms_.Clear();
     simulating_ = true;
 
@@ -351,6 +745,163 @@ void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
     MarkNetworkUpdate();
 }
 
+void PhysicsWorld::SetShapeCachePath(const String& path)
+{
+    shapeCachePath_ = path;
+}
+
+void PhysicsWorld::SetThreadedSimulation(bool enable)
+{
+    threadedSimulation_ = enable;
+
+    WorkQueue* queue = enable ? GetSubsystem<WorkQueue>() : 0;
+    static_cast<ThreadedCollisionDispatcher*>(collisionDispatcher_)->SetWorkQueue(queue);
+    static_cast<ThreadedDynamicsWorld*>(world_)->SetWorkQueue(queue);
+}
+
+void PhysicsWorld::SetCollisionEvents(bool enable)
+{
+    collisionEvents_ = enable;
+
+    // Forget the pairs so that re-enabling does not report stale collisions as ended
+    if (!enable)
+    {
+        currentCollisions_.Clear();
+        previousCollisions_.Clear();
+    }
+}
+
+void PhysicsWorld::SetContactStream(bool enable)
+{
+    contactStream_ = enable;
+
+    if (!enable)
+    {
+        contactPairs_.Clear();
+        previousContactPairs_.Clear();
+        contactPoints_.Clear();
+    }
+}
+
+void PhysicsWorld::SetActivationRegionMode(ActivationRegionMode mode)
+{
+    if (mode != activationRegionMode_)
+    {
+        // Restore the bodies while the old mode is still in effect, as it decides how they were deactivated
+        for (PODVector<RigidBody*>::Iterator i = rigidBodies_.Begin(); i != rigidBodies_.End(); ++i)
+            (*i)->SetRegionActive(true);
+
+        activationRegionMode_ = mode;
+        activationBudget_ = 0.0f;
+        MarkNetworkUpdate();
+    }
+}
+
+void PhysicsWorld::SetActivationMargin(float margin)
+{
+    activationMargin_ = Max(margin, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::SetActivationInterval(float interval)
+{
+    activationInterval_ = Max(interval, 0.0f);
+    MarkNetworkUpdate();
+}
+
+void PhysicsWorld::UpdateActivationRegions()
+{
+    if (activationRegionMode_ != ACTIVATION_REGION_NONE && activationObservers_.Size())
+    {
+        activationCursor_ = 0;
+        CheckActivationRegions(rigidBodies_.Size());
+    }
+}
+
+void PhysicsWorld::BuildCollisionGeometry(const PODVector<CollisionShape*>& shapes)
+{
+    URHO3D_PROFILE(BuildCollisionGeometry);
+
+    // Collect the model geometries missing from the cache, grouped by model
+    Vector<CollisionGeometryBuildWork> works;
+    HashMap<Model*, unsigned> workIndices;
+    for (unsigned i = 0; i < shapes.Size(); ++i)
+    {
+        ShapeType shapeType = shapes[i]->GetShapeType();
+        Model* model = shapes[i]->GetModel();
+        unsigned lodLevel = shapes[i]->GetLodLevel();
+        if ((shapeType != SHAPE_TRIANGLEMESH && shapeType != SHAPE_CONVEXHULL) || !model || !model->GetNumGeometries())
+            continue;
+
+        HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >& cache =
+            shapeType == SHAPE_TRIANGLEMESH ? triMeshCache_ : convexCache_;
+        if (cache.Contains(MakePair(model, lodLevel)) || HasDynamicBuffers(model, lodLevel))
+            continue;
+
+        HashMap<Model*, unsigned>::ConstIterator j = workIndices.Find(model);
+        if (j == workIndices.End())
+        {
+            j = workIndices.Insert(MakePair(model, works.Size()));
+            works.Resize(works.Size() + 1);
+            works.Back().model_ = model;
+        }
+
+        Vector<CollisionGeometryBuild>& builds = works[j->second_].builds_;
+        bool found = false;
+        for (unsigned k = 0; k < builds.Size() && !found; ++k)
+            found = builds[k].shapeType_ == shapeType && builds[k].lodLevel_ == lodLevel;
+        if (!found)
+        {
+            CollisionGeometryBuild build;
+            build.shapeType_ = shapeType;
+            build.lodLevel_ = lodLevel;
+            builds.Push(build);
+        }
+    }
+
+    if (works.Size())
+    {
+        WorkQueue* queue = GetSubsystem<WorkQueue>();
+        for (unsigned i = 0; i < works.Size(); ++i)
+        {
+            if (queue)
+            {
+                SharedPtr<WorkItem> item = queue->GetFreeItem();
+                item->priority_ = M_MAX_UNSIGNED;
+                item->workFunction_ = BuildCollisionGeometryWork;
+                item->start_ = &works[i];
+                item->aux_ = &shapeCachePath_;
+                queue->AddWorkItem(item);
+            }
+            else
+            {
+                WorkItem item;
+                item.start_ = &works[i];
+                item.aux_ = &shapeCachePath_;
+                BuildCollisionGeometryWork(&item, 0);
+            }
+        }
+
+        if (queue)
+            queue->Complete(M_MAX_UNSIGNED);
+
+        for (unsigned i = 0; i < works.Size(); ++i)
+        {
+            for (unsigned j = 0; j < works[i].builds_.Size(); ++j)
+            {
+                const CollisionGeometryBuild& build = works[i].builds_[j];
+                HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> >& cache =
+                    build.shapeType_ == SHAPE_TRIANGLEMESH ? triMeshCache_ : convexCache_;
+                cache[MakePair(works[i].model_, build.lodLevel_)] = build.geometry_;
+            }
+        }
+    }
+
+    // Create the pending shapes now, as cleaning up the cache would remove the new geometry before they reference it
+    for (unsigned i = 0; i < shapes.Size(); ++i)
+        shapes[i]->ApplyAttributes();
+}
+
 void PhysicsWorld::Raycast(PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask)
 {
     URHO3D_PROFILE(PhysicsRaycast);
@@ -411,6 +962,26 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     }
 }
 
+void PhysicsWorld::RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsRaycastQuery>& queries)
+{
+    URHO3D_PROFILE(PhysicsRaycastBatch);
+
+    results.Resize(queries.Size());
+    if (queries.Empty())
+        return;
+
+    RaycastBatch batch;
+    batch.broadphase_ = static_cast<btDbvtBroadphase*>(broadphase_);
+    batch.queries_ = &queries[0];
+    batch.results_ = &results[0];
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->GetNumThreads() && queries.Size() > QUERIES_PER_BATCH_JOB)
+        RunQueryBatch(queue, RaycastBatchWork, queries, &batch);
+    else
+        ProcessRaycastQueries(batch, 0, queries.Size());
+}
+
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask)
 {
     URHO3D_PROFILE(PhysicsRaycastSingleSegmented);
@@ -645,6 +1216,33 @@ void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const BoundingB
     delete tempRigidBody;
 }
 
+void PhysicsWorld::GetRigidBodiesBatch(Vector<PODVector<RigidBody*> >& results, const PODVector<PhysicsOverlapQuery>& queries)
+{
+    URHO3D_PROFILE(PhysicsOverlapBatch);
+
+    results.Resize(queries.Size());
+    if (queries.Empty())
+        return;
+
+    OverlapBatch batch;
+    batch.broadphase_ = static_cast<btDbvtBroadphase*>(broadphase_);
+    batch.world_ = world_;
+    batch.queries_ = &queries[0];
+    batch.results_ = &results[0];
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    if (queue && queue->GetNumThreads() && queries.Size() > QUERIES_PER_BATCH_JOB)
+    {
+        // The collision algorithms allocate from the dispatcher's shared pools, which need to be guarded meanwhile
+        ThreadedCollisionDispatcher* dispatcher = static_cast<ThreadedCollisionDispatcher*>(collisionDispatcher_);
+        dispatcher->SetConcurrentAccess(true);
+        RunQueryBatch(queue, OverlapBatchWork, queries, &batch);
+        dispatcher->SetConcurrentAccess(false);
+    }
+    else
+        ProcessOverlapQueries(batch, 0, queries.Size());
+}
+
 void PhysicsWorld::GetRigidBodies(PODVector<RigidBody*>& result, const RigidBody* body)
 {
     URHO3D_PROFILE(PhysicsBodyQuery);
@@ -674,6 +1272,20 @@ void PhysicsWorld::GetCollidingBodies(PODVector<RigidBody*>& result, const Rigid
 
     result.Clear();
 
+    if (!collisionEvents_)
+    {
+        for (PODVector<PhysicsContactPair>::ConstIterator i = contactPairs_.Begin(); i != contactPairs_.End(); ++i)
+        {
+            if (i->state_ == CONTACT_PAIR_END || !i->bodyA_ || !i->bodyB_)
+                continue;
+            if (i->bodyA_ == body)
+                result.Push(i->bodyB_);
+            else if (i->bodyB_ == body)
+                result.Push(i->bodyA_);
+        }
+        return;
+    }
+
     for (HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, btPersistentManifold*>::Iterator i = currentCollisions_.Begin();
          i != currentCollisions_.End(); ++i)
     {
@@ -708,13 +1320,35 @@ bool PhysicsWorld::GetSplitImpulse() const
 void PhysicsWorld::AddRigidBody(RigidBody* body)
 {
     rigidBodies_.Push(body);
+    if (body->GetActivationRadius() > 0.0f)
+        AddActivationObserver(body);
 }
 
 void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 {
     rigidBodies_.Remove(body);
+    activationObservers_.Remove(body);
     // Remove possible dangling pointer from the delayedWorldTransforms structure
     delayedWorldTransforms_.Erase(body);
+    // Clear dangling pointers from the contact stream. The pairs are left in place, as they may be being iterated
+    for (PODVector<PhysicsContactPair>::Iterator i = contactPairs_.Begin(); i != contactPairs_.End(); ++i)
+    {
+        if (i->bodyA_ == body)
+            i->bodyA_ = 0;
+        if (i->bodyB_ == body)
+            i->bodyB_ = 0;
+    }
+}
+
+void PhysicsWorld::AddActivationObserver(RigidBody* body)
+{
+    if (!activationObservers_.Contains(body))
+        activationObservers_.Push(body);
+}
+
+void PhysicsWorld::RemoveActivationObserver(RigidBody* body)
+{
+    activationObservers_.Remove(body);
 }
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
@@ -839,6 +1473,20 @@ void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE(SendCollisionEvents);
 
+    if (contactStream_)
+    {
+        UpdateContactStream();
+
+        using namespace PhysicsContacts;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_WORLD] = this;
+        SendEvent(E_PHYSICSCONTACTS, eventData);
+    }
+
+    if (!collisionEvents_)
+        return;
+
     currentCollisions_.Clear();
     physicsCollisionData_.Clear();
     nodeCollisionData_.Clear();
@@ -865,13 +1513,7 @@ void PhysicsWorld::SendCollisionEvents()
             if (!bodyA || !bodyB)
                 continue;
 
-            // Skip collision event signaling if both objects are static, or if collision event mode does not match
-            if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                continue;
-            if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                !bodyA->IsActive() && !bodyB->IsActive())
+            if (!IsCollisionReported(bodyA, bodyB))
                 continue;
 
             WeakPtr<RigidBody> bodyWeakA(bodyA);
@@ -998,13 +1640,7 @@ void PhysicsWorld::SendCollisionEvents()
 
                 bool trigger = bodyA->IsTrigger() || bodyB->IsTrigger();
 
-                // Skip collision event signaling if both objects are static, or if collision event mode does not match
-                if (bodyA->GetMass() == 0.0f && bodyB->GetMass() == 0.0f)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_NEVER || bodyB->GetCollisionEventMode() == COLLISION_NEVER)
-                    continue;
-                if (bodyA->GetCollisionEventMode() == COLLISION_ACTIVE && bodyB->GetCollisionEventMode() == COLLISION_ACTIVE &&
-                    !bodyA->IsActive() && !bodyB->IsActive())
+                if (!IsCollisionReported(bodyA, bodyB))
                     continue;
 
                 Node* nodeA = bodyA->GetNode();
@@ -1044,6 +1680,166 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void PhysicsWorld::UpdateContactStream()
+{
+    URHO3D_PROFILE(UpdateContactStream);
+
+    // Keep the collisions of the previous step that did not end, and whose bodies still exist. They remain sorted
+    previousContactPairs_.Clear();
+    for (PODVector<PhysicsContactPair>::ConstIterator i = contactPairs_.Begin(); i != contactPairs_.End(); ++i)
+    {
+        if (i->state_ != CONTACT_PAIR_END && i->bodyA_ && i->bodyB_)
+            previousContactPairs_.Push(*i);
+    }
+
+    contactPairs_.Clear();
+    contactPoints_.Clear();
+
+    int numManifolds = collisionDispatcher_->getNumManifolds();
+    for (int i = 0; i < numManifolds; ++i)
+    {
+        btPersistentManifold* contactManifold = collisionDispatcher_->getManifoldByIndexInternal(i);
+        int numContacts = contactManifold->getNumContacts();
+        if (!numContacts)
+            continue;
+
+        RigidBody* bodyA = static_cast<RigidBody*>(contactManifold->getBody0()->getUserPointer());
+        RigidBody* bodyB = static_cast<RigidBody*>(contactManifold->getBody1()->getUserPointer());
+        if (!bodyA || !bodyB || !IsCollisionReported(bodyA, bodyB))
+            continue;
+
+        // Order the bodies by address, and flip the contacts to match if necessary
+        bool swapped = bodyB < bodyA;
+
+        PhysicsContactPair pair;
+        pair.bodyA_ = swapped ? bodyB : bodyA;
+        pair.bodyB_ = swapped ? bodyA : bodyB;
+        pair.firstContact_ = contactPoints_.Size();
+        pair.numContacts_ = (unsigned)numContacts;
+        pair.state_ = CONTACT_PAIR_START;
+        pair.trigger_ = bodyA->IsTrigger() || bodyB->IsTrigger();
+        contactPairs_.Push(pair);
+
+        for (int j = 0; j < numContacts; ++j)
+        {
+            const btManifoldPoint& point = contactManifold->getContactPoint(j);
+
+            PhysicsContactPoint contact;
+            contact.position_ = ToVector3(swapped ? point.m_positionWorldOnA : point.m_positionWorldOnB);
+            contact.normal_ = swapped ? -ToVector3(point.m_normalWorldOnB) : ToVector3(point.m_normalWorldOnB);
+            contact.distance_ = point.m_distance1;
+            contact.impulse_ = point.m_appliedImpulse;
+            contactPoints_.Push(contact);
+        }
+    }
+
+    Sort(contactPairs_.Begin(), contactPairs_.End(), CompareContactPairs);
+
+    // Compound shapes produce one manifold per child shape pair. Merge them so that each body pair has a single record
+    // with contiguous contact points; otherwise the duplicates would be misreported as started and ended collisions
+    bool hasDuplicates = false;
+    for (unsigned i = 1; i < contactPairs_.Size() && !hasDuplicates; ++i)
+        hasDuplicates = !CompareContactPairs(contactPairs_[i - 1], contactPairs_[i]);
+
+    if (hasDuplicates)
+    {
+        manifoldContactPoints_ = contactPoints_;
+        contactPoints_.Clear();
+
+        unsigned numMerged = 0;
+        for (unsigned i = 0; i < contactPairs_.Size(); ++i)
+        {
+            PhysicsContactPair pair = contactPairs_[i];
+            if (!numMerged || CompareContactPairs(contactPairs_[numMerged - 1], pair))
+            {
+                contactPairs_[numMerged] = pair;
+                contactPairs_[numMerged].firstContact_ = contactPoints_.Size();
+                contactPairs_[numMerged].numContacts_ = 0;
+                ++numMerged;
+            }
+
+            contactPoints_.Insert(contactPoints_.End(), manifoldContactPoints_.Begin() + pair.firstContact_,
+                manifoldContactPoints_.Begin() + pair.firstContact_ + pair.numContacts_);
+            contactPairs_[numMerged - 1].numContacts_ += pair.numContacts_;
+        }
+        contactPairs_.Resize(numMerged);
+    }
+
+    // Find the started and ended collisions by walking the sorted pairs of both steps side by side
+    unsigned numPairs = contactPairs_.Size();
+    unsigned j = 0;
+    for (unsigned i = 0; i < numPairs; ++i)
+    {
+        // Ended collisions are appended to the same array, so access the pair by index only
+        while (j < previousContactPairs_.Size() && CompareContactPairs(previousContactPairs_[j], contactPairs_[i]))
+            AddEndedContactPair(contactPairs_, previousContactPairs_[j++]);
+
+        if (j < previousContactPairs_.Size() && previousContactPairs_[j].bodyA_ == contactPairs_[i].bodyA_ &&
+            previousContactPairs_[j].bodyB_ == contactPairs_[i].bodyB_)
+        {
+            contactPairs_[i].state_ = CONTACT_PAIR_ONGOING;
+            ++j;
+        }
+    }
+
+    while (j < previousContactPairs_.Size())
+        AddEndedContactPair(contactPairs_, previousContactPairs_[j++]);
+}
+
+void PhysicsWorld::CheckActivationRegions(unsigned count)
+{
+    URHO3D_PROFILE(CheckActivationRegions);
+
+    count = Min(count, rigidBodies_.Size());
+
+    for (unsigned i = 0; i < count; ++i)
+    {
+        if (activationCursor_ >= rigidBodies_.Size())
+            activationCursor_ = 0;
+        RigidBody* body = rigidBodies_[activationCursor_++];
+
+        // Observers and bodies held by constraints are always simulated
+        if (body->GetActivationRadius() > 0.0f || body->GetConstraints().Size())
+        {
+            body->SetRegionActive(true);
+            continue;
+        }
+        // Freezing only concerns dynamic bodies
+        if (activationRegionMode_ == ACTIVATION_REGION_FREEZE && (body->GetMass() <= 0.0f || body->IsKinematic()))
+            continue;
+
+        // Measure against the world bounding box, so that large bodies such as floors are not cut off by their center
+        BoundingBox box(body->GetPosition(), body->GetPosition());
+        if (body->GetBody())
+        {
+            btVector3 aabbMin, aabbMax;
+            body->GetBody()->getAabb(aabbMin, aabbMax);
+            box.Define(ToVector3(aabbMin), ToVector3(aabbMax));
+        }
+
+        // Activate inside any region, deactivate only when past the margin of all of them
+        bool inside = false;
+        bool outside = true;
+        for (PODVector<RigidBody*>::ConstIterator j = activationObservers_.Begin(); j != activationObservers_.End(); ++j)
+        {
+            Vector3 center = (*j)->GetPosition();
+            float radius = (*j)->GetActivationRadius();
+            if (Sphere(center, radius).IsInsideFast(box) != OUTSIDE)
+            {
+                inside = true;
+                break;
+            }
+            if (Sphere(center, radius + activationMargin_).IsInsideFast(box) != OUTSIDE)
+                outside = false;
+        }
+
+        if (inside)
+            body->SetRegionActive(true);
+        else if (outside)
+            body->SetRegionActive(false);
+    }
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
@@ -25,6 +25,7 @@
 #include "../Container/HashSet.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
@@ -48,7 +49,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -83,6 +83,113 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_;
 };
 
+/// State of a colliding rigid body pair in the contact stream.
+enum ContactPairState
+{
+    CONTACT_PAIR_START = 0,
+    CONTACT_PAIR_ONGOING,
+    CONTACT_PAIR_END
+};
+
+/// Handling of rigid bodies outside the activation regions.
+enum ActivationRegionMode
+{
+    ACTIVATION_REGION_NONE = 0,
+    ACTIVATION_REGION_FREEZE,
+    ACTIVATION_REGION_REMOVE
+};
+
+/// Contact point in the contact stream.
+struct URHO3D_API PhysicsContactPoint
+{
+    /// Worldspace position on body B.
+    Vector3 position_;
+    /// Worldspace normal on body B, pointing towards body A.
+    Vector3 normal_;
+    /// Distance between the bodies, negative when interpenetrating.
+    float distance_;
+    /// Impulse applied in collision.
+    float impulse_;
+};
+
+/// Colliding rigid body pair in the contact stream.
+struct URHO3D_API PhysicsContactPair
+{
+    /// First rigid body. Null if it has been removed since.
+    RigidBody* bodyA_;
+    /// Second rigid body. Null if it has been removed since.
+    RigidBody* bodyB_;
+    /// Index of the first contact point in the contact point array.
+    unsigned firstContact_;
+    /// Number of contact points. Zero for ended collisions.
+    unsigned numContacts_;
+    /// Collision state.
+    ContactPairState state_;
+    /// Whether either of the bodies is a trigger.
+    bool trigger_;
+};
+
+/// Physics raycast or swept sphere query for batched execution.
+struct URHO3D_API PhysicsRaycastQuery
+{
+    /// Construct with defaults.
+    PhysicsRaycastQuery() :
+        maxDistance_(0.0f),
+        radius_(0.0f),
+        collisionMask_(M_MAX_UNSIGNED)
+    {
+    }
+
+    /// Construct with ray, maximum distance, sphere radius and collision mask.
+    PhysicsRaycastQuery(const Ray& ray, float maxDistance, float radius = 0.0f, unsigned collisionMask = M_MAX_UNSIGNED) :
+        ray_(ray),
+        maxDistance_(maxDistance),
+        radius_(radius),
+        collisionMask_(collisionMask)
+    {
+    }
+
+    /// Worldspace ray.
+    Ray ray_;
+    /// Maximum distance along the ray. Must be finite.
+    float maxDistance_;
+    /// Radius of the swept sphere, or zero for a raycast.
+    float radius_;
+    /// Collision mask.
+    unsigned collisionMask_;
+};
+
+/// Physics sphere or box overlap query for batched execution.
+struct URHO3D_API PhysicsOverlapQuery
+{
+    /// Construct with defaults.
+    PhysicsOverlapQuery() :
+        collisionMask_(M_MAX_UNSIGNED)
+    {
+    }
+
+    /// Construct a sphere query.
+    PhysicsOverlapQuery(const Sphere& sphere, unsigned collisionMask = M_MAX_UNSIGNED) :
+        sphere_(sphere),
+        collisionMask_(collisionMask)
+    {
+    }
+
+    /// Construct a box query.
+    PhysicsOverlapQuery(const BoundingBox& box, unsigned collisionMask = M_MAX_UNSIGNED) :
+        box_(box),
+        collisionMask_(collisionMask)
+    {
+    }
+
+    /// Worldspace sphere. Used if defined.
+    Sphere sphere_;
+    /// Worldspace box. Used if the sphere is not defined.
+    BoundingBox box_;
+    /// Collision mask.
+    unsigned collisionMask_;
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -97,6 +204,8 @@ struct DelayedWorldTransform
 };
 
 static const float DEFAULT_MAX_NETWORK_ANGULAR_VELOCITY = 100.0f;
+static const float DEFAULT_ACTIVATION_MARGIN = 5.0f;
+static const float DEFAULT_ACTIVATION_INTERVAL = 0.5f;
 
 /// Physics simulation world component. Should be added only to the root scene node.
 class URHO3D_API PhysicsWorld : public Component, public btIDebugDraw
@@ -114,6 +223,9 @@ public:
     /// Register object factory.
     static void RegisterObject(Context* context);
 
+    /// Apply attribute changes that can not be applied immediately. Builds the collision geometry of all pending collision shapes in parallel after scene load.
+    virtual void ApplyAttributes();
+
     /// Check if an AABB is visible for debug drawing.
     virtual bool isVisible(const btVector3& aabbMin, const btVector3& aabbMax);
     /// Draw a physics debug line.
@@ -157,6 +269,24 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set directory for caching cooked triangle mesh and convex hull geometry on disk. Empty (default) disables the disk cache.
+    void SetShapeCachePath(const String& path);
+    /// Set whether to run the narrowphase, constraint solving and integration in parallel on the work queue. Results are deterministic and do not depend on the thread count, but may differ slightly from the single-threaded simulation. Disabled by default.
+    void SetThreadedSimulation(bool enable);
+    /// Set whether to send the per-pair collision events (E_PHYSICSCOLLISION, E_NODECOLLISION etc.) Enabled by default.
+    void SetCollisionEvents(bool enable);
+    /// Set whether to collect the colliding pairs and their contact points into flat arrays after each simulation step and send E_PHYSICSCONTACTS. Disabled by default.
+    void SetContactStream(bool enable);
+    /// Set how rigid bodies outside the activation radii of the observer bodies are handled. Freeze turns dynamic bodies static in place, so that they still block other bodies and queries. Remove takes all bodies out of the physics world, including from queries. Bodies with constraints are always simulated. Default none.
+    void SetActivationRegionMode(ActivationRegionMode mode);
+    /// Set extra distance beyond an activation radius before a body is deactivated, to avoid toggling bodies at the region border.
+    void SetActivationMargin(float margin);
+    /// Set time in seconds over which all rigid bodies are checked against the activation regions. The checks are spread evenly over the simulation updates. Zero checks all bodies on each update.
+    void SetActivationInterval(float interval);
+    /// Check all rigid bodies against the activation regions immediately, for example after an observer has been teleported.
+    void UpdateActivationRegions();
+    /// Build the missing model triangle mesh and convex hull geometry of collision shapes in parallel on the work queue, then apply the pending shape changes.
+    void BuildCollisionGeometry(const PODVector<CollisionShape*>& shapes);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -164,6 +294,8 @@ public:
     void RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Perform a physics world segmented raycast and return the closest hit. Useful for big scenes with many bodies.
     void RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of raycasts and swept sphere tests spread over the work queue threads, and return the closest hit of each query in query order.
+    void RaycastSingleBatch(PODVector<PhysicsRaycastResult>& results, const PODVector<PhysicsRaycastQuery>& queries);
     /// Perform a physics world swept sphere test and return the closest hit.
     void SphereCast
         (PhysicsRaycastResult& result, const Ray& ray, float radius, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -179,9 +311,11 @@ public:
     void GetRigidBodies(PODVector<RigidBody*>& result, const Sphere& sphere, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Return rigid bodies by a box query.
     void GetRigidBodies(PODVector<RigidBody*>& result, const BoundingBox& box, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Return rigid bodies by a batch of sphere and box queries spread over the work queue threads. The results are in query order.
+    void GetRigidBodiesBatch(Vector<PODVector<RigidBody*> >& results, const PODVector<PhysicsOverlapQuery>& queries);
     /// Return rigid bodies by contact test with the specified body. It needs to be active to return all contacts reliably.
     void GetRigidBodies(PODVector<RigidBody*>& result, const RigidBody* body);
-    /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
+    /// Return rigid bodies that have been in collision with the specified body on the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions. Requires either the collision events or the contact stream to be enabled.
     void GetCollidingBodies(PODVector<RigidBody*>& result, const RigidBody* body);
 
     /// Return gravity.
@@ -211,10 +345,41 @@ public:
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return directory for caching cooked collision geometry on disk.
+    const String& GetShapeCachePath() const { return shapeCachePath_; }
+
+    /// Return whether the simulation runs in parallel on the work queue.
+    bool GetThreadedSimulation() const { return threadedSimulation_; }
+
+    /// Return whether the per-pair collision events are sent.
+    bool GetCollisionEvents() const { return collisionEvents_; }
+
+    /// Return whether the contact stream is collected.
+    bool GetContactStream() const { return contactStream_; }
+
+    /// Return activation region mode.
+    ActivationRegionMode GetActivationRegionMode() const { return activationRegionMode_; }
+
+    /// Return extra distance beyond an activation radius before a body is deactivated.
+    float GetActivationMargin() const { return activationMargin_; }
+
+    /// Return time over which all rigid bodies are checked against the activation regions.
+    float GetActivationInterval() const { return activationInterval_; }
+
+    /// Return colliding pairs of the last simulation step from the contact stream, sorted by body with the ended collisions last.
+    const PODVector<PhysicsContactPair>& GetContactPairs() const { return contactPairs_; }
+
+    /// Return contact points of the last simulation step from the contact stream. Indexed by the contact pairs.
+    const PODVector<PhysicsContactPoint>& GetContactPoints() const { return contactPoints_; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
     void RemoveRigidBody(RigidBody* body);
+    /// Add an activation region observer. Called by RigidBody.
+    void AddActivationObserver(RigidBody* body);
+    /// Remove an activation region observer. Called by RigidBody.
+    void RemoveActivationObserver(RigidBody* body);
     /// Add a collision shape to keep track of. Called by CollisionShape.
     void AddCollisionShape(CollisionShape* shape);
     /// Remove a collision shape. Called by CollisionShape.
@@ -266,6 +431,10 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Collect the contact stream of the last simulation step.
+    void UpdateContactStream();
+    /// Check the given number of rigid bodies against the activation regions, continuing from where the previous check ended.
+    void CheckActivationRegions(unsigned count);
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_;
@@ -289,12 +458,24 @@ private:
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, btPersistentManifold*> currentCollisions_;
     /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, btPersistentManifold*> previousCollisions_;
+    /// Colliding pairs of the contact stream.
+    PODVector<PhysicsContactPair> contactPairs_;
+    /// Colliding pairs of the contact stream on the previous step.
+    PODVector<PhysicsContactPair> previousContactPairs_;
+    /// Contact points of the contact stream.
+    PODVector<PhysicsContactPoint> contactPoints_;
+    /// Contact points in manifold order, used when merging the manifolds of a body pair.
+    PODVector<PhysicsContactPoint> manifoldContactPoints_;
+    /// Activation region observer bodies.
+    PODVector<RigidBody*> activationObservers_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
     HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> > triMeshCache_;
     /// Cache for convex geometry data by model and LOD level.
     HashMap<Pair<Model*, unsigned>, SharedPtr<CollisionGeometryData> > convexCache_;
+    /// Directory for caching cooked collision geometry on disk.
+    String shapeCachePath_;
     /// Preallocated event data map for physics collision events.
     VariantMap physicsCollisionData_;
     /// Preallocated event data map for node collision events.
@@ -309,6 +490,16 @@ private:
     float timeAcc_;
     /// Maximum angular velocity for network replication.
     float maxNetworkAngularVelocity_;
+    /// Activation region mode.
+    ActivationRegionMode activationRegionMode_;
+    /// Extra distance beyond an activation radius before deactivation.
+    float activationMargin_;
+    /// Time over which all rigid bodies are checked against the activation regions.
+    float activationInterval_;
+    /// Fractional number of rigid bodies left over to check.
+    float activationBudget_;
+    /// Index of the next rigid body to check against the activation regions.
+    unsigned activationCursor_;
     /// Automatic simulation update enabled flag.
     bool updateEnabled_;
     /// Interpolation flag.
@@ -319,6 +510,12 @@ private:
     bool applyingTransforms_;
     /// Simulating flag.
     bool simulating_;
+    /// Multithreaded simulation flag.
+    bool threadedSimulation_;
+    /// Per-pair collision events flag.
+    bool collisionEvents_;
+    /// Contact stream flag.
+    bool contactStream_;
     /// Debug draw depth test mode.
     bool debugDepthTest_;
     /// Debug renderer.
@@ -69,6 +69,9 @@ RigidBody::RigidBody(Context* context) :
     gravityOverride_(Vector3::ZERO),
     centerOfMass_(Vector3::ZERO),
     mass_(DEFAULT_MASS),
+    activationRadius_(0.0f),
+    regionLinearVelocity_(Vector3::ZERO),
+    regionAngularVelocity_(Vector3::ZERO),
     collisionLayer_(DEFAULT_COLLISION_LAYER),
     collisionMask_(DEFAULT_COLLISION_MASK),
     collisionEventMode_(COLLISION_ACTIVE),
@@ -80,6 +83,8 @@ RigidBody::RigidBody(Context* context) :
     readdBody_(false),
     inWorld_(false),
     enableMassUpdate_(true),
+    regionActive_(true),
+    regionSleeping_(false),
     hasSimulated_(false)
 {
     compoundShape_ = new btCompoundShape();
@@ -134,6 +139,7 @@ void RigidBody::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Is Kinematic", bool, kinematic_, false, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Is Trigger", bool, trigger_, false, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Gravity Override", GetGravityOverride, SetGravityOverride, Vector3, Vector3::ZERO, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Activation Radius", GetActivationRadius, SetActivationRadius, float, 0.0f, AM_DEFAULT);
 }
 
 void RigidBody::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
@@ -527,6 +533,31 @@ void RigidBody::SetCollisionEventMode(CollisionEventMode mode)
     MarkNetworkUpdate();
 }
 
+void RigidBody::SetActivationRadius(float radius)
+{
+    radius = Max(radius, 0.0f);
+
+    if (radius != activationRadius_)
+    {
+        bool wasObserver = activationRadius_ > 0.0f;
+        activationRadius_ = radius;
+
+        if (physicsWorld_ && wasObserver != (radius > 0.0f))
+        {
+            if (radius > 0.0f)
+            {
+                physicsWorld_->AddActivationObserver(this);
+                // An observer is always simulated itself
+                SetRegionActive(true);
+            }
+            else
+                physicsWorld_->RemoveActivationObserver(this);
+        }
+
+        MarkNetworkUpdate();
+    }
+}
+
 void RigidBody::ApplyForce(const Vector3& force)
 {
     if (body_ && force != Vector3::ZERO)
@@ -599,6 +630,38 @@ void RigidBody::ReAddBodyToWorld()
         AddBodyToWorld();
 }
 
+void RigidBody::SetRegionActive(bool enable)
+{
+    if (enable == regionActive_)
+        return;
+
+    if (!enable)
+    {
+        regionLinearVelocity_ = GetLinearVelocity();
+        regionAngularVelocity_ = GetAngularVelocity();
+        regionSleeping_ = body_ && !body_->isActive();
+    }
+
+    // A frozen body loses its velocity, while a removed body keeps it
+    bool wasFrozen = IsRegionFrozen();
+    regionActive_ = enable;
+
+    // Re-adding switches the body between the simulated and the frozen or removed state
+    if (body_ && IsEnabledEffective())
+        AddBodyToWorld();
+
+    if (enable && body_ && inWorld_ && mass_ > 0.0f && !kinematic_)
+    {
+        if (wasFrozen)
+        {
+            SetLinearVelocity(regionLinearVelocity_);
+            SetAngularVelocity(regionAngularVelocity_);
+        }
+        if (regionSleeping_)
+            body_->forceActivationState(ISLAND_SLEEPING);
+    }
+}
+
 void RigidBody::DisableMassUpdate()
 {
     enableMassUpdate_ = false;
@@ -808,11 +871,12 @@ void RigidBody::UpdateMass()
     centerOfMass_ = ToVector3(principal.getOrigin());
     SetPosition(oldPosition);
 
-    // Calculate final inertia
+    // Calculate final inertia. A body frozen outside the activation regions is made static until it becomes active again
+    float mass = IsRegionFrozen() ? 0.0f : mass_;
     btVector3 localInertia(0.0f, 0.0f, 0.0f);
-    if (mass_ > 0.0f)
-        shiftedCompoundShape_->calculateLocalInertia(mass_, localInertia);
-    body_->setMassProps(mass_, localInertia);
+    if (mass > 0.0f)
+        shiftedCompoundShape_->calculateLocalInertia(mass, localInertia);
+    body_->setMassProps(mass, localInertia);
     body_->updateInertiaTensor();
 
     // Reapply constraint positions for new center of mass shift
@@ -1012,7 +1076,7 @@ void RigidBody::AddBodyToWorld()
     body_->setCollisionFlags(flags);
     body_->forceActivationState(kinematic_ ? DISABLE_DEACTIVATION : ISLAND_SLEEPING);
 
-    if (!IsEnabledEffective())
+    if (!IsEnabledEffective() || IsRegionRemoved())
         return;
 
     btDiscreteDynamicsWorld* world = physicsWorld_->GetWorld();
@@ -1021,7 +1085,7 @@ void RigidBody::AddBodyToWorld()
     readdBody_ = false;
     hasSimulated_ = false;
 
-    if (mass_ > 0.0f)
+    if (mass_ > 0.0f && !IsRegionFrozen())
         Activate();
     else
     {
@@ -1040,6 +1104,16 @@ void RigidBody::RemoveBodyFromWorld()
     }
 }
 
+bool RigidBody::IsRegionFrozen() const
+{
+    return !regionActive_ && physicsWorld_ && physicsWorld_->GetActivationRegionMode() == ACTIVATION_REGION_FREEZE;
+}
+
+bool RigidBody::IsRegionRemoved() const
+{
+    return !regionActive_ && physicsWorld_ && physicsWorld_->GetActivationRegionMode() == ACTIVATION_REGION_REMOVE;
+}
+
 void RigidBody::HandleTargetPosition(StringHash eventType, VariantMap& eventData)
 {
     // Copy the smoothing target position to the rigid body
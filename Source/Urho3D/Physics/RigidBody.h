@@ -126,6 +126,8 @@ public:
     void SetCollisionLayerAndMask(unsigned layer, unsigned mask);
     /// Set collision event signaling mode. Default is to signal when rigid bodies are active.
     void SetCollisionEventMode(CollisionEventMode mode);
+    /// Set activation radius. If positive, the body is an observer of the physics world's activation regions, and bodies within the radius are kept simulated. Zero (default) is not an observer.
+    void SetActivationRadius(float radius);
     /// Apply force to center of mass.
     void ApplyForce(const Vector3& force);
     /// Apply force at local position.
@@ -144,6 +146,8 @@ public:
     void Activate();
     /// Readd rigid body to the physics world to clean up internal state like stale contacts.
     void ReAddBodyToWorld();
+    /// Set whether the body is inside an activation region. Outside, the body is frozen or removed from the physics world depending on the activation region mode. Its velocity and sleeping state are restored when it becomes active again. Called by PhysicsWorld, but can also be used to restore a body on demand.
+    void SetRegionActive(bool enable);
     /// Disable mass update. Call this to optimize performance when adding or editing multiple collision shapes in the same node.
     void DisableMassUpdate();
     /// Re-enable mass update and recalculate the mass/inertia by calling UpdateMass(). Call when collision shape changes are finished.
@@ -225,6 +229,15 @@ public:
     /// Return collision event signaling mode.
     CollisionEventMode GetCollisionEventMode() const { return collisionEventMode_; }
 
+    /// Return activation radius.
+    float GetActivationRadius() const { return activationRadius_; }
+
+    /// Return whether the body is inside an activation region.
+    bool IsRegionActive() const { return regionActive_; }
+
+    /// Return constraints that refer to this rigid body.
+    const PODVector<Constraint*>& GetConstraints() const { return constraints_; }
+
     /// Return colliding rigid bodies from the last simulation step. Only returns collisions that were sent as events (depends on collision event mode) and excludes e.g. static-static collisions.
     void GetCollidingBodies(PODVector<RigidBody*>& result) const;
 
@@ -258,6 +271,10 @@ private:
     void AddBodyToWorld();
     /// Remove the rigid body from the physics world.
     void RemoveBodyFromWorld();
+    /// Return whether the body is frozen into a static body for being outside the activation regions.
+    bool IsRegionFrozen() const;
+    /// Return whether the body is kept out of the physics world for being outside the activation regions.
+    bool IsRegionRemoved() const;
     /// Handle SmoothedTransform target position update.
     void HandleTargetPosition(StringHash eventType, VariantMap& eventData);
     /// Handle SmoothedTransform target rotation update.
@@ -281,6 +298,12 @@ private:
     Vector3 centerOfMass_;
     /// Mass.
     float mass_;
+    /// Activation radius as an observer.
+    float activationRadius_;
+    /// Linear velocity stored when leaving the activation regions.
+    Vector3 regionLinearVelocity_;
+    /// Angular velocity stored when leaving the activation regions.
+    Vector3 regionAngularVelocity_;
     /// Attribute buffer for network replication.
     mutable VectorBuffer attrBuffer_;
     /// Collision layer.
@@ -305,6 +328,10 @@ private:
     bool inWorld_;
     /// Mass update enable flag.
     bool enableMassUpdate_;
+    /// Inside activation region flag.
+    bool regionActive_;
+    /// Sleeping state stored when leaving the activation regions.
+    bool regionSleeping_;
     /// Internal flag whether has simulated at least once.
     mutable bool hasSimulated_;
 };
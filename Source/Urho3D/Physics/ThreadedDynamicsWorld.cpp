@@ -0,0 +1,470 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../Physics/ThreadedDynamicsWorld.h"
+
+#include <Bullet/BulletCollision/BroadphaseCollision/btOverlappingPairCache.h>
+#include <Bullet/BulletCollision/CollisionShapes/btCollisionShape.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btTypedConstraint.h>
+#include <Bullet/BulletDynamics/Dynamics/btRigidBody.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Overlapping pairs per narrowphase work item. Fixed so that the manifold order does not depend on the thread count.
+static const int PAIRS_PER_DISPATCH_JOB = 128;
+/// Rigid bodies per integration work item.
+static const int BODIES_PER_INTEGRATION_JOB = 256;
+
+static void DispatchPairsWork(const WorkItem* item, unsigned threadIndex)
+{
+    ThreadedCollisionDispatcher* dispatcher = reinterpret_cast<ThreadedCollisionDispatcher*>(item->aux_);
+    dispatcher->ProcessPairs(*reinterpret_cast<CollisionDispatchJob*>(item->start_), threadIndex);
+}
+
+static void SolveBatchWork(const WorkItem* item, unsigned threadIndex)
+{
+    ThreadedDynamicsWorld* world = reinterpret_cast<ThreadedDynamicsWorld*>(item->aux_);
+    world->SolveBatch(*reinterpret_cast<ConstraintSolverBatch*>(item->start_), threadIndex);
+}
+
+static void PredictMotionWork(const WorkItem* item, unsigned threadIndex)
+{
+    ThreadedDynamicsWorld* world = reinterpret_cast<ThreadedDynamicsWorld*>(item->aux_);
+    world->PredictMotion(*reinterpret_cast<RigidBodyJob*>(item->start_));
+}
+
+static void IntegrateTransformsWork(const WorkItem* item, unsigned threadIndex)
+{
+    ThreadedDynamicsWorld* world = reinterpret_cast<ThreadedDynamicsWorld*>(item->aux_);
+    world->IntegrateTransforms(*reinterpret_cast<RigidBodyJob*>(item->start_));
+}
+
+static inline int GetConstraintIslandId(const btTypedConstraint* constraint)
+{
+    const btCollisionObject& bodyA = constraint->getRigidBodyA();
+    const btCollisionObject& bodyB = constraint->getRigidBodyB();
+    return bodyA.getIslandTag() >= 0 ? bodyA.getIslandTag() : bodyB.getIslandTag();
+}
+
+static inline bool CompareConstraintIslands(const btTypedConstraint* lhs, const btTypedConstraint* rhs)
+{
+    return GetConstraintIslandId(lhs) < GetConstraintIslandId(rhs);
+}
+
+static void AddWorkItem(WorkQueue* queue, void (*workFunction)(const WorkItem*, unsigned), void* start, void* aux)
+{
+    SharedPtr<WorkItem> item = queue->GetFreeItem();
+    item->priority_ = M_MAX_UNSIGNED;
+    item->workFunction_ = workFunction;
+    item->start_ = start;
+    item->end_ = 0;
+    item->aux_ = aux;
+    queue->AddWorkItem(item);
+}
+
+ThreadedCollisionDispatcher::ThreadedCollisionDispatcher(btCollisionConfiguration* collisionConfiguration) :
+    btCollisionDispatcher(collisionConfiguration),
+    workQueue_(0),
+    pairs_(0),
+    dispatchInfo_(0),
+    dispatching_(false),
+    concurrentAccess_(false)
+{
+}
+
+void ThreadedCollisionDispatcher::dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo,
+    btDispatcher* dispatcher)
+{
+    btBroadphasePairArray& pairs = pairCache->getOverlappingPairArray();
+    int numJobs = (pairs.size() + PAIRS_PER_DISPATCH_JOB - 1) / PAIRS_PER_DISPATCH_JOB;
+    if (!workQueue_ || !workQueue_->GetNumThreads() || numJobs < 2)
+    {
+        btCollisionDispatcher::dispatchAllCollisionPairs(pairCache, dispatchInfo, dispatcher);
+        return;
+    }
+
+    unsigned numThreads = workQueue_->GetNumThreads() + 1;
+    threadIDs_.Resize(numThreads);
+    threadJobs_.Resize(numThreads);
+    for (unsigned i = 0; i < numThreads; ++i)
+        threadJobs_[i] = 0;
+
+    if (jobs_.Size() < (unsigned)numJobs)
+        jobs_.Resize((unsigned)numJobs);
+
+    pairs_ = &pairs;
+    dispatchInfo_ = &dispatchInfo;
+    dispatching_ = true;
+    int firstNewManifold = m_manifoldsPtr.size();
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        CollisionDispatchJob& job = jobs_[i];
+        job.begin_ = i * PAIRS_PER_DISPATCH_JOB;
+        job.end_ = Min(job.begin_ + PAIRS_PER_DISPATCH_JOB, pairs.size());
+        job.newManifolds_.Clear();
+        job.releasedManifolds_.Clear();
+        AddWorkItem(workQueue_, DispatchPairsWork, &job, this);
+    }
+
+    workQueue_->Complete(M_MAX_UNSIGNED);
+
+    dispatching_ = false;
+    pairs_ = 0;
+    dispatchInfo_ = 0;
+
+    // Store the new manifolds in pair order instead of the order the threads happened to create them in
+    int index = firstNewManifold;
+    for (int i = 0; i < numJobs; ++i)
+    {
+        const PODVector<btPersistentManifold*>& newManifolds = jobs_[i].newManifolds_;
+        for (unsigned j = 0; j < newManifolds.Size(); ++j)
+        {
+            m_manifoldsPtr[index] = newManifolds[j];
+            newManifolds[j]->m_index1a = index;
+            ++index;
+        }
+    }
+    assert(index == m_manifoldsPtr.size());
+
+    // Then perform the deferred releases, also in pair order
+    for (int i = 0; i < numJobs; ++i)
+    {
+        const PODVector<btPersistentManifold*>& releasedManifolds = jobs_[i].releasedManifolds_;
+        for (unsigned j = 0; j < releasedManifolds.Size(); ++j)
+            btCollisionDispatcher::releaseManifold(releasedManifolds[j]);
+    }
+}
+
+btPersistentManifold* ThreadedCollisionDispatcher::getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1)
+{
+    if (!dispatching_ && !concurrentAccess_)
+        return btCollisionDispatcher::getNewManifold(body0, body1);
+
+    MutexLock lock(mutex_);
+    btPersistentManifold* manifold = btCollisionDispatcher::getNewManifold(body0, body1);
+    CollisionDispatchJob* job = GetCurrentJob();
+    if (job)
+        job->newManifolds_.Push(manifold);
+    return manifold;
+}
+
+void ThreadedCollisionDispatcher::releaseManifold(btPersistentManifold* manifold)
+{
+    if (!dispatching_ && !concurrentAccess_)
+    {
+        btCollisionDispatcher::releaseManifold(manifold);
+        return;
+    }
+
+    // Releasing swaps the last manifold into the freed slot, so postpone it to keep the manifold order intact
+    MutexLock lock(mutex_);
+    CollisionDispatchJob* job = GetCurrentJob();
+    if (job)
+        job->releasedManifolds_.Push(manifold);
+    else
+        btCollisionDispatcher::releaseManifold(manifold);
+}
+
+void* ThreadedCollisionDispatcher::allocateCollisionAlgorithm(int size)
+{
+    if (!dispatching_ && !concurrentAccess_)
+        return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+
+    MutexLock lock(mutex_);
+    return btCollisionDispatcher::allocateCollisionAlgorithm(size);
+}
+
+void ThreadedCollisionDispatcher::freeCollisionAlgorithm(void* ptr)
+{
+    if (!dispatching_ && !concurrentAccess_)
+    {
+        btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+        return;
+    }
+
+    MutexLock lock(mutex_);
+    btCollisionDispatcher::freeCollisionAlgorithm(ptr);
+}
+
+void ThreadedCollisionDispatcher::ProcessPairs(CollisionDispatchJob& job, unsigned threadIndex)
+{
+    {
+        MutexLock lock(mutex_);
+        threadIDs_[threadIndex] = Thread::GetCurrentThreadID();
+        threadJobs_[threadIndex] = &job;
+    }
+
+    btNearCallback nearCallback = getNearCallback();
+    btBroadphasePairArray& pairs = *pairs_;
+    for (int i = job.begin_; i < job.end_; ++i)
+        nearCallback(pairs[i], *this, *dispatchInfo_);
+
+    {
+        MutexLock lock(mutex_);
+        threadJobs_[threadIndex] = 0;
+    }
+}
+
+CollisionDispatchJob* ThreadedCollisionDispatcher::GetCurrentJob() const
+{
+    ThreadID threadID = Thread::GetCurrentThreadID();
+    for (unsigned i = 0; i < threadJobs_.Size(); ++i)
+    {
+        if (threadJobs_[i] && threadIDs_[i] == threadID)
+            return threadJobs_[i];
+    }
+
+    return 0;
+}
+
+ThreadedDynamicsWorld::ThreadedDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* pairCache,
+    btConstraintSolver* constraintSolver, btCollisionConfiguration* collisionConfiguration) :
+    btDiscreteDynamicsWorld(dispatcher, pairCache, constraintSolver, collisionConfiguration),
+    workQueue_(0),
+    numBatches_(0),
+    solverInfo_(0),
+    timeStep_(0.0f)
+{
+    solvers_.Push(constraintSolver);
+}
+
+ThreadedDynamicsWorld::~ThreadedDynamicsWorld()
+{
+    // The first solver is owned by the physics world
+    for (unsigned i = 1; i < solvers_.Size(); ++i)
+        delete solvers_[i];
+}
+
+void ThreadedDynamicsWorld::processIsland(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds,
+    int numManifolds, int islandId)
+{
+    // Find the joint constraints of the island from the constraints sorted by island
+    btTypedConstraint** constraints = m_sortedConstraints.size() ? &m_sortedConstraints[0] : 0;
+    int firstConstraint = 0;
+    int numConstraints = m_sortedConstraints.size();
+    if (islandId >= 0)
+    {
+        int low = 0;
+        int high = numConstraints;
+        while (low < high)
+        {
+            int mid = (low + high) / 2;
+            if (GetConstraintIslandId(constraints[mid]) < islandId)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        firstConstraint = low;
+        while (high < numConstraints && GetConstraintIslandId(constraints[high]) == islandId)
+            ++high;
+        numConstraints = high - firstConstraint;
+    }
+
+    // The solver temporarily stores its body indices into kinematic bodies, so islands that share them can not be solved in parallel
+    bool kinematic = false;
+    for (int i = 0; i < numManifolds && !kinematic; ++i)
+    {
+        kinematic = manifolds[i]->getBody0()->isKinematicObject() || manifolds[i]->getBody1()->isKinematicObject();
+    }
+    for (int i = firstConstraint; i < firstConstraint + numConstraints && !kinematic; ++i)
+    {
+        kinematic = constraints[i]->getRigidBodyA().isKinematicObject() || constraints[i]->getRigidBodyB().isKinematicObject();
+    }
+
+    ConstraintSolverBatch* batch;
+    if (kinematic)
+        batch = &kinematicBatch_;
+    else
+    {
+        // Start a new batch once the previous one is large enough. Depends only on the islands, not on the thread count
+        int minBatchSize = solverInfo_->m_minimumSolverBatchSize;
+        if (!numBatches_ || minBatchSize <= 1 || batches_[numBatches_ - 1].GetSize() > (unsigned)minBatchSize)
+        {
+            if (batches_.Size() <= numBatches_)
+                batches_.Resize(numBatches_ + 1);
+            batches_[numBatches_++].Clear();
+        }
+        batch = &batches_[numBatches_ - 1];
+    }
+
+    for (int i = 0; i < numBodies; ++i)
+        batch->bodies_.Push(bodies[i]);
+    for (int i = 0; i < numManifolds; ++i)
+        batch->manifolds_.Push(manifolds[i]);
+    for (int i = firstConstraint; i < firstConstraint + numConstraints; ++i)
+        batch->constraints_.Push(constraints[i]);
+}
+
+void ThreadedDynamicsWorld::SolveBatch(ConstraintSolverBatch& batch, unsigned threadIndex)
+{
+    btConstraintSolver* solver = solvers_[threadIndex];
+    solver->solveGroup(batch.bodies_.Size() ? &batch.bodies_[0] : 0, batch.bodies_.Size(),
+        batch.manifolds_.Size() ? &batch.manifolds_[0] : 0, batch.manifolds_.Size(),
+        batch.constraints_.Size() ? &batch.constraints_[0] : 0, batch.constraints_.Size(), *solverInfo_, 0, m_dispatcher1);
+}
+
+void ThreadedDynamicsWorld::PredictMotion(RigidBodyJob& job)
+{
+    for (int i = job.begin_; i < job.end_; ++i)
+    {
+        btRigidBody* body = m_nonStaticRigidBodies[i];
+        if (!body->isStaticOrKinematicObject())
+        {
+            body->applyDamping(timeStep_);
+            body->predictIntegratedTransform(timeStep_, body->getInterpolationWorldTransform());
+        }
+    }
+}
+
+void ThreadedDynamicsWorld::IntegrateTransforms(RigidBodyJob& job)
+{
+    bool useContinuous = getDispatchInfo().m_useContinuous;
+    btTransform predictedTrans;
+
+    for (int i = job.begin_; i < job.end_; ++i)
+    {
+        btRigidBody* body = m_nonStaticRigidBodies[i];
+        body->setHitFraction(1.0f);
+
+        if (body->isActive() && !body->isStaticOrKinematicObject())
+        {
+            body->predictIntegratedTransform(timeStep_, predictedTrans);
+
+            // Motion clamping sweeps through the broadphase, which is not thread-safe
+            btScalar squareMotion = (predictedTrans.getOrigin() - body->getWorldTransform().getOrigin()).length2();
+            if (useContinuous && body->getCcdSquareMotionThreshold() && body->getCcdSquareMotionThreshold() < squareMotion &&
+                body->getCollisionShape()->isConvex())
+                job.ccdBodies_.Push(body);
+            else
+                body->proceedToTransform(predictedTrans);
+        }
+    }
+}
+
+void ThreadedDynamicsWorld::predictUnconstraintMotion(btScalar timeStep)
+{
+    if (!IsParallel(m_nonStaticRigidBodies.size()))
+    {
+        btDiscreteDynamicsWorld::predictUnconstraintMotion(timeStep);
+        return;
+    }
+
+    timeStep_ = timeStep;
+    RunRigidBodyJobs(PredictMotionWork);
+}
+
+void ThreadedDynamicsWorld::integrateTransforms(btScalar timeStep)
+{
+    if (!IsParallel(m_nonStaticRigidBodies.size()) || m_applySpeculativeContactRestitution)
+    {
+        btDiscreteDynamicsWorld::integrateTransforms(timeStep);
+        return;
+    }
+
+    timeStep_ = timeStep;
+    RunRigidBodyJobs(IntegrateTransformsWork);
+
+    // Integrate the bodies that need motion clamping on this thread, in body order
+    btAlignedObjectArray<btRigidBody*> ccdBodies;
+    for (unsigned i = 0; i < bodyJobs_.Size(); ++i)
+    {
+        const PODVector<btRigidBody*>& jobBodies = bodyJobs_[i].ccdBodies_;
+        for (unsigned j = 0; j < jobBodies.Size(); ++j)
+            ccdBodies.push_back(jobBodies[j]);
+    }
+
+    if (ccdBodies.size())
+    {
+        allBodies_.copyFromArray(m_nonStaticRigidBodies);
+        m_nonStaticRigidBodies.copyFromArray(ccdBodies);
+        btDiscreteDynamicsWorld::integrateTransforms(timeStep);
+        m_nonStaticRigidBodies.copyFromArray(allBodies_);
+    }
+}
+
+void ThreadedDynamicsWorld::solveConstraints(btContactSolverInfo& solverInfo)
+{
+    if (!workQueue_ || !workQueue_->GetNumThreads() || !m_islandManager->getSplitIslands())
+    {
+        btDiscreteDynamicsWorld::solveConstraints(solverInfo);
+        return;
+    }
+
+    m_sortedConstraints.resize(m_constraints.size());
+    for (int i = 0; i < m_constraints.size(); ++i)
+        m_sortedConstraints[i] = m_constraints[i];
+    m_sortedConstraints.quickSort(CompareConstraintIslands);
+
+    m_constraintSolver->prepareSolve(getNumCollisionObjects(), m_dispatcher1->getNumManifolds());
+
+    // Gather the active islands into batches
+    solverInfo_ = &solverInfo;
+    numBatches_ = 0;
+    kinematicBatch_.Clear();
+    m_islandManager->buildAndProcessIslands(m_dispatcher1, this, this);
+
+    // Each thread needs its own solver, as the solvers keep their working data as members
+    unsigned numThreads = workQueue_->GetNumThreads() + 1;
+    while (solvers_.Size() < numThreads)
+        solvers_.Push(new btSequentialImpulseConstraintSolver());
+
+    for (unsigned i = 0; i < numBatches_; ++i)
+        AddWorkItem(workQueue_, SolveBatchWork, &batches_[i], this);
+    if (kinematicBatch_.GetSize())
+        AddWorkItem(workQueue_, SolveBatchWork, &kinematicBatch_, this);
+    workQueue_->Complete(M_MAX_UNSIGNED);
+
+    m_constraintSolver->allSolved(solverInfo, m_debugDrawer);
+}
+
+bool ThreadedDynamicsWorld::IsParallel(int numBodies) const
+{
+    return workQueue_ && workQueue_->GetNumThreads() && numBodies >= 2 * BODIES_PER_INTEGRATION_JOB;
+}
+
+void ThreadedDynamicsWorld::RunRigidBodyJobs(void (*workFunction)(const WorkItem*, unsigned))
+{
+    int numBodies = m_nonStaticRigidBodies.size();
+    unsigned numJobs = (unsigned)((numBodies + BODIES_PER_INTEGRATION_JOB - 1) / BODIES_PER_INTEGRATION_JOB);
+    bodyJobs_.Resize(numJobs);
+
+    for (unsigned i = 0; i < numJobs; ++i)
+    {
+        RigidBodyJob& job = bodyJobs_[i];
+        job.begin_ = i * BODIES_PER_INTEGRATION_JOB;
+        job.end_ = Min(job.begin_ + BODIES_PER_INTEGRATION_JOB, numBodies);
+        job.ccdBodies_.Clear();
+        AddWorkItem(workQueue_, workFunction, &job, this);
+    }
+
+    workQueue_->Complete(M_MAX_UNSIGNED);
+}
+
+}
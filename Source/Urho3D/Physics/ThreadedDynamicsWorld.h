@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/Vector.h"
+#include "../Core/Mutex.h"
+#include "../Core/Thread.h"
+
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcher.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btSimulationIslandManager.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+
+namespace Urho3D
+{
+
+class WorkQueue;
+
+struct WorkItem;
+
+/// Range of overlapping pairs processed by one narrowphase dispatch work item.
+struct CollisionDispatchJob
+{
+    /// Index of the first pair.
+    int begin_;
+    /// Index past the last pair.
+    int end_;
+    /// Contact manifolds created while processing the range, in creation order.
+    PODVector<btPersistentManifold*> newManifolds_;
+    /// Contact manifolds released while processing the range, in release order.
+    PODVector<btPersistentManifold*> releasedManifolds_;
+};
+
+/// Group of simulation islands solved together by one constraint solver work item.
+struct ConstraintSolverBatch
+{
+    /// Clear the batch.
+    void Clear()
+    {
+        bodies_.Clear();
+        manifolds_.Clear();
+        constraints_.Clear();
+    }
+
+    /// Return number of bodies, contact manifolds and constraints in the batch.
+    unsigned GetSize() const { return bodies_.Size() + manifolds_.Size() + constraints_.Size(); }
+
+    /// Collision objects of the islands.
+    PODVector<btCollisionObject*> bodies_;
+    /// Contact manifolds of the islands.
+    PODVector<btPersistentManifold*> manifolds_;
+    /// Constraints of the islands.
+    PODVector<btTypedConstraint*> constraints_;
+};
+
+/// Range of rigid bodies integrated by one work item.
+struct RigidBodyJob
+{
+    /// Index of the first body.
+    int begin_;
+    /// Index past the last body.
+    int end_;
+    /// Bodies in the range that need continuous collision detection, which is left to the calling thread.
+    PODVector<btRigidBody*> ccdBodies_;
+};
+
+/// Bullet collision dispatcher that can run the narrowphase of the overlapping pairs in parallel on the work queue.
+class URHO3D_API ThreadedCollisionDispatcher : public btCollisionDispatcher
+{
+public:
+    /// Construct.
+    ThreadedCollisionDispatcher(btCollisionConfiguration* collisionConfiguration);
+
+    /// Process all overlapping pairs. Splits the pairs into fixed-size ranges when a work queue is set, and orders the new contact manifolds by range afterward so that the result does not depend on thread timing.
+    virtual void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& dispatchInfo, btDispatcher* dispatcher);
+    /// Create a contact manifold.
+    virtual btPersistentManifold* getNewManifold(const btCollisionObject* body0, const btCollisionObject* body1);
+    /// Release a contact manifold. Deferred until the end of a parallel dispatch.
+    virtual void releaseManifold(btPersistentManifold* manifold);
+    /// Allocate memory for a collision algorithm.
+    virtual void* allocateCollisionAlgorithm(int size);
+    /// Free memory of a collision algorithm.
+    virtual void freeCollisionAlgorithm(void* ptr);
+
+    /// Set work queue to use, or null to process the pairs on the calling thread only.
+    void SetWorkQueue(WorkQueue* queue) { workQueue_ = queue; }
+    /// Set whether other threads run collision algorithms outside of a dispatch, such as batched scene queries. Guards the manifold and collision algorithm pools while enabled.
+    void SetConcurrentAccess(bool enable) { concurrentAccess_ = enable; }
+
+    /// Process a range of overlapping pairs. Called from the work queue.
+    void ProcessPairs(CollisionDispatchJob& job, unsigned threadIndex);
+
+    /// Return the work queue in use.
+    WorkQueue* GetWorkQueue() const { return workQueue_; }
+    /// Return whether concurrent access outside of a dispatch is enabled.
+    bool GetConcurrentAccess() const { return concurrentAccess_; }
+
+private:
+    /// Return the range being processed by the calling thread, or null if none. Must be called with the mutex held.
+    CollisionDispatchJob* GetCurrentJob() const;
+
+    /// Work queue.
+    WorkQueue* workQueue_;
+    /// Pair ranges of the current dispatch.
+    Vector<CollisionDispatchJob> jobs_;
+    /// Thread IDs by work queue thread index.
+    PODVector<ThreadID> threadIDs_;
+    /// Range being processed by work queue thread index.
+    PODVector<CollisionDispatchJob*> threadJobs_;
+    /// Overlapping pairs of the current dispatch.
+    btBroadphasePairArray* pairs_;
+    /// Dispatch info of the current dispatch.
+    const btDispatcherInfo* dispatchInfo_;
+    /// Mutex for the manifold and collision algorithm pools.
+    Mutex mutex_;
+    /// Parallel dispatch in progress flag.
+    bool dispatching_;
+    /// Concurrent access outside of a dispatch flag.
+    bool concurrentAccess_;
+};
+
+/// Bullet discrete dynamics world that can solve simulation islands and integrate rigid bodies in parallel on the work queue.
+class URHO3D_API ThreadedDynamicsWorld : public btDiscreteDynamicsWorld, public btSimulationIslandManager::IslandCallback
+{
+public:
+    /// Construct.
+    ThreadedDynamicsWorld(btDispatcher* dispatcher, btBroadphaseInterface* pairCache, btConstraintSolver* constraintSolver,
+        btCollisionConfiguration* collisionConfiguration);
+    /// Destruct.
+    virtual ~ThreadedDynamicsWorld();
+
+    /// Collect a simulation island into the solver batches.
+    virtual void processIsland(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds, int islandId);
+
+    /// Set work queue to use, or null to simulate on the calling thread only.
+    void SetWorkQueue(WorkQueue* queue) { workQueue_ = queue; }
+
+    /// Solve a batch of simulation islands. Called from the work queue.
+    void SolveBatch(ConstraintSolverBatch& batch, unsigned threadIndex);
+    /// Apply damping and predict the unconstrained motion of a range of rigid bodies. Called from the work queue.
+    void PredictMotion(RigidBodyJob& job);
+    /// Integrate the transforms of a range of rigid bodies. Called from the work queue.
+    void IntegrateTransforms(RigidBodyJob& job);
+
+    /// Return the work queue in use.
+    WorkQueue* GetWorkQueue() const { return workQueue_; }
+
+protected:
+    /// Predict the unconstrained motion of all rigid bodies.
+    virtual void predictUnconstraintMotion(btScalar timeStep);
+    /// Integrate the transforms of all rigid bodies.
+    virtual void integrateTransforms(btScalar timeStep);
+    /// Solve the contact and joint constraints of all active simulation islands.
+    virtual void solveConstraints(btContactSolverInfo& solverInfo);
+
+private:
+    /// Return whether to run a stage in parallel over the given number of rigid bodies.
+    bool IsParallel(int numBodies) const;
+    /// Split the rigid bodies into ranges and run a work function on each of them.
+    void RunRigidBodyJobs(void (*workFunction)(const WorkItem*, unsigned));
+
+    /// Work queue.
+    WorkQueue* workQueue_;
+    /// Constraint solvers by work queue thread index. The first one is the world's own solver.
+    PODVector<btConstraintSolver*> solvers_;
+    /// Solver batches of the islands that do not touch kinematic bodies.
+    Vector<ConstraintSolverBatch> batches_;
+    /// Number of batches in use.
+    unsigned numBatches_;
+    /// Solver batch of the islands that touch kinematic bodies. Solved as one, as the solver writes to the kinematic bodies.
+    ConstraintSolverBatch kinematicBatch_;
+    /// Rigid body ranges of the current stage.
+    Vector<RigidBodyJob> bodyJobs_;
+    /// Rigid bodies kept aside while the continuous collision detection is done on the calling thread.
+    btAlignedObjectArray<btRigidBody*> allBodies_;
+    /// Solver info of the current step.
+    btContactSolverInfo* solverInfo_;
+    /// Time step of the current step.
+    btScalar timeStep_;
+};
+
+}
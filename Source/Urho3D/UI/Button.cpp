@@ -149,11 +149,13 @@ void Button::OnKey(int key, int buttons, int qualifiers)
 void Button::SetPressedOffset(const IntVector2& offset)
 {
     pressedOffset_ = offset;
+    MarkBatchesDirty();
 }
 
 void Button::SetPressedOffset(int x, int y)
 {
     pressedOffset_ = IntVector2(x, y);
+    MarkBatchesDirty();
 }
 
 void Button::SetPressedChildOffset(const IntVector2& offset)
@@ -186,6 +188,7 @@ void Button::SetPressed(bool enable)
 {
     pressed_ = enable;
     SetChildOffset(pressed_ ? pressedChildOffset_ : IntVector2::ZERO);
+    MarkBatchesDirty();
 }
 
 }
@@ -41,7 +41,8 @@ FontGlyph::FontGlyph() :
 }
 
 FontFace::FontFace(Font* font) :
-    font_(font)
+    font_(font),
+    glyphVersion_(0)
 {
 }
 
@@ -59,15 +60,10 @@ FontFace::~FontFace()
 
 const FontGlyph* FontFace::GetGlyph(unsigned c)
 {
-    HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
-    if (i != glyphMapping_.End())
-    {
-        FontGlyph& glyph = i->second_;
-        glyph.used_ = true;
-        return &glyph;
-    }
-    else
-        return 0;
+    FontGlyph* glyph = FindGlyph(c);
+    if (glyph)
+        glyph->used_ = true;
+    return glyph;
 }
 
 short FontFace::GetKerning(unsigned c, unsigned d) const
@@ -112,6 +108,29 @@ SharedPtr<Texture2D> FontFace::CreateFaceTexture()
     return texture;
 }
 
+FontGlyph* FontFace::FindGlyph(unsigned c)
+{
+    if (c < glyphTable_.Size() && glyphTable_[c])
+        return glyphTable_[c];
+
+    HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
+    if (i == glyphMapping_.End())
+        return 0;
+
+    // Glyphs are never removed from the mapping, so the table can hold pointers to them
+    if (c < FONT_GLYPH_TABLE_SIZE)
+    {
+        if (glyphTable_.Empty())
+        {
+            glyphTable_.Resize(FONT_GLYPH_TABLE_SIZE);
+            memset(&glyphTable_[0], 0, FONT_GLYPH_TABLE_SIZE * sizeof(FontGlyph*));
+        }
+        glyphTable_[c] = &i->second_;
+    }
+
+    return &i->second_;
+}
+
 SharedPtr<Texture2D> FontFace::LoadFaceTexture(SharedPtr<Image> image)
 {
     SharedPtr<Texture2D> texture = CreateFaceTexture();
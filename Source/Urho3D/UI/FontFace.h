@@ -33,6 +33,9 @@ class Font;
 class Image;
 class Texture2D;
 
+/// Number of code points, starting from zero, that are looked up from a flat table instead of the glyph mapping.
+static const unsigned FONT_GLYPH_TABLE_SIZE = 256;
+
 /// %Font glyph description.
 struct FontGlyph
 {
@@ -92,17 +95,24 @@ public:
     /// Return textures.
     const Vector<SharedPtr<Texture2D> >& GetTextures() const { return textures_; }
 
+    /// Return counter that changes whenever glyphs become resident on or are evicted from the textures.
+    unsigned GetGlyphVersion() const { return glyphVersion_; }
+
 protected:
     friend class FontFaceBitmap;
     /// Create a texture for font rendering.
     SharedPtr<Texture2D> CreateFaceTexture();
     /// Load font face texture from image resource.
     SharedPtr<Texture2D> LoadFaceTexture(SharedPtr<Image> image);
+    /// Return glyph structure corresponding to a character without marking it used. Return null if glyph not found.
+    FontGlyph* FindGlyph(unsigned c);
 
     /// Parent font.
     Font* font_;
     /// Glyph mapping.
     HashMap<unsigned, FontGlyph> glyphMapping_;
+    /// Flat lookup table of glyphs for the first code points, pointing into the glyph mapping. Filled as glyphs are looked up.
+    PODVector<FontGlyph*> glyphTable_;
     /// Kerning mapping.
     HashMap<unsigned, short> kerningMapping_;
     /// Glyph texture pages.
@@ -111,6 +121,8 @@ protected:
     int pointSize_;
     /// Row height.
     int rowHeight_;
+    /// Glyph residency counter.
+    unsigned glyphVersion_;
 };
 
 }
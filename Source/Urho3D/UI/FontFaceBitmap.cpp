@@ -191,8 +191,10 @@ bool FontFaceBitmap::Load(FontFace* fontFace, bool usedGlyphs)
 
     for (HashMap<unsigned, FontGlyph>::ConstIterator i = fontFace->glyphMapping_.Begin(); i != fontFace->glyphMapping_.End(); ++i)
     {
+        // Skip glyphs that have pixels but are not resident on any texture, such as mutable glyphs still waiting for
+        // rasterization or evicted, as there is nothing to copy
         FontGlyph fontGlyph = i->second_;
-        if (!fontGlyph.used_)
+        if (!fontGlyph.used_ || (fontGlyph.width_ && fontGlyph.height_ && fontGlyph.page_ >= fontFace->textures_.Size()))
             continue;
 
         int x, y;
@@ -243,6 +245,8 @@ bool FontFaceBitmap::Load(FontFace* fontFace, bool usedGlyphs)
     {
         FontGlyph& newGlyph = i->second_;
         const FontGlyph& oldGlyph = fontFace->glyphMapping_[i->first_];
+        if (!oldGlyph.width_ || !oldGlyph.height_)
+            continue;
         Blit(newImages[newGlyph.page_], newGlyph.x_, newGlyph.y_, newGlyph.width_, newGlyph.height_, oldImages[oldGlyph.page_],
             oldGlyph.x_, oldGlyph.y_, components);
     }
@@ -23,6 +23,9 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Texture2D.h"
 #include "../IO/FileSystem.h"
@@ -46,6 +49,110 @@ inline int RoundToPixels(FT_Pos value)
     return (int)(value >> 6) + (((value & 0x3f) >= 0x20) ? 1 : 0);
 }
 
+/// Fill glyph metrics from a loaded glyph slot. Position within texture is not set.
+static void SetGlyphMetrics(FontGlyph& glyph, FT_GlyphSlot slot, int ascender)
+{
+    glyph.width_ = (short)Max(RoundToPixels(slot->metrics.width), (int)slot->bitmap.width);
+    glyph.height_ = (short)Max(RoundToPixels(slot->metrics.height), (int)slot->bitmap.rows);
+    glyph.offsetX_ = (short)(RoundToPixels(slot->metrics.horiBearingX));
+    glyph.offsetY_ = (short)(ascender - RoundToPixels(slot->metrics.horiBearingY));
+    glyph.advanceX_ = (short)(slot->metrics.horiAdvance >> 6);
+}
+
+/// Copy a rendered glyph bitmap into 8-bit image data.
+static void CopyGlyphBitmap(FT_GlyphSlot slot, unsigned char* dest, unsigned pitch)
+{
+    if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
+    {
+        for (unsigned int y = 0; y < slot->bitmap.rows; ++y)
+        {
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + y * pitch;
+
+            for (unsigned int x = 0; x < slot->bitmap.width; ++x)
+                rowDest[x] = (unsigned char)((src[x >> 3] & (0x80 >> (x & 7))) ? 255 : 0);
+        }
+    }
+    else
+    {
+        for (unsigned int y = 0; y < slot->bitmap.rows; ++y)
+        {
+            unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
+            unsigned char* rowDest = dest + y * pitch;
+
+            for (unsigned int x = 0; x < slot->bitmap.width; ++x)
+                rowDest[x] = src[x];
+        }
+    }
+}
+
+/// Glyph to be rasterized in the background.
+struct GlyphRasterTarget
+{
+    /// Character code.
+    unsigned charCode_;
+    /// Texture index.
+    unsigned texture_;
+    /// X position in texture.
+    short x_;
+    /// Y position in texture.
+    short y_;
+    /// Width.
+    short width_;
+    /// Height.
+    short height_;
+    /// Destination in the texture image.
+    unsigned char* dest_;
+    /// Texture image row pitch.
+    unsigned pitch_;
+};
+
+/// Background glyph rasterization job.
+struct GlyphRasterJob : public RefCounted
+{
+    /// Construct.
+    GlyphRasterJob() :
+        face_(0),
+        loadMode_(FT_LOAD_DEFAULT),
+        completed_(false)
+    {
+    }
+
+    /// FreeType face to rasterize with.
+    void* face_;
+    /// FreeType load mode.
+    int loadMode_;
+    /// Glyphs to rasterize.
+    PODVector<GlyphRasterTarget> glyphs_;
+    /// Work item.
+    SharedPtr<WorkItem> workItem_;
+    /// Completed flag.
+    volatile bool completed_;
+};
+
+static void RasterizeGlyphsWork(const WorkItem* item, unsigned threadIndex)
+{
+    GlyphRasterJob* job = reinterpret_cast<GlyphRasterJob*>(item->aux_);
+    FT_Face face = (FT_Face)job->face_;
+
+    for (unsigned i = 0; i < job->glyphs_.Size(); ++i)
+    {
+        const GlyphRasterTarget& target = job->glyphs_[i];
+
+        // Clear the area including padding first, as it may still hold an evicted glyph
+        for (int y = 0; y <= target.height_; ++y)
+            memset(target.dest_ + y * target.pitch_, 0, (size_t)(target.width_ + 1));
+
+        if (!FT_Load_Char(face, target.charCode_, job->loadMode_))
+        {
+            FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+            CopyGlyphBitmap(face->glyph, target.dest_, target.pitch_);
+        }
+    }
+
+    job->completed_ = true;
+}
+
 /// FreeType library subsystem.
 class FreeTypeLibrary : public Object
 {
@@ -59,6 +166,8 @@ public:
         FT_Error error = FT_Init_FreeType(&library_);
         if (error)
             URHO3D_LOGERROR("Could not initialize FreeType library");
+
+        SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(FreeTypeLibrary, HandleEndFrame));
     }
 
     /// Destruct.
@@ -67,22 +176,61 @@ public:
         FT_Done_FreeType(library_);
     }
 
+    /// Add a font face that uses mutable glyphs, to be updated each frame.
+    void AddMutableFace(FontFaceFreeType* face)
+    {
+        mutableFaces_.Push(WeakPtr<FontFaceFreeType>(face));
+    }
+
     FT_Library GetLibrary() const { return library_; }
 
 private:
+    /// Handle frame end event. Upload glyphs rasterized in the background and rasterize newly requested glyphs.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData)
+    {
+        for (Vector<WeakPtr<FontFaceFreeType> >::Iterator i = mutableFaces_.Begin(); i != mutableFaces_.End();)
+        {
+            if (i->Expired())
+                i = mutableFaces_.Erase(i);
+            else
+            {
+                (*i)->UpdateGlyphs();
+                ++i;
+            }
+        }
+    }
+
     /// FreeType library.
     FT_Library library_;
+    /// Font faces using mutable glyphs.
+    Vector<WeakPtr<FontFaceFreeType> > mutableFaces_;
 };
 
 FontFaceFreeType::FontFaceFreeType(Font* font) :
     FontFace(font),
     face_(0),
-    loadMode_(FT_LOAD_DEFAULT)
+    loadMode_(FT_LOAD_DEFAULT),
+    rasterLibrary_(0),
+    rasterFace_(0),
+    currentTexture_(0),
+    frameNumber_(0)
 {
 }
 
 FontFaceFreeType::~FontFaceFreeType()
 {
+    CompleteRasterization();
+
+    if (rasterFace_)
+    {
+        FT_Done_Face((FT_Face)rasterFace_);
+        rasterFace_ = 0;
+    }
+    if (rasterLibrary_)
+    {
+        FT_Done_FreeType((FT_Library)rasterLibrary_);
+        rasterLibrary_ = 0;
+    }
     if (face_)
     {
         FT_Done_Face((FT_Face)face_);
@@ -283,33 +431,178 @@ bool FontFaceFreeType::Load(const unsigned char* fontData, unsigned fontDataSize
         hasMutableGlyph_ = false;
     }
     else
+    {
         hasMutableGlyph_ = true;
 
+        // Keep the texture contents, so that further glyphs can be rasterized into them
+        textureImages_.Push(image);
+        textureLastUse_.Push(0);
+        currentTexture_ = 0;
+
+        // Rasterize in the background with a separate library and face, as FreeType objects must not be used from two
+        // threads at once
+        FT_Library rasterLibrary;
+        if (!FT_Init_FreeType(&rasterLibrary))
+        {
+            rasterLibrary_ = rasterLibrary;
+            FT_Face rasterFace;
+            if (!FT_New_Memory_Face(rasterLibrary, fontData, fontDataSize, 0, &rasterFace))
+            {
+                rasterFace_ = rasterFace;
+                FT_Set_Char_Size(rasterFace, 0, pointSize * 64, FONT_DPI, FONT_DPI);
+            }
+        }
+        if (!rasterFace_)
+            URHO3D_LOGWARNING("Could not create font face for background glyph rasterization, rasterizing on the main thread");
+
+        freeType->AddMutableFace(this);
+    }
+
     return true;
 }
 
 const FontGlyph* FontFaceFreeType::GetGlyph(unsigned c)
 {
-    HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
-    if (i != glyphMapping_.End())
+    FontGlyph* glyph = FindGlyph(c);
+    if (!glyph && LoadCharGlyphMetrics(c))
+        glyph = FindGlyph(c);
+    if (!glyph)
+        return 0;
+
+    glyph->used_ = true;
+    // Glyphs with no pixels, such as space, have no texture
+    if (!glyph->width_ || !glyph->height_)
+        return glyph;
+
+    if (glyph->page_ < textureLastUse_.Size())
+        textureLastUse_[glyph->page_] = frameNumber_;
+    else if (hasMutableGlyph_ && !pendingGlyphs_.Contains(c))
     {
-        FontGlyph& glyph = i->second_;
-        glyph.used_ = true;
-        return &glyph;
+        // Not resident on any texture yet or evicted: queue for rasterization. Until then the glyph is laid out, but not
+        // rendered
+        pendingGlyphs_.Insert(c);
+        requestedGlyphs_.Push(c);
     }
 
-    if (LoadCharGlyph(c))
+    return glyph;
+}
+
+void FontFaceFreeType::UpdateGlyphs()
+{
+    ++frameNumber_;
+
+    if (rasterJob_)
     {
-        HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Find(c);
-        if (i != glyphMapping_.End())
+        if (!rasterJob_->completed_)
+            return;
+
+        // Make the rasterized glyphs resident and find the changed area of each texture
+        PODVector<IntRect> dirtyRects(textures_.Size());
+        for (unsigned i = 0; i < dirtyRects.Size(); ++i)
+            dirtyRects[i] = IntRect(M_MAX_INT, M_MAX_INT, M_MIN_INT, M_MIN_INT);
+
+        const PODVector<GlyphRasterTarget>& glyphs = rasterJob_->glyphs_;
+        for (unsigned i = 0; i < glyphs.Size(); ++i)
         {
-            FontGlyph& glyph = i->second_;
-            glyph.used_ = true;
-            return &glyph;
+            const GlyphRasterTarget& target = glyphs[i];
+            pendingGlyphs_.Erase(target.charCode_);
+
+            FontGlyph* glyph = FindGlyph(target.charCode_);
+            if (!glyph)
+                continue;
+            glyph->x_ = target.x_;
+            glyph->y_ = target.y_;
+            glyph->page_ = target.texture_;
+
+            IntRect& rect = dirtyRects[target.texture_];
+            rect.left_ = Min(rect.left_, (int)target.x_);
+            rect.top_ = Min(rect.top_, (int)target.y_);
+            rect.right_ = Max(rect.right_, target.x_ + target.width_ + 1);
+            rect.bottom_ = Max(rect.bottom_, target.y_ + target.height_ + 1);
         }
+
+        // Upload only the changed area of each texture
+        PODVector<unsigned char> uploadData;
+        for (unsigned i = 0; i < dirtyRects.Size(); ++i)
+        {
+            const IntRect& rect = dirtyRects[i];
+            if (rect.left_ >= rect.right_)
+                continue;
+
+            Image* image = textureImages_[i];
+            int width = rect.Width();
+            int height = rect.Height();
+            uploadData.Resize((unsigned)(width * height));
+            for (int y = 0; y < height; ++y)
+                memcpy(&uploadData[y * width], image->GetData() + (rect.top_ + y) * image->GetWidth() + rect.left_, (size_t)width);
+            textures_[i]->SetData(0, rect.left_, rect.top_, width, height, &uploadData[0]);
+        }
+
+        rasterJob_.Reset();
+        ++glyphVersion_;
     }
 
-    return 0;
+    if (requestedGlyphs_.Empty())
+        return;
+
+    SharedPtr<GlyphRasterJob> job(new GlyphRasterJob());
+    job->face_ = rasterFace_ ? rasterFace_ : face_;
+    job->loadMode_ = loadMode_;
+
+    bool evicted = false;
+    for (unsigned i = 0; i < requestedGlyphs_.Size(); ++i)
+    {
+        unsigned charCode = requestedGlyphs_[i];
+        FontGlyph* glyph = FindGlyph(charCode);
+        GlyphRasterTarget target;
+        int x, y;
+
+        // If there is no space, forget the request. Texture use is tracked per frame, so the glyph will be requested again
+        // once textures can be evicted
+        if (!glyph || !AllocateGlyphArea(glyph->width_ + 1, glyph->height_ + 1, target.texture_, x, y, evicted))
+        {
+            pendingGlyphs_.Erase(charCode);
+            continue;
+        }
+        textureLastUse_[target.texture_] = frameNumber_;
+
+        Image* image = textureImages_[target.texture_];
+        target.charCode_ = charCode;
+        target.x_ = (short)x;
+        target.y_ = (short)y;
+        target.width_ = glyph->width_;
+        target.height_ = glyph->height_;
+        target.dest_ = image->GetData() + y * image->GetWidth() + x;
+        target.pitch_ = (unsigned)image->GetWidth();
+        job->glyphs_.Push(target);
+    }
+    requestedGlyphs_.Clear();
+
+    // Let text elements drop the evicted glyphs
+    if (evicted)
+        ++glyphVersion_;
+
+    if (job->glyphs_.Empty())
+        return;
+
+    rasterJob_ = job;
+
+    WorkQueue* queue = font_->GetSubsystem<WorkQueue>();
+    if (!rasterFace_ || !queue)
+    {
+        WorkItem item;
+        item.aux_ = job;
+        RasterizeGlyphsWork(&item, 0);
+        return;
+    }
+
+    // Use a non-pooled work item, so that it can safely be removed from the queue later
+    SharedPtr<WorkItem> item(new WorkItem());
+    item->workFunction_ = RasterizeGlyphsWork;
+    item->aux_ = job;
+    item->priority_ = 0;
+    job->workItem_ = item;
+    queue->AddWorkItem(item);
 }
 
 bool FontFaceFreeType::CanLoadAllGlyphs(const PODVector<unsigned>& charCodes, int& textureWidth, int& textureHeight) const
@@ -353,6 +646,9 @@ bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
         return false;
 
     textures_.Push(texture);
+    textureImages_.Push(image);
+    textureLastUse_.Push(frameNumber_);
+    currentTexture_ = textures_.Size() - 1;
     allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textureWidth, textureHeight);
 
     font_->SetMemoryUse(font_->GetMemoryUse() + textureWidth * textureHeight);
@@ -360,6 +656,78 @@ bool FontFaceFreeType::SetupNextTexture(int textureWidth, int textureHeight)
     return true;
 }
 
+bool FontFaceFreeType::AllocateGlyphArea(int width, int height, unsigned& texture, int& x, int& y, bool& evicted)
+{
+    if (allocator_.Allocate(width, height, x, y))
+    {
+        texture = currentTexture_;
+        return true;
+    }
+
+    UI* ui = font_->GetSubsystem<UI>();
+    if (textures_.Size() < ui->GetMaxFontTextures())
+    {
+        if (!SetupNextTexture(allocator_.GetWidth(), allocator_.GetHeight()))
+            return false;
+    }
+    else
+    {
+        // Evict the least recently used texture, but not one used during this or the previous frame. The frame number is
+        // advanced at the end of a frame, so the glyphs of the frame just rendered are marked with the previous number
+        unsigned oldest = M_MAX_UNSIGNED;
+        for (unsigned i = 0; i < textureLastUse_.Size(); ++i)
+        {
+            if (frameNumber_ - textureLastUse_[i] > 1 && (oldest == M_MAX_UNSIGNED || textureLastUse_[i] < textureLastUse_[oldest]))
+                oldest = i;
+        }
+        if (oldest == M_MAX_UNSIGNED)
+            return false;
+
+        if (EvictTexture(oldest))
+            evicted = true;
+    }
+
+    if (!allocator_.Allocate(width, height, x, y))
+        return false;
+
+    texture = currentTexture_;
+    return true;
+}
+
+bool FontFaceFreeType::EvictTexture(unsigned index)
+{
+    bool resident = false;
+    for (HashMap<unsigned, FontGlyph>::Iterator i = glyphMapping_.Begin(); i != glyphMapping_.End(); ++i)
+    {
+        FontGlyph& glyph = i->second_;
+        if (glyph.page_ == index)
+        {
+            glyph.page_ = M_MAX_UNSIGNED;
+            resident = true;
+        }
+    }
+
+    currentTexture_ = index;
+    allocator_.Reset(FONT_TEXTURE_MIN_SIZE, FONT_TEXTURE_MIN_SIZE, textures_[index]->GetWidth(), textures_[index]->GetHeight());
+    return resident;
+}
+
+void FontFaceFreeType::CompleteRasterization()
+{
+    if (!rasterJob_ || !rasterJob_->workItem_)
+        return;
+
+    // If the job is already running in a worker thread, wait for it to finish
+    WorkQueue* queue = font_ ? font_->GetSubsystem<WorkQueue>() : (WorkQueue*)0;
+    if (!queue || !queue->RemoveWorkItem(rasterJob_->workItem_))
+    {
+        while (!rasterJob_->completed_)
+            Time::Sleep(0);
+    }
+
+    rasterJob_.Reset();
+}
+
 bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
 {
     if (!face_)
@@ -373,77 +741,26 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
     if (!error)
     {
         // Note: position within texture will be filled later
-        fontGlyph.width_ = (short)Max(RoundToPixels(slot->metrics.width), (int)slot->bitmap.width);
-        fontGlyph.height_ = (short)Max(RoundToPixels(slot->metrics.height), (int)slot->bitmap.rows);
-        fontGlyph.offsetX_ = (short)(RoundToPixels(slot->metrics.horiBearingX));
-        fontGlyph.offsetY_ = (short)(ascender_ - RoundToPixels(slot->metrics.horiBearingY));
-        fontGlyph.advanceX_ = (short)(slot->metrics.horiAdvance >> 6);
+        SetGlyphMetrics(fontGlyph, slot, ascender_);
 
         if (fontGlyph.width_ > 0 && fontGlyph.height_ > 0)
         {
             int x, y;
             if (!allocator_.Allocate(fontGlyph.width_ + 1, fontGlyph.height_ + 1, x, y))
-            {
-                if (!SetupNextTexture(allocator_.GetWidth(), allocator_.GetHeight()))
-                    return false;
-
-                if (!allocator_.Allocate(fontGlyph.width_ + 1, fontGlyph.height_ + 1, x, y))
-                    return false;
-            }
+                return false;
 
             fontGlyph.x_ = (short)x;
             fontGlyph.y_ = (short)y;
-
-            unsigned char* dest = 0;
-            unsigned pitch = 0;
-            if (image)
-            {
-                fontGlyph.page_ = 0;
-                dest = image->GetData() + fontGlyph.y_ * image->GetWidth() + fontGlyph.x_;
-                pitch = (unsigned)image->GetWidth();
-            }
-            else
-            {
-                fontGlyph.page_ = textures_.Size() - 1;
-                dest = new unsigned char[fontGlyph.width_ * fontGlyph.height_];
-                pitch = (unsigned)fontGlyph.width_;
-            }
+            fontGlyph.page_ = 0;
 
             FT_Render_Glyph(slot, FT_RENDER_MODE_NORMAL);
-            if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_MONO)
-            {
-                for (unsigned int y = 0; y < slot->bitmap.rows; ++y)
-                {
-                    unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                    unsigned char* rowDest = dest + y * pitch;
-
-                    for (unsigned int x = 0; x < slot->bitmap.width; ++x)
-                        rowDest[x] = (unsigned char)((src[x >> 3] & (0x80 >> (x & 7))) ? 255 : 0);
-                }
-            }
-            else
-            {
-                for (unsigned int y = 0; y < slot->bitmap.rows; ++y)
-                {
-                    unsigned char* src = slot->bitmap.buffer + slot->bitmap.pitch * y;
-                    unsigned char* rowDest = dest + y * pitch;
-
-                    for (unsigned int x = 0; x < slot->bitmap.width; ++x)
-                        rowDest[x] = src[x];
-                }
-            }
-
-            if (!image)
-            {
-                textures_.Back()->SetData(0, fontGlyph.x_, fontGlyph.y_, fontGlyph.width_, fontGlyph.height_, dest);
-                delete[] dest;
-            }
+            CopyGlyphBitmap(slot, image->GetData() + fontGlyph.y_ * image->GetWidth() + fontGlyph.x_, (unsigned)image->GetWidth());
         }
         else
         {
             fontGlyph.x_ = 0;
             fontGlyph.y_ = 0;
-            fontGlyph.page_ = 0;
+            fontGlyph.page_ = M_MAX_UNSIGNED;
         }
     }
     else
@@ -453,9 +770,37 @@ bool FontFaceFreeType::LoadCharGlyph(unsigned charCode, Image* image)
         fontGlyph.offsetX_ = 0;
         fontGlyph.offsetY_ = 0;
         fontGlyph.advanceX_ = 0;
-        fontGlyph.page_ = 0;
+        fontGlyph.page_ = M_MAX_UNSIGNED;
+    }
+
+    glyphMapping_[charCode] = fontGlyph;
+
+    return true;
+}
+
+bool FontFaceFreeType::LoadCharGlyphMetrics(unsigned charCode)
+{
+    if (!face_)
+        return false;
+
+    FT_Face face = (FT_Face)face_;
+
+    FontGlyph fontGlyph;
+    fontGlyph.x_ = 0;
+    fontGlyph.y_ = 0;
+    if (!FT_Load_Char(face, charCode, loadMode_))
+        SetGlyphMetrics(fontGlyph, face->glyph, ascender_);
+    else
+    {
+        fontGlyph.width_ = 0;
+        fontGlyph.height_ = 0;
+        fontGlyph.offsetX_ = 0;
+        fontGlyph.offsetY_ = 0;
+        fontGlyph.advanceX_ = 0;
     }
 
+    // Glyphs with no pixels never get a texture, others once rasterized
+    fontGlyph.page_ = M_MAX_UNSIGNED;
     glyphMapping_[charCode] = fontGlyph;
 
     return true;
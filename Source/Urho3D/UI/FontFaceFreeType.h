@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Container/HashSet.h"
 #include "../UI/FontFace.h"
 
 namespace Urho3D
@@ -29,6 +30,7 @@ namespace Urho3D
 
 class FreeTypeLibrary;
 class Texture2D;
+struct GlyphRasterJob;
 
 /// Free type font face description.
 class URHO3D_API FontFaceFreeType : public FontFace
@@ -47,13 +49,24 @@ public:
     /// Return if font face uses mutable glyphs.
     virtual bool HasMutableGlyphs() const { return hasMutableGlyph_; }
 
+    /// Upload the glyphs rasterized in the background and start rasterizing the glyphs requested since. Called once per frame in mutable glyph mode.
+    void UpdateGlyphs();
+
 private:
     /// Check can load all glyph in one texture, return true and texture size if can load.
     bool CanLoadAllGlyphs(const PODVector<unsigned>& charCodes, int& textureWidth, int& textureHeight) const;
     /// Setup next texture.
     bool SetupNextTexture(int textureWidth, int textureHeight);
-    /// Load char glyph.
-    bool LoadCharGlyph(unsigned charCode, Image* image = 0);
+    /// Load char glyph into an image.
+    bool LoadCharGlyph(unsigned charCode, Image* image);
+    /// Load char glyph metrics only. The glyph is rasterized in the background once used.
+    bool LoadCharGlyphMetrics(unsigned charCode);
+    /// Allocate texture area for a glyph, evicting the least recently used texture if all are full. Set the evicted flag if resident glyphs were dropped. Return true if successful.
+    bool AllocateGlyphArea(int width, int height, unsigned& texture, int& x, int& y, bool& evicted);
+    /// Evict all glyphs from a texture and start filling it again. Return true if any glyphs were resident on it.
+    bool EvictTexture(unsigned index);
+    /// Wait for the background rasterization to finish.
+    void CompleteRasterization();
 
     /// FreeType library.
     SharedPtr<FreeTypeLibrary> freeType_;
@@ -67,6 +80,24 @@ private:
     bool hasMutableGlyph_;
     /// Glyph area allocator.
     AreaAllocator allocator_;
+    /// FreeType library used by the background rasterization. Separate from the main thread library, as FreeType objects must not be used from two threads at once.
+    void* rasterLibrary_;
+    /// FreeType face used by the background rasterization.
+    void* rasterFace_;
+    /// Images holding the texture contents in mutable glyph mode. Written by the background rasterization.
+    Vector<SharedPtr<Image> > textureImages_;
+    /// Frame number each texture was last used on, for least recently used eviction.
+    PODVector<unsigned> textureLastUse_;
+    /// Texture the glyph area allocator is filling.
+    unsigned currentTexture_;
+    /// Frame number.
+    unsigned frameNumber_;
+    /// Glyphs waiting for or undergoing rasterization.
+    HashSet<unsigned> pendingGlyphs_;
+    /// Glyphs requested since the last rasterization job was started.
+    PODVector<unsigned> requestedGlyphs_;
+    /// Rasterization job in progress.
+    SharedPtr<GlyphRasterJob> rasterJob_;
 };
 
 }
@@ -171,7 +171,13 @@ ListView::ListView(Context* context) :
     hierarchyMode_(true),    // Init to true here so that the setter below takes effect
     baseIndent_(0),
     clearSelectionOnDefocus_(false),
-    selectOnClickEnd_(false)
+    selectOnClickEnd_(false),
+    virtualMode_(false),
+    virtualItemCount_(0),
+    virtualItemHeight_(0),
+    virtualRowHeight_(0),
+    virtualNumSlots_(0),
+    virtualItemType_(Text::GetTypeStatic())
 {
     resizeContentWidth_ = true;
 
@@ -182,6 +188,7 @@ ListView::ListView(Context* context) :
     SubscribeToEvent(E_FOCUSCHANGED, URHO3D_HANDLER(ListView, HandleItemFocusChanged));
     SubscribeToEvent(this, E_DEFOCUSED, URHO3D_HANDLER(ListView, HandleFocusChanged));
     SubscribeToEvent(this, E_FOCUSED, URHO3D_HANDLER(ListView, HandleFocusChanged));
+    SubscribeToEvent(this, E_VIEWCHANGED, URHO3D_HANDLER(ListView, HandleViewChanged));
 
     UpdateUIClickSubscription();
 }
@@ -259,6 +266,13 @@ void ListView::OnKey(int key, int buttons, int qualifiers)
 
         case KEY_PAGEDOWN:
             {
+                if (virtualMode_)
+                {
+                    // All rows have the same height in virtual mode
+                    delta = pageDirection * Max((int)(pageStep_ * scrollPanel_->GetHeight()) / Max(virtualRowHeight_, 1) - 1, 1);
+                    break;
+                }
+
                 // Convert page step to pixels and see how many items have to be skipped to reach that many pixels
                 if (selection == M_MAX_UNSIGNED)
                     selection = 0;      // Assume as if first item is selected
@@ -321,6 +335,8 @@ void ListView::OnResize()
     // When in hierarchy mode also need to resize the overlay container
     if (hierarchyMode_)
         overlayContainer_->SetSize(scrollPanel_->GetSize());
+
+    UpdateVirtualItems();
 }
 
 void ListView::AddItem(UIElement* item)
@@ -333,6 +349,12 @@ void ListView::InsertItem(unsigned index, UIElement* item, UIElement* parentItem
     if (!item || item->GetParent() == contentElement_)
         return;
 
+    if (virtualMode_)
+    {
+        URHO3D_LOGERROR("Can not insert items to a list view in virtual mode");
+        return;
+    }
+
     // Enable input so that clicking the item can be detected
     item->SetEnabled(true);
     item->SetSelected(false);
@@ -393,6 +415,12 @@ void ListView::RemoveItem(UIElement* item, unsigned index)
     if (!item)
         return;
 
+    if (virtualMode_)
+    {
+        URHO3D_LOGERROR("Can not remove items from a list view in virtual mode");
+        return;
+    }
+
     unsigned numItems = GetNumItems();
     for (unsigned i = index; i < numItems; ++i)
     {
@@ -471,6 +499,13 @@ void ListView::RemoveItem(unsigned index)
 
 void ListView::RemoveAllItems()
 {
+    if (virtualMode_)
+    {
+        ClearSelection();
+        SetVirtualItemCount(0);
+        return;
+    }
+
     contentElement_->DisableLayoutUpdate();
 
     ClearSelection();
@@ -655,8 +690,7 @@ void ListView::ChangeSelection(int delta, bool additive)
         if (newSelection >= numItems)
             break;
 
-        UIElement* item = GetItem(newSelection);
-        if (item->IsVisible())
+        if (virtualMode_ || GetItem(newSelection)->IsVisible())
         {
             indices.Push(okSelection = newSelection);
             delta -= direction;
@@ -690,6 +724,10 @@ void ListView::SetHierarchyMode(bool enable)
     if (enable == hierarchyMode_)
         return;
 
+    // The content element is recreated below, so leave virtual mode first
+    if (enable)
+        SetVirtualMode(false);
+
     hierarchyMode_ = enable;
     UIElement* container;
     if (enable)
@@ -746,6 +784,84 @@ void ListView::SetSelectOnClickEnd(bool enable)
     }
 }
 
+void ListView::SetVirtualMode(bool enable)
+{
+    if (enable == virtualMode_)
+        return;
+
+    if (enable)
+        SetHierarchyMode(false);
+    RemoveAllItems();
+
+    virtualMode_ = enable;
+    virtualItemCount_ = 0;
+    virtualRowHeight_ = virtualItemHeight_;
+    virtualNumSlots_ = 0;
+    virtualItemIndices_.Clear();
+
+    contentElement_->RemoveAllChildren();
+    // In virtual mode the item elements are positioned manually, and the content element is sized to hold all rows
+    contentElement_->SetLayoutMode(enable ? LM_FREE : LM_VERTICAL);
+    if (enable)
+        contentElement_->SetHeight(0);
+}
+
+void ListView::SetVirtualItemCount(unsigned count)
+{
+    if (!virtualMode_)
+    {
+        URHO3D_LOGERROR("Virtual item count can only be set in virtual mode");
+        return;
+    }
+
+    virtualItemCount_ = count;
+
+    // Drop selections that are no longer within the list
+    if (!selections_.Empty() && selections_.Back() >= count)
+    {
+        PODVector<unsigned> indices;
+        for (unsigned i = 0; i < selections_.Size() && selections_[i] < count; ++i)
+            indices.Push(selections_[i]);
+        SetSelections(indices);
+    }
+
+    UpdateVirtualContentSize();
+}
+
+void ListView::SetVirtualItemHeight(int height)
+{
+    virtualItemHeight_ = Max(height, 0);
+    virtualRowHeight_ = virtualItemHeight_;
+    if (virtualMode_)
+        UpdateVirtualContentSize();
+}
+
+void ListView::SetVirtualItemType(StringHash type)
+{
+    if (type == virtualItemType_)
+        return;
+
+    virtualItemType_ = type;
+    if (virtualMode_)
+    {
+        contentElement_->RemoveAllChildren();
+        virtualRowHeight_ = virtualItemHeight_;
+        virtualNumSlots_ = 0;
+        virtualItemIndices_.Clear();
+        UpdateVirtualContentSize();
+    }
+}
+
+void ListView::RefreshVirtualItems()
+{
+    if (!virtualMode_)
+        return;
+
+    for (unsigned i = 0; i < virtualItemIndices_.Size(); ++i)
+        virtualItemIndices_[i] = M_MAX_UNSIGNED;
+    UpdateVirtualItems();
+}
+
 void ListView::Expand(unsigned index, bool enable, bool recursive)
 {
     if (!hierarchyMode_)
@@ -803,11 +919,20 @@ void ListView::ToggleExpand(unsigned index, bool recursive)
 
 unsigned ListView::GetNumItems() const
 {
-    return contentElement_->GetNumChildren();
+    return virtualMode_ ? virtualItemCount_ : contentElement_->GetNumChildren();
 }
 
 UIElement* ListView::GetItem(unsigned index) const
 {
+    if (virtualMode_)
+    {
+        // Only the items currently bound to an item element can be returned
+        if (index >= virtualItemCount_ || !virtualNumSlots_)
+            return 0;
+        unsigned slot = index % virtualNumSlots_;
+        return virtualItemIndices_[slot] == index ? contentElement_->GetChild(slot) : 0;
+    }
+
     return contentElement_->GetChild(index);
 }
 
@@ -827,6 +952,12 @@ unsigned ListView::FindItem(UIElement* item) const
     if (item->GetParent() != contentElement_)
         return M_MAX_UNSIGNED;
 
+    if (virtualMode_)
+    {
+        unsigned slot = contentElement_->FindChild(item);
+        return slot < virtualItemIndices_.Size() ? virtualItemIndices_[slot] : M_MAX_UNSIGNED;
+    }
+
     const Vector<SharedPtr<UIElement> >& children = contentElement_->GetChildren();
 
     // Binary search for list item based on screen coordinate Y
@@ -867,7 +998,7 @@ unsigned ListView::GetSelection() const
 
 UIElement* ListView::GetSelectedItem() const
 {
-    return contentElement_->GetChild(GetSelection());
+    return GetItem(GetSelection());
 }
 
 PODVector<UIElement*> ListView::GetSelectedItems() const
@@ -954,9 +1085,20 @@ bool ListView::FilterImplicitAttributes(XMLElement& dest) const
 
 void ListView::UpdateSelectionEffect()
 {
-    unsigned numItems = GetNumItems();
     bool highlighted = highlightMode_ == HM_ALWAYS || HasFocus();
 
+    if (virtualMode_)
+    {
+        for (unsigned i = 0; i < virtualItemIndices_.Size(); ++i)
+        {
+            unsigned index = virtualItemIndices_[i];
+            contentElement_->GetChild(i)->SetSelected(highlightMode_ != HM_NEVER && index != M_MAX_UNSIGNED &&
+                selections_.Contains(index) && highlighted);
+        }
+        return;
+    }
+
+    unsigned numItems = GetNumItems();
     for (unsigned i = 0; i < numItems; ++i)
     {
         UIElement* item = GetItem(i);
@@ -969,7 +1111,14 @@ void ListView::UpdateSelectionEffect()
 
 void ListView::EnsureItemVisibility(unsigned index)
 {
-    EnsureItemVisibility(GetItem(index));
+    // In virtual mode the item may not have an element yet, but its position is known
+    if (virtualMode_)
+    {
+        if (index < virtualItemCount_)
+            EnsureRangeVisibility(index * virtualRowHeight_, virtualRowHeight_);
+    }
+    else
+        EnsureItemVisibility(GetItem(index));
 }
 
 void ListView::EnsureItemVisibility(UIElement* item)
@@ -977,18 +1126,7 @@ void ListView::EnsureItemVisibility(UIElement* item)
     if (!item || !item->IsVisible())
         return;
 
-    IntVector2 newView = GetViewPosition();
-    IntVector2 currentOffset = item->GetPosition() - newView;
-    const IntRect& clipBorder = scrollPanel_->GetClipBorder();
-    IntVector2 windowSize(scrollPanel_->GetWidth() - clipBorder.left_ - clipBorder.right_,
-        scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_);
-
-    if (currentOffset.y_ < 0)
-        newView.y_ += currentOffset.y_;
-    if (currentOffset.y_ + item->GetHeight() > windowSize.y_)
-        newView.y_ += currentOffset.y_ + item->GetHeight() - windowSize.y_;
-
-    SetViewPosition(newView);
+    EnsureRangeVisibility(item->GetPosition().y_, item->GetHeight());
 }
 
 void ListView::HandleUIMouseClick(StringHash eventType, VariantMap& eventData)
@@ -1137,4 +1275,136 @@ void ListView::UpdateUIClickSubscription()
     SubscribeToEvent(selectOnClickEnd_ ? E_UIMOUSECLICKEND : E_UIMOUSECLICK, URHO3D_HANDLER(ListView, HandleUIMouseClick));
 }
 
+void ListView::HandleViewChanged(StringHash eventType, VariantMap& eventData)
+{
+    UpdateVirtualItems();
+}
+
+void ListView::EnsureRangeVisibility(int top, int height)
+{
+    IntVector2 newView = GetViewPosition();
+    int currentOffset = top - newView.y_;
+    const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+    int windowHeight = scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_;
+
+    if (currentOffset < 0)
+        newView.y_ += currentOffset;
+    if (currentOffset + height > windowHeight)
+        newView.y_ += currentOffset + height - windowHeight;
+
+    SetViewPosition(newView);
+}
+
+void ListView::UpdateVirtualContentSize()
+{
+    // Estimate the row height from the first item if not set explicitly
+    if (!virtualRowHeight_ && virtualItemCount_)
+    {
+        if (!contentElement_->GetNumChildren() && !CreateVirtualItem())
+            return;
+
+        WeakPtr<ListView> self(this);
+        BindVirtualItem(0, 0);
+        if (self.Expired())
+            return;
+
+        virtualRowHeight_ = Max(contentElement_->GetChild(0)->GetHeight(), 1);
+    }
+
+    // Resizing the content element updates the scroll bars through ScrollView, and the item elements through OnResize()
+    unsigned maxRows = (unsigned)(M_MAX_INT / Max(virtualRowHeight_, 1));
+    contentElement_->SetHeight((int)Min(virtualItemCount_, maxRows) * virtualRowHeight_);
+    UpdateVirtualItems();
+}
+
+void ListView::UpdateVirtualItems()
+{
+    if (!virtualMode_)
+        return;
+
+    unsigned first = 0;
+    unsigned numSlots = 0;
+    if (virtualItemCount_ && virtualRowHeight_)
+    {
+        const IntRect& clipBorder = scrollPanel_->GetClipBorder();
+        int viewHeight = Max(scrollPanel_->GetHeight() - clipBorder.top_ - clipBorder.bottom_, 0);
+        // One extra row for the partially visible rows at both edges
+        numSlots = Min((unsigned)(viewHeight / virtualRowHeight_ + 2), virtualItemCount_);
+        first = Min((unsigned)(Max(viewPosition_.y_, 0) / virtualRowHeight_), virtualItemCount_ - numSlots);
+    }
+
+    while (contentElement_->GetNumChildren() < numSlots)
+    {
+        if (!CreateVirtualItem())
+            return;
+    }
+
+    // Item indices map to different elements when the number of slots changes, so everything must be rebound
+    if (numSlots != virtualNumSlots_)
+    {
+        virtualNumSlots_ = numSlots;
+        for (unsigned i = 0; i < virtualItemIndices_.Size(); ++i)
+            virtualItemIndices_[i] = M_MAX_UNSIGNED;
+    }
+
+    WeakPtr<ListView> self(this);
+    int width = contentElement_->GetWidth();
+
+    for (unsigned i = first; i < first + numSlots; ++i)
+    {
+        unsigned slot = i % numSlots;
+        UIElement* item = contentElement_->GetChild(slot);
+        item->SetPosition(0, (int)i * virtualRowHeight_);
+        item->SetSize(width, virtualRowHeight_);
+        item->SetVisible(true);
+
+        if (virtualItemIndices_[slot] != i)
+        {
+            BindVirtualItem(slot, i);
+            if (self.Expired())
+                return;
+        }
+    }
+
+    // Hide the surplus item elements, but keep them for reuse in case the view grows again
+    for (unsigned i = numSlots; i < contentElement_->GetNumChildren(); ++i)
+    {
+        contentElement_->GetChild(i)->SetVisible(false);
+        virtualItemIndices_[i] = M_MAX_UNSIGNED;
+    }
+}
+
+bool ListView::CreateVirtualItem()
+{
+    UIElement* item = contentElement_->CreateChild(virtualItemType_);
+    if (!item)
+    {
+        URHO3D_LOGERROR("Could not create virtual list view item element");
+        return false;
+    }
+
+    // Enable input so that clicking the item can be detected
+    item->SetStyleAuto();
+    item->SetEnabled(true);
+    virtualItemIndices_.Push(M_MAX_UNSIGNED);
+    return true;
+}
+
+void ListView::BindVirtualItem(unsigned slot, unsigned index)
+{
+    UIElement* item = contentElement_->GetChild(slot);
+    virtualItemIndices_[slot] = index;
+
+    bool highlighted = highlightMode_ == HM_ALWAYS || HasFocus();
+    item->SetSelected(highlightMode_ != HM_NEVER && highlighted && selections_.Contains(index));
+
+    using namespace VirtualItemBind;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_ELEMENT] = this;
+    eventData[P_ITEM] = item;
+    eventData[P_INDEX] = index;
+    SendEvent(E_VIRTUALITEMBIND, eventData);
+}
+
 }
@@ -96,6 +96,18 @@ public:
     void SetClearSelectionOnDefocus(bool enable);
     /// Enable reacting to click end instead of click start for item selection. Default false.
     void SetSelectOnClickEnd(bool enable);
+    /// \brief Enable virtual mode. Instead of holding an element for each item, only enough item elements to fill the view are created and recycled while scrolling.
+    /// E_VIRTUALITEMBIND is sent whenever an item element needs to be filled with the data of an item index. Items can not be added or removed individually in virtual mode, use SetVirtualItemCount() instead.
+    /// All items in the list will be lost during mode change. Enabling virtual mode disables hierarchy mode.
+    void SetVirtualMode(bool enable);
+    /// Set number of items in virtual mode.
+    void SetVirtualItemCount(unsigned count);
+    /// Set row height in virtual mode. If zero (default), the height of the first item element after binding is used for all rows.
+    void SetVirtualItemHeight(int height);
+    /// Set type of the item elements created in virtual mode. Default Text.
+    void SetVirtualItemType(StringHash type);
+    /// Rebind all item elements in view, for example after the data source has changed. Only has effect in virtual mode.
+    void RefreshVirtualItems();
 
     /// Expand item at index. Only has effect in hierarchy mode.
     void Expand(unsigned index, bool enable, bool recursive = false);
@@ -145,6 +157,18 @@ public:
     /// Return base indent.
     int GetBaseIndent() const { return baseIndent_; }
 
+    /// Return whether virtual mode enabled.
+    bool GetVirtualMode() const { return virtualMode_; }
+
+    /// Return number of items in virtual mode.
+    unsigned GetVirtualItemCount() const { return virtualItemCount_; }
+
+    /// Return row height set for virtual mode. Zero if estimated from the first item element.
+    int GetVirtualItemHeight() const { return virtualItemHeight_; }
+
+    /// Return type of the item elements created in virtual mode.
+    StringHash GetVirtualItemType() const { return virtualItemType_; }
+
     /// Ensure full visibility of the item.
     void EnsureItemVisibility(unsigned index);
     /// Ensure full visibility of the item.
@@ -172,6 +196,20 @@ protected:
     bool clearSelectionOnDefocus_;
     /// React to click end instead of click start flag.
     bool selectOnClickEnd_;
+    /// Virtual mode flag.
+    bool virtualMode_;
+    /// Number of items in virtual mode.
+    unsigned virtualItemCount_;
+    /// Row height set for virtual mode, zero to estimate.
+    int virtualItemHeight_;
+    /// Row height in use in virtual mode, zero if not yet known.
+    int virtualRowHeight_;
+    /// Number of item elements in use in virtual mode. Item index N is shown by the item element at N modulo this.
+    unsigned virtualNumSlots_;
+    /// Type of the item elements created in virtual mode.
+    StringHash virtualItemType_;
+    /// Item index bound to each item element in virtual mode, or M_MAX_UNSIGNED if none.
+    PODVector<unsigned> virtualItemIndices_;
 
 private:
     /// Handle global UI mouseclick to check for selection change.
@@ -184,6 +222,18 @@ private:
     void HandleFocusChanged(StringHash eventType, VariantMap& eventData);
     /// Update subscription to UI click events
     void UpdateUIClickSubscription();
+    /// Handle view position changed to recycle the item elements in virtual mode.
+    void HandleViewChanged(StringHash eventType, VariantMap& eventData);
+    /// Scroll the view so that the given vertical range of the content element is fully visible.
+    void EnsureRangeVisibility(int top, int height);
+    /// Estimate the row height if necessary, resize the content element and update the item elements in virtual mode.
+    void UpdateVirtualContentSize();
+    /// Position, show, hide and rebind the item elements to match the view in virtual mode.
+    void UpdateVirtualItems();
+    /// Create a new item element for virtual mode. Return true if successful.
+    bool CreateVirtualItem();
+    /// Bind the item element at slot to an item index and send the bind event.
+    void BindVirtualItem(unsigned slot, unsigned index);
 };
 
 }
@@ -184,12 +184,14 @@ void Sprite::SetTexture(Texture* texture)
     texture_ = texture;
     if (imageRect_ == IntRect::ZERO)
         SetFullImageRect();
+    MarkBatchesDirty();
 }
 
 void Sprite::SetImageRect(const IntRect& rect)
 {
     if (rect != IntRect::ZERO)
         imageRect_ = rect;
+    MarkBatchesDirty();
 }
 
 void Sprite::SetFullImageRect()
@@ -201,6 +203,7 @@ void Sprite::SetFullImageRect()
 void Sprite::SetBlendMode(BlendMode mode)
 {
     blendMode_ = mode;
+    MarkBatchesDirty();
 }
 
 const Matrix3x4& Sprite::GetTransform() const
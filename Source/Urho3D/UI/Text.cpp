@@ -60,6 +60,7 @@ Text::Text(Context* context) :
     wordWrap_(false),
     autoLocalizable_(false),
     charLocationsDirty_(true),
+    glyphVersion_(0),
     selectionStart_(0),
     selectionLength_(0),
     selectionColor_(Color::TRANSPARENT),
@@ -67,7 +68,9 @@ Text::Text(Context* context) :
     textEffect_(TE_NONE),
     effectColor_(Color::BLACK),
     effectDepthBias_(0.0f),
-    rowHeight_(0)
+    rowHeight_(0),
+    layoutWrapWidth_(-1),
+    layoutRowSpacing_(0.0f)
 {
     // By default Text does not derive opacity from parent elements
     useDerivedOpacity_ = false;
@@ -110,6 +113,15 @@ void Text::ApplyAttributes()
     UpdateText();
 }
 
+void Text::Update(float timeStep)
+{
+    UIElement::Update(timeStep);
+
+    // Glyphs rasterized in the background have become resident or moved: rebuild batches to show them
+    if (fontFace_ && fontFace_->GetGlyphVersion() != glyphVersion_)
+        MarkBatchesDirty();
+}
+
 void Text::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor)
 {
     FontFace* face = font_ ? font_->GetFace(fontSize_) : (FontFace*)0;
@@ -120,7 +132,7 @@ void Text::GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData,
     }
 
     // If face has changed or char locations are not valid anymore, update before rendering
-    if (charLocationsDirty_ || !fontFace_ || face != fontFace_)
+    if (charLocationsDirty_ || !fontFace_ || face != fontFace_ || glyphVersion_ != face->GetGlyphVersion())
         UpdateCharLocations();
     // If face uses mutable glyphs mechanism, reacquire glyphs before rendering to make sure they are in the texture
     else if (face->HasMutableGlyphs())
@@ -227,6 +239,7 @@ void Text::OnResize()
 void Text::OnIndentSet()
 {
     charLocationsDirty_ = true;
+    MarkBatchesDirty();
 }
 
 bool Text::SetFont(const String& fontName, int size)
@@ -278,6 +291,66 @@ void Text::SetText(const String& text)
     UpdateText();
 }
 
+void Text::AppendText(const String& text)
+{
+    if (text.Empty())
+        return;
+
+    if (autoLocalizable_)
+    {
+        SetText(stringId_ + text);
+        return;
+    }
+
+    // Wrapped rows may reflow anywhere, so only unwrapped text with an up-to-date layout is laid out incrementally
+    FontFace* face = font_ ? font_->GetFace(fontSize_) : (FontFace*)0;
+    bool incremental = face && !wordWrap_ && face == layoutFace_ && layoutWrapWidth_ == -1 &&
+        layoutText_.Length() == text_.Length() && layoutRowSpacing_ == rowSpacing_;
+
+    unsigned oldNumChars = unicodeText_.Size();
+    text_ += text;
+    for (unsigned i = 0; i < text.Length();)
+        unicodeText_.Push(text.NextUTF8Char(i));
+    ValidateSelection();
+
+    if (!incremental)
+    {
+        UpdateText();
+        return;
+    }
+
+    MarkBatchesDirty();
+
+    // Find the start of the last row. If it was measured, its width must be removed as it is measured again
+    unsigned rowStart = oldNumChars;
+    int lastRowWidth = 0;
+    while (rowStart && printText_[rowStart - 1] != '\n')
+        --rowStart;
+    for (unsigned i = rowStart; i < oldNumChars; ++i)
+    {
+        const FontGlyph* glyph = face->GetGlyph(printText_[i]);
+        if (glyph)
+        {
+            lastRowWidth += glyph->advanceX_;
+            if (i < oldNumChars - 1)
+                lastRowWidth += face->GetKerning(printText_[i], printText_[i + 1]);
+        }
+    }
+    if (lastRowWidth && rowWidths_.Size())
+        rowWidths_.Pop();
+
+    // Without wordwrap the printed text is the same as the text
+    for (unsigned i = oldNumChars; i < unicodeText_.Size(); ++i)
+    {
+        printText_.Push(unicodeText_[i]);
+        printToText_.Push(i);
+    }
+
+    UpdateRows(face, rowStart);
+
+    layoutText_ += text;
+}
+
 void Text::SetTextAlignment(HorizontalAlignment align)
 {
     if (align != textAlignment_)
@@ -285,6 +358,7 @@ void Text::SetTextAlignment(HorizontalAlignment align)
         textAlignment_ = align;
         charLocationsDirty_ = true;
     }
+    MarkBatchesDirty();
 }
 
 void Text::SetRowSpacing(float spacing)
@@ -343,32 +417,38 @@ void Text::SetSelection(unsigned start, unsigned length)
     selectionStart_ = start;
     selectionLength_ = length;
     ValidateSelection();
+    MarkBatchesDirty();
 }
 
 void Text::ClearSelection()
 {
     selectionStart_ = 0;
     selectionLength_ = 0;
+    MarkBatchesDirty();
 }
 
 void Text::SetSelectionColor(const Color& color)
 {
     selectionColor_ = color;
+    MarkBatchesDirty();
 }
 
 void Text::SetHoverColor(const Color& color)
 {
     hoverColor_ = color;
+    MarkBatchesDirty();
 }
 
 void Text::SetTextEffect(TextEffect textEffect)
 {
     textEffect_ = textEffect;
+    MarkBatchesDirty();
 }
 
 void Text::SetEffectColor(const Color& effectColor)
 {
     effectColor_ = effectColor;
+    MarkBatchesDirty();
 }
 
 void Text::SetUsedInText3D(bool usedInText3D)
@@ -441,21 +521,27 @@ bool Text::FilterImplicitAttributes(XMLElement& dest) const
 
 void Text::UpdateText(bool onResize)
 {
+    FontFace* face = font_ ? font_->GetFace(fontSize_) : (FontFace*)0;
+    int wrapWidth = wordWrap_ ? GetWidth() : -1;
+
+    // Skip the layout if nothing affecting it has changed, for example when the same text is set every frame
+    if (face && face == layoutFace_ && text_ == layoutText_ &&
+        wrapWidth == layoutWrapWidth_ && rowSpacing_ == layoutRowSpacing_)
+        return;
+
+    MarkBatchesDirty();
+
     rowWidths_.Clear();
     printText_.Clear();
 
     if (font_)
     {
-        FontFace* face = font_->GetFace(fontSize_);
         if (!face)
             return;
 
         rowHeight_ = face->GetRowHeight();
 
-        int width = 0;
-        int height = 0;
         int rowWidth = 0;
-        int rowHeight = (int)(rowSpacing_ * rowHeight_);
 
         // First see if the text must be split up
         if (!wordWrap_)
@@ -564,51 +650,13 @@ void Text::UpdateText(bool onResize)
             }
         }
 
-        rowWidth = 0;
+        UpdateRows(face, 0);
 
-        for (unsigned i = 0; i < printText_.Size(); ++i)
-        {
-            unsigned c = printText_[i];
-
-            if (c != '\n')
-            {
-                const FontGlyph* glyph = face->GetGlyph(c);
-                if (glyph)
-                {
-                    rowWidth += glyph->advanceX_;
-                    if (i < printText_.Size() - 1)
-                        rowWidth += face->GetKerning(c, printText_[i + 1]);
-                }
-            }
-            else
-            {
-                width = Max(width, rowWidth);
-                height += rowHeight;
-                rowWidths_.Push(rowWidth);
-                rowWidth = 0;
-            }
-        }
-
-        if (rowWidth)
-        {
-            width = Max(width, rowWidth);
-            height += rowHeight;
-            rowWidths_.Push(rowWidth);
-        }
-
-        // Set at least one row height even if text is empty
-        if (!height)
-            height = rowHeight;
-
-        // Set minimum and current size according to the text size, but respect fixed width if set
-        if (!IsFixedWidth())
-        {
-            SetMinWidth(wordWrap_ ? 0 : width);
-            SetWidth(width);
-        }
-        SetFixedHeight(height);
-
-        charLocationsDirty_ = true;
+        // Remember what the layout was made with. Resizing may have caused a nested update, so read the width again
+        layoutFace_ = face;
+        layoutText_ = text_;
+        layoutWrapWidth_ = wordWrap_ ? GetWidth() : -1;
+        layoutRowSpacing_ = rowSpacing_;
     }
     else
     {
@@ -626,6 +674,53 @@ void Text::UpdateText(bool onResize)
     }
 }
 
+void Text::UpdateRows(FontFace* face, unsigned start)
+{
+    int rowWidth = 0;
+
+    for (unsigned i = start; i < printText_.Size(); ++i)
+    {
+        unsigned c = printText_[i];
+
+        if (c != '\n')
+        {
+            const FontGlyph* glyph = face->GetGlyph(c);
+            if (glyph)
+            {
+                rowWidth += glyph->advanceX_;
+                if (i < printText_.Size() - 1)
+                    rowWidth += face->GetKerning(c, printText_[i + 1]);
+            }
+        }
+        else
+        {
+            rowWidths_.Push(rowWidth);
+            rowWidth = 0;
+        }
+    }
+
+    if (rowWidth)
+        rowWidths_.Push(rowWidth);
+
+    int width = 0;
+    for (unsigned i = 0; i < rowWidths_.Size(); ++i)
+        width = Max(width, rowWidths_[i]);
+
+    // Set at least one row height even if text is empty
+    int rowHeight = (int)(rowSpacing_ * rowHeight_);
+    int height = rowHeight * Max((int)rowWidths_.Size(), 1);
+
+    // Set minimum and current size according to the text size, but respect fixed width if set
+    if (!IsFixedWidth())
+    {
+        SetMinWidth(wordWrap_ ? 0 : width);
+        SetWidth(width);
+    }
+    SetFixedHeight(height);
+
+    charLocationsDirty_ = true;
+}
+
 void Text::UpdateCharLocations()
 {
     // Remember the font face to see if it's still valid when it's time to render
@@ -633,6 +728,7 @@ void Text::UpdateCharLocations()
     if (!face)
         return;
     fontFace_ = face;
+    glyphVersion_ = face->GetGlyphVersion();
 
     int rowHeight = (int)(rowSpacing_ * rowHeight_);
 
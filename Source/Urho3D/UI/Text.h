@@ -86,6 +86,8 @@ public:
 
     /// Apply attribute changes that can not be applied immediately.
     virtual void ApplyAttributes();
+    /// Perform UI element update.
+    virtual void Update(float timeStep);
     /// Return UI rendering batches.
     virtual void GetBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor);
     /// React to resize.
@@ -99,6 +101,8 @@ public:
     bool SetFont(Font* font, int size = DEFAULT_FONT_SIZE);
     /// Set text. Text is assumed to be either ASCII or UTF8-encoded.
     void SetText(const String& text);
+    /// Append text to the end. Without wordwrap only the last row is laid out again. In auto localizable mode appends to the string identifier.
+    void AppendText(const String& text);
     /// Set row alignment.
     void SetTextAlignment(HorizontalAlignment align);
     /// Set row spacing, 1.0 for original font spacing.
@@ -195,6 +199,8 @@ protected:
     void UpdateText(bool onResize = false);
     /// Update cached character locations after text update, or when text alignment or indent has changed.
     void UpdateCharLocations();
+    /// Measure the rows of the printed text starting from the start of a row, then resize to fit the text.
+    void UpdateRows(FontFace* face, unsigned start);
     /// Validate text selection to be within the text.
     void ValidateSelection();
     /// Return row start X position.
@@ -222,6 +228,8 @@ protected:
     bool wordWrap_;
     /// Char positions dirty flag.
     bool charLocationsDirty_;
+    /// Glyph version of the font face when char positions were last updated.
+    unsigned glyphVersion_;
     /// Selection start.
     unsigned selectionStart_;
     /// Selection length.
@@ -254,6 +262,14 @@ protected:
     bool autoLocalizable_;
     /// Storage string id. Used when enabled autoLocalizable.
     String stringId_;
+    /// Font face of the current text layout.
+    WeakPtr<FontFace> layoutFace_;
+    /// Text of the current text layout.
+    String layoutText_;
+    /// Wrap width of the current text layout, or -1 if not wrapped.
+    int layoutWrapWidth_;
+    /// Row spacing of the current text layout.
+    float layoutRowSpacing_;
     /// Handle change Language.
     void HandleChangeLanguage(StringHash eventType, VariantMap& eventData);
     /// UTF8 to Unicode.
@@ -32,6 +32,7 @@
 #include "../Resource/ResourceCache.h"
 #include "../Scene/Node.h"
 #include "../UI/Font.h"
+#include "../UI/FontFace.h"
 #include "../UI/Text.h"
 #include "../UI/Text3D.h"
 
@@ -132,6 +133,10 @@ void Text3D::UpdateBatches(const FrameInfo& frame)
             break;
         }
     }
+
+    // Mutable glyphs rasterized in the background have become resident or moved
+    if (text_.fontFace_ && text_.fontFace_->GetGlyphVersion() != text_.glyphVersion_)
+        fontDataLost_ = true;
 }
 
 void Text3D::UpdateGeometry(const FrameInfo& frame)
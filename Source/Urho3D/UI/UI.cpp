@@ -75,6 +75,8 @@ const float DEFAULT_DRAGBEGIN_INTERVAL = 0.5f;
 const float DEFAULT_TOOLTIP_DELAY = 0.5f;
 const int DEFAULT_DRAGBEGIN_DISTANCE = 5;
 const int DEFAULT_FONT_TEXTURE_MAX_SIZE = 2048;
+const unsigned DEFAULT_FONT_TEXTURES_MAX = 4;
+const int HIT_TEST_CELL_SIZE = 64;
 
 const char* UI_CATEGORY = "UI";
 
@@ -90,6 +92,7 @@ UI::UI(Context* context) :
     lastMouseButtons_(0),
     qualifiers_(0),
     maxFontTextureSize_(DEFAULT_FONT_TEXTURE_MAX_SIZE),
+    maxFontTextures_(DEFAULT_FONT_TEXTURES_MAX),
     initialized_(false),
     usingTouchInput_(false),
 #ifdef _WIN32
@@ -191,6 +194,8 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     {
         UIElement* oldFocusElement = focusElement_;
         focusElement_.Reset();
+        // Focus affects the hover offset of border images
+        oldFocusElement->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Defocused::P_ELEMENT] = oldFocusElement;
@@ -201,6 +206,7 @@ void UI::SetFocusElement(UIElement* element, bool byKey)
     if (element && element->GetFocusMode() >= FM_FOCUSABLE)
     {
         focusElement_ = element;
+        element->MarkBatchesDirty();
 
         VariantMap& focusEventData = GetEventDataMap();
         focusEventData[Focused::P_ELEMENT] = element;
@@ -379,6 +385,12 @@ void UI::Update(float timeStep)
             {
                 using namespace HoverEnd;
 
+                // Elements inside a batch cache do not reset their hover state while rendering. If the cache was regenerated
+                // on the last hovered frame, the state was reset already and SetHovering() sees no change, so always
+                // invalidate the cached batches to remove the hover highlight
+                element->SetHovering(false);
+                element->MarkBatchesDirty();
+
                 VariantMap& eventData = GetEventDataMap();
                 eventData[P_ELEMENT] = element;
                 element->SendEvent(E_HOVEREND, eventData);
@@ -565,6 +577,16 @@ void UI::SetMaxFontTextureSize(int size)
     }
 }
 
+void UI::SetMaxFontTextures(unsigned num)
+{
+    num = Max(num, 1U);
+    if (num != maxFontTextures_)
+    {
+        maxFontTextures_ = num;
+        ReleaseFontFaces();
+    }
+}
+
 void UI::SetNonFocusedMouseWheel(bool nonFocusedMouseWheel)
 {
     nonFocusedMouseWheel_ = nonFocusedMouseWheel;
@@ -605,8 +627,28 @@ IntVector2 UI::GetCursorPosition() const
 
 UIElement* UI::GetElementAt(const IntVector2& position, bool enabledOnly)
 {
+    UIElement* root = HasModalElement() ? rootModalElement_ : rootElement_;
     UIElement* result = 0;
-    GetElementAt(result, HasModalElement() ? rootModalElement_ : rootElement_, position, enabledOnly);
+
+    // Elements may extend outside the screen; positions there are rare, so use the full hierarchy search for them
+    if (position.x_ < 0 || position.y_ < 0 || position.x_ >= root->GetWidth() || position.y_ >= root->GetHeight())
+    {
+        GetElementAt(result, root, position, enabledOnly);
+        return result;
+    }
+
+    UpdateHitTestIndex(root);
+
+    // Elements of the cell are in hit test order, so the last one containing the position is topmost
+    const PODVector<unsigned>& cell = hitTestCells_[(position.y_ / HIT_TEST_CELL_SIZE) * hitTestGridSize_.x_ +
+        position.x_ / HIT_TEST_CELL_SIZE];
+    for (unsigned i = cell.Size() - 1; i < cell.Size(); --i)
+    {
+        unsigned index = cell[i];
+        if (hitTestRects_[index].IsInside(position) == INSIDE && (!enabledOnly || hitTestElements_[index]->IsEnabled()))
+            return hitTestElements_[index];
+    }
+
     return result;
 }
 
@@ -845,6 +887,24 @@ void UI::GetBatches(UIElement* element, IntRect currentScissor)
     if (currentScissor.left_ == currentScissor.right_ || currentScissor.top_ == currentScissor.bottom_)
         return;
 
+    if (!element->GetCacheBatches())
+    {
+        GetChildBatches(element, currentScissor);
+        return;
+    }
+
+    // Reuse the child batches if nothing below the element has changed, otherwise regenerate and store them
+    if (element->GetCachedBatches(batches_, vertexData_, currentScissor))
+        return;
+
+    unsigned batchStart = batches_.Size();
+    unsigned vertexStart = vertexData_.Size();
+    GetChildBatches(element, currentScissor);
+    element->SetCachedBatches(batches_, batchStart, vertexData_, vertexStart, currentScissor);
+}
+
+void UI::GetChildBatches(UIElement* element, const IntRect& currentScissor)
+{
     element->SortChildren();
     const Vector<SharedPtr<UIElement> >& children = element->GetChildren();
     if (children.Empty())
@@ -960,6 +1020,165 @@ void UI::GetElementAt(UIElement*& result, UIElement* current, const IntVector2&
     }
 }
 
+void UI::QueueHitTestUpdate(UIElement* element, UIElement* root)
+{
+    if (root != hitTestRoot_)
+        return;
+
+    element->hitTestQueued_ = true;
+    hitTestQueue_.Push(WeakPtr<UIElement>(element));
+}
+
+void UI::UpdateHitTestIndex(UIElement* root)
+{
+    if (root != hitTestRoot_ || root->hitTestDirty_)
+    {
+        RebuildHitTestIndex(root);
+        return;
+    }
+
+    if (hitTestQueue_.Empty())
+        return;
+
+    URHO3D_PROFILE(UpdateHitTestIndex);
+
+    // Position and size changes leave the hierarchy and so the hit test order intact. Update only the rectangles of the moved
+    // elements and their children. An element missing from the index means that the hierarchy has changed after all
+    for (unsigned i = 0; i < hitTestQueue_.Size(); ++i)
+    {
+        UIElement* element = hitTestQueue_[i];
+        if (!element)
+            continue;
+
+        element->hitTestQueued_ = false;
+        unsigned index = element->hitTestIndex_;
+        if (index >= hitTestElements_.Size() || hitTestElements_[index] != element ||
+            !UpdateHitTestElement(element, hitTestClipRects_[index]))
+        {
+            RebuildHitTestIndex(root);
+            return;
+        }
+    }
+
+    hitTestQueue_.Clear();
+}
+
+void UI::RebuildHitTestIndex(UIElement* root)
+{
+    URHO3D_PROFILE(RebuildHitTestIndex);
+
+    for (unsigned i = 0; i < hitTestQueue_.Size(); ++i)
+    {
+        if (hitTestQueue_[i])
+            hitTestQueue_[i]->hitTestQueued_ = false;
+    }
+    hitTestQueue_.Clear();
+
+    hitTestRoot_ = root;
+    root->hitTestDirty_ = false;
+    hitTestElements_.Clear();
+    hitTestRects_.Clear();
+    hitTestClipRects_.Clear();
+
+    const IntVector2& rootSize = root->GetSize();
+    hitTestGridSize_.x_ = Max((rootSize.x_ + HIT_TEST_CELL_SIZE - 1) / HIT_TEST_CELL_SIZE, 1);
+    hitTestGridSize_.y_ = Max((rootSize.y_ + HIT_TEST_CELL_SIZE - 1) / HIT_TEST_CELL_SIZE, 1);
+    hitTestCells_.Resize((unsigned)(hitTestGridSize_.x_ * hitTestGridSize_.y_));
+    for (unsigned i = 0; i < hitTestCells_.Size(); ++i)
+        hitTestCells_[i].Clear();
+
+    AddToHitTestIndex(root, IntRect(0, 0, rootSize.x_, rootSize.y_));
+}
+
+void UI::AddToHitTestIndex(UIElement* current, const IntRect& clipRect)
+{
+    current->SortChildren();
+    const Vector<SharedPtr<UIElement> >& children = current->GetChildren();
+
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        UIElement* element = children[i];
+        if (element == cursor_.Get() || !element->IsVisible())
+            continue;
+
+        // Every visible element gets an entry, even if clipped out, so that it can be updated in place when it moves
+        const IntVector2& screenPos = element->GetScreenPosition();
+        const IntVector2& size = element->GetSize();
+        IntRect rect(Max(screenPos.x_, clipRect.left_), Max(screenPos.y_, clipRect.top_),
+            Min(screenPos.x_ + size.x_, clipRect.right_), Min(screenPos.y_ + size.y_, clipRect.bottom_));
+
+        unsigned index = hitTestElements_.Size();
+        element->hitTestIndex_ = index;
+        hitTestElements_.Push(element);
+        hitTestRects_.Push(rect);
+        hitTestClipRects_.Push(clipRect);
+        SetHitTestCells(index, true);
+
+        if (element->GetNumChildren())
+            AddToHitTestIndex(element, element->GetClipChildren() ? rect : clipRect);
+    }
+}
+
+bool UI::UpdateHitTestElement(UIElement* element, const IntRect& clipRect)
+{
+    unsigned index = element->hitTestIndex_;
+    if (index >= hitTestElements_.Size() || hitTestElements_[index] != element)
+        return false;
+
+    const IntVector2& screenPos = element->GetScreenPosition();
+    const IntVector2& size = element->GetSize();
+    IntRect rect(Max(screenPos.x_, clipRect.left_), Max(screenPos.y_, clipRect.top_),
+        Min(screenPos.x_ + size.x_, clipRect.right_), Min(screenPos.y_ + size.y_, clipRect.bottom_));
+
+    if (rect != hitTestRects_[index])
+    {
+        SetHitTestCells(index, false);
+        hitTestRects_[index] = rect;
+        SetHitTestCells(index, true);
+    }
+    hitTestClipRects_[index] = clipRect;
+
+    const Vector<SharedPtr<UIElement> >& children = element->GetChildren();
+    const IntRect& childClipRect = element->GetClipChildren() ? rect : clipRect;
+    for (unsigned i = 0; i < children.Size(); ++i)
+    {
+        UIElement* child = children[i];
+        if (child != cursor_.Get() && child->IsVisible() && !UpdateHitTestElement(child, childClipRect))
+            return false;
+    }
+
+    return true;
+}
+
+void UI::SetHitTestCells(unsigned index, bool add)
+{
+    const IntRect& rect = hitTestRects_[index];
+    if (rect.left_ >= rect.right_ || rect.top_ >= rect.bottom_)
+        return;
+
+    int left = rect.left_ / HIT_TEST_CELL_SIZE;
+    int top = rect.top_ / HIT_TEST_CELL_SIZE;
+    int right = (rect.right_ - 1) / HIT_TEST_CELL_SIZE;
+    int bottom = (rect.bottom_ - 1) / HIT_TEST_CELL_SIZE;
+    for (int y = top; y <= bottom; ++y)
+    {
+        for (int x = left; x <= right; ++x)
+        {
+            // Keep the cells in hit test order. When rebuilding, the new index always goes last
+            PODVector<unsigned>& cell = hitTestCells_[y * hitTestGridSize_.x_ + x];
+            if (add)
+            {
+                unsigned position = cell.Size();
+                while (position && cell[position - 1] > index)
+                    --position;
+                cell.Insert(position, index);
+            }
+            else
+                cell.Remove(index);
+        }
+    }
+}
+
 UIElement* UI::GetFocusableElement(UIElement* element)
 {
     while (element)
@@ -1045,6 +1264,7 @@ void UI::ProcessHover(const IntVector2& cursorPos, int buttons, int qualifiers,
                 // Begin hover event
                 if (!hoveredElements_.Contains(element))
                 {
+                    element->MarkBatchesDirty();
                     SendDragOrHoverEvent(E_HOVERBEGIN, element, cursorPos, IntVector2::ZERO, 0);
                     // Exit if element is destroyed by the event handling
                     if (!element)
@@ -1090,6 +1310,7 @@ void UI::ProcessHover(const IntVector2& cursorPos, int buttons, int qualifiers,
             // Begin hover event
             if (!hoveredElements_.Contains(element))
             {
+                element->MarkBatchesDirty();
                 SendDragOrHoverEvent(E_HOVERBEGIN, element, cursorPos, IntVector2::ZERO, 0);
                 // Exit if element is destroyed by the event handling
                 if (!element)
@@ -85,13 +85,15 @@ public:
     void SetDefaultToolTipDelay(float delay);
     /// Set maximum font face texture size. Must be a power of two. Default is 2048.
     void SetMaxFontTextureSize(int size);
+    /// Set maximum number of textures per font face in mutable glyph mode. When all are full, the least recently used texture is evicted. Default 4.
+    void SetMaxFontTextures(unsigned num);
     /// Set whether mouse wheel can control also a non-focused element.
     void SetNonFocusedMouseWheel(bool nonFocusedMouseWheel);
     /// Set whether to use system clipboard. Default false.
     void SetUseSystemClipboard(bool enable);
     /// Set whether to show the on-screen keyboard (if supported) when a %LineEdit is focused. Default true on mobile devices.
     void SetUseScreenKeyboard(bool enable);
-    /// Set whether to use mutable (eraseable) glyphs to ensure a font face never expands to more than one texture. Default false.
+    /// Set whether to use mutable (eraseable) glyphs, rasterized in the background when first used, to ensure a font face never expands to more than the maximum number of textures. Default false.
     void SetUseMutableGlyphs(bool enable);
     /// Set whether to force font autohinting instead of using FreeType's TTF bytecode interpreter.
     void SetForceAutoHint(bool enable);
@@ -149,6 +151,9 @@ public:
     /// Return font texture maximum size.
     int GetMaxFontTextureSize() const { return maxFontTextureSize_; }
 
+    /// Return maximum number of textures per font face in mutable glyph mode.
+    unsigned GetMaxFontTextures() const { return maxFontTextures_; }
+
     /// Return whether mouse wheel can control also a non-focused element.
     bool IsNonFocusedMouseWheel() const { return nonFocusedMouseWheel_; }
 
@@ -190,6 +195,9 @@ public:
     /// Return current UI scale.
     float GetScale() const { return uiScale_; }
 
+    /// Queue an element whose position or size has changed for updating in the hit test index. Called by UIElement.
+    void QueueHitTestUpdate(UIElement* element, UIElement* root);
+
 private:
     /// Initialize when screen mode initially set.
     void Initialize();
@@ -202,8 +210,20 @@ private:
         (bool resetRenderTargets, VertexBuffer* buffer, const PODVector<UIBatch>& batches, unsigned batchStart, unsigned batchEnd);
     /// Generate batches from an UI element recursively. Skip the cursor element.
     void GetBatches(UIElement* element, IntRect currentScissor);
+    /// Generate batches from the children of an UI element, bypassing its batch cache.
+    void GetChildBatches(UIElement* element, const IntRect& currentScissor);
     /// Return UI element at screen position recursively.
     void GetElementAt(UIElement*& result, UIElement* current, const IntVector2& position, bool enabledOnly);
+    /// Rebuild the hit test index if the root element or its hierarchy has changed, otherwise update the queued elements.
+    void UpdateHitTestIndex(UIElement* root);
+    /// Rebuild the hit test index of a root element.
+    void RebuildHitTestIndex(UIElement* root);
+    /// Add the child elements of an UI element to the hit test index recursively. Skip the cursor element.
+    void AddToHitTestIndex(UIElement* current, const IntRect& clipRect);
+    /// Update the rectangle of an element and its children in the hit test index. Return false if one of them is not in the index, in which case the index needs a rebuild.
+    bool UpdateHitTestElement(UIElement* element, const IntRect& clipRect);
+    /// Add an element to or remove it from the hit test index grid cells overlapped by its rectangle.
+    void SetHitTestCells(unsigned index, bool add);
     /// Return the first element in hierarchy that can alter focus.
     UIElement* GetFocusableElement(UIElement* element);
     /// Return cursor position and visibility either from the cursor element, or the Input subsystem.
@@ -288,6 +308,20 @@ private:
     SharedPtr<VertexBuffer> debugVertexBuffer_;
     /// UI element query vector.
     PODVector<UIElement*> tempElements_;
+    /// Root element of the hit test index.
+    WeakPtr<UIElement> hitTestRoot_;
+    /// Hit test index elements in hit test order.
+    PODVector<UIElement*> hitTestElements_;
+    /// Hit test index element screen rectangles, clipped by their parents.
+    PODVector<IntRect> hitTestRects_;
+    /// Hit test index element clipping rectangles from their parents.
+    PODVector<IntRect> hitTestClipRects_;
+    /// Elements whose position or size has changed since the hit test index was updated.
+    Vector<WeakPtr<UIElement> > hitTestQueue_;
+    /// Hit test index grid cells, holding indices of the elements overlapping each cell in hit test order.
+    Vector<PODVector<unsigned> > hitTestCells_;
+    /// Hit test index grid size in cells.
+    IntVector2 hitTestGridSize_;
     /// Clipboard text.
     mutable String clipBoard_;
     /// Seconds between clicks to register a double click.
@@ -306,6 +340,8 @@ private:
     int qualifiers_;
     /// Font texture maximum size.
     int maxFontTextureSize_;
+    /// Maximum number of textures per font face in mutable glyph mode.
+    unsigned maxFontTextures_;
     /// Initialized flag.
     bool initialized_;
     /// Touch used flag.
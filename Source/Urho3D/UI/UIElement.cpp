@@ -130,6 +130,11 @@ UIElement::UIElement(Context* context) :
     opacityDirty_(true),
     derivedColorDirty_(true),
     sortOrderDirty_(false),
+    cacheBatches_(false),
+    batchesDirty_(true),
+    hitTestDirty_(true),
+    hitTestQueued_(false),
+    hitTestIndex_(M_MAX_UNSIGNED),
     colorGradient_(false),
     traversalMode_(TM_BREADTH_FIRST),
     elementEventSender_(false)
@@ -176,6 +181,7 @@ void UIElement::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Bring To Back", GetBringToBack, SetBringToBack, bool, true, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Clip Children", GetClipChildren, SetClipChildren, bool, false, AM_FILE);
     URHO3D_ACCESSOR_ATTRIBUTE("Use Derived Opacity", GetUseDerivedOpacity, SetUseDerivedOpacity, bool, true, AM_FILE);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cache Batches", GetCacheBatches, SetCacheBatches, bool, false, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Focus Mode", GetFocusMode, SetFocusMode, FocusMode, focusModes, FM_NOTFOCUSABLE, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Drag And Drop Mode", GetDragDropMode, SetDragDropMode, unsigned, dragDropModes, DD_DISABLED, AM_FILE);
     URHO3D_ENUM_ACCESSOR_ATTRIBUTE("Layout Mode", GetLayoutMode, SetLayoutMode, LayoutMode, layoutModes, LM_FREE, AM_FILE);
@@ -198,6 +204,7 @@ void UIElement::ApplyAttributes()
         if (color_[i] != color_[0])
             colorGradient_ = true;
     }
+    MarkBatchesDirty();
 }
 
 bool UIElement::LoadXML(const XMLElement& source, bool setInstanceDefault)
@@ -775,6 +782,7 @@ void UIElement::SetClipBorder(const IntRect& rect)
     clipBorder_.top_ = Max(rect.top_, 0);
     clipBorder_.right_ = Max(rect.right_, 0);
     clipBorder_.bottom_ = Max(rect.bottom_, 0);
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(const Color& color)
@@ -783,6 +791,7 @@ void UIElement::SetColor(const Color& color)
         color_[i] = color;
     colorGradient_ = false;
     derivedColorDirty_ = true;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetColor(Corner corner, const Color& color)
@@ -796,6 +805,7 @@ void UIElement::SetColor(Corner corner, const Color& color)
         if (i != corner && color_[i] != color_[corner])
             colorGradient_ = true;
     }
+    MarkBatchesDirty();
 }
 
 void UIElement::SetPriority(int priority)
@@ -806,6 +816,8 @@ void UIElement::SetPriority(int priority)
     priority_ = priority;
     if (parent_)
         parent_->sortOrderDirty_ = true;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetOpacity(float opacity)
@@ -827,6 +839,8 @@ void UIElement::SetBringToBack(bool enable)
 void UIElement::SetClipChildren(bool enable)
 {
     clipChildren_ = enable;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetSortChildren(bool enable)
@@ -835,11 +849,14 @@ void UIElement::SetSortChildren(bool enable)
         sortOrderDirty_ = true;
 
     sortChildren_ = enable;
+    MarkBatchesDirty();
+    MarkHitTestDirty();
 }
 
 void UIElement::SetUseDerivedOpacity(bool enable)
 {
     useDerivedOpacity_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetEnabled(bool enable)
@@ -910,6 +927,7 @@ void UIElement::SetFocus(bool enable)
 void UIElement::SetSelected(bool enable)
 {
     selected_ = enable;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetVisible(bool enable)
@@ -922,6 +940,8 @@ void UIElement::SetVisible(bool enable)
     if (enable != visible_)
     {
         visible_ = enable;
+        MarkBatchesDirty();
+        MarkHitTestDirty();
 
         // Parent's layout may change as a result of visibility change
         if (parent_)
@@ -944,6 +964,59 @@ void UIElement::SetVisible(bool enable)
     }
 }
 
+void UIElement::SetCacheBatches(bool enable)
+{
+    if (enable != cacheBatches_)
+    {
+        cacheBatches_ = enable;
+        batchesDirty_ = true;
+        cachedBatches_.Clear();
+        cachedVertexData_.Clear();
+    }
+}
+
+void UIElement::MarkBatchesDirty()
+{
+    for (UIElement* element = this; element; element = element->parent_)
+        element->batchesDirty_ = true;
+}
+
+void UIElement::MarkHitTestDirty()
+{
+    UIElement* element = this;
+    while (element->parent_)
+    {
+        // The cursor is not hit tested, so it can move without invalidating the index
+        if (element->GetType() == Cursor::GetTypeStatic())
+            return;
+        element = element->parent_;
+    }
+
+    element->hitTestDirty_ = true;
+}
+
+void UIElement::QueueHitTestUpdate()
+{
+    UIElement* element = this;
+    while (element->parent_)
+    {
+        if (element->GetType() == Cursor::GetTypeStatic())
+            return;
+        element = element->parent_;
+    }
+
+    // A resized root changes the index grid, so it needs a rebuild. Otherwise nothing needs to be queued while a rebuild
+    // is pending anyway
+    if (element == this)
+        hitTestDirty_ = true;
+    else if (!element->hitTestDirty_ && !hitTestQueued_)
+    {
+        UI* ui = GetSubsystem<UI>();
+        if (ui)
+            ui->QueueHitTestUpdate(this, element);
+    }
+}
+
 void UIElement::SetDragDropMode(unsigned mode)
 {
     dragDropMode_ = mode;
@@ -1309,6 +1382,8 @@ void UIElement::RemoveChild(UIElement* element, unsigned index)
 
             element->Detach();
             children_.Erase(i);
+            MarkBatchesDirty();
+            MarkHitTestDirty();
             UpdateLayout();
             return;
         }
@@ -1336,6 +1411,8 @@ void UIElement::RemoveChildAtIndex(unsigned index)
 
     children_[index]->Detach();
     children_.Erase(index);
+    MarkBatchesDirty();
+    MarkHitTestDirty();
     UpdateLayout();
 }
 
@@ -1362,6 +1439,8 @@ void UIElement::RemoveAllChildren()
         (*i++)->Detach();
     }
     children_.Clear();
+    MarkBatchesDirty();
+    MarkHitTestDirty();
     UpdateLayout();
 }
 
@@ -1396,6 +1475,7 @@ void UIElement::SetInternal(bool enable)
 void UIElement::SetTraversalMode(TraversalMode traversalMode)
 {
     traversalMode_ = traversalMode;
+    MarkBatchesDirty();
 }
 
 void UIElement::SetElementEventSender(bool flag)
@@ -1716,7 +1796,11 @@ void UIElement::SetChildOffset(const IntVector2& offset)
 
 void UIElement::SetHovering(bool enable)
 {
-    hovering_ = enable;
+    if (enable != hovering_)
+    {
+        hovering_ = enable;
+        MarkBatchesDirty();
+    }
 }
 
 void UIElement::AdjustScissor(IntRect& currentScissor)
@@ -1757,6 +1841,56 @@ void UIElement::GetBatchesWithOffset(IntVector2& offset, PODVector<UIBatch>& bat
     }
 }
 
+bool UIElement::GetCachedBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) const
+{
+    if (!cacheBatches_ || batchesDirty_ || currentScissor != cachedScissor_)
+        return false;
+
+    unsigned vertexOffset = vertexData.Size();
+    if (!cachedVertexData_.Empty())
+    {
+        vertexData.Resize(vertexOffset + cachedVertexData_.Size());
+        memcpy(&vertexData[vertexOffset], &cachedVertexData_[0], cachedVertexData_.Size() * sizeof(float));
+    }
+
+    for (unsigned i = 0; i < cachedBatches_.Size(); ++i)
+    {
+        UIBatch batch = cachedBatches_[i];
+        batch.vertexData_ = &vertexData;
+        batch.vertexStart_ += vertexOffset;
+        batch.vertexEnd_ += vertexOffset;
+        batches.Push(batch);
+    }
+
+    return true;
+}
+
+void UIElement::SetCachedBatches(const PODVector<UIBatch>& batches, unsigned batchStart, const PODVector<float>& vertexData,
+    unsigned vertexStart, const IntRect& currentScissor)
+{
+    // The first child quads may have been merged into the batch preceding the cached range. Start from that batch then,
+    // clamped to the cached vertices, so that the replayed batches cover all of them
+    if (batchStart && batches[batchStart - 1].vertexEnd_ > vertexStart)
+        --batchStart;
+
+    cachedBatches_.Clear();
+    for (unsigned i = batchStart; i < batches.Size(); ++i)
+    {
+        UIBatch batch = batches[i];
+        batch.vertexData_ = &cachedVertexData_;
+        batch.vertexStart_ = Max(batch.vertexStart_, vertexStart) - vertexStart;
+        batch.vertexEnd_ -= vertexStart;
+        cachedBatches_.Push(batch);
+    }
+
+    cachedVertexData_.Resize(vertexData.Size() - vertexStart);
+    if (!cachedVertexData_.Empty())
+        memcpy(&cachedVertexData_[0], &vertexData[vertexStart], cachedVertexData_.Size() * sizeof(float));
+
+    cachedScissor_ = currentScissor;
+    batchesDirty_ = false;
+}
+
 UIElement* UIElement::GetElementEventSender() const
 {
     UIElement* element = const_cast<UIElement*>(this);
@@ -1830,13 +1964,22 @@ Animatable* UIElement::FindAttributeAnimationTarget(const String& name, String&
 }
 
 void UIElement::MarkDirty()
+{
+    // The parents' batch caches only need to be marked once, the children are marked by the recursion below
+    MarkBatchesDirty();
+    QueueHitTestUpdate();
+    MarkDirtyRecursive();
+}
+
+void UIElement::MarkDirtyRecursive()
 {
     positionDirty_ = true;
     opacityDirty_ = true;
     derivedColorDirty_ = true;
+    batchesDirty_ = true;
 
     for (Vector<SharedPtr<UIElement> >::ConstIterator i = children_.Begin(); i != children_.End(); ++i)
-        (*i)->MarkDirty();
+        (*i)->MarkDirtyRecursive();
 }
 
 bool UIElement::RemoveChildXML(XMLElement& parent, const String& name) const
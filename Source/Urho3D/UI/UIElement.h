@@ -113,6 +113,8 @@ class URHO3D_API UIElement : public Animatable
 {
     URHO3D_OBJECT(UIElement, Animatable);
 
+    friend class UI;
+
 public:
     /// Construct.
     UIElement(Context* context);
@@ -259,6 +261,12 @@ public:
     void SetClipChildren(bool enable);
     /// Set whether should sort child elements according to priority. Default true.
     void SetSortChildren(bool enable);
+    /// Set whether to keep the rendering batches of child elements between frames and only rebuild them when the child elements change. Default false.
+    void SetCacheBatches(bool enable);
+    /// Mark the cached batches of this element and its parents as needing a rebuild. Layout, style, text, color and visibility changes do this automatically; call after changing custom rendering state.
+    void MarkBatchesDirty();
+    /// Mark the hit test index of the root element as needing a rebuild. Visibility, priority and hierarchy changes do this automatically. Position and size changes only update the element and its children in the index.
+    void MarkHitTestDirty();
     /// Set whether parent elements' opacity affects opacity. Default true.
     void SetUseDerivedOpacity(bool enable);
     /// Set whether reacts to input. Default false, but is enabled by subclasses if applicable.
@@ -432,6 +440,9 @@ public:
     /// Return whether should sort child elements according to priority.
     bool GetSortChildren() const { return sortChildren_; }
 
+    /// Return whether keeps the rendering batches of child elements between frames.
+    bool GetCacheBatches() const { return cacheBatches_; }
+
     /// Return whether parent elements' opacity affects opacity.
     bool GetUseDerivedOpacity() const { return useDerivedOpacity_; }
 
@@ -564,6 +575,11 @@ public:
     void AdjustScissor(IntRect& currentScissor);
     /// Get UI rendering batches with a specified offset. Also recurse to child elements.
     void GetBatchesWithOffset(IntVector2& offset, PODVector<UIBatch>& batches, PODVector<float>& vertexData, IntRect currentScissor);
+    /// Append the cached child element batches if they are still valid for the scissor. Return true if successful. Used internally.
+    bool GetCachedBatches(PODVector<UIBatch>& batches, PODVector<float>& vertexData, const IntRect& currentScissor) const;
+    /// Store child element batches from the given batch and vertex data start to the cache. Used internally.
+    void SetCachedBatches(const PODVector<UIBatch>& batches, unsigned batchStart, const PODVector<float>& vertexData,
+        unsigned vertexStart, const IntRect& currentScissor);
 
     /// Return color attribute. Uses just the top-left color.
     const Color& GetColorAttr() const { return color_[0]; }
@@ -688,6 +704,10 @@ private:
     IntVector2 GetLayoutChildPosition(UIElement* child);
     /// Detach from parent.
     void Detach();
+    /// Mark screen position and cached batches dirty for self and child elements.
+    void MarkDirtyRecursive();
+    /// Queue the element and its children for a hit test index update after a position or size change.
+    void QueueHitTestUpdate();
     /// Verify that child elements have proper alignment for layout mode.
     void VerifyChildAlignment();
     /// Handle logic post-update event.
@@ -719,6 +739,16 @@ private:
     mutable bool derivedColorDirty_;
     /// Child priority sorting dirty flag.
     bool sortOrderDirty_;
+    /// Cache child element batches flag.
+    bool cacheBatches_;
+    /// Cached child element batches dirty flag.
+    bool batchesDirty_;
+    /// Hit test index dirty flag. Only used in root elements.
+    bool hitTestDirty_;
+    /// Queued for a hit test index update flag.
+    bool hitTestQueued_;
+    /// Index in the UI's hit test index, valid only while the index holds this element at it.
+    unsigned hitTestIndex_;
     /// Has color gradient flag.
     bool colorGradient_;
     /// Default style file.
@@ -733,6 +763,12 @@ private:
     static XPathQuery styleXPathQuery_;
     /// Tag list.
     StringVector tags_;
+    /// Cached child element batches.
+    PODVector<UIBatch> cachedBatches_;
+    /// Cached child element vertex data.
+    PODVector<float> cachedVertexData_;
+    /// Scissor the child element batches were cached with.
+    IntRect cachedScissor_;
 };
 
 template <class T> T* UIElement::CreateChild(const String& name, unsigned index)
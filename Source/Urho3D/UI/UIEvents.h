@@ -260,6 +260,14 @@ URHO3D_EVENT(E_ITEMDOUBLECLICKED, ItemDoubleClicked)
     URHO3D_PARAM(P_QUALIFIERS, Qualifiers);        // int
 }
 
+/// Listview item element needs to be filled with the data of an item index in virtual mode.
+URHO3D_EVENT(E_VIRTUALITEMBIND, VirtualItemBind)
+{
+    URHO3D_PARAM(P_ELEMENT, Element);              // UIElement pointer
+    URHO3D_PARAM(P_ITEM, Item);                    // UIElement pointer
+    URHO3D_PARAM(P_INDEX, Index);                  // unsigned
+}
+
 /// LineEdit or ListView unhandled key pressed.
 URHO3D_EVENT(E_UNHANDLEDKEY, UnhandledKey)
 {
@@ -47,6 +47,7 @@ Drawable2D::Drawable2D(Context* context) :
     Drawable(context, DRAWABLE_GEOMETRY2D),
     layer_(0),
     orderInLayer_(0),
+    sourceBatchesVersion_(0),
     sourceBatchesDirty_(true)
 {
 }
@@ -99,7 +100,10 @@ void Drawable2D::SetOrderInLayer(int orderInLayer)
 const Vector<SourceBatch2D>& Drawable2D::GetSourceBatches()
 {
     if (sourceBatchesDirty_)
+    {
         UpdateSourceBatches();
+        ++sourceBatchesVersion_;
+    }
 
     return sourceBatches_;
 }
@@ -54,8 +54,8 @@ struct SourceBatch2D
     WeakPtr<Drawable2D> owner_;
     /// Distance to camera.
     mutable float distance_;
-    /// Draw order.
-    int drawOrder_;
+    /// Draw order. The drawable's layer and order in layer are in the high 32 bits, the order among its batches in the low 32 bits.
+    long long drawOrder_;
     /// Material.
     SharedPtr<Material> material_;
     /// Vertices.
@@ -94,6 +94,8 @@ public:
 
     /// Return all source batches (called by Renderer2D).
     const Vector<SourceBatch2D>& GetSourceBatches();
+    /// Return source batch version, incremented whenever the source batches are rebuilt.
+    unsigned GetSourceBatchesVersion() const { return sourceBatchesVersion_; }
 
 protected:
     /// Handle scene being assigned.
@@ -105,8 +107,8 @@ protected:
     /// Update source batches.
     virtual void UpdateSourceBatches() = 0;
 
-    /// Return draw order by layer and order in layer.
-    int GetDrawOrder() const { return (layer_ << 20) + (orderInLayer_ << 10); }
+    /// Return source batch draw order by layer and order in layer.
+    long long GetDrawOrder() const { return (long long)((layer_ << 20) + (orderInLayer_ << 10)) << 32; }
 
     /// Layer.
     int layer_;
@@ -114,6 +116,8 @@ protected:
     int orderInLayer_;
     /// Source batches.
     Vector<SourceBatch2D> sourceBatches_;
+    /// Source batches version.
+    unsigned sourceBatchesVersion_;
     /// Source batches dirty flag.
     bool sourceBatchesDirty_;
     /// Renderer2D.
@@ -51,4 +51,12 @@ URHO3D_EVENT(E_PHYSICSENDCONTACT2D, PhysicsEndContact2D)
     URHO3D_PARAM(P_NODEB, NodeB);                  // Node pointer
 }
 
+/// Physics contacts of a step in batched contact mode. Query them from the world with GetBeginContacts() and GetEndContacts().
+URHO3D_EVENT(E_PHYSICSCONTACTS2D, PhysicsContacts2D)
+{
+    URHO3D_PARAM(P_WORLD, World);                  // PhysicsWorld2D pointer
+    URHO3D_PARAM(P_NUMBEGINCONTACTS, NumBeginContacts); // int
+    URHO3D_PARAM(P_NUMENDCONTACTS, NumEndContacts); // int
+}
+
 }
@@ -24,12 +24,14 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Container/Sort.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
 #include "../IO/Log.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
+#include "../Urho2D/CollisionShape2D.h"
 #include "../Urho2D/PhysicsEvents2D.h"
 #include "../Urho2D/PhysicsUtils2D.h"
 #include "../Urho2D/PhysicsWorld2D.h"
@@ -44,6 +46,7 @@ extern const char* SUBSYSTEM_CATEGORY;
 static const Vector2 DEFAULT_GRAVITY(0.0f, -9.81f);
 static const int DEFAULT_VELOCITY_ITERATIONS = 8;
 static const int DEFAULT_POSITION_ITERATIONS = 3;
+static const int DEFAULT_FPS = 60;
 
 PhysicsWorld2D::PhysicsWorld2D(Context* context) :
     Component(context),
@@ -51,9 +54,14 @@ PhysicsWorld2D::PhysicsWorld2D(Context* context) :
     gravity_(DEFAULT_GRAVITY),
     velocityIterations_(DEFAULT_VELOCITY_ITERATIONS),
     positionIterations_(DEFAULT_POSITION_ITERATIONS),
+    fps_(DEFAULT_FPS),
+    maxSubSteps_(0),
+    timeAcc_(0.0f),
+    interpolation_(true),
     debugRenderer_(0),
     physicsStepping_(false),
     applyingTransforms_(false),
+    batchContactEvents_(false),
     updateEnabled_(true)
 {
     // Set default debug draw flags
@@ -99,6 +107,10 @@ void PhysicsWorld2D::RegisterObject(Context* context)
         AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Position Iterations", GetPositionIterations, SetPositionIterations, int, DEFAULT_POSITION_ITERATIONS,
         AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Batch Contact Events", GetBatchContactEvents, SetBatchContactEvents, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Physics FPS", GetFps, SetFps, int, DEFAULT_FPS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Max Substeps", GetMaxSubSteps, SetMaxSubSteps, int, 0, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Interpolation", GetInterpolation, SetInterpolation, bool, true, AM_FILE);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -125,7 +137,14 @@ void PhysicsWorld2D::BeginContact(b2Contact* contact)
     if (!fixtureA || !fixtureB)
         return;
 
-    beginContactInfos_.Push(ContactInfo(contact));
+    if (batchContactEvents_)
+    {
+        beginContactIndices_[contact] = beginContacts_.Size();
+        beginContacts_.Resize(beginContacts_.Size() + 1);
+        FillContact(beginContacts_.Back(), contact);
+    }
+    else
+        beginContactInfos_.Push(ContactInfo(contact));
 }
 
 void PhysicsWorld2D::EndContact(b2Contact* contact)
@@ -138,7 +157,29 @@ void PhysicsWorld2D::EndContact(b2Contact* contact)
     if (!fixtureA || !fixtureB)
         return;
 
-    endContactInfos_.Push(ContactInfo(contact));
+    if (batchContactEvents_)
+    {
+        // The Box2D contact is destroyed after this, so it may not receive further impulses
+        beginContactIndices_.Erase(contact);
+        endContacts_.Resize(endContacts_.Size() + 1);
+        FillContact(endContacts_.Back(), contact);
+    }
+    else
+        endContactInfos_.Push(ContactInfo(contact));
+}
+
+void PhysicsWorld2D::PostSolve(b2Contact* contact, const b2ContactImpulse* impulse)
+{
+    if (!physicsStepping_ || beginContactIndices_.Empty())
+        return;
+
+    HashMap<b2Contact*, unsigned>::ConstIterator i = beginContactIndices_.Find(contact);
+    if (i == beginContactIndices_.End())
+        return;
+
+    PhysicsContact2D& record = beginContacts_[i->second_];
+    for (int j = 0; j < impulse->count; ++j)
+        record.impulse_ += impulse->normalImpulses[j];
 }
 
 void PhysicsWorld2D::DrawPolygon(const b2Vec2* vertices, int32 vertexCount, const b2Color& color)
@@ -228,56 +269,47 @@ void PhysicsWorld2D::Update(float timeStep)
 {
     URHO3D_PROFILE(UpdatePhysics2D);
 
-    using namespace PhysicsPreStep;
-
-    VariantMap& eventData = GetEventDataMap();
-    eventData[P_WORLD] = this;
-    eventData[P_TIMESTEP] = timeStep;
-    SendEvent(E_PHYSICSPRESTEP, eventData);
-
-    physicsStepping_ = true;
-    world_->Step(timeStep, velocityIterations_, positionIterations_);
-    physicsStepping_ = false;
-
-    // Apply world transforms. Unparented transforms first
-    for (unsigned i = 0; i < rigidBodies_.Size();)
+    float internalTimeStep = 1.0f / fps_;
+    int maxSubSteps = (int)(timeStep * fps_) + 1;
+    if (maxSubSteps_ < 0)
     {
-        if (rigidBodies_[i])
-        {
-            rigidBodies_[i]->ApplyWorldTransform();
-            ++i;
-        }
-        else
-        {
-            // Erase possible stale weak pointer
-            rigidBodies_.Erase(i);
-        }
+        // Variable timestep: step once with the whole frame time
+        internalTimeStep = timeStep;
+        maxSubSteps = 1;
+        timeAcc_ = 0.0f;
     }
+    else if (maxSubSteps_ > 0)
+        maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
-    // Apply delayed (parented) world transforms now, if any
-    while (!delayedWorldTransforms_.Empty())
+    timeAcc_ += timeStep;
+    int numSteps = internalTimeStep > 0.0f ? Min((int)(timeAcc_ / internalTimeStep), maxSubSteps) : 0;
+    bool interpolate = interpolation_ && maxSubSteps_ >= 0;
+
+    for (int i = 0; i < numSteps; ++i)
     {
-        for (HashMap<RigidBody2D*, DelayedWorldTransform2D>::Iterator i = delayedWorldTransforms_.Begin();
-            i != delayedWorldTransforms_.End();)
+        // Only the last step is needed as the interpolation start
+        if (interpolate && i == numSteps - 1)
         {
-            const DelayedWorldTransform2D& transform = i->second_;
-
-            // If parent's transform has already been assigned, can proceed
-            if (!delayedWorldTransforms_.Contains(transform.parentRigidBody_))
+            for (unsigned j = 0; j < rigidBodies_.Size(); ++j)
             {
-                transform.rigidBody_->ApplyWorldTransform(transform.worldPosition_, transform.worldRotation_);
-                i = delayedWorldTransforms_.Erase(i);
+                if (rigidBodies_[j])
+                    rigidBodies_[j]->StorePreviousTransform();
             }
-            else
-                ++i;
         }
+
+        StepSimulation(internalTimeStep, !interpolate);
+        timeAcc_ -= internalTimeStep;
     }
 
-    SendBeginContactEvents();
-    SendEndContactEvents();
+    // Discard the time that could not be simulated due to the substep limit, so that the simulation does not fall behind
+    if (maxSubSteps_ < 0 || timeAcc_ < 0.0f)
+        timeAcc_ = 0.0f;
+    else if (timeAcc_ >= internalTimeStep)
+        timeAcc_ = fmodf(timeAcc_, internalTimeStep);
 
-    using namespace PhysicsPostStep;
-    SendEvent(E_PHYSICSPOSTSTEP, eventData);
+    // The interpolated transforms change every frame, even if no step was taken
+    if (interpolate)
+        ApplyWorldTransforms(timeAcc_ / internalTimeStep);
 }
 
 void PhysicsWorld2D::DrawDebugGeometry()
@@ -292,6 +324,21 @@ void PhysicsWorld2D::SetUpdateEnabled(bool enable)
     updateEnabled_ = enable;
 }
 
+void PhysicsWorld2D::SetFps(int fps)
+{
+    fps_ = Clamp(fps, 1, 1000);
+}
+
+void PhysicsWorld2D::SetMaxSubSteps(int num)
+{
+    maxSubSteps_ = num;
+}
+
+void PhysicsWorld2D::SetInterpolation(bool enable)
+{
+    interpolation_ = enable;
+}
+
 void PhysicsWorld2D::SetDrawShape(bool drawShape)
 {
     if (drawShape)
@@ -375,6 +422,21 @@ void PhysicsWorld2D::SetPositionIterations(int positionIterations)
     positionIterations_ = positionIterations;
 }
 
+void PhysicsWorld2D::SetBatchContactEvents(bool enable)
+{
+    if (enable == batchContactEvents_)
+        return;
+
+    // Do not mix contacts collected in the two modes
+    if (physicsStepping_)
+    {
+        URHO3D_LOGERROR("Can not change contact event mode while stepping the physics simulation");
+        return;
+    }
+
+    batchContactEvents_ = enable;
+}
+
 void PhysicsWorld2D::AddRigidBody(RigidBody2D* rigidBody)
 {
     if (!rigidBody)
@@ -668,6 +730,77 @@ void PhysicsWorld2D::HandleSceneSubsystemUpdate(StringHash eventType, VariantMap
     Update(eventData[P_TIMESTEP].GetFloat());
 }
 
+void PhysicsWorld2D::StepSimulation(float timeStep, bool applyTransforms)
+{
+    using namespace PhysicsPreStep;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_WORLD] = this;
+    eventData[P_TIMESTEP] = timeStep;
+    SendEvent(E_PHYSICSPRESTEP, eventData);
+
+    physicsStepping_ = true;
+    world_->Step(timeStep, velocityIterations_, positionIterations_);
+    physicsStepping_ = false;
+    beginContactIndices_.Clear();
+
+    // When interpolating, the transforms are applied once after all steps instead
+    if (applyTransforms)
+        ApplyWorldTransforms(1.0f);
+
+    if (batchContactEvents_)
+        SendBatchedContactEvents();
+    else
+    {
+        SendBeginContactEvents();
+        SendEndContactEvents();
+    }
+
+    // The contact events reuse the event data map, so fill it again
+    eventData[PhysicsPostStep::P_WORLD] = this;
+    eventData[PhysicsPostStep::P_TIMESTEP] = timeStep;
+    SendEvent(E_PHYSICSPOSTSTEP, eventData);
+
+    ClearBatchedContacts();
+}
+
+void PhysicsWorld2D::ApplyWorldTransforms(float interpolation)
+{
+    // Apply world transforms. Unparented transforms first
+    for (unsigned i = 0; i < rigidBodies_.Size();)
+    {
+        if (rigidBodies_[i])
+        {
+            rigidBodies_[i]->ApplyWorldTransform(interpolation);
+            ++i;
+        }
+        else
+        {
+            // Erase possible stale weak pointer
+            rigidBodies_.Erase(i);
+        }
+    }
+
+    // Apply delayed (parented) world transforms now, if any
+    while (!delayedWorldTransforms_.Empty())
+    {
+        for (HashMap<RigidBody2D*, DelayedWorldTransform2D>::Iterator i = delayedWorldTransforms_.Begin();
+            i != delayedWorldTransforms_.End();)
+        {
+            const DelayedWorldTransform2D& transform = i->second_;
+
+            // If parent's transform has already been assigned, can proceed
+            if (!delayedWorldTransforms_.Contains(transform.parentRigidBody_))
+            {
+                transform.rigidBody_->ApplyWorldTransform(transform.worldPosition_, transform.worldRotation_);
+                i = delayedWorldTransforms_.Erase(i);
+            }
+            else
+                ++i;
+        }
+    }
+}
+
 void PhysicsWorld2D::SendBeginContactEvents()
 {
     if (beginContactInfos_.Empty())
@@ -714,6 +847,110 @@ void PhysicsWorld2D::SendEndContactEvents()
     endContactInfos_.Clear();
 }
 
+void PhysicsWorld2D::SendBatchedContactEvents()
+{
+    if (beginContacts_.Empty() && endContacts_.Empty())
+        return;
+
+    // Index the contacts by node for the per-node queries
+    beginNodeContacts_.Resize(beginContacts_.Size() * 2);
+    for (unsigned i = 0; i < beginContacts_.Size(); ++i)
+    {
+        const PhysicsContact2D& record = beginContacts_[i];
+        beginNodeContacts_[i * 2] = MakePair(record.nodeA_, i);
+        beginNodeContacts_[i * 2 + 1] = MakePair(record.nodeB_, i);
+    }
+    Sort(beginNodeContacts_.Begin(), beginNodeContacts_.End());
+
+    endNodeContacts_.Resize(endContacts_.Size() * 2);
+    for (unsigned i = 0; i < endContacts_.Size(); ++i)
+    {
+        const PhysicsContact2D& record = endContacts_[i];
+        endNodeContacts_[i * 2] = MakePair(record.nodeA_, i);
+        endNodeContacts_[i * 2 + 1] = MakePair(record.nodeB_, i);
+    }
+    Sort(endNodeContacts_.Begin(), endNodeContacts_.End());
+
+    using namespace PhysicsContacts2D;
+
+    VariantMap& eventData = GetEventDataMap();
+    eventData[P_WORLD] = this;
+    eventData[P_NUMBEGINCONTACTS] = (int)beginContacts_.Size();
+    eventData[P_NUMENDCONTACTS] = (int)endContacts_.Size();
+    SendEvent(E_PHYSICSCONTACTS2D, eventData);
+}
+
+void PhysicsWorld2D::ClearBatchedContacts()
+{
+    beginContacts_.Clear();
+    endContacts_.Clear();
+    beginNodeContacts_.Clear();
+    endNodeContacts_.Clear();
+    contactRefs_.Clear();
+}
+
+void PhysicsWorld2D::FillContact(PhysicsContact2D& record, b2Contact* contact)
+{
+    b2Fixture* fixtureA = contact->GetFixtureA();
+    b2Fixture* fixtureB = contact->GetFixtureB();
+    record.bodyA_ = (RigidBody2D*)(fixtureA->GetBody()->GetUserData());
+    record.bodyB_ = (RigidBody2D*)(fixtureB->GetBody()->GetUserData());
+    record.nodeA_ = record.bodyA_->GetNode();
+    record.nodeB_ = record.bodyB_->GetNode();
+    record.shapeA_ = (CollisionShape2D*)fixtureA->GetUserData();
+    record.shapeB_ = (CollisionShape2D*)fixtureB->GetUserData();
+    record.impulse_ = 0.0f;
+
+    b2WorldManifold worldManifold;
+    contact->GetWorldManifold(&worldManifold);
+    record.normal_ = ToVector2(worldManifold.normal);
+    record.position_ = contact->GetManifold()->pointCount ? ToVector2(worldManifold.points[0]) : Vector2::ZERO;
+
+    // Keep the contacting objects alive until the end of the step, in case event handlers remove them
+    contactRefs_.Push(SharedPtr<RefCounted>(record.bodyA_));
+    contactRefs_.Push(SharedPtr<RefCounted>(record.bodyB_));
+    contactRefs_.Push(SharedPtr<RefCounted>(record.nodeA_));
+    contactRefs_.Push(SharedPtr<RefCounted>(record.nodeB_));
+    contactRefs_.Push(SharedPtr<RefCounted>(record.shapeA_));
+    contactRefs_.Push(SharedPtr<RefCounted>(record.shapeB_));
+}
+
+void PhysicsWorld2D::GetBeginContacts(PODVector<PhysicsContact2D>& result, Node* node) const
+{
+    GetNodeContacts(result, node, beginContacts_, beginNodeContacts_);
+}
+
+void PhysicsWorld2D::GetEndContacts(PODVector<PhysicsContact2D>& result, Node* node) const
+{
+    GetNodeContacts(result, node, endContacts_, endNodeContacts_);
+}
+
+void PhysicsWorld2D::GetNodeContacts(PODVector<PhysicsContact2D>& result, Node* node, const PODVector<PhysicsContact2D>& contacts,
+    const PODVector<Pair<Node*, unsigned> >& nodeContacts) const
+{
+    result.Clear();
+
+    // Binary search for the first contact of the node
+    unsigned first = 0;
+    unsigned last = nodeContacts.Size();
+    while (first < last)
+    {
+        unsigned middle = (first + last) / 2;
+        if (nodeContacts[middle].first_ < node)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    for (unsigned i = first; i < nodeContacts.Size() && nodeContacts[i].first_ == node; ++i)
+    {
+        // A node contacting itself appears twice in a row
+        if (i > first && nodeContacts[i].second_ == nodeContacts[i - 1].second_)
+            continue;
+        result.Push(contacts[nodeContacts[i].second_]);
+    }
+}
+
 PhysicsWorld2D::ContactInfo::ContactInfo()
 {
 }
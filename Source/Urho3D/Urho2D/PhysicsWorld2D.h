@@ -30,6 +30,7 @@ namespace Urho3D
 {
 
 class Camera;
+class CollisionShape2D;
 class RigidBody2D;
 
 /// 2D Physics raycast hit.
@@ -57,6 +58,41 @@ struct URHO3D_API PhysicsRaycastResult2D
     RigidBody2D* body_;
 };
 
+/// 2D physics contact record for batched contact event delivery.
+struct URHO3D_API PhysicsContact2D
+{
+    /// Construct with defaults.
+    PhysicsContact2D() :
+        bodyA_(0),
+        bodyB_(0),
+        nodeA_(0),
+        nodeB_(0),
+        shapeA_(0),
+        shapeB_(0),
+        impulse_(0.0f)
+    {
+    }
+
+    /// Rigid body A.
+    RigidBody2D* bodyA_;
+    /// Rigid body B.
+    RigidBody2D* bodyB_;
+    /// Node A.
+    Node* nodeA_;
+    /// Node B.
+    Node* nodeB_;
+    /// Collision shape A.
+    CollisionShape2D* shapeA_;
+    /// Collision shape B.
+    CollisionShape2D* shapeB_;
+    /// Contact worldspace position. Zero if the shapes do not generate contact points, for example sensors.
+    Vector2 position_;
+    /// Contact worldspace normal, pointing from A to B.
+    Vector2 normal_;
+    /// Total normal impulse applied during the step. Zero for end contacts.
+    float impulse_;
+};
+
 /// Delayed world transform assignment for parented 2D rigidbodies.
 struct DelayedWorldTransform2D
 {
@@ -91,6 +127,8 @@ public:
     virtual void BeginContact(b2Contact* contact);
     /// Called when two fixtures cease to touch.
     virtual void EndContact(b2Contact* contact);
+    /// Called after the solver has finished with a touching contact.
+    virtual void PostSolve(b2Contact* contact, const b2ContactImpulse* impulse);
 
     // Implement b2Draw.
     /// Draw a closed polygon provided in CCW order.
@@ -112,6 +150,12 @@ public:
     void DrawDebugGeometry();
     /// Enable or disable automatic physics simulation during scene update. Enabled by default.
     void SetUpdateEnabled(bool enable);
+    /// Set simulation substeps per second.
+    void SetFps(int fps);
+    /// Set maximum number of physics substeps per frame. 0 (default) is unlimited. Positive values cap the amount. Use a negative value to step once per frame with the frame's timestep. This may cause inconsistent physics behavior.
+    void SetMaxSubSteps(int num);
+    /// Set whether to interpolate rendered transforms between simulation steps.
+    void SetInterpolation(bool enable);
     /// Set draw shape.
     void SetDrawShape(bool drawShape);
     /// Set draw joint.
@@ -138,6 +182,8 @@ public:
     void SetVelocityIterations(int velocityIterations);
     /// Set position iterations.
     void SetPositionIterations(int positionIterations);
+    /// Set whether to deliver contacts as one E_PHYSICSCONTACTS2D event per step instead of one event per contact. Default false.
+    void SetBatchContactEvents(bool enable);
     /// Add rigid body.
     void AddRigidBody(RigidBody2D* rigidBody);
     /// Remove rigid body.
@@ -157,10 +203,29 @@ public:
     RigidBody2D* GetRigidBody(int screenX, int screenY, unsigned collisionMask = M_MAX_UNSIGNED);
     /// Return rigid bodies by a box query.
     void GetRigidBodies(PODVector<RigidBody2D*>& result, const Rect& aabb, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Return begin contacts of a node during the last step. Only valid in batched contact mode during E_PHYSICSCONTACTS2D and E_PHYSICSPOSTSTEP.
+    void GetBeginContacts(PODVector<PhysicsContact2D>& result, Node* node) const;
+    /// Return end contacts of a node during the last step. Only valid in batched contact mode during E_PHYSICSCONTACTS2D and E_PHYSICSPOSTSTEP.
+    void GetEndContacts(PODVector<PhysicsContact2D>& result, Node* node) const;
+
+    /// Return all begin contacts during the last step. Only valid in batched contact mode during E_PHYSICSCONTACTS2D and E_PHYSICSPOSTSTEP.
+    const PODVector<PhysicsContact2D>& GetBeginContacts() const { return beginContacts_; }
+
+    /// Return all end contacts during the last step. Only valid in batched contact mode during E_PHYSICSCONTACTS2D and E_PHYSICSPOSTSTEP.
+    const PODVector<PhysicsContact2D>& GetEndContacts() const { return endContacts_; }
 
     /// Return whether physics world will automatically simulate during scene update.
     bool IsUpdateEnabled() const { return updateEnabled_; }
 
+    /// Return simulation steps per second.
+    int GetFps() const { return fps_; }
+
+    /// Return maximum number of physics substeps per frame.
+    int GetMaxSubSteps() const { return maxSubSteps_; }
+
+    /// Return whether interpolation between simulation steps is enabled.
+    bool GetInterpolation() const { return interpolation_; }
+
     /// Return draw shape.
     bool GetDrawShape() const { return (m_drawFlags & e_shapeBit) != 0; }
 
@@ -196,6 +261,9 @@ public:
     /// Return position iterations.
     int GetPositionIterations() const { return positionIterations_; }
 
+    /// Return whether contacts are delivered as one event per step.
+    bool GetBatchContactEvents() const { return batchContactEvents_; }
+
     /// Return the Box2D physics world.
     b2World* GetWorld() { return world_; }
 
@@ -212,10 +280,23 @@ protected:
 private:
     /// Handle the scene subsystem update event, step simulation here.
     void HandleSceneSubsystemUpdate(StringHash eventType, VariantMap& eventData);
+    /// Perform one simulation step and send the step and contact events.
+    void StepSimulation(float timeStep, bool applyTransforms);
+    /// Apply world transforms from the Box2D bodies to the scene nodes, interpolating from the previous step by the given factor.
+    void ApplyWorldTransforms(float interpolation);
     /// Send begin contact events.
     void SendBeginContactEvents();
     /// Send end contact events.
     void SendEndContactEvents();
+    /// Send the batched contacts event.
+    void SendBatchedContactEvents();
+    /// Clear the batched contacts.
+    void ClearBatchedContacts();
+    /// Fill a batched contact record and keep the contacting objects alive.
+    void FillContact(PhysicsContact2D& record, b2Contact* contact);
+    /// Return contacts of a node using a node contact index.
+    void GetNodeContacts(PODVector<PhysicsContact2D>& result, Node* node, const PODVector<PhysicsContact2D>& contacts,
+        const PODVector<Pair<Node*, unsigned> >& nodeContacts) const;
 
     /// Box2D physics world.
     b2World* world_;
@@ -225,6 +306,14 @@ private:
     int velocityIterations_;
     /// Position iterations.
     int positionIterations_;
+    /// Simulation substeps per second.
+    int fps_;
+    /// Maximum number of simulation substeps per frame. 0 (default) unlimited, or negative values for one variable timestep per frame.
+    int maxSubSteps_;
+    /// Time accumulator for fixed timestep.
+    float timeAcc_;
+    /// Interpolation flag.
+    bool interpolation_;
 
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
     WeakPtr<Scene> scene_;
@@ -239,6 +328,8 @@ private:
     bool physicsStepping_;
     /// Applying transforms.
     bool applyingTransforms_;
+    /// Batched contact event delivery flag.
+    bool batchContactEvents_;
     /// Rigid bodies.
     Vector<WeakPtr<RigidBody2D> > rigidBodies_;
     /// Delayed (parented) world transform assignments.
@@ -267,6 +358,18 @@ private:
     Vector<ContactInfo> beginContactInfos_;
     /// End contact infos.
     Vector<ContactInfo> endContactInfos_;
+    /// Batched begin contacts.
+    PODVector<PhysicsContact2D> beginContacts_;
+    /// Batched end contacts.
+    PODVector<PhysicsContact2D> endContacts_;
+    /// Batched begin contact indices by node, sorted by node.
+    PODVector<Pair<Node*, unsigned> > beginNodeContacts_;
+    /// Batched end contact indices by node, sorted by node.
+    PODVector<Pair<Node*, unsigned> > endNodeContacts_;
+    /// Batched begin contact indices by Box2D contact, for accumulating impulses during the step.
+    HashMap<b2Contact*, unsigned> beginContactIndices_;
+    /// References to keep contacting objects alive during batched contact event handling.
+    Vector<SharedPtr<RefCounted> > contactRefs_;
 };
 
 }
@@ -49,11 +49,15 @@ namespace Urho3D
 extern const char* blendModeNames[];
 
 static const unsigned MASK_VERTEX2D = MASK_POSITION | MASK_COLOR | MASK_TEXCOORD1;
+/// Minimum number of changed vertices before the copy to the vertex buffer is split between worker threads.
+static const unsigned MIN_VERTICES_PER_COPY_ITEM = 8192;
 
 ViewBatchInfo2D::ViewBatchInfo2D() :
     vertexBufferUpdateFrameNumber_(0),
     indexCount_(0),
     vertexCount_(0),
+    copyDest_(0),
+    copyStart_(0),
     batchUpdatedFrameNumber_(0),
     batchCount_(0)
 {
@@ -140,6 +144,8 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
     // Fill index buffer
     if (indexBuffer_->GetIndexCount() < indexCount || indexBuffer_->IsDataLost())
     {
+        // Grow in powers of two quads so that the index buffer is rarely rebuilt as the sprite count rises
+        indexCount = Max(NextPowerOfTwo(indexCount / 6), indexBuffer_->GetIndexCount() / 6) * 6;
         bool largeIndices = (indexCount * 4 / 6) > 0xffff;
         indexBuffer_->SetSize(indexCount, largeIndices);
 
@@ -192,31 +198,7 @@ void Renderer2D::UpdateGeometry(const FrameInfo& frame)
 
     if (viewBatchInfo.vertexBufferUpdateFrameNumber_ != frame_.frameNumber_)
     {
-        unsigned vertexCount = viewBatchInfo.vertexCount_;
-        VertexBuffer* vertexBuffer = viewBatchInfo.vertexBuffer_;
-        if (vertexBuffer->GetVertexCount() < vertexCount)
-            vertexBuffer->SetSize(vertexCount, MASK_VERTEX2D, true);
-
-        if (vertexCount)
-        {
-            Vertex2D* dest = reinterpret_cast<Vertex2D*>(vertexBuffer->Lock(0, vertexCount, true));
-            if (dest)
-            {
-                const PODVector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
-                for (unsigned b = 0; b < sourceBatches.Size(); ++b)
-                {
-                    const Vector<Vertex2D>& vertices = sourceBatches[b]->vertices_;
-                    for (unsigned i = 0; i < vertices.Size(); ++i)
-                        dest[i] = vertices[i];
-                    dest += vertices.Size();
-                }
-
-                vertexBuffer->Unlock();
-            }
-            else
-                URHO3D_LOGERROR("Failed to lock vertex buffer");
-        }
-
+        UpdateVertexBuffer(viewBatchInfo);
         viewBatchInfo.vertexBufferUpdateFrameNumber_ = frame_.frameNumber_;
     }
 }
@@ -240,6 +222,10 @@ void Renderer2D::RemoveDrawable(Drawable2D* drawable)
         return;
 
     drawables_.Remove(drawable);
+
+    // The drawable's source batches may be freed and their addresses reused, so forget what has been uploaded
+    for (HashMap<Camera*, ViewBatchInfo2D>::Iterator i = viewBatchInfos_.Begin(); i != viewBatchInfos_.End(); ++i)
+        i->second_.uploadedBatches_.Clear();
 }
 
 Material* Renderer2D::GetMaterial(Texture2D* texture, BlendMode blendMode)
@@ -319,6 +305,24 @@ void CheckDrawableVisibility(const WorkItem* item, unsigned threadIndex)
     }
 }
 
+static void CopySourceBatchVertices(const ViewBatchInfo2D& viewBatchInfo, const unsigned* start, const unsigned* end)
+{
+    while (start != end)
+    {
+        unsigned b = *start++;
+        const Vector<Vertex2D>& vertices = viewBatchInfo.sourceBatches_[b]->vertices_;
+        memcpy(viewBatchInfo.copyDest_ + (viewBatchInfo.vertexStarts_[b] - viewBatchInfo.copyStart_), &vertices[0],
+            vertices.Size() * sizeof(Vertex2D));
+    }
+}
+
+static void CopySourceBatchVerticesWork(const WorkItem* item, unsigned threadIndex)
+{
+    const ViewBatchInfo2D* viewBatchInfo = reinterpret_cast<const ViewBatchInfo2D*>(item->aux_);
+    CopySourceBatchVertices(*viewBatchInfo, reinterpret_cast<const unsigned*>(item->start_),
+        reinterpret_cast<const unsigned*>(item->end_));
+}
+
 void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace BeginViewUpdate;
@@ -355,8 +359,8 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
             if (i < numWorkItems - 1 && end - start > drawablesPerItem)
                 end = start + drawablesPerItem;
 
-            item->start_ = &(*start);
-            item->end_ = &(*end);
+            item->start_ = start.ptr_;
+            item->end_ = end.ptr_;
             queue->AddWorkItem(item);
 
             start = end;
@@ -369,7 +373,10 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
 
     // Create vertex buffer
     if (!viewBatchInfo.vertexBuffer_)
+    {
         viewBatchInfo.vertexBuffer_ = new VertexBuffer(context_);
+        viewBatchInfo.vertexBuffer_->SetShadowed(true);
+    }
 
     UpdateViewBatchInfo(viewBatchInfo, camera);
 
@@ -491,6 +498,120 @@ void Renderer2D::UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* cam
     viewBatchInfo.batchUpdatedFrameNumber_ = frame_.frameNumber_;
 }
 
+void Renderer2D::UpdateVertexBuffer(ViewBatchInfo2D& viewBatchInfo)
+{
+    unsigned vertexCount = viewBatchInfo.vertexCount_;
+    VertexBuffer* vertexBuffer = viewBatchInfo.vertexBuffer_;
+    if (vertexBuffer->GetVertexCount() < vertexCount)
+    {
+        // Resizing loses the shadow data, so everything must be copied again
+        vertexBuffer->SetSize(NextPowerOfTwo(vertexCount), MASK_VERTEX2D, true);
+        viewBatchInfo.uploadedBatches_.Clear();
+    }
+    else if (vertexBuffer->IsDataLost())
+    {
+        viewBatchInfo.uploadedBatches_.Clear();
+        vertexBuffer->ClearDataLost();
+    }
+
+    if (!vertexCount)
+        return;
+
+    // Compare the sorted source batches against the previous upload. A source batch only needs copying if it is new,
+    // has been rebuilt by its drawable, or has moved inside the vertex buffer
+    const PODVector<const SourceBatch2D*>& sourceBatches = viewBatchInfo.sourceBatches_;
+    PODVector<const SourceBatch2D*>& uploadedBatches = viewBatchInfo.uploadedBatches_;
+    PODVector<unsigned>& uploadedVersions = viewBatchInfo.uploadedVersions_;
+    PODVector<unsigned>& vertexStarts = viewBatchInfo.vertexStarts_;
+    PODVector<unsigned>& dirtyBatches = viewBatchInfo.dirtyBatches_;
+
+    unsigned numUploaded = uploadedBatches.Size();
+    uploadedBatches.Resize(sourceBatches.Size());
+    uploadedVersions.Resize(sourceBatches.Size());
+    dirtyBatches.Clear();
+
+    unsigned vertexStart = 0;
+    unsigned dirtyStart = M_MAX_UNSIGNED;
+    unsigned dirtyEnd = 0;
+    unsigned numDirtyVertices = 0;
+
+    for (unsigned b = 0; b < sourceBatches.Size(); ++b)
+    {
+        const SourceBatch2D* sourceBatch = sourceBatches[b];
+        unsigned version = sourceBatch->owner_->GetSourceBatchesVersion();
+        unsigned numVertices = sourceBatch->vertices_.Size();
+
+        // Vertex starts of the previous upload are only overwritten below, so compare against them before that
+        bool unchanged = b < numUploaded && uploadedBatches[b] == sourceBatch && uploadedVersions[b] == version &&
+            vertexStarts[b] == vertexStart;
+
+        if (!unchanged)
+        {
+            uploadedBatches[b] = sourceBatch;
+            uploadedVersions[b] = version;
+            dirtyBatches.Push(b);
+            dirtyStart = Min(dirtyStart, vertexStart);
+            dirtyEnd = Max(dirtyEnd, vertexStart + numVertices);
+            numDirtyVertices += numVertices;
+        }
+
+        if (vertexStarts.Size() <= b)
+            vertexStarts.Push(vertexStart);
+        else
+            vertexStarts[b] = vertexStart;
+
+        vertexStart += numVertices;
+    }
+
+    // Forget source batches that are no longer drawn
+    vertexStarts.Resize(sourceBatches.Size());
+
+    if (dirtyBatches.Empty())
+        return;
+
+    viewBatchInfo.copyDest_ = reinterpret_cast<Vertex2D*>(vertexBuffer->Lock(dirtyStart, dirtyEnd - dirtyStart));
+    viewBatchInfo.copyStart_ = dirtyStart;
+    if (!viewBatchInfo.copyDest_)
+    {
+        URHO3D_LOGERROR("Failed to lock vertex buffer");
+        uploadedBatches.Clear();
+        return;
+    }
+
+    WorkQueue* queue = GetSubsystem<WorkQueue>();
+    unsigned numWorkItems = Min(queue->GetNumThreads() + 1, numDirtyVertices / MIN_VERTICES_PER_COPY_ITEM);
+    if (numWorkItems > 1)
+    {
+        URHO3D_PROFILE(CopySourceBatchVertices);
+
+        unsigned batchesPerItem = dirtyBatches.Size() / numWorkItems;
+        PODVector<unsigned>::Iterator start = dirtyBatches.Begin();
+        for (unsigned i = 0; i < numWorkItems; ++i)
+        {
+            SharedPtr<WorkItem> item = queue->GetFreeItem();
+            item->priority_ = M_MAX_UNSIGNED;
+            item->workFunction_ = CopySourceBatchVerticesWork;
+            item->aux_ = &viewBatchInfo;
+
+            PODVector<unsigned>::Iterator end = dirtyBatches.End();
+            if (i < numWorkItems - 1 && end - start > (int)batchesPerItem)
+                end = start + batchesPerItem;
+
+            item->start_ = start.ptr_;
+            item->end_ = end.ptr_;
+            queue->AddWorkItem(item);
+
+            start = end;
+        }
+
+        queue->Complete(M_MAX_UNSIGNED);
+    }
+    else
+        CopySourceBatchVertices(viewBatchInfo, dirtyBatches.Begin().ptr_, dirtyBatches.End().ptr_);
+
+    vertexBuffer->Unlock();
+}
+
 void Renderer2D::AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material, 
     unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance)
 {
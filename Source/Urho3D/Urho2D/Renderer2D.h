@@ -35,6 +35,7 @@ class Technique;
 class VertexBuffer;
 struct FrameInfo;
 struct SourceBatch2D;
+struct Vertex2D;
 
 /// 2D view batch info.
 struct ViewBatchInfo2D
@@ -48,8 +49,20 @@ struct ViewBatchInfo2D
     unsigned indexCount_;
     /// Vertex count.
     unsigned vertexCount_;
-    /// Vertex buffer.
+    /// Vertex buffer. Shadowed, so that unchanged source batches can be left in place between frames.
     SharedPtr<VertexBuffer> vertexBuffer_;
+    /// Source batches currently stored in the vertex buffer.
+    PODVector<const SourceBatch2D*> uploadedBatches_;
+    /// Source batch versions currently stored in the vertex buffer.
+    PODVector<unsigned> uploadedVersions_;
+    /// Vertex start of each source batch in the vertex buffer.
+    PODVector<unsigned> vertexStarts_;
+    /// Indices of source batches whose vertices must be copied in the current update.
+    PODVector<unsigned> dirtyBatches_;
+    /// Locked vertex data for the current update.
+    Vertex2D* copyDest_;
+    /// Vertex start of the locked range for the current update.
+    unsigned copyStart_;
     /// Batch updated frame number.
     unsigned batchUpdatedFrameNumber_;
     /// Source batches.
@@ -109,6 +122,8 @@ private:
     void GetDrawables(PODVector<Drawable2D*>& drawables, Node* node);
     /// Update view batch info.
     void UpdateViewBatchInfo(ViewBatchInfo2D& viewBatchInfo, Camera* camera);
+    /// Copy the vertices of changed or moved source batches to the view's vertex buffer.
+    void UpdateVertexBuffer(ViewBatchInfo2D& viewBatchInfo);
     /// Add view batch.
     void AddViewBatch(ViewBatchInfo2D& viewBatchInfo, Material* material, 
         unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float distance);
@@ -56,6 +56,7 @@ RigidBody2D::RigidBody2D(Context* context) :
     massData_.mass = 0.0f;
     massData_.I = 0.0f;
     massData_.center.SetZero();
+    previousTransform_.SetIdentity();
 }
 
 RigidBody2D::~RigidBody2D()
@@ -350,6 +351,7 @@ void RigidBody2D::CreateBody()
 
     body_ = physicsWorld_->GetWorld()->CreateBody(&bodyDef_);
     body_->SetUserData(this);
+    previousTransform_ = body_->GetTransform();
 
     for (unsigned i = 0; i < collisionShapes_.Size(); ++i)
     {
@@ -391,7 +393,7 @@ void RigidBody2D::ReleaseBody()
     body_ = 0;
 }
 
-void RigidBody2D::ApplyWorldTransform()
+void RigidBody2D::ApplyWorldTransform(float interpolation)
 {
     if (!body_ || !node_)
         return;
@@ -408,10 +410,26 @@ void RigidBody2D::ApplyWorldTransform()
         return;
 
     const b2Transform& transform = body_->GetTransform();
+    b2Vec2 position = transform.p;
+    float angle = transform.q.GetAngle();
+    if (interpolation < 1.0f)
+    {
+        // Interpolate along the shorter arc, as the angles are wrapped to [-pi, pi]
+        float previousAngle = previousTransform_.q.GetAngle();
+        float deltaAngle = angle - previousAngle;
+        if (deltaAngle > M_PI)
+            deltaAngle -= 2.0f * M_PI;
+        else if (deltaAngle < -M_PI)
+            deltaAngle += 2.0f * M_PI;
+
+        position = previousTransform_.p + interpolation * (position - previousTransform_.p);
+        angle = previousAngle + interpolation * deltaAngle;
+    }
+
     Vector3 newWorldPosition = node_->GetWorldPosition();
-    newWorldPosition.x_ = transform.p.x;
-    newWorldPosition.y_ = transform.p.y;
-    Quaternion newWorldRotation(transform.q.GetAngle() * M_RADTODEG, Vector3::FORWARD);
+    newWorldPosition.x_ = position.x;
+    newWorldPosition.y_ = position.y;
+    Quaternion newWorldRotation(angle * M_RADTODEG, Vector3::FORWARD);
 
     if (parentRigidBody)
     {
@@ -426,6 +444,12 @@ void RigidBody2D::ApplyWorldTransform()
         ApplyWorldTransform(newWorldPosition, newWorldRotation);
 }
 
+void RigidBody2D::StorePreviousTransform()
+{
+    if (body_)
+        previousTransform_ = body_->GetTransform();
+}
+
 void RigidBody2D::ApplyWorldTransform(const Vector3& newWorldPosition, const Quaternion& newWorldRotation)
 {
     if (newWorldPosition != node_->GetWorldPosition() || newWorldRotation != node_->GetWorldRotation())
@@ -436,6 +460,11 @@ void RigidBody2D::ApplyWorldTransform(const Vector3& newWorldPosition, const Qua
         node_->SetWorldRotation(newWorldRotation);
         physicsWorld_->SetApplyingTransforms(false);
     }
+
+    // Record the applied pose, which may be interpolated and so differ from the body's, to detect later outside changes.
+    // Read it back from the node so that it compares exactly with what OnMarkedDirty() computes
+    bodyDef_.position = ToB2Vec2(node_->GetWorldPosition());
+    bodyDef_.angle = node_->GetWorldRotation().RollAngle() * M_DEGTORAD;
 }
 
 void RigidBody2D::AddCollisionShape2D(CollisionShape2D* collisionShape)
@@ -568,7 +597,8 @@ void RigidBody2D::OnMarkedDirty(Node* node)
         return;
     }
 
-    // Check if transform has changed from the last one set in ApplyWorldTransform()
+    // Check if transform has changed from the last one set in ApplyWorldTransform(), for example by moving a parent node.
+    // Other changes such as scale leave the pose and the simulation untouched
     b2Vec2 newPosition = ToB2Vec2(node_->GetWorldPosition());
     float newAngle = node_->GetWorldRotation().RollAngle() * M_DEGTORAD;
     if (newPosition != bodyDef_.position || newAngle != bodyDef_.angle)
@@ -576,7 +606,11 @@ void RigidBody2D::OnMarkedDirty(Node* node)
         bodyDef_.position = newPosition;
         bodyDef_.angle = newAngle;
         if (body_)
+        {
+            // Moved from outside the simulation: do not interpolate from the old position
             body_->SetTransform(newPosition, newAngle);
+            previousTransform_ = body_->GetTransform();
+        }
     }
 }
 
@@ -101,8 +101,10 @@ public:
     /// Release body.
     void ReleaseBody();
 
-    /// Apply world transform from the Box2D body. Called by PhysicsWorld2D.
-    void ApplyWorldTransform();
+    /// Apply world transform from the Box2D body, optionally interpolated from the previous step's transform. Called by PhysicsWorld2D.
+    void ApplyWorldTransform(float interpolation = 1.0f);
+    /// Store the Box2D body transform before a simulation step for interpolation. Called by PhysicsWorld2D.
+    void StorePreviousTransform();
     /// Apply specified world position & rotation. Called by PhysicsWorld2D.
     void ApplyWorldTransform(const Vector3& newWorldPosition, const Quaternion& newWorldRotation);
     /// Add collision shape.
@@ -165,7 +167,7 @@ private:
 
     /// Physics world.
     WeakPtr<PhysicsWorld2D> physicsWorld_;
-    /// Box2D body define.
+    /// Box2D body define. Its position and angle hold the last pose applied to the node.
     b2BodyDef bodyDef_;
     /// Box2D mass data.
     b2MassData massData_;
@@ -173,6 +175,8 @@ private:
     bool useFixtureMass_;
     /// Box2D body.
     b2Body* body_;
+    /// Box2D body transform before the last simulation step.
+    b2Transform previousTransform_;
     /// Collision shapes.
     Vector<WeakPtr<CollisionShape2D> > collisionShapes_;
     /// Constraints.
@@ -0,0 +1,224 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Texture2D.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+#include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
+#include "../Urho2D/SpriteSheet2D.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+SpriteAtlas2D::SpriteAtlas2D(Context* context) :
+    Object(context),
+    pageSize_(2048),
+    padding_(1)
+{
+}
+
+SpriteAtlas2D::~SpriteAtlas2D()
+{
+}
+
+void SpriteAtlas2D::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SpriteAtlas2D>();
+}
+
+void SpriteAtlas2D::SetPageSize(int size)
+{
+    pageSize_ = Max(size, 1);
+}
+
+void SpriteAtlas2D::SetPadding(int padding)
+{
+    padding_ = Max(padding, 0);
+}
+
+bool SpriteAtlas2D::AddSprite(Sprite2D* sprite)
+{
+    if (!sprite || !sprite->GetTexture())
+    {
+        URHO3D_LOGERROR("Null sprite or sprite without texture, can not add to atlas");
+        return false;
+    }
+
+    if (sprite->GetSpriteSheet())
+    {
+        URHO3D_LOGWARNING("Sprite " + sprite->GetName() + " already belongs to a sprite sheet, not adding to atlas");
+        return false;
+    }
+
+    // Textures do not keep their image data, so load the source image again. Load it as a temporary resource, so that the
+    // image is freed after packing instead of staying in the resource cache
+    Texture2D* texture = sprite->GetTexture();
+    SharedPtr<Image> source = GetSubsystem<ResourceCache>()->GetTempResource<Image>(texture->GetName());
+    if (!source)
+    {
+        URHO3D_LOGERROR("Could not load image " + texture->GetName() + " for sprite atlas");
+        return false;
+    }
+
+    if (source->IsCompressed() || source->GetDepth() > 1)
+    {
+        URHO3D_LOGERROR("Compressed or 3D image " + texture->GetName() + " can not be added to sprite atlas");
+        return false;
+    }
+
+    IntRect sourceRect = sprite->GetRectangle();
+    sourceRect.left_ = Clamp(sourceRect.left_, 0, source->GetWidth());
+    sourceRect.right_ = Clamp(sourceRect.right_, sourceRect.left_, source->GetWidth());
+    sourceRect.top_ = Clamp(sourceRect.top_, 0, source->GetHeight());
+    sourceRect.bottom_ = Clamp(sourceRect.bottom_, sourceRect.top_, source->GetHeight());
+
+    int width = sourceRect.Width();
+    int height = sourceRect.Height();
+    if (width + 2 * padding_ > pageSize_ || height + 2 * padding_ > pageSize_)
+    {
+        URHO3D_LOGERROR("Sprite " + sprite->GetName() + " is too large for sprite atlas page size " + String(pageSize_));
+        return false;
+    }
+
+    // Try the existing pages first, newest first as the older ones are more likely to be full
+    unsigned pageIndex = pages_.Size();
+    int x = 0;
+    int y = 0;
+    for (unsigned i = pages_.Size() - 1; i < pages_.Size(); --i)
+    {
+        if (pages_[i].allocator_.Allocate(width + 2 * padding_, height + 2 * padding_, x, y))
+        {
+            pageIndex = i;
+            break;
+        }
+    }
+
+    if (pageIndex == pages_.Size())
+    {
+        CreatePage().allocator_.Allocate(width + 2 * padding_, height + 2 * padding_, x, y);
+        pageIndex = pages_.Size() - 1;
+    }
+
+    Page& page = pages_[pageIndex];
+    x += padding_;
+    y += padding_;
+
+    unsigned char* dest = page.image_->GetData();
+    if (source->GetComponents() == 4)
+    {
+        const unsigned char* src = source->GetData();
+        for (int row = 0; row < height; ++row)
+        {
+            memcpy(dest + ((y + row) * pageSize_ + x) * 4, src + ((sourceRect.top_ + row) * source->GetWidth() +
+                sourceRect.left_) * 4, (size_t)width * 4);
+        }
+    }
+    else
+    {
+        for (int row = 0; row < height; ++row)
+        {
+            for (int column = 0; column < width; ++column)
+                page.image_->SetPixelInt(x + column, y + row, source->GetPixelInt(sourceRect.left_ + column, sourceRect.top_ + row));
+        }
+    }
+
+    page.dirty_ = true;
+
+    PendingSprite pending;
+    pending.sprite_ = sprite;
+    pending.page_ = pageIndex;
+    pending.rectangle_ = IntRect(x, y, x + width, y + height);
+    pendingSprites_.Push(pending);
+
+    return true;
+}
+
+void SpriteAtlas2D::Commit()
+{
+    for (unsigned i = 0; i < pages_.Size(); ++i)
+    {
+        Page& page = pages_[i];
+        if (!page.dirty_)
+            continue;
+
+        Texture2D* texture = page.spriteSheet_->GetTexture();
+        if (!texture)
+        {
+            SharedPtr<Texture2D> newTexture(new Texture2D(context_));
+            newTexture->SetName(page.spriteSheet_->GetName());
+            // Mip levels would blend neighbouring sprites together
+            newTexture->SetNumLevels(1);
+            page.spriteSheet_->SetTexture(newTexture);
+            texture = newTexture;
+        }
+
+        texture->SetData(page.image_, true);
+        page.dirty_ = false;
+    }
+
+    for (unsigned i = 0; i < pendingSprites_.Size(); ++i)
+    {
+        const PendingSprite& pending = pendingSprites_[i];
+        Sprite2D* sprite = pending.sprite_;
+        SpriteSheet2D* spriteSheet = pages_[pending.page_].spriteSheet_;
+
+        spriteSheet->DefineSprite(sprite->GetName(), pending.rectangle_, sprite->GetHotSpot(), sprite->GetOffset());
+
+        sprite->SetTexture(spriteSheet->GetTexture());
+        sprite->SetRectangle(pending.rectangle_);
+        sprite->SetSpriteSheet(spriteSheet);
+    }
+
+    pendingSprites_.Clear();
+}
+
+SpriteSheet2D* SpriteAtlas2D::GetPage(unsigned index) const
+{
+    return index < pages_.Size() ? pages_[index].spriteSheet_ : (SpriteSheet2D*)0;
+}
+
+SpriteAtlas2D::Page& SpriteAtlas2D::CreatePage()
+{
+    pages_.Resize(pages_.Size() + 1);
+    Page& page = pages_.Back();
+
+    page.image_ = new Image(context_);
+    page.image_->SetSize(pageSize_, pageSize_, 4);
+    page.image_->ClearInt(0);
+    page.allocator_.Reset(pageSize_, pageSize_, 0, 0, false);
+    page.spriteSheet_ = new SpriteSheet2D(context_);
+    // Renderer2D names materials after their texture, so keep the page names unique
+    static unsigned pageCounter = 0;
+    page.spriteSheet_->SetName("SpriteAtlas2D_" + String(pageCounter++));
+    page.dirty_ = false;
+
+    return page;
+}
+
+}
@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Math/AreaAllocator.h"
+
+namespace Urho3D
+{
+
+class Image;
+class Sprite2D;
+class SpriteSheet2D;
+
+/// Runtime sprite atlas. Packs the images of loose sprites into shared texture pages, so that sprites which used
+/// separate textures can be drawn with the same material and merged into the same batch by Renderer2D.
+class URHO3D_API SpriteAtlas2D : public Object
+{
+    URHO3D_OBJECT(SpriteAtlas2D, Object);
+
+public:
+    /// Construct.
+    SpriteAtlas2D(Context* context);
+    /// Destruct.
+    virtual ~SpriteAtlas2D();
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set page width and height in pixels. Only affects pages created after the call. Default 2048.
+    void SetPageSize(int size);
+    /// Set transparent padding in pixels around each packed sprite. Default 1.
+    void SetPadding(int padding);
+    /// Pack a sprite's image into a page. The sprite is moved to the page texture on the next Commit(), so sprites
+    /// should be added before they are assigned to drawables. Return true if successful.
+    bool AddSprite(Sprite2D* sprite);
+    /// Upload changed pages and move the sprites added since the last commit to the page textures.
+    void Commit();
+
+    /// Return page size.
+    int GetPageSize() const { return pageSize_; }
+
+    /// Return padding.
+    int GetPadding() const { return padding_; }
+
+    /// Return number of pages.
+    unsigned GetNumPages() const { return pages_.Size(); }
+
+    /// Return sprite sheet of a page. Its sprites are defined by the names of the packed sprites.
+    SpriteSheet2D* GetPage(unsigned index) const;
+
+private:
+    /// Atlas page.
+    struct Page
+    {
+        /// Page image.
+        SharedPtr<Image> image_;
+        /// Area allocator.
+        AreaAllocator allocator_;
+        /// Sprite sheet holding the page texture.
+        SharedPtr<SpriteSheet2D> spriteSheet_;
+        /// Image changed since the last commit flag.
+        bool dirty_;
+    };
+
+    /// Sprite packed but not yet committed.
+    struct PendingSprite
+    {
+        /// Sprite.
+        SharedPtr<Sprite2D> sprite_;
+        /// Page index.
+        unsigned page_;
+        /// Rectangle in the page.
+        IntRect rectangle_;
+    };
+
+    /// Create a new page.
+    Page& CreatePage();
+
+    /// Pages.
+    Vector<Page> pages_;
+    /// Sprites waiting for commit.
+    Vector<PendingSprite> pendingSprites_;
+    /// Page size.
+    int pageSize_;
+    /// Padding.
+    int padding_;
+};
+
+}
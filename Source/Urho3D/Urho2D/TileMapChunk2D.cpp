@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Texture2D.h"
+#include "../Scene/Node.h"
+#include "../Urho2D/Renderer2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
+#include "../Urho2D/TmxFile2D.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+TileMapChunk2D::TileMapChunk2D(Context* context) :
+    Drawable2D(context),
+    tileLayer_(0),
+    tileRect_(IntRect::ZERO)
+{
+}
+
+TileMapChunk2D::~TileMapChunk2D()
+{
+}
+
+void TileMapChunk2D::RegisterObject(Context* context)
+{
+    context->RegisterFactory<TileMapChunk2D>();
+}
+
+void TileMapChunk2D::SetTiles(const TmxTileLayer2D* tileLayer, const TileMapInfo2D& info, const IntRect& tileRect)
+{
+    tileLayer_ = tileLayer;
+    info_ = info;
+    tileRect_ = tileRect;
+
+    sourceBatchesDirty_ = true;
+    OnMarkedDirty(node_);
+}
+
+void TileMapChunk2D::OnWorldBoundingBoxUpdate()
+{
+    boundingBox_.Clear();
+    worldBoundingBox_.Clear();
+
+    const Vector<SourceBatch2D>& sourceBatches = GetSourceBatches();
+    for (unsigned i = 0; i < sourceBatches.Size(); ++i)
+    {
+        const Vector<Vertex2D>& vertices = sourceBatches[i].vertices_;
+        for (unsigned j = 0; j < vertices.Size(); ++j)
+            worldBoundingBox_.Merge(vertices[j].position_);
+    }
+
+    boundingBox_ = worldBoundingBox_.Transformed(node_->GetWorldTransform().Inverse());
+}
+
+void TileMapChunk2D::OnDrawOrderChanged()
+{
+    long long drawOrder = GetDrawOrder();
+    for (unsigned i = 0; i < sourceBatches_.Size(); ++i)
+        sourceBatches_[i].drawOrder_ = drawOrder + batchDrawOrders_[i];
+}
+
+void TileMapChunk2D::UpdateSourceBatches()
+{
+    if (!sourceBatchesDirty_)
+        return;
+
+    sourceBatches_.Clear();
+    batchDrawOrders_.Clear();
+
+    if (!tileLayer_ || !renderer_)
+        return;
+
+    const Matrix3x4& worldTransform = node_->GetWorldTransform();
+    unsigned color = Color::WHITE.ToUInt();
+
+    // Tiles are visited in the same order the per-tile sprites used to be drawn in. A new batch starts on each row and
+    // whenever the material changes, so that overlapping tiles keep their relative order. The draw order below the
+    // drawable's own is made of the row, the chunk column and the batch within the row, so that rows interleave correctly
+    // with the neighbouring chunks, e.g. on staggered maps or with tiles taller than one cell. A row of a chunk has at most
+    // as many batches as tiles, so the batch and chunk column never overflow into the row
+    unsigned numChunksX = (unsigned)(tileLayer_->GetWidth() + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    unsigned rowStride = numChunksX * TILE_CHUNK_SIZE;
+    unsigned chunkOffset = (unsigned)(tileRect_.left_ / TILE_CHUNK_SIZE) * TILE_CHUNK_SIZE;
+    for (int y = tileRect_.top_; y < tileRect_.bottom_; ++y)
+    {
+        unsigned rowStart = sourceBatches_.Size();
+        for (int x = tileRect_.left_; x < tileRect_.right_; ++x)
+        {
+            const Tile2D* tile = tileLayer_->GetTile(x, y);
+            if (!tile)
+                continue;
+
+            Sprite2D* sprite = tile->GetSprite();
+            if (!sprite)
+                continue;
+
+            Rect drawRect;
+            Rect textureRect;
+            if (!sprite->GetDrawRectangle(drawRect) || !sprite->GetTextureRectangle(textureRect))
+                continue;
+
+            Material* material = renderer_->GetMaterial(sprite->GetTexture(), BLEND_ALPHA);
+            if (sourceBatches_.Size() == rowStart || sourceBatches_.Back().material_ != material)
+            {
+                unsigned batchInRow = sourceBatches_.Size() - rowStart;
+                sourceBatches_.Resize(sourceBatches_.Size() + 1);
+                sourceBatches_.Back().owner_ = this;
+                sourceBatches_.Back().material_ = material;
+                batchDrawOrders_.Push((unsigned)y * rowStride + chunkOffset + batchInRow);
+            }
+
+            Vector<Vertex2D>& vertices = sourceBatches_.Back().vertices_;
+            drawRect.min_ += info_.TileIndexToPosition(x, y);
+            drawRect.max_ += info_.TileIndexToPosition(x, y);
+
+            Vertex2D vertex0;
+            Vertex2D vertex1;
+            Vertex2D vertex2;
+            Vertex2D vertex3;
+
+            vertex0.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.min_.y_, 0.0f);
+            vertex1.position_ = worldTransform * Vector3(drawRect.min_.x_, drawRect.max_.y_, 0.0f);
+            vertex2.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.max_.y_, 0.0f);
+            vertex3.position_ = worldTransform * Vector3(drawRect.max_.x_, drawRect.min_.y_, 0.0f);
+
+            vertex0.uv_ = textureRect.min_;
+            vertex1.uv_ = Vector2(textureRect.min_.x_, textureRect.max_.y_);
+            vertex2.uv_ = textureRect.max_;
+            vertex3.uv_ = Vector2(textureRect.max_.x_, textureRect.min_.y_);
+
+            vertex0.color_ = vertex1.color_ = vertex2.color_ = vertex3.color_ = color;
+
+            vertices.Push(vertex0);
+            vertices.Push(vertex1);
+            vertices.Push(vertex2);
+            vertices.Push(vertex3);
+        }
+    }
+
+    OnDrawOrderChanged();
+
+    sourceBatchesDirty_ = false;
+}
+
+}
@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2008-2016 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Urho2D/Drawable2D.h"
+#include "../Urho2D/TileMapDefs2D.h"
+
+namespace Urho3D
+{
+
+class TmxTileLayer2D;
+
+/// Number of tiles along each side of a tile map chunk.
+static const int TILE_CHUNK_SIZE = 32;
+
+/// Drawable for a rectangular block of tiles in a tile layer. Created by TileMapLayer2D. Each row of tiles gets its own source batches, with a draw order by row, so that the rows of neighbouring chunks are drawn in the map's row order.
+class URHO3D_API TileMapChunk2D : public Drawable2D
+{
+    URHO3D_OBJECT(TileMapChunk2D, Drawable2D);
+
+public:
+    /// Construct.
+    TileMapChunk2D(Context* context);
+    /// Destruct.
+    ~TileMapChunk2D();
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set tile layer, map info and the tile index rectangle (right and bottom exclusive) covered by this chunk.
+    void SetTiles(const TmxTileLayer2D* tileLayer, const TileMapInfo2D& info, const IntRect& tileRect);
+
+    /// Return tile index rectangle.
+    const IntRect& GetTileRect() const { return tileRect_; }
+
+protected:
+    /// Recalculate the world-space bounding box.
+    virtual void OnWorldBoundingBoxUpdate();
+    /// Handle draw order changed.
+    virtual void OnDrawOrderChanged();
+    /// Update source batches.
+    virtual void UpdateSourceBatches();
+
+private:
+    /// Tile layer.
+    const TmxTileLayer2D* tileLayer_;
+    /// Tile map info.
+    TileMapInfo2D info_;
+    /// Tile index rectangle.
+    IntRect tileRect_;
+    /// Draw order of each source batch relative to the drawable's draw order.
+    PODVector<unsigned> batchDrawOrders_;
+};
+
+}
@@ -28,6 +28,7 @@
 #include "../Scene/Node.h"
 #include "../Urho2D/StaticSprite2D.h"
 #include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
 #include "../Urho2D/TmxFile2D.h"
 
@@ -171,9 +172,9 @@ void TileMapLayer2D::SetDrawOrder(int drawOrder)
         if (!nodes_[i])
             continue;
 
-        StaticSprite2D* staticSprite = nodes_[i]->GetComponent<StaticSprite2D>();
-        if (staticSprite)
-            staticSprite->SetLayer(drawOrder_);
+        Drawable2D* drawable = nodes_[i]->GetDerivedComponent<Drawable2D>();
+        if (drawable)
+            drawable->SetLayer(drawOrder_);
     }
 }
 
@@ -242,7 +243,8 @@ Node* TileMapLayer2D::GetTileNode(int x, int y) const
     if (x < 0 || x >= tileLayer_->GetWidth() || y < 0 || y >= tileLayer_->GetHeight())
         return 0;
 
-    return nodes_[y * tileLayer_->GetWidth() + x];
+    int numChunksX = (tileLayer_->GetWidth() + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    return nodes_[(y / TILE_CHUNK_SIZE) * numChunksX + x / TILE_CHUNK_SIZE];
 }
 
 unsigned TileMapLayer2D::GetNumObjects() const
@@ -289,27 +291,29 @@ void TileMapLayer2D::SetTileLayer(const TmxTileLayer2D* tileLayer)
 
     int width = tileLayer->GetWidth();
     int height = tileLayer->GetHeight();
-    nodes_.Resize((unsigned)(width * height));
+    int numChunksX = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    int numChunksY = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+    nodes_.Resize((unsigned)(numChunksX * numChunksY));
 
+    // Render the tiles in square chunks instead of a node and sprite per tile, so that node count, memory use and
+    // culling cost scale with the number of chunks. Each chunk only rebuilds its vertices when it is dirtied
     const TileMapInfo2D& info = tileMap_->GetInfo();
-    for (int y = 0; y < height; ++y)
+    for (int cy = 0; cy < numChunksY; ++cy)
     {
-        for (int x = 0; x < width; ++x)
+        for (int cx = 0; cx < numChunksX; ++cx)
         {
-            const Tile2D* tile = tileLayer->GetTile(x, y);
-            if (!tile)
-                continue;
+            IntRect tileRect(cx * TILE_CHUNK_SIZE, cy * TILE_CHUNK_SIZE, Min((cx + 1) * TILE_CHUNK_SIZE, width),
+                Min((cy + 1) * TILE_CHUNK_SIZE, height));
 
-            SharedPtr<Node> tileNode(GetNode()->CreateChild("Tile"));
-            tileNode->SetTemporary(true);
-            tileNode->SetPosition(info.TileIndexToPosition(x, y));
+            SharedPtr<Node> chunkNode(GetNode()->CreateChild("TileChunk"));
+            chunkNode->SetTemporary(true);
 
-            StaticSprite2D* staticSprite = tileNode->CreateComponent<StaticSprite2D>();
-            staticSprite->SetSprite(tile->GetSprite());
-            staticSprite->SetLayer(drawOrder_);
-            staticSprite->SetOrderInLayer(y * width + x);
+            TileMapChunk2D* chunk = chunkNode->CreateComponent<TileMapChunk2D>();
+            chunk->SetTiles(tileLayer, info, tileRect);
+            // The chunks share the order in layer, as they order their tile rows among each other
+            chunk->SetLayer(drawOrder_);
 
-            nodes_[y * width + x] = tileNode;
+            nodes_[cy * numChunksX + cx] = chunkNode;
         }
     }
 }
@@ -82,7 +82,7 @@ public:
     int GetWidth() const;
     /// Return height (for tile layer only).
     int GetHeight() const;
-    /// Return tile node (for tile layer only).
+    /// Return node of the chunk that renders the tile (for tile layer only). The node is shared by all tiles of a 32x32 chunk, so moving or hiding it affects the whole chunk. There are no longer per-tile nodes.
     Node* GetTileNode(int x, int y) const;
     /// Return tile (for tile layer only).
     Tile2D* GetTile(int x, int y) const;
@@ -119,7 +119,7 @@ private:
     int drawOrder_;
     /// Visible.
     bool visible_;
-    /// Tile node or image nodes.
+    /// Tile chunk, object or image nodes.
     Vector<SharedPtr<Node> > nodes_;
 };
 
@@ -110,6 +110,9 @@ bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
     XMLElement tileElem = dataElem.GetChild("tile");
     tiles_.Resize((unsigned)(width_ * height_));
 
+    // Tiles with the same gid share one Tile2D, so memory use follows the number of distinct tiles
+    HashMap<int, SharedPtr<Tile2D> > gidToTile;
+
     for (int y = 0; y < height_; ++y)
     {
         for (int x = 0; x < width_; ++x)
@@ -120,10 +123,14 @@ bool TmxTileLayer2D::Load(const XMLElement& element, const TileMapInfo2D& info)
             int gid = tileElem.GetInt("gid");
             if (gid > 0)
             {
-                SharedPtr<Tile2D> tile(new Tile2D());
-                tile->gid_ = gid;
-                tile->sprite_ = tmxFile_->GetTileSprite(gid);
-                tile->propertySet_ = tmxFile_->GetTilePropertySet(gid);
+                SharedPtr<Tile2D>& tile = gidToTile[gid];
+                if (!tile)
+                {
+                    tile = new Tile2D();
+                    tile->gid_ = gid;
+                    tile->sprite_ = tmxFile_->GetTileSprite(gid);
+                    tile->propertySet_ = tmxFile_->GetTilePropertySet(gid);
+                }
                 tiles_[y * width_ + x] = tile;
             }
 
@@ -47,8 +47,10 @@
 #include "../Urho2D/Renderer2D.h"
 #include "../Urho2D/RigidBody2D.h"
 #include "../Urho2D/Sprite2D.h"
+#include "../Urho2D/SpriteAtlas2D.h"
 #include "../Urho2D/SpriteSheet2D.h"
 #include "../Urho2D/TileMap2D.h"
+#include "../Urho2D/TileMapChunk2D.h"
 #include "../Urho2D/TileMapLayer2D.h"
 #include "../Urho2D/TmxFile2D.h"
 
@@ -65,6 +67,7 @@ void RegisterUrho2DLibrary(Context* context)
 
     Sprite2D::RegisterObject(context);
     SpriteSheet2D::RegisterObject(context);
+    SpriteAtlas2D::RegisterObject(context);
 
     // Must register objects from base to derived order
     Drawable2D::RegisterObject(context);
@@ -79,6 +82,7 @@ void RegisterUrho2DLibrary(Context* context)
     TmxFile2D::RegisterObject(context);
     TileMap2D::RegisterObject(context);
     TileMapLayer2D::RegisterObject(context);
+    TileMapChunk2D::RegisterObject(context);
 
     PhysicsWorld2D::RegisterObject(context);
     RigidBody2D::RegisterObject(context);
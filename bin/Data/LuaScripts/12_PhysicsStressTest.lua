@@ -3,6 +3,7 @@
 --     - Physics and rendering performance with a high (1000) moving object count
 --     - Using triangle meshes for collision
 --     - Optimizing physics simulation by leaving out collision event signaling
+--     - Running the physics simulation on multiple threads
 --     - Usage of Lua Coroutine to yield/resume based on time step
 
 require "LuaScripts/Utilities/Sample"
@@ -136,7 +137,8 @@ function CreateInstructions()
     instructionText:SetText("Use WASD keys and mouse to move\n"..
         "LMB to spawn physics objects\n"..
         "F5 to save scene, F7 to load\n"..
-        "Space to toggle physics debug geometry")
+        "Space to toggle physics debug geometry\n"..
+        "T to toggle multithreaded physics, F2 to see step time")
     instructionText:SetFont(cache:GetResource("Font", "Fonts/Anonymous Pro.ttf"), 15)
     -- The text has multiple rows. Center them in relation to each other
     instructionText.textAlignment = HA_CENTER
@@ -214,6 +216,12 @@ function MoveCamera(timeStep)
     if input:GetKeyPress(KEY_SPACE) then
         drawDebug = not drawDebug
     end
+
+    -- Toggle multithreaded physics simulation with T. Compare the StepSimulation time in the profiler (F2)
+    if input:GetKeyPress(KEY_T) then
+        local physicsWorld = scene_:GetComponent("PhysicsWorld")
+        physicsWorld.threadedSimulation = not physicsWorld.threadedSimulation
+    end
 end
 
 function SpawnObject()